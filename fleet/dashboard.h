@@ -0,0 +1,166 @@
+#ifndef FLEET_DASHBOARD_H
+#define FLEET_DASHBOARD_H
+
+// Fleet dashboard page (GET /). Polls /api/fleet with the version from its
+// last reply, so it only receives the controllers that changed.
+static const char DASHBOARD_HTML[] = R"HTML(<!DOCTYPE html>
+<html lang="en">
+<head>
+    <meta charset="UTF-8">
+    <meta name="viewport" content="width=device-width, initial-scale=1.0">
+    <title>Feeder Fleet</title>
+    <style>
+        * { margin: 0; padding: 0; box-sizing: border-box; }
+        body { font-family: 'Segoe UI', Tahoma, Geneva, Verdana, sans-serif; background: #f5f5f5; padding: 20px; }
+        .container { max-width: 1400px; margin: 0 auto; }
+        h1 { color: #333; margin-bottom: 20px; }
+        .card { background: white; border-radius: 8px; padding: 20px; margin-bottom: 20px; box-shadow: 0 2px 4px rgba(0,0,0,0.1); }
+        .card h2 { color: #444; margin-bottom: 15px; font-size: 1.3em; }
+        .summary { display: grid; grid-template-columns: repeat(auto-fit, minmax(120px, 1fr)); gap: 15px; }
+        .summary div { background: #f9f9f9; border-radius: 5px; padding: 12px; text-align: center; cursor: pointer; }
+        .summary div.selected { outline: 2px solid #2196F3; }
+        .summary b { display: block; font-size: 1.8em; color: #333; }
+        .summary span { color: #666; font-size: 0.9em; }
+        table { width: 100%; border-collapse: collapse; font-size: 0.95em; }
+        th, td { padding: 8px; text-align: left; border-bottom: 1px solid #eee; }
+        th { background: #f9f9f9; color: #555; }
+        tbody tr { cursor: pointer; }
+        tbody tr:hover { background: #f0f7ff; }
+        .state { padding: 2px 8px; border-radius: 10px; color: white; font-size: 0.85em; }
+        .idle, .waiting, .manual { background: #607D8B; }
+        .starting { background: #FF9800; }
+        .feeding { background: #4CAF50; }
+        .alarm, .error { background: #f44336; }
+        .offline, .unknown { background: #9E9E9E; }
+        .muted { color: #888; }
+        .err { color: #c62828; }
+    </style>
+</head>
+<body>
+<div class="container">
+    <h1>Feeder Fleet</h1>
+
+    <div class="card">
+        <div class="summary" id="summary"></div>
+    </div>
+
+    <div class="card">
+        <h2>Controllers</h2>
+        <table>
+            <thead><tr>
+                <th>Controller</th><th>State</th><th>Bin A</th><th>Bin B</th><th>Bin C</th><th>Bin D</th>
+                <th>Dispensed</th><th>Flow</th><th>Next feed</th><th>Last seen</th><th>Error</th>
+            </tr></thead>
+            <tbody id="controllers"></tbody>
+        </table>
+    </div>
+
+    <div class="card" id="historyCard" style="display:none">
+        <h2 id="historyTitle"></h2>
+        <table>
+            <thead><tr>
+                <th>Time</th><th>Cycle</th><th>Target</th><th>Actual</th><th>Duration</th><th>Alarm</th>
+            </tr></thead>
+            <tbody id="history"></tbody>
+        </table>
+    </div>
+</div>
+
+<script>
+    let version = 0;
+    let filter = 'all';
+    const controllers = {};
+
+    function esc(s) {
+        return String(s).replace(/[&<>"]/g, c => ({'&': '&amp;', '<': '&lt;', '>': '&gt;', '"': '&quot;'}[c]));
+    }
+
+    function num(v, digits) {
+        return typeof v === 'number' ? v.toFixed(digits) : '';
+    }
+
+    function clock(epoch) {
+        return epoch ? new Date(epoch * 1000).toLocaleString() : '';
+    }
+
+    function age(ms) {
+        if (!ms) return 'never';
+        const s = Math.max(0, Math.round((Date.now() - ms) / 1000));
+        return s < 60 ? s + ' s ago' : s < 3600 ? Math.round(s / 60) + ' min ago' : Math.round(s / 3600) + ' h ago';
+    }
+
+    function shown(c) {
+        if (filter === 'all') return true;
+        if (filter === 'offline') return !c.online;
+        return c.online && c.state === filter;
+    }
+
+    function renderSummary(s) {
+        const items = [['all', s.controllers, 'Controllers'], ['offline', s.offline, 'Offline'],
+                       ['starting', s.starting, 'Starting'], ['feeding', s.feeding, 'Feeding'], ['alarm', s.alarm, 'Alarm'],
+                       ['error', s.error, 'Error'], ['waiting', s.waiting, 'Waiting'], ['idle', s.idle, 'Idle']];
+        document.getElementById('summary').innerHTML = items.map(([key, count, label]) =>
+            `<div data-filter="${key}" class="${key === filter ? 'selected' : ''}"><b>${count}</b><span>${label}</span></div>`
+        ).join('');
+    }
+
+    function renderTable() {
+        const rows = Object.values(controllers).filter(shown).sort((a, b) => a.name.localeCompare(b.name));
+        document.getElementById('controllers').innerHTML = rows.map(c => {
+            const st = c.status || {};
+            const w = st.currentWeight || [];
+            const state = c.online ? c.state : 'offline';
+            const error = c.online ? (st.lastError || '') : c.lastError;
+            return `<tr data-name="${esc(c.name)}">
+                <td>${esc(c.name)}<br><span class="muted">${esc(c.host)}</span></td>
+                <td><span class="state ${state}">${state}</span></td>
+                <td>${num(w[0], 0)}</td><td>${num(w[1], 0)}</td><td>${num(w[2], 0)}</td><td>${num(w[3], 0)}</td>
+                <td>${num(st.weightDispensed, 1)}</td><td>${num(st.flowRate, 2)}</td>
+                <td>${clock(st.nextFeedTime)}</td><td>${age(c.lastSeen)}</td>
+                <td class="err">${esc(error)}</td></tr>`;
+        }).join('');
+    }
+
+    async function refresh() {
+        try {
+            const data = await (await fetch('/api/fleet?since=' + version)).json();
+            data.controllers.forEach(c => controllers[c.name] = c);
+            version = data.version;
+            renderSummary(data.summary);
+        } catch (e) {
+            // Keep the last view; next refresh tries again
+        }
+        renderTable();  // Ages move on even when nothing changed
+    }
+
+    async function showHistory(name) {
+        const data = await (await fetch('/api/fleet/history?controller=' + encodeURIComponent(name))).json();
+        document.getElementById('historyTitle').textContent = 'Feed History - ' + name;
+        document.getElementById('history').innerHTML = data.events.slice(-50).reverse().map(e => `<tr>
+            <td>${clock(e.timestamp)}</td><td>${e.feedCycle}</td><td>${num(e.targetWeight, 1)}</td>
+            <td>${num(e.actualWeight, 1)}</td><td>${e.duration} s</td>
+            <td class="err">${e.alarmTriggered ? esc(e.alarmReason) : ''}</td></tr>`).join('');
+        document.getElementById('historyCard').style.display = '';
+    }
+
+    document.getElementById('summary').addEventListener('click', e => {
+        const item = e.target.closest('[data-filter]');
+        if (!item) return;
+        filter = item.dataset.filter;
+        document.querySelectorAll('#summary div').forEach(d => d.classList.toggle('selected', d === item));
+        renderTable();
+    });
+
+    document.getElementById('controllers').addEventListener('click', e => {
+        const row = e.target.closest('tr');
+        if (row) showHistory(row.dataset.name);
+    });
+
+    refresh();
+    setInterval(refresh, 5000);
+</script>
+</body>
+</html>
+)HTML";
+
+#endif // FLEET_DASHBOARD_H
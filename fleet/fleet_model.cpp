@@ -0,0 +1,134 @@
+#include "fleet_model.h"
+#include "json_scan.h"
+
+// A status without the fields that change on every read (clock, heap,
+// BinTrac poll time), so an idle controller doesn't count as changed
+static std::string comparable(const std::string& status) {
+    return JsonScan::without(JsonScan::without(JsonScan::without(status, "currentTime"), "heap"),
+                             "lastBintracUpdate");
+}
+
+FleetModel::FleetModel(size_t historyLimit) : _version(0), _historyLimit(historyLimit) {}
+
+size_t FleetModel::add(const ControllerAddress& address) {
+    std::unique_lock<std::shared_mutex> lock(_lock);
+    ControllerRecord record;
+    record.address = address;
+    record.version = ++_version;
+    _controllers.push_back(record);
+    return _controllers.size() - 1;
+}
+
+size_t FleetModel::size() const {
+    std::shared_lock<std::shared_mutex> lock(_lock);
+    return _controllers.size();
+}
+
+const ControllerAddress& FleetModel::address(size_t index) const {
+    // Addresses don't change once polling starts
+    return _controllers[index].address;
+}
+
+ControllerState FleetModel::statusReceived(size_t index, const std::string& status, uint32_t latencyMs,
+                                           uint64_t now) {
+    double state = -1;
+    JsonScan::number(status, "state", state);
+
+    std::unique_lock<std::shared_mutex> lock(_lock);
+    ControllerRecord& record = _controllers[index];
+    ControllerState previous = record.state;
+
+    bool changed = !record.online || comparable(status) != comparable(record.status);
+
+    record.online = true;
+    record.lastSeen = now;
+    record.lastError.clear();
+    record.polls++;
+    record.failures = 0;
+    record.latencyMs = latencyMs;
+    record.status = status;
+    record.state = (ControllerState)(int)state;
+    if (changed) touch(record);
+    return previous;
+}
+
+void FleetModel::pollFailed(size_t index, const std::string& error) {
+    std::unique_lock<std::shared_mutex> lock(_lock);
+    ControllerRecord& record = _controllers[index];
+    bool changed = record.online || record.lastError != error;
+
+    record.online = false;
+    record.lastError = error;
+    record.polls++;
+    record.failures++;
+    if (changed) touch(record);
+}
+
+size_t FleetModel::historyCursor(size_t index) const {
+    std::shared_lock<std::shared_mutex> lock(_lock);
+    return _controllers[index].historyCursor;
+}
+
+uint32_t FleetModel::historyGeneration(size_t index) const {
+    std::shared_lock<std::shared_mutex> lock(_lock);
+    return _controllers[index].historyGeneration;
+}
+
+void FleetModel::historyReceived(size_t index, const std::vector<std::string>& events, size_t next,
+                                 uint32_t generation, bool restarted) {
+    std::unique_lock<std::shared_mutex> lock(_lock);
+    ControllerRecord& record = _controllers[index];
+    record.historyCursor = next;
+    record.historyGeneration = generation;
+
+    if (restarted) {
+        // Sequence numbers keep counting so a dashboard's since stays valid
+        record.historyFirst += record.history.size();
+        record.history.clear();
+    }
+    if (events.empty() && !restarted) return;
+
+    for (const std::string& event : events) {
+        record.history.push_back(event);
+    }
+    while (record.history.size() > _historyLimit) {
+        record.history.pop_front();
+        record.historyFirst++;
+    }
+    touch(record);
+}
+
+uint32_t FleetModel::failures(size_t index) const {
+    std::shared_lock<std::shared_mutex> lock(_lock);
+    return _controllers[index].failures;
+}
+
+uint64_t FleetModel::version() const {
+    std::shared_lock<std::shared_mutex> lock(_lock);
+    return _version;
+}
+
+uint64_t FleetModel::forEachChanged(uint64_t since,
+                                    const std::function<void(const ControllerRecord&)>& visit) const {
+    std::shared_lock<std::shared_mutex> lock(_lock);
+    for (const ControllerRecord& record : _controllers) {
+        if (record.version > since) visit(record);
+    }
+    return _version;
+}
+
+bool FleetModel::withController(const std::string& name,
+                                const std::function<void(const ControllerRecord&)>& visit) const {
+    std::shared_lock<std::shared_mutex> lock(_lock);
+    for (const ControllerRecord& record : _controllers) {
+        if (record.address.name == name) {
+            visit(record);
+            return true;
+        }
+    }
+    return false;
+}
+
+void FleetModel::touch(ControllerRecord& record) {
+    record.version = ++_version;
+}
@@ -0,0 +1,94 @@
+#ifndef FLEET_MODEL_H
+#define FLEET_MODEL_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+// Controller states as reported in /api/status "state" (SystemState in src/types.h)
+enum class ControllerState : int {
+    UNKNOWN = -1,
+    IDLE = 0,
+    WAITING = 1,
+    FEEDING = 2,
+    ALARM = 3,
+    MANUAL = 4,
+    ERROR = 5,
+    STARTING = 6  // Staggered start: feed due, waiting its turn behind other controllers
+};
+
+struct ControllerAddress {
+    std::string name;
+    std::string host;
+    uint16_t port = 80;
+};
+
+// Everything the aggregator knows about one controller
+struct ControllerRecord {
+    ControllerAddress address;
+
+    bool online = false;
+    uint64_t lastSeen = 0;        // Unix ms of the last good status (0 = never)
+    std::string lastError;
+    uint32_t polls = 0;
+    uint32_t failures = 0;        // Failed polls in a row
+    uint32_t latencyMs = 0;       // Last status round trip
+
+    std::string status;           // Last /api/status body as sent
+    ControllerState state = ControllerState::UNKNOWN;
+
+    std::deque<std::string> history;  // Feed events as sent, oldest first
+    uint64_t historyFirst = 0;        // Sequence number of history.front()
+    size_t historyCursor = 0;         // The controller's cursor for the next delta
+    uint32_t historyGeneration = 0;   // Generation that cursor belongs to (0 = none yet)
+
+    uint64_t version = 0;         // Model version of the last change to this record
+};
+
+// Consolidated view of the fleet, shared by the pollers (writers) and the
+// dashboard server (readers). Every change bumps a global version and stamps
+// the record with it, so a dashboard asking for changes since the version
+// it last saw gets only the controllers that changed.
+class FleetModel {
+public:
+    explicit FleetModel(size_t historyLimit = 500);
+
+    // Setup, before polling starts
+    size_t add(const ControllerAddress& address);
+    size_t size() const;
+    const ControllerAddress& address(size_t index) const;
+
+    // Poll results
+    // Returns the previous state
+    ControllerState statusReceived(size_t index, const std::string& status, uint32_t latencyMs, uint64_t now);
+    void pollFailed(size_t index, const std::string& error);
+    size_t historyCursor(size_t index) const;
+    uint32_t historyGeneration(size_t index) const;
+    // A history delta; restarted = the controller's history was cleared
+    // (the reply started over from its oldest event)
+    void historyReceived(size_t index, const std::vector<std::string>& events, size_t next, uint32_t generation,
+                         bool restarted);
+    uint32_t failures(size_t index) const;
+
+    uint64_t version() const;
+
+    // Read access for rendering, under the shared lock
+    // Calls visit for each record changed after since; returns the current version
+    uint64_t forEachChanged(uint64_t since, const std::function<void(const ControllerRecord&)>& visit) const;
+    // Calls visit for the named controller; false if there is none
+    bool withController(const std::string& name, const std::function<void(const ControllerRecord&)>& visit) const;
+
+private:
+    mutable std::shared_mutex _lock;
+    std::vector<ControllerRecord> _controllers;
+    uint64_t _version;
+    size_t _historyLimit;
+
+    void touch(ControllerRecord& record);
+};
+
+#endif // FLEET_MODEL_H
@@ -0,0 +1,248 @@
+#include "fleet_server.h"
+#include "dashboard.h"
+#include "json_scan.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static const int REQUEST_TIMEOUT_MS = 2000;
+static const size_t REQUEST_MAX = 8192;
+
+static const char* stateName(ControllerState state) {
+    switch (state) {
+        case ControllerState::IDLE: return "idle";
+        case ControllerState::WAITING: return "waiting";
+        case ControllerState::FEEDING: return "feeding";
+        case ControllerState::ALARM: return "alarm";
+        case ControllerState::MANUAL: return "manual";
+        case ControllerState::ERROR: return "error";
+        case ControllerState::STARTING: return "starting";
+        default: return "unknown";
+    }
+}
+
+static const char* reasonPhrase(int code) {
+    switch (code) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        default: return "Error";
+    }
+}
+
+FleetServer::FleetServer(const FleetModel& model, const ConnectionPool& pool)
+    : _model(model), _pool(pool), _listenFd(-1), _port(0), _running(false) {}
+
+FleetServer::~FleetServer() {
+    if (_listenFd >= 0) close(_listenFd);
+}
+
+bool FleetServer::begin(uint16_t port, std::string& error) {
+    _listenFd = socket(AF_INET6, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (_listenFd < 0) {
+        error = "socket: " + std::string(strerror(errno));
+        return false;
+    }
+    int one = 1;
+    int zero = 0;
+    setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(_listenFd, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero));  // IPv4 too
+
+    sockaddr_in6 address = {};
+    address.sin6_family = AF_INET6;
+    address.sin6_addr = in6addr_any;
+    address.sin6_port = htons(port);
+    if (bind(_listenFd, (sockaddr*)&address, sizeof(address)) != 0 || listen(_listenFd, 32) != 0) {
+        error = "port " + std::to_string(port) + ": " + strerror(errno);
+        close(_listenFd);
+        _listenFd = -1;
+        return false;
+    }
+
+    socklen_t length = sizeof(address);
+    getsockname(_listenFd, (sockaddr*)&address, &length);
+    _port = ntohs(address.sin6_port);
+    _running = true;
+    return true;
+}
+
+void FleetServer::run() {
+    while (_running) {
+        pollfd p = {_listenFd, POLLIN, 0};
+        if (poll(&p, 1, 200) <= 0) continue;
+
+        int fd = accept4(_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) continue;
+        serveConnection(fd);
+        close(fd);
+    }
+}
+
+void FleetServer::serveConnection(int fd) const {
+    timeval timeout = {REQUEST_TIMEOUT_MS / 1000, (REQUEST_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // Request line and headers; GETs have no body
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos) {
+        if (request.size() > REQUEST_MAX) return;
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) return;
+        request.append(buffer, n);
+    }
+
+    std::string method, target, contentType, body;
+    size_t methodEnd = request.find(' ');
+    size_t targetEnd = methodEnd != std::string::npos ? request.find(' ', methodEnd + 1) : std::string::npos;
+    int code = 400;
+    if (targetEnd != std::string::npos) {
+        method = request.substr(0, methodEnd);
+        target = request.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+        code = handle(method, target, contentType, body);
+    }
+    if (code != 200) {
+        contentType = "application/json";
+        body = "{\"error\":" + JsonScan::quote(reasonPhrase(code)) + "}";
+    }
+
+    char header[256];
+    int headerLength = snprintf(header, sizeof(header),
+                                "HTTP/1.1 %d %s\r\n"
+                                "Content-Type: %s\r\n"
+                                "Content-Length: %zu\r\n"
+                                "Cache-Control: no-store\r\n"
+                                "Connection: close\r\n\r\n",
+                                code, reasonPhrase(code), contentType.c_str(), body.size());
+    std::string response(header, headerLength);
+    if (method != "HEAD") response += body;
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t n = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        sent += n;
+    }
+}
+
+int FleetServer::handle(const std::string& method, const std::string& target, std::string& contentType,
+                        std::string& body) const {
+    if (method != "GET" && method != "HEAD") return 405;
+
+    size_t question = target.find('?');
+    std::string path = target.substr(0, question);
+    std::string query = question != std::string::npos ? target.substr(question + 1) : "";
+
+    if (path == "/" || path == "/index.html") {
+        contentType = "text/html; charset=utf-8";
+        body = DASHBOARD_HTML;
+        return 200;
+    }
+    if (path == "/api/fleet") {
+        contentType = "application/json";
+        body = fleetJson(strtoull(queryParam(query, "since").c_str(), nullptr, 10));
+        return 200;
+    }
+    if (path == "/api/fleet/history") {
+        contentType = "application/json";
+        std::string name = queryParam(query, "controller");
+        uint64_t since = strtoull(queryParam(query, "since").c_str(), nullptr, 10);
+        return historyJson(name, since, body) ? 200 : 404;
+    }
+    return 404;
+}
+
+std::string FleetServer::fleetJson(uint64_t since) const {
+    // Summary over the whole fleet
+    unsigned total = 0, online = 0;
+    unsigned states[8] = {};  // Indexed by state + 1 (unknown = 0)
+    _model.forEachChanged(0, [&](const ControllerRecord& record) {
+        total++;
+        if (!record.online) return;
+        online++;
+        int state = (int)record.state + 1;
+        states[state >= 0 && state < 8 ? state : 0]++;
+    });
+
+    // Only the controllers that changed since the caller's version
+    std::string controllers;
+    uint64_t version = _model.forEachChanged(since, [&](const ControllerRecord& record) {
+        if (!controllers.empty()) controllers += ',';
+        char fields[256];
+        snprintf(fields, sizeof(fields),
+                 ",\"port\":%u,\"online\":%s,\"state\":%s,\"lastSeen\":%llu,\"polls\":%u,\"failures\":%u,"
+                 "\"latencyMs\":%u,\"historyEvents\":%llu,\"version\":%llu,",
+                 record.address.port, record.online ? "true" : "false",
+                 JsonScan::quote(stateName(record.state)).c_str(), (unsigned long long)record.lastSeen,
+                 record.polls, record.failures, record.latencyMs,
+                 (unsigned long long)(record.historyFirst + record.history.size()),
+                 (unsigned long long)record.version);
+        controllers += "{\"name\":" + JsonScan::quote(record.address.name) +
+                       ",\"host\":" + JsonScan::quote(record.address.host) + fields +
+                       "\"lastError\":" + JsonScan::quote(record.lastError) +
+                       ",\"status\":" + (record.status.empty() ? "null" : record.status) + "}";
+    });
+
+    char head[512];
+    snprintf(head, sizeof(head),
+             "{\"version\":%llu,\"full\":%s,"
+             "\"summary\":{\"controllers\":%u,\"online\":%u,\"offline\":%u,\"idle\":%u,\"waiting\":%u,"
+             "\"feeding\":%u,\"alarm\":%u,\"manual\":%u,\"error\":%u,\"starting\":%u},"
+             "\"pool\":{\"requests\":%llu,\"opened\":%llu,\"reused\":%llu,\"failed\":%llu},"
+             "\"controllers\":[",
+             (unsigned long long)version, since == 0 ? "true" : "false", total, online, total - online,
+             states[1], states[2], states[3], states[4], states[5], states[6], states[7],
+             (unsigned long long)_pool.getRequests(), (unsigned long long)_pool.getOpened(),
+             (unsigned long long)_pool.getReused(), (unsigned long long)_pool.getFailed());
+    return head + controllers + "]}";
+}
+
+bool FleetServer::historyJson(const std::string& name, uint64_t since, std::string& body) const {
+    return _model.withController(name, [&](const ControllerRecord& record) {
+        uint64_t next = record.historyFirst + record.history.size();
+        uint64_t first = std::min(std::max(since, record.historyFirst), next);
+
+        body = "{\"controller\":" + JsonScan::quote(name) + ",\"first\":" + std::to_string(first) +
+               ",\"next\":" + std::to_string(next) + ",\"events\":[";
+        for (uint64_t seq = first; seq < next; seq++) {
+            if (seq > first) body += ',';
+            body += record.history[seq - record.historyFirst];
+        }
+        body += "]}";
+    });
+}
+
+// Value of name in a query string, percent-decoded ("" if absent)
+std::string FleetServer::queryParam(const std::string& query, const char* name) {
+    std::string key = std::string(name) + "=";
+    size_t start = 0;
+    while (start < query.size()) {
+        size_t end = query.find('&', start);
+        if (end == std::string::npos) end = query.size();
+        if (query.compare(start, key.size(), key) == 0) {
+            std::string value;
+            for (size_t i = start + key.size(); i < end; i++) {
+                if (query[i] == '+') {
+                    value += ' ';
+                } else if (query[i] == '%' && i + 2 < end) {
+                    value += (char)strtol(query.substr(i + 1, 2).c_str(), nullptr, 16);
+                    i += 2;
+                } else {
+                    value += query[i];
+                }
+            }
+            return value;
+        }
+        start = end + 1;
+    }
+    return "";
+}
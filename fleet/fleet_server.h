@@ -0,0 +1,48 @@
+#ifndef FLEET_SERVER_H
+#define FLEET_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "fleet_model.h"
+#include "http_client.h"
+
+// The fleet dashboard and its API:
+//   GET /                                      dashboard page
+//   GET /api/fleet[?since=<version>]           summary, and the controllers changed after version
+//   GET /api/fleet/history?controller=<name>[&since=<seq>]
+//                                              a controller's feed events from sequence number seq
+// One request per connection, served in turn on the calling thread; every
+// reply is rendered from the model in memory, so none of them waits on a
+// controller.
+class FleetServer {
+public:
+    FleetServer(const FleetModel& model, const ConnectionPool& pool);
+    ~FleetServer();
+
+    bool begin(uint16_t port, std::string& error);
+    uint16_t getPort() const { return _port; }
+
+    // Serve until stop() (checks every 200 ms)
+    void run();
+    void stop() { _running = false; }
+
+    // Route one request, for the accept loop and tests
+    int handle(const std::string& method, const std::string& target, std::string& contentType,
+               std::string& body) const;
+
+private:
+    const FleetModel& _model;
+    const ConnectionPool& _pool;
+    int _listenFd;
+    uint16_t _port;
+    std::atomic<bool> _running;
+
+    void serveConnection(int fd) const;
+    std::string fleetJson(uint64_t since) const;
+    bool historyJson(const std::string& name, uint64_t since, std::string& body) const;
+
+    static std::string queryParam(const std::string& query, const char* name);
+};
+
+#endif // FLEET_SERVER_H
@@ -0,0 +1,268 @@
+#include "http_client.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static const size_t MAX_BODY = 1 << 20;  // A controller reply is a few KB
+
+static uint64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Waits for events on fd until deadline; false on timeout or error
+static bool waitFor(int fd, short events, uint64_t deadline) {
+    for (;;) {
+        uint64_t now = nowMs();
+        if (now >= deadline) return false;
+        pollfd p = {fd, events, 0};
+        int ready = poll(&p, 1, (int)(deadline - now));
+        if (ready > 0) return true;
+        if (ready < 0 && errno != EINTR) return false;
+    }
+}
+
+ConnectionPool::ConnectionPool(uint32_t timeoutMs)
+    : _timeoutMs(timeoutMs), _opened(0), _reused(0), _requests(0), _failed(0) {}
+
+ConnectionPool::~ConnectionPool() {
+    closeIdle();
+}
+
+bool ConnectionPool::get(const std::string& host, uint16_t port, const std::string& path, HttpResponse& response,
+                         std::string& error) {
+    std::string key = host + ":" + std::to_string(port);
+    std::string request = "GET " + path + " HTTP/1.1\r\nHost: " + key +
+                          "\r\nAccept: application/json\r\nConnection: keep-alive\r\n\r\n";
+    _requests++;
+
+    // A parked connection may have been closed by the server meanwhile:
+    // one more try on a fresh connection then
+    for (int attempt = 0; attempt < 2; attempt++) {
+        int fd = takeIdle(key);
+        bool reused = fd >= 0;
+        if (!reused) {
+            fd = open(host, port, error);
+            if (fd < 0) break;
+        }
+
+        response = HttpResponse();
+        if (!exchange(fd, request, response, error)) {
+            close(fd);
+            if (reused) continue;
+            break;
+        }
+
+        if (reused) _reused++;
+        if (response.keepAlive) {
+            park(key, fd);
+        } else {
+            close(fd);
+        }
+        return true;
+    }
+
+    _failed++;
+    return false;
+}
+
+void ConnectionPool::closeIdle() {
+    std::lock_guard<std::mutex> lock(_lock);
+    for (auto& entry : _idle) close(entry.second);
+    _idle.clear();
+}
+
+size_t ConnectionPool::getIdle() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _idle.size();
+}
+
+int ConnectionPool::takeIdle(const std::string& key) {
+    std::lock_guard<std::mutex> lock(_lock);
+    auto it = _idle.find(key);
+    if (it == _idle.end()) return -1;
+    int fd = it->second;
+    _idle.erase(it);
+    return fd;
+}
+
+void ConnectionPool::park(const std::string& key, int fd) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _idle.emplace(key, fd);
+}
+
+int ConnectionPool::open(const std::string& host, uint16_t port, std::string& error) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    int result = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses);
+    if (result != 0) {
+        error = "resolve failed: " + std::string(gai_strerror(result));
+        return -1;
+    }
+
+    int fd = -1;
+    error = "no address";
+    for (addrinfo* a = addresses; a != nullptr && fd < 0; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, a->ai_protocol);
+        if (fd < 0) {
+            error = strerror(errno);
+            continue;
+        }
+
+        // Non-blocking connect so an unplugged controller costs the timeout, not the kernel's minutes
+        if (connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+            int socketError = errno;
+            if (socketError == EINPROGRESS) {
+                socklen_t length = sizeof(socketError);
+                if (!waitFor(fd, POLLOUT, nowMs() + _timeoutMs)) {
+                    socketError = ETIMEDOUT;
+                } else if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &socketError, &length) != 0) {
+                    socketError = errno;
+                }
+            }
+            if (socketError != 0) {
+                error = "connect failed: " + std::string(strerror(socketError));
+                close(fd);
+                fd = -1;
+                continue;
+            }
+        }
+    }
+    freeaddrinfo(addresses);
+    if (fd < 0) return -1;
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    _opened++;
+    return fd;
+}
+
+bool ConnectionPool::exchange(int fd, const std::string& request, HttpResponse& response, std::string& error) {
+    uint64_t deadline = nowMs() + _timeoutMs;
+
+    size_t sent = 0;
+    while (sent < request.size()) {
+        ssize_t n = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += n;
+        } else if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            if (!waitFor(fd, POLLOUT, deadline)) {
+                error = "send timed out";
+                return false;
+            }
+        } else {
+            error = "send failed: " + std::string(strerror(errno));
+            return false;
+        }
+    }
+
+    // Read until the header is in, then until the body is complete
+    std::string data;
+    size_t headerEnd = std::string::npos;
+    long contentLength = -1;
+    bool chunked = false;
+    bool closed = false;
+    char buffer[4096];
+
+    for (;;) {
+        if (headerEnd == std::string::npos) {
+            headerEnd = data.find("\r\n\r\n");
+            if (headerEnd != std::string::npos) {
+                // Status line and the headers that frame the body
+                if (data.compare(0, 5, "HTTP/") != 0) {
+                    error = "not an HTTP reply";
+                    return false;
+                }
+                size_t space = data.find(' ');
+                response.status = space != std::string::npos ? atoi(data.c_str() + space + 1) : 0;
+                response.keepAlive = data.compare(0, 8, "HTTP/1.1") == 0;
+
+                size_t lineStart = data.find("\r\n") + 2;
+                while (lineStart < headerEnd) {
+                    size_t lineEnd = data.find("\r\n", lineStart);
+                    std::string line = data.substr(lineStart, lineEnd - lineStart);
+                    lineStart = lineEnd + 2;
+                    if (strncasecmp(line.c_str(), "Content-Length:", 15) == 0) {
+                        contentLength = atol(line.c_str() + 15);
+                    } else if (strncasecmp(line.c_str(), "Transfer-Encoding:", 18) == 0) {
+                        chunked = strcasestr(line.c_str(), "chunked") != nullptr;
+                    } else if (strncasecmp(line.c_str(), "Connection:", 11) == 0) {
+                        if (strcasestr(line.c_str(), "close") != nullptr) response.keepAlive = false;
+                        if (strcasestr(line.c_str(), "keep-alive") != nullptr) response.keepAlive = true;
+                    }
+                }
+                headerEnd += 4;
+            }
+        }
+
+        if (headerEnd != std::string::npos) {
+            if (contentLength >= 0 && data.size() - headerEnd >= (size_t)contentLength) {
+                response.body = data.substr(headerEnd, contentLength);
+                return true;
+            }
+            if (chunked) {
+                // Complete once the zero-size chunk is in
+                std::string body;
+                size_t p = headerEnd;
+                bool complete = false;
+                for (;;) {
+                    size_t lineEnd = data.find("\r\n", p);
+                    if (lineEnd == std::string::npos) break;
+                    size_t size = strtoul(data.c_str() + p, nullptr, 16);
+                    if (size == 0) {
+                        complete = data.find("\r\n", lineEnd + 2) != std::string::npos;
+                        break;
+                    }
+                    if (data.size() < lineEnd + 2 + size + 2) break;
+                    body.append(data, lineEnd + 2, size);
+                    p = lineEnd + 2 + size + 2;
+                }
+                if (complete) {
+                    response.body = body;
+                    return true;
+                }
+            }
+            if (closed && contentLength < 0 && !chunked) {
+                // Framed by the close
+                response.body = data.substr(headerEnd);
+                response.keepAlive = false;
+                return true;
+            }
+        }
+        if (closed) {
+            error = data.empty() ? "connection closed" : "reply cut short";
+            return false;
+        }
+        if (data.size() > MAX_BODY) {
+            error = "reply too large";
+            return false;
+        }
+
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            data.append(buffer, n);
+        } else if (n == 0) {
+            closed = true;
+        } else if (errno == EAGAIN || errno == EINTR) {
+            if (!waitFor(fd, POLLIN, deadline)) {
+                error = "reply timed out";
+                return false;
+            }
+        } else {
+            error = "receive failed: " + std::string(strerror(errno));
+            return false;
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef FLEET_HTTP_CLIENT_H
+#define FLEET_HTTP_CLIENT_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+struct HttpResponse {
+    int status = 0;
+    std::string body;
+    bool keepAlive = false;  // The server left the connection open
+};
+
+// HTTP/1.1 GETs to the controllers over plain sockets, with every wait
+// (resolve aside) bounded by the timeout. A connection the server leaves
+// open after a reply is parked and reused for that server's next request;
+// the controllers close theirs (two web sockets each), so against them this
+// is one connection per request, opened only by the one worker polling that
+// controller.
+class ConnectionPool {
+public:
+    explicit ConnectionPool(uint32_t timeoutMs = 3000);
+    ~ConnectionPool();
+
+    // false with error set on a network error or a malformed reply
+    // (an HTTP error status is still a reply)
+    bool get(const std::string& host, uint16_t port, const std::string& path, HttpResponse& response,
+             std::string& error);
+
+    // Close parked connections
+    void closeIdle();
+
+    uint64_t getOpened() const { return _opened; }
+    uint64_t getReused() const { return _reused; }
+    uint64_t getRequests() const { return _requests; }
+    uint64_t getFailed() const { return _failed; }
+    size_t getIdle() const;
+
+private:
+    uint32_t _timeoutMs;
+    mutable std::mutex _lock;
+    std::multimap<std::string, int> _idle;  // "host:port" -> socket
+
+    std::atomic<uint64_t> _opened;
+    std::atomic<uint64_t> _reused;
+    std::atomic<uint64_t> _requests;
+    std::atomic<uint64_t> _failed;
+
+    int takeIdle(const std::string& key);
+    void park(const std::string& key, int fd);
+    int open(const std::string& host, uint16_t port, std::string& error);
+    bool exchange(int fd, const std::string& request, HttpResponse& response, std::string& error);
+};
+
+#endif // FLEET_HTTP_CLIENT_H
@@ -0,0 +1,118 @@
+#include "json_scan.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace JsonScan {
+
+// Position just past "key": (whitespace skipped), or npos
+static size_t valueStart(const std::string& json, const char* key) {
+    std::string needle = "\"" + std::string(key) + "\"";
+    size_t pos = 0;
+    while ((pos = json.find(needle, pos)) != std::string::npos) {
+        size_t p = pos + needle.size();
+        while (p < json.size() && isspace((unsigned char)json[p])) p++;
+        if (p < json.size() && json[p] == ':') {
+            p++;
+            while (p < json.size() && isspace((unsigned char)json[p])) p++;
+            return p;
+        }
+        pos = p;  // A string value that happens to match, keep looking
+    }
+    return std::string::npos;
+}
+
+// Position just past the value starting at p (string, object, array or scalar)
+static size_t valueEnd(const std::string& json, size_t p) {
+    if (p >= json.size()) return p;
+    if (json[p] == '"') {
+        for (p++; p < json.size(); p++) {
+            if (json[p] == '\\') p++;
+            else if (json[p] == '"') return p + 1;
+        }
+        return p;
+    }
+    if (json[p] == '{' || json[p] == '[') {
+        int depth = 0;
+        bool inString = false;
+        for (; p < json.size(); p++) {
+            char c = json[p];
+            if (inString) {
+                if (c == '\\') p++;
+                else if (c == '"') inString = false;
+            } else if (c == '"') {
+                inString = true;
+            } else if (c == '{' || c == '[') {
+                depth++;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) return p + 1;
+            }
+        }
+        return p;
+    }
+    while (p < json.size() && json[p] != ',' && json[p] != '}' && json[p] != ']') p++;
+    return p;
+}
+
+bool number(const std::string& json, const char* key, double& value) {
+    size_t p = valueStart(json, key);
+    if (p == std::string::npos) return false;
+    if (json.compare(p, 4, "true") == 0) {
+        value = 1;
+        return true;
+    }
+    if (json.compare(p, 5, "false") == 0) {
+        value = 0;
+        return true;
+    }
+    const char* start = json.c_str() + p;
+    char* end;
+    value = strtod(start, &end);
+    return end != start;
+}
+
+bool arrayObjects(const std::string& json, const char* key, std::vector<std::string>& objects) {
+    size_t p = valueStart(json, key);
+    if (p == std::string::npos || json[p] != '[') return false;
+
+    size_t end = valueEnd(json, p);
+    for (p++; p < end;) {
+        if (json[p] == '{') {
+            size_t objectEnd = valueEnd(json, p);
+            objects.push_back(json.substr(p, objectEnd - p));
+            p = objectEnd;
+        } else {
+            p++;
+        }
+    }
+    return true;
+}
+
+std::string without(const std::string& json, const char* key) {
+    size_t p = valueStart(json, key);
+    if (p == std::string::npos) return json;
+
+    size_t start = json.rfind('"', json.rfind('"', p - 1) - 1);  // Opening quote of the key
+    size_t end = valueEnd(json, p);
+    if (end < json.size() && json[end] == ',') end++;
+    return json.substr(0, start) + json.substr(end);
+}
+
+std::string quote(const std::string& s) {
+    std::string out = "\"";
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+}  // namespace JsonScan
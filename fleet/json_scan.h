@@ -0,0 +1,27 @@
+#ifndef FLEET_JSON_SCAN_H
+#define FLEET_JSON_SCAN_H
+
+#include <string>
+#include <vector>
+
+// Just enough JSON for the controller API: the aggregator stores status and
+// history objects as the controllers sent them and only looks inside for a
+// few fields, so there is no document model here.
+namespace JsonScan {
+
+// Number (or true/false as 1/0) of the first "key": anywhere in json
+bool number(const std::string& json, const char* key, double& value);
+
+// Raw text of each object in the array "key": [...]
+bool arrayObjects(const std::string& json, const char* key, std::vector<std::string>& objects);
+
+// json with the field "key": ... removed (to compare two statuses
+// ignoring a field that changes on every read)
+std::string without(const std::string& json, const char* key);
+
+// s as a quoted JSON string
+std::string quote(const std::string& s);
+
+}  // namespace JsonScan
+
+#endif // FLEET_JSON_SCAN_H
@@ -0,0 +1,149 @@
+// Fleet aggregator: polls many feeder controllers and serves one dashboard
+//
+//   fleet_aggregator [options] <controllers file>
+//
+// The controllers file has one controller per line, "name host[:port]"
+// (# starts a comment). See README.md, Fleet Aggregator.
+
+#ifndef PIO_UNIT_TESTING
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <getopt.h>
+#include <sstream>
+#include "fleet_model.h"
+#include "fleet_server.h"
+#include "http_client.h"
+#include "poller.h"
+
+static FleetServer* server = nullptr;
+
+static void onSignal(int) {
+    if (server != nullptr) server->stop();
+}
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s [options] <controllers file>\n"
+            "  --port <n>              Dashboard and API port (default 8090)\n"
+            "  --workers <n>           Polls in flight at once (default 16)\n"
+            "  --interval <s>          Status poll interval per controller (default 5)\n"
+            "  --history-interval <s>  History delta interval per controller (default 60)\n"
+            "  --timeout <ms>          Connect and reply timeout (default 3000)\n"
+            "  --history-limit <n>     Feed events kept per controller (default 500)\n",
+            program);
+}
+
+// "name host[:port]" lines; false (with a message) on a bad line
+static bool loadControllers(const char* path, FleetModel& model) {
+    std::ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "fleet: can't open %s\n", path);
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+
+        std::istringstream fields(line);
+        ControllerAddress address;
+        std::string target;
+        if (!(fields >> address.name)) continue;  // Blank
+        if (!(fields >> target)) {
+            fprintf(stderr, "fleet: %s:%d: expected \"name host[:port]\"\n", path, lineNumber);
+            return false;
+        }
+
+        size_t colon = target.rfind(':');
+        address.host = target.substr(0, colon);
+        if (colon != std::string::npos) {
+            int port = atoi(target.c_str() + colon + 1);
+            if (port <= 0 || port > 65535) {
+                fprintf(stderr, "fleet: %s:%d: bad port\n", path, lineNumber);
+                return false;
+            }
+            address.port = port;
+        }
+        model.add(address);
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    uint16_t port = 8090;
+    uint32_t timeoutMs = 3000;
+    size_t historyLimit = 500;
+    PollerOptions options;
+
+    static const option longOptions[] = {
+        {"port", required_argument, nullptr, 'p'},
+        {"workers", required_argument, nullptr, 'w'},
+        {"interval", required_argument, nullptr, 'i'},
+        {"history-interval", required_argument, nullptr, 'H'},
+        {"timeout", required_argument, nullptr, 't'},
+        {"history-limit", required_argument, nullptr, 'l'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}};
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "p:w:i:H:t:l:h", longOptions, nullptr)) != -1) {
+        switch (opt) {
+            case 'p': port = atoi(optarg); break;
+            case 'w': options.workers = atoi(optarg); break;
+            case 'i': options.statusIntervalMs = atoi(optarg) * 1000; break;
+            case 'H': options.historyIntervalMs = atoi(optarg) * 1000; break;
+            case 't': timeoutMs = atoi(optarg); break;
+            case 'l': historyLimit = atoi(optarg); break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (optind != argc - 1 || options.statusIntervalMs == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    FleetModel model(historyLimit);
+    if (!loadControllers(argv[optind], model)) return 1;
+    if (model.size() == 0) {
+        fprintf(stderr, "fleet: no controllers in %s\n", argv[optind]);
+        return 1;
+    }
+
+    ConnectionPool pool(timeoutMs);
+    FleetServer fleetServer(model, pool);
+    std::string error;
+    if (!fleetServer.begin(port, error)) {
+        fprintf(stderr, "fleet: %s\n", error.c_str());
+        return 1;
+    }
+
+    server = &fleetServer;
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    Poller poller(model, pool, options);
+    poller.start();
+    printf("fleet: %zu controllers, %u workers, status every %u s, dashboard on port %u\n", model.size(),
+           options.workers, options.statusIntervalMs / 1000, fleetServer.getPort());
+    fflush(stdout);
+
+    fleetServer.run();
+
+    poller.stop();
+    printf("fleet: stopped after %llu polls (%llu connections, %llu reused, %llu failed)\n",
+           (unsigned long long)poller.getPolls(), (unsigned long long)pool.getOpened(),
+           (unsigned long long)pool.getReused(), (unsigned long long)pool.getFailed());
+    return 0;
+}
+
+#endif // PIO_UNIT_TESTING
@@ -0,0 +1,181 @@
+#include "poller.h"
+#include "json_scan.h"
+#include <chrono>
+#include <cstdio>
+
+static const size_t HISTORY_PAGE = 50;  // Events per /api/history reply (WEB_HISTORY_ENTRIES)
+
+static uint64_t steadyMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static uint64_t wallMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+Poller::Poller(FleetModel& model, ConnectionPool& pool, const PollerOptions& options)
+    : _model(model), _pool(pool), _options(options), _historyDue(model.size(), 0), _running(false), _polls(0) {
+    if (_options.workers == 0) _options.workers = 1;
+}
+
+Poller::~Poller() {
+    stop();
+}
+
+void Poller::start() {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_running) return;
+    _running = true;
+
+    // Spread the first polls over an interval rather than hitting every controller at once
+    uint64_t now = steadyMs();
+    size_t count = _model.size();
+    _historyDue.resize(count, 0);
+    _queue = decltype(_queue)();
+    for (size_t i = 0; i < count; i++) {
+        _queue.push({now + (uint64_t)_options.statusIntervalMs * i / count, i});
+    }
+
+    for (unsigned i = 0; i < _options.workers; i++) {
+        _workers.emplace_back(&Poller::workerLoop, this);
+    }
+}
+
+void Poller::stop() {
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!_running) return;
+        _running = false;
+    }
+    _wake.notify_all();
+    for (std::thread& worker : _workers) worker.join();
+    _workers.clear();
+}
+
+void Poller::workerLoop() {
+    std::unique_lock<std::mutex> lock(_lock);
+    while (_running) {
+        if (_queue.empty()) {
+            _wake.wait(lock);
+            continue;
+        }
+        uint64_t now = steadyMs();
+        Due due = _queue.top();
+        if (due.at > now) {
+            _wake.wait_for(lock, std::chrono::milliseconds(due.at - now));
+            continue;
+        }
+        _queue.pop();
+
+        lock.unlock();
+        pollController(due.index);
+        uint64_t next = steadyMs() + nextDelay(due.index);
+        lock.lock();
+
+        _queue.push({next, due.index});
+        _wake.notify_one();  // It may be due before what the others are waiting for
+    }
+}
+
+void Poller::pollController(size_t index, bool withHistory) {
+    _polls++;
+
+    ControllerState previous, current;
+    if (!pollStatus(index, previous, current)) return;
+
+    // A feed that just ended has a new history event
+    bool feedEnded = previous == ControllerState::FEEDING && current != ControllerState::FEEDING;
+    uint64_t now = steadyMs();
+    if (withHistory || feedEnded || now >= _historyDue[index]) {
+        _historyDue[index] = now + _options.historyIntervalMs;
+        pollHistory(index);
+    }
+}
+
+bool Poller::pollStatus(size_t index, ControllerState& previous, ControllerState& current) {
+    const ControllerAddress& address = _model.address(index);
+    HttpResponse response;
+    std::string error;
+    uint64_t start = steadyMs();
+
+    if (!_pool.get(address.host, address.port, "/api/status", response, error)) {
+        _model.pollFailed(index, error);
+        return false;
+    }
+    if (response.status != 200) {
+        _model.pollFailed(index, "status: HTTP " + std::to_string(response.status));
+        return false;
+    }
+
+    double state = -1;
+    if (!JsonScan::number(response.body, "state", state)) {
+        _model.pollFailed(index, "status: not a controller reply");
+        return false;
+    }
+
+    previous = _model.statusReceived(index, response.body, (uint32_t)(steadyMs() - start), wallMs());
+    current = (ControllerState)(int)state;
+    return true;
+}
+
+void Poller::pollHistory(size_t index) {
+    const ControllerAddress& address = _model.address(index);
+    size_t cursor = _model.historyCursor(index);
+    uint32_t generation = _model.historyGeneration(index);
+
+    for (unsigned page = 0; page < _options.historyPages; page++) {
+        // The generation makes the controller ignore a cursor from before a clear
+        std::string target = "/api/history?since=" + std::to_string(cursor);
+        if (generation != 0) target += "&generation=" + std::to_string(generation);
+
+        HttpResponse response;
+        std::string error;
+        if (!_pool.get(address.host, address.port, target, response, error)) {
+            fprintf(stderr, "fleet: %s: history: %s\n", address.name.c_str(), error.c_str());
+            return;
+        }
+        if (response.status != 200) {
+            fprintf(stderr, "fleet: %s: history: HTTP %d\n", address.name.c_str(), response.status);
+            return;
+        }
+
+        std::vector<std::string> events;
+        JsonScan::arrayObjects(response.body, "history", events);
+
+        double next = 0;
+        if (!JsonScan::number(response.body, "next", next)) {
+            // Firmware without cursors: the first page every time
+            _model.historyReceived(index, events, 0, 0, true);
+            return;
+        }
+
+        // A new generation means the history was cleared and the reply
+        // started over from its oldest event. Firmware without generations:
+        // only a cursor that went backwards shows it
+        double replyGeneration = 0;
+        bool restarted;
+        if (JsonScan::number(response.body, "generation", replyGeneration)) {
+            restarted = generation != 0 && (uint32_t)replyGeneration != generation;
+        } else {
+            restarted = (size_t)next < cursor;
+        }
+        _model.historyReceived(index, events, (size_t)next, (uint32_t)replyGeneration, restarted);
+        cursor = (size_t)next;
+        generation = (uint32_t)replyGeneration;
+
+        if (events.size() < HISTORY_PAGE) return;  // Caught up
+    }
+}
+
+uint64_t Poller::nextDelay(size_t index) const {
+    uint32_t failures = _model.failures(index);
+    uint64_t delay = _options.statusIntervalMs;
+    for (uint32_t i = 0; i < failures && delay < _options.retryMaxMs; i++) {
+        delay *= 2;
+    }
+    return delay < _options.retryMaxMs || failures == 0 ? delay : _options.retryMaxMs;
+}
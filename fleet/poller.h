@@ -0,0 +1,70 @@
+#ifndef FLEET_POLLER_H
+#define FLEET_POLLER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include "fleet_model.h"
+#include "http_client.h"
+
+struct PollerOptions {
+    unsigned workers = 16;               // Polls in flight at once
+    uint32_t statusIntervalMs = 5000;    // GET /api/status per controller
+    uint32_t historyIntervalMs = 60000;  // GET /api/history?since=<cursor> per controller
+    uint32_t retryMaxMs = 60000;         // Longest wait between polls of an offline controller
+    unsigned historyPages = 20;          // History pages per poll while catching up
+};
+
+// Polls every controller in the model from a fixed pool of worker threads.
+// Controllers wait in a queue ordered by when they are next due; a worker
+// takes the earliest, polls it and puts it back, so a controller is never
+// polled by two workers at once (it has two web sockets) and a hundred
+// controllers need no more threads than the polls actually in flight.
+// First polls are spread over one status interval. History is fetched as
+// a delta from the controller's cursor, on its own interval and right after
+// a feed ends. A controller that doesn't answer is retried with a doubling
+// interval, up to retryMaxMs.
+class Poller {
+public:
+    Poller(FleetModel& model, ConnectionPool& pool, const PollerOptions& options);
+    ~Poller();
+
+    void start();
+    void stop();
+
+    // One poll of one controller on the calling thread (status, and history
+    // when due or withHistory)
+    void pollController(size_t index, bool withHistory = false);
+
+    uint64_t getPolls() const { return _polls; }
+
+private:
+    struct Due {
+        uint64_t at;  // Steady clock ms
+        size_t index;
+        bool operator>(const Due& other) const { return at > other.at; }
+    };
+
+    FleetModel& _model;
+    ConnectionPool& _pool;
+    PollerOptions _options;
+
+    std::vector<std::thread> _workers;
+    std::mutex _lock;
+    std::condition_variable _wake;
+    std::priority_queue<Due, std::vector<Due>, std::greater<Due>> _queue;
+    std::vector<uint64_t> _historyDue;  // Per controller, steady clock ms
+    bool _running;
+    std::atomic<uint64_t> _polls;
+
+    void workerLoop();
+    bool pollStatus(size_t index, ControllerState& previous, ControllerState& current);
+    void pollHistory(size_t index);
+    uint64_t nextDelay(size_t index) const;
+};
+
+#endif // FLEET_POLLER_H
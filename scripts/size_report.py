@@ -0,0 +1,385 @@
+#!/usr/bin/env python3
+"""
+Flash and static RAM report with budgets
+
+Splits the linked image by module (source file, library or SDK component)
+and symbol, using the linker map for module ownership and nm for symbol
+sizes, and checks the totals and per-module limits against budgets.
+
+As a PlatformIO extra script (extra_scripts = post:scripts/size_report.py):
+- every build writes the linker map and $BUILD_DIR/memory.json, prints the
+  totals and fails if a budget is exceeded
+- pio run -e esp32dev -t memory prints the full report
+Budgets come from the environment's options:
+  custom_budget_flash = <bytes>      Image bytes (code, rodata, initialized data)
+  custom_budget_dram = <bytes>       Static RAM: .data + .bss + .noinit
+  custom_budget_iram = <bytes>       IRAM code
+  custom_budget_modules =            One per line: <module pattern> <region>=<bytes>...
+      src/*  dram=81920              (fnmatch patterns, summed over the matches)
+
+Standalone (any GNU ld map and ELF, host builds included):
+  python3 scripts/size_report.py firmware.elf --map firmware.map [--nm xtensa-esp32-elf-nm]
+      [--top 30] [--by object] [--budget flash=1245184 --budget dram=131072]
+      [--budget-module "src/* dram=81920"] [--json memory.json]
+Exits 1 if a budget is exceeded.
+"""
+
+import argparse
+import bisect
+import fnmatch
+import json
+import os
+import re
+import subprocess
+import sys
+
+REGIONS = ("flash", "dram", "iram")
+
+_HEX = re.compile(r"^0x[0-9a-fA-F]+$")
+_ARCHIVE_MEMBER = re.compile(r"^(.*)\(([^()]*)\)$")
+
+
+# ---- Linker map ----
+
+def regions_of(section):
+    """Regions an output section takes up: flash = bytes in the image"""
+    s = section
+    if s.startswith(".iram0"):
+        return ("iram",) if s.endswith("bss") else ("flash", "iram")
+    if s.startswith(".rtc"):
+        return ()  # RTC memory has its own small budget, not tracked here
+    if s.startswith(".dram0.bss") or s.startswith(".bss") or s in (".noinit", ".dram0.noinit", ".tbss", ".ext_ram.bss"):
+        return ("dram",)
+    if s.startswith(".dram0") or s.startswith(".data") or s == ".tdata":
+        return ("flash", "dram")
+    if s.startswith(".flash"):
+        return () if "noload" in s else ("flash",)
+    if s.startswith((".text", ".rodata", ".init", ".fini", ".eh_frame", ".gcc_except_table", ".ctors", ".dtors")):
+        return ("flash",)
+    return ()
+
+
+def module_of(path, by="module"):
+    """Owner of an input file: source file, library or SDK component"""
+    path = path.strip()
+    match = _ARCHIVE_MEMBER.match(path)
+    if match:
+        archive, member = match.groups()
+        name = os.path.basename(archive)
+        if name.startswith("lib"):
+            name = name[3:]
+        if name.endswith(".a"):
+            name = name[:-2]
+        return f"{name}:{member}" if by == "object" else name
+
+    normalized = path.replace("\\", "/")
+    name = os.path.basename(normalized)
+    if name.endswith(".o"):
+        name = name[:-2]
+    parts = normalized.split("/")
+    if "src" in parts[:-1]:
+        return "src/" + name
+    parent = parts[-2] if len(parts) > 1 else ""
+    if by == "object" or not parent:
+        return f"{parent}/{name}" if parent else name
+    return parent
+
+
+def parse_map(lines):
+    """Output sections [(name, address, size)] and input pieces [(address, size, output section, path)]"""
+    outputs = []
+    pieces = []
+    started = False
+    current = None
+    pending = None  # Name of a section whose address/size wrapped onto the next line
+
+    for raw in lines:
+        line = raw.rstrip("\n")
+        if not started:
+            started = line.startswith("Linker script and memory map")
+            continue
+        if not line.strip():
+            continue
+
+        if not line[0].isspace():
+            # Output section: ".name addr size" or ".name" then "addr size" on the next line
+            fields = line.split()
+            pending = None
+            current = None
+            if fields[0].startswith(".") and fields[0] != "/DISCARD/":
+                if len(fields) >= 3 and _HEX.match(fields[1]) and _HEX.match(fields[2]):
+                    current = fields[0]
+                    outputs.append((current, int(fields[1], 16), int(fields[2], 16)))
+                elif len(fields) == 1:
+                    pending = ("output", fields[0])
+            continue
+
+        fields = line.split()
+        if pending and pending[0] == "output":
+            if len(fields) >= 2 and _HEX.match(fields[0]) and _HEX.match(fields[1]):
+                current = pending[1]
+                outputs.append((current, int(fields[0], 16), int(fields[1], 16)))
+            pending = None
+            continue
+        if current is None:
+            continue
+
+        if pending and pending[0] == "input":
+            # Wrapped input section: "addr size path"
+            if len(fields) >= 3 and _HEX.match(fields[0]) and _HEX.match(fields[1]):
+                pieces.append((int(fields[0], 16), int(fields[1], 16), current, " ".join(fields[2:])))
+            pending = None
+            continue
+
+        first = fields[0]
+        if first == "*fill*":
+            if len(fields) >= 3 and _HEX.match(fields[1]) and _HEX.match(fields[2]):
+                pieces.append((int(fields[1], 16), int(fields[2], 16), current, "(padding)"))
+        elif line[1] != " " and (first.startswith(".") or first == "COMMON"):
+            # Input section, " .text.foo addr size path" or wrapped
+            if len(fields) >= 4 and _HEX.match(fields[1]) and _HEX.match(fields[2]):
+                pieces.append((int(fields[1], 16), int(fields[2], 16), current, " ".join(fields[3:])))
+            elif len(fields) == 1:
+                pending = ("input", first)
+        # Anything else is a symbol, an assignment or a linker script line
+
+    return outputs, [p for p in pieces if p[1] > 0]
+
+
+# ---- Report ----
+
+class Image:
+    def __init__(self, outputs, pieces, by="module"):
+        self.outputs = sorted(outputs, key=lambda o: o[1])
+        self.pieces = sorted(pieces)
+        self.starts = [p[0] for p in self.pieces]
+        self.totals = dict.fromkeys(REGIONS, 0)
+        self.modules = {}
+
+        for name, _, size in self.outputs:
+            for region in regions_of(name):
+                self.totals[region] += size
+
+        for _, size, section, path in self.pieces:
+            regions = regions_of(section)
+            if not regions:
+                continue
+            sizes = self.modules.setdefault(module_of(path, by), dict.fromkeys(REGIONS, 0))
+            for region in regions:
+                sizes[region] += size
+
+    def section_at(self, address):
+        for name, start, size in self.outputs:
+            if start <= address < start + size:
+                return name
+        return None
+
+    def module_at(self, address, by="module"):
+        i = bisect.bisect_right(self.starts, address) - 1
+        if i >= 0:
+            start, size, _, path = self.pieces[i]
+            if address < start + size:
+                return module_of(path, by)
+        return "?"
+
+
+def read_symbols(nm, elf, image, by="module", tool_env=None):
+    """[(size, regions, module, name)] for every sized symbol"""
+    result = subprocess.run([nm, "-S", "--size-sort", "-C", elf], capture_output=True, text=True, env=tool_env)
+    if result.returncode != 0:
+        raise RuntimeError(f"{nm} failed: {result.stderr.strip()}")
+
+    symbols = []
+    for line in result.stdout.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) < 4:
+            continue
+        address, size = int(fields[0], 16), int(fields[1], 16)
+        section = image.section_at(address)
+        regions = regions_of(section) if section else ()
+        if size == 0 or not regions:
+            continue
+        symbols.append((size, regions, image.module_at(address, by), fields[3]))
+    symbols.sort(key=lambda s: -s[0])
+    return symbols
+
+
+def parse_module_budgets(lines):
+    """["src/* dram=81920 flash=200000", ...] to [(pattern, {region: bytes})]"""
+    budgets = []
+    for line in lines:
+        line = line.split(";")[0].strip()
+        if not line:
+            continue
+        pattern, *limits = line.split()
+        parsed = {}
+        for limit in limits:
+            region, _, value = limit.partition("=")
+            if region not in REGIONS or not value:
+                raise ValueError(f"Bad module budget '{line}' (want <pattern> flash|dram|iram=<bytes>...)")
+            parsed[region] = int(value, 0)
+        budgets.append((pattern, parsed))
+    return budgets
+
+
+def check_budgets(image, budgets, module_budgets):
+    """Failures as text; totals first, then module patterns"""
+    failures = []
+    for region, limit in budgets.items():
+        if limit and image.totals[region] > limit:
+            failures.append(f"{region} {image.totals[region]:,} bytes exceeds budget {limit:,} "
+                            f"by {image.totals[region] - limit:,}")
+    for pattern, limits in module_budgets:
+        matched = [m for m in image.modules if fnmatch.fnmatchcase(m, pattern)]
+        for region, limit in limits.items():
+            used = sum(image.modules[m][region] for m in matched)
+            if used > limit:
+                failures.append(f"{pattern} {region} {used:,} bytes exceeds budget {limit:,} by {used - limit:,}")
+    return failures
+
+
+def format_totals(image, budgets):
+    lines = []
+    for region in REGIONS:
+        used = image.totals[region]
+        limit = budgets.get(region)
+        budget = f" / budget {limit:>10,} ({100.0 * used / limit:5.1f}%)" if limit else ""
+        lines.append(f"  {region:<6}{used:>11,}{budget}")
+    return lines
+
+
+def format_report(image, symbols, budgets, top):
+    lines = ["Totals (bytes)"] + format_totals(image, budgets) + [""]
+
+    lines.append(f"{'Module':<36}{'flash':>11}{'dram':>10}{'iram':>10}")
+    modules = sorted(image.modules.items(), key=lambda m: (-m[1]["flash"], -m[1]["dram"]))
+    for name, sizes in modules[:top]:
+        lines.append(f"{name[:35]:<36}{sizes['flash']:>11,}{sizes['dram']:>10,}{sizes['iram']:>10,}")
+    rest = modules[top:]
+    if rest:
+        sums = {r: sum(s[r] for _, s in rest) for r in REGIONS}
+        lines.append(f"{f'({len(rest)} more)':<36}{sums['flash']:>11,}{sums['dram']:>10,}{sums['iram']:>10,}")
+    lines.append("")
+
+    lines.append(f"{'Largest symbols':<54}{'size':>9}  {'region':<12}module")
+    for size, regions, module, name in symbols[:top]:
+        region = "+".join(r for r in regions if r != "flash") or "flash"
+        lines.append(f"  {name[:52]:<52}{size:>9,}  {region:<12}{module}")
+    return lines
+
+
+def to_json(image, symbols, budgets, failures, top):
+    return {
+        "totals": image.totals,
+        "budgets": budgets,
+        "modules": image.modules,
+        "symbols": [{"name": n, "size": s, "regions": list(r), "module": m} for s, r, m, n in symbols[:top]],
+        "failures": failures,
+    }
+
+
+def analyze(elf, map_path, nm, by="module", tool_env=None):
+    with open(map_path, errors="replace") as f:
+        outputs, pieces = parse_map(f)
+    if not outputs:
+        raise RuntimeError(f"No memory map found in {map_path}")
+    image = Image(outputs, pieces, by)
+    symbols = read_symbols(nm, elf, image, by, tool_env)
+    return image, symbols
+
+
+# ---- PlatformIO ----
+
+def _option(env, name, default=""):
+    try:
+        return env.GetProjectOption(name)
+    except Exception:  # Option not set for this environment
+        return default
+
+
+def setup_platformio(env):
+    map_path = os.path.join(env.subst("$BUILD_DIR"), "firmware.map")
+    json_path = os.path.join(env.subst("$BUILD_DIR"), "memory.json")
+    env.Append(LINKFLAGS=["-Wl,-Map," + map_path])
+
+    budgets = {r: int(str(_option(env, f"custom_budget_{r}", "0")), 0) for r in REGIONS}
+    module_budgets = parse_module_budgets(str(_option(env, "custom_budget_modules")).splitlines())
+
+    cc = env.subst("$CC")
+    nm = cc[:-3] + "nm" if cc.endswith("gcc") else "nm"
+    tool_env = {k: str(v) for k, v in env["ENV"].items()}
+
+    def run(elf, full):
+        image, symbols = analyze(elf, map_path, nm, tool_env=tool_env)
+        failures = check_budgets(image, budgets, module_budgets)
+        with open(json_path, "w") as f:
+            json.dump(to_json(image, symbols, budgets, failures, 100), f, indent=1)
+
+        lines = format_report(image, symbols, budgets, 40) if full else ["Memory (bytes)"] + format_totals(image, budgets)
+        print("\n".join(lines))
+        for failure in failures:
+            print("MEMORY BUDGET EXCEEDED: " + failure)
+        return 1 if failures else 0
+
+    def check_action(target, source, env):
+        return run(str(target[0]), False)
+
+    def report_action(target, source, env):
+        return run(str(source[0]), True)
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", check_action)
+    env.AddCustomTarget(
+        name="memory",
+        dependencies="$BUILD_DIR/${PROGNAME}.elf",
+        actions=[report_action],
+        title="Memory report",
+        description="Flash and static RAM per module and symbol, checked against the budgets",
+    )
+
+
+# ---- Command line ----
+
+def main():
+    parser = argparse.ArgumentParser(description="Flash and static RAM report with budgets",
+                                     formatter_class=argparse.RawDescriptionHelpFormatter, epilog=__doc__)
+    parser.add_argument("elf")
+    parser.add_argument("--map", help="Linker map (default: <elf without extension>.map)")
+    parser.add_argument("--nm", default="nm", help="nm for the ELF's architecture (default: nm)")
+    parser.add_argument("--top", type=int, default=30, help="Modules and symbols listed (default 30)")
+    parser.add_argument("--by", choices=("module", "object"), default="module",
+                        help="Group libraries by archive or by object file")
+    parser.add_argument("--budget", action="append", default=[], metavar="REGION=BYTES")
+    parser.add_argument("--budget-module", action="append", default=[], metavar="'PATTERN REGION=BYTES...'")
+    parser.add_argument("--json", help="Also write the report as JSON")
+    args = parser.parse_args()
+
+    budgets = {}
+    for budget in args.budget:
+        region, _, value = budget.partition("=")
+        if region not in REGIONS:
+            parser.error(f"Unknown region '{region}' (flash, dram, iram)")
+        budgets[region] = int(value, 0)
+
+    map_path = args.map or os.path.splitext(args.elf)[0] + ".map"
+    image, symbols = analyze(args.elf, map_path, args.nm, args.by)
+    failures = check_budgets(image, budgets, parse_module_budgets(args.budget_module))
+
+    print("\n".join(format_report(image, symbols, budgets, args.top)))
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(to_json(image, symbols, budgets, failures, args.top), f, indent=1)
+    for failure in failures:
+        print("MEMORY BUDGET EXCEEDED: " + failure)
+    return 1 if failures else 0
+
+
+try:
+    Import("env")  # noqa: F821 - defined when PlatformIO runs this as an extra script
+    _PLATFORMIO = True
+except NameError:
+    _PLATFORMIO = False
+
+if _PLATFORMIO:
+    setup_platformio(env)  # noqa: F821
+elif __name__ == "__main__":
+    sys.exit(main())
@@ -1,5 +1,6 @@
 #include "auger_control.h"
 #include "config.h"
+#include "logger.h"
 
 AugerControl::AugerControl() {
     _augerRunning = false;
@@ -33,6 +34,10 @@ AugerControl::AugerControl() {
     _lastWeightDuringPause = 0;
     _fillStabilizedTime = 0;
     _fillInProgress = false;
+    _flowEstimate = 0;
+    _lastSampleWeight = 0;
+    _lastSampleTime = 0;
+    _etaSeconds = 0;
     strcpy(_alarmReason, "");
     strcpy(_warningMessage, "");
 }
@@ -48,12 +53,12 @@ void AugerControl::begin() {
     // Ensure all relays are OFF at startup
     stopAll();
 
-    Serial.println("Auger and chain control initialized");
+    LOG_INFO("feed", "Auger and chain control initialized");
 }
 
 void AugerControl::startFeeding(float targetWeight, uint16_t chainPreRunTime, uint16_t maxRuntime, float fillDetectionThreshold, uint16_t fillSettlingTime) {
     if (_stage != FeedingStage::STOPPED) {
-        Serial.println("Cannot start feeding - already in progress");
+        LOG_WARN("feed", "Cannot start feeding - already in progress");
         return;
     }
 
@@ -77,18 +82,20 @@ void AugerControl::startFeeding(float targetWeight, uint16_t chainPreRunTime, ui
     _lastWeight = 0;
     _fillInProgress = false;
     _fillStabilizedTime = 0;
+    _lastSampleTime = 0;
+    _etaSeconds = 0;
     strcpy(_alarmReason, "");
 
     // Start with chain only
     _stage = FeedingStage::CHAIN_ONLY;
-    Serial.println("About to start chain...");
+    LOG_DEBUG("feed", "About to start chain...");
     controlChain(true);
 
-    Serial.printf("Feeding started: Target=%.2f, ChainPreRun=%ds, MaxTime=%ds\n",
+    LOG_INFO("feed", "Feeding started: Target=%.2f, ChainPreRun=%ds, MaxTime=%ds",
                   targetWeight, chainPreRunTime, maxRuntime);
 }
 
-FeedingStage AugerControl::update(float currentTotalWeight) {
+FeedingStage AugerControl::update(float currentTotalWeight, unsigned long sampleTime) {
     if (_stage == FeedingStage::STOPPED || _stage == FeedingStage::COMPLETED || _stage == FeedingStage::FAILED) {
         return _stage;
     }
@@ -118,7 +125,7 @@ FeedingStage AugerControl::update(float currentTotalWeight) {
     if (_startWeight == 0 && currentTotalWeight > 0) {
         _startWeight = currentTotalWeight;
         _weightAtMinuteStart = currentTotalWeight;
-        Serial.printf("Start weight initialized: %.2f lbs\n", _startWeight);
+        LOG_INFO("feed", "Start weight initialized: %.2f lbs", _startWeight);
     }
 
     // Calculate weight dispensed (weight should decrease as feed goes out)
@@ -138,10 +145,13 @@ FeedingStage AugerControl::update(float currentTotalWeight) {
         _weightWhenPaused = currentTotalWeight;  // Save weight at pause (never changes)
         _lastWeightDuringPause = currentTotalWeight;  // Track current weight during monitoring
         _fillStabilizedTime = 0;
-        Serial.println("Feed PAUSED - bin filling detected (weight increase from previous reading)");
+        LOG_INFO("feed", "Feed PAUSED - bin filling detected (weight increase from previous reading)");
         return _stage;
     }
 
+    // Refine flow estimate and completion prediction with this sample
+    updateFlowEstimate(currentTotalWeight, sampleTime);
+
     unsigned long elapsed = (millis() - _feedStartTime) / 1000;  // seconds
 
     switch (_stage) {
@@ -149,7 +159,7 @@ FeedingStage AugerControl::update(float currentTotalWeight) {
             // Check if chain pre-run time has elapsed
             if ((millis() - _chainStartTime) / 1000 >= _chainPreRunTime) {
                 // Start auger as well
-                Serial.printf("Chain pre-run complete (%ds), starting auger...\n", _chainPreRunTime);
+                LOG_INFO("feed", "Chain pre-run complete (%ds), starting auger...", _chainPreRunTime);
                 controlAuger(true);
                 _stage = FeedingStage::BOTH_RUNNING;
 
@@ -158,7 +168,7 @@ FeedingStage AugerControl::update(float currentTotalWeight) {
                 _minuteStartTime = millis();
                 _weightAtMinuteStart = currentTotalWeight;
 
-                Serial.println("Stage: BOTH_RUNNING");
+                LOG_INFO("feed", "Stage: BOTH_RUNNING");
             }
             break;
 
@@ -169,7 +179,8 @@ FeedingStage AugerControl::update(float currentTotalWeight) {
             if (_weightDispensed >= _targetWeight) {
                 stopAll();
                 _stage = FeedingStage::COMPLETED;
-                Serial.printf("Feeding completed: Dispensed=%.2f in %lus\n",
+                _etaSeconds = 0;
+                LOG_INFO("feed", "Feeding completed: Dispensed=%.2f in %lus",
                              _weightDispensed, elapsed);
                 return _stage;
             }
@@ -226,7 +237,7 @@ FeedingStage AugerControl::update(float currentTotalWeight) {
                     // Reset last weight to prevent immediate re-trigger
                     _lastWeight = currentTotalWeight;
 
-                    Serial.printf("Feed RESUMED after bin fill (+%.2f lbs, settled for %ds)\n",
+                    LOG_INFO("feed", "Feed RESUMED after bin fill (+%.2f lbs, settled for %ds)",
                                  weightGain, _fillSettlingTime);
 
                     // Resume to previous stage
@@ -239,6 +250,7 @@ FeedingStage AugerControl::update(float currentTotalWeight) {
                         controlChain(true);
                         controlAuger(true);
                         // Reset monitoring timers for resumed feeding
+                        _lastSampleTime = 0;
                         _bothRunningStartTime = millis();
                         _minuteStartTime = millis();
                         _weightAtMinuteStart = currentTotalWeight;
@@ -264,6 +276,56 @@ void AugerControl::stopAll() {
     controlAuger(false);
     controlChain(false);
     _stage = FeedingStage::STOPPED;
+    _etaSeconds = 0;
+}
+
+void AugerControl::updateFlowEstimate(float currentWeight, unsigned long sampleTime) {
+    // update() is ticked faster than weights arrive: same sample, nothing new
+    if (_lastSampleTime != 0 && sampleTime == _lastSampleTime) {
+        return;
+    }
+
+    // Only samples with both motors running and a valid reading say anything about flow
+    if (_stage == FeedingStage::BOTH_RUNNING && !_weightReadingFailed && _lastSampleTime != 0) {
+        float dt = (sampleTime - _lastSampleTime) / 1000.0;
+        if (dt > 0) {
+            float sampleFlow = (_lastSampleWeight - currentWeight) / dt;
+            if (sampleFlow >= 0) {
+                if (_flowEstimate <= 0) {
+                    _flowEstimate = sampleFlow;
+                } else {
+                    _flowEstimate += FLOW_ESTIMATE_ALPHA * (sampleFlow - _flowEstimate);
+                }
+            }
+        }
+    }
+
+    _lastSampleWeight = currentWeight;
+    _lastSampleTime = sampleTime;
+
+    updateEta();
+}
+
+void AugerControl::updateEta() {
+    if (_flowEstimate <= 0) {
+        _etaSeconds = 0;  // Unknown until we have seen feed flow
+        return;
+    }
+
+    float remaining = _targetWeight - _weightDispensed;
+    if (remaining < 0) remaining = 0;
+
+    float eta = remaining / _flowEstimate;
+
+    // Chain pre-run still has to finish before the auger starts
+    if (_stage == FeedingStage::CHAIN_ONLY) {
+        unsigned long chainElapsed = (millis() - _chainStartTime) / 1000;
+        if (chainElapsed < _chainPreRunTime) {
+            eta += _chainPreRunTime - chainElapsed;
+        }
+    }
+
+    _etaSeconds = (unsigned long)(eta + 0.5);
 }
 
 void AugerControl::checkSafety(float currentWeight) {
@@ -290,19 +352,20 @@ void AugerControl::triggerAlarm(const char* reason) {
     strncpy(_alarmReason, reason, sizeof(_alarmReason) - 1);
     _alarmReason[sizeof(_alarmReason) - 1] = '\0';
 
-    Serial.printf("ALARM: %s\n", reason);
+    LOG_ERROR("feed", "ALARM: %s", reason);
 
     // Stop all motors immediately
     controlAuger(false);
     controlChain(false);
     _stage = FeedingStage::FAILED;
+    _etaSeconds = 0;
 }
 
 void AugerControl::sendWarning(const char* warning) {
     strncpy(_warningMessage, warning, sizeof(_warningMessage) - 1);
     _warningMessage[sizeof(_warningMessage) - 1] = '\0';
     _warningPending = true;
-    Serial.printf("WARNING: %s\n", warning);
+    LOG_WARN("feed", "%s", warning);
 }
 
 float AugerControl::getFlowRate() const {
@@ -325,7 +388,7 @@ unsigned long AugerControl::getDuration() const {
 
 void AugerControl::setAuger(bool state) {
     if (_stage != FeedingStage::STOPPED) {
-        Serial.println("Cannot manual control - feeding in progress");
+        LOG_WARN("feed", "Cannot manual control - feeding in progress");
         return;
     }
     controlAuger(state);
@@ -333,7 +396,7 @@ void AugerControl::setAuger(bool state) {
 
 void AugerControl::setChain(bool state) {
     if (_stage != FeedingStage::STOPPED) {
-        Serial.println("Cannot manual control - feeding in progress");
+        LOG_WARN("feed", "Cannot manual control - feeding in progress");
         return;
     }
     controlChain(state);
@@ -342,7 +405,7 @@ void AugerControl::setChain(bool state) {
 void AugerControl::controlAuger(bool state) {
     digitalWrite(RELAY_1_PIN, state ? HIGH : LOW);
     _augerRunning = state;
-    Serial.printf("GPIO %d (Auger): %s\n", RELAY_1_PIN, state ? "ON (HIGH)" : "OFF (LOW)");
+    LOG_DEBUG("feed", "GPIO %d (Auger): %s", RELAY_1_PIN, state ? "ON (HIGH)" : "OFF (LOW)");
 }
 
 void AugerControl::controlChain(bool state) {
@@ -351,5 +414,5 @@ void AugerControl::controlChain(bool state) {
     digitalWrite(RELAY_4_PIN, state ? HIGH : LOW);
     digitalWrite(RELAY_5_PIN, state ? HIGH : LOW);
     _chainRunning = state;
-    Serial.printf("GPIOs %d,%d,%d,%d (Chains A-D): %s\n", RELAY_2_PIN, RELAY_3_PIN, RELAY_4_PIN, RELAY_5_PIN, state ? "ON (HIGH)" : "OFF (LOW)");
+    LOG_DEBUG("feed", "GPIOs %d,%d,%d,%d (Chains A-D): %s", RELAY_2_PIN, RELAY_3_PIN, RELAY_4_PIN, RELAY_5_PIN, state ? "ON (HIGH)" : "OFF (LOW)");
 }
@@ -18,15 +18,20 @@ public:
     void stopAll();
 
     // Update - call frequently in main loop
+    // sampleTime = millis() when the weight was read; the flow estimate only
+    // moves when it changes (the loop runs faster than weights arrive)
     // Returns current feeding stage
-    FeedingStage update(float currentTotalWeight);
+    FeedingStage update(float currentTotalWeight, unsigned long sampleTime);
 
     // Get status
     bool isAugerRunning() const { return _augerRunning; }
     bool isChainRunning() const { return _chainRunning; }
     FeedingStage getStage() const { return _stage; }
     float getWeightDispensed() const { return _weightDispensed; }
+    float getTargetWeight() const { return _targetWeight; }
     float getFlowRate() const;  // lbs/min
+    float getFlowEstimate() const { return _flowEstimate * 60.0; }  // smoothed live flow, lbs/min
+    unsigned long getEtaSeconds() const { return _etaSeconds; }     // predicted time to target, 0 = unknown
     unsigned long getDuration() const;
     bool isAlarmTriggered() const { return _alarmTriggered; }
     const char* getAlarmReason() const { return _alarmReason; }
@@ -86,6 +91,13 @@ private:
     bool _warnedIncrease;
     bool _warnedLowRate;
 
+    // Live flow estimate (EWMA of per-sample flow, lbs/sec) and ETA, updated every sample
+    // The estimate carries over between feeds as the prior for the next CHAIN_ONLY stage
+    float _flowEstimate;
+    float _lastSampleWeight;
+    unsigned long _lastSampleTime;
+    unsigned long _etaSeconds;
+
     // Bin filling detection and pause state
     FeedingStage _stageBeforePause;
     float _lastWeight;                // Previous weight reading for fill detection
@@ -94,6 +106,10 @@ private:
     unsigned long _fillStabilizedTime;
     bool _fillInProgress;
 
+    // Flow estimate and ETA
+    void updateFlowEstimate(float currentWeight, unsigned long sampleTime);
+    void updateEta();
+
     // Safety and warnings
     void checkSafety(float currentWeight);
     void triggerAlarm(const char* reason);
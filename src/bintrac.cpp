@@ -2,6 +2,10 @@
 #include "config.h"
 
 #include <Ethernet.h>
+#include "net_lock.h"
+#include "net_events.h"
+#include "w5500_spi.h"
+#include "logger.h"
 
 BinTrac::BinTrac() {
     _connected = false;
@@ -49,7 +53,7 @@ bool BinTrac::reconnect() {
         if (testValue != 0 || testBuffer[0] == 0xFFFF) {
             _connected = true;
             snprintf(_lastError, sizeof(_lastError), "Connected");
-            Serial.printf("BinTrac connected to %s:%d (ID: %d)\n", _ipAddress, _port, _deviceID);
+            LOG_INFO("bintrac", "BinTrac connected to %s:%d (ID: %d)", _ipAddress, _port, _deviceID);
         } else {
             _connected = false;
             snprintf(_lastError, sizeof(_lastError), "Connected but no valid data from %s:%d", _ipAddress, _port);
@@ -128,6 +132,17 @@ bool BinTrac::readBin(uint8_t binIndex, float& weight) {
     return true;
 }
 
+bool BinTrac::readTime(uint16_t address, unsigned long& epoch) {
+    uint16_t buffer[2];
+
+    if (!modbusRead(address, 2, buffer)) {
+        return false;
+    }
+
+    epoch = ((unsigned long)buffer[0] << 16) | buffer[1];
+    return true;
+}
+
 bool BinTrac::isConnected() {
     // Consider disconnected if no successful read in last 30 seconds
     if (_connected && (millis() - _lastReadTime > 30000)) {
@@ -156,7 +171,7 @@ bool BinTrac::modbusRead(uint16_t address, uint16_t length, uint16_t* buffer) {
 #ifdef USE_WIFI
     WiFiClient client;
 #else
-    EthernetClient client;
+    LockedEthernetClient client(SocketUser::MODBUS);  // Other tasks share the W5500
 #endif
 
     // Parse IP address
@@ -167,6 +182,7 @@ bool BinTrac::modbusRead(uint16_t address, uint16_t length, uint16_t* buffer) {
     }
 
     // Connect to Modbus server
+    unsigned long pollStart = micros();
     if (!client.connect(ip, _port)) {
         snprintf(_lastError, sizeof(_lastError), "TCP connection failed to %s:%d", _ipAddress, _port);
         return false;
@@ -174,12 +190,65 @@ bool BinTrac::modbusRead(uint16_t address, uint16_t length, uint16_t* buffer) {
 
     // Build Modbus TCP request
     static uint16_t transactionID = 1;
-    uint8_t request[12];
+    uint8_t request[MODBUS_REQUEST_SIZE];
+    buildReadRequest(request, transactionID++, _deviceID, address, length);
+
+    // Send request
+    client.write(request, sizeof(request));
+    client.flush();
+
+    // Wait for response with timeout
+    unsigned long startTime = millis();
+    while (client.available() < MODBUS_RESPONSE_HEADER_SIZE && (millis() - startTime < BINTRAC_TIMEOUT)) {
+        NetEvents::waitForSocket(startTime, BINTRAC_TIMEOUT);
+    }
+
+    if (client.available() < MODBUS_RESPONSE_HEADER_SIZE) {
+        client.stop();
+        snprintf(_lastError, sizeof(_lastError), "Timeout waiting for response from %s:%d", _ipAddress, _port);
+        return false;
+    }
+
+    // Read response header (9 bytes)
+    uint8_t response[MODBUS_RESPONSE_HEADER_SIZE];
+    client.read(response, sizeof(response));
+
+    uint8_t byteCount;
+    char error[64];
+    if (!checkResponseHeader(response, length, byteCount, error, sizeof(error))) {
+        client.stop();
+        snprintf(_lastError, sizeof(_lastError), "%s from %s:%d", error, _ipAddress, _port);
+        return false;
+    }
+
+    // Wait for data bytes
+    startTime = millis();
+    while (client.available() < byteCount && (millis() - startTime < BINTRAC_TIMEOUT)) {
+        NetEvents::waitForSocket(startTime, BINTRAC_TIMEOUT);
+    }
+
+    if (client.available() < byteCount) {
+        client.stop();
+        snprintf(_lastError, sizeof(_lastError), "Timeout waiting for data bytes");
+        return false;
+    }
 
+    // Read register values (big-endian) in one block
+    uint8_t data[256];
+    client.read(data, byteCount);
+    decodeRegisters(data, length, buffer);
+
+    client.stop();
+    W5500Spi::recordTransfer(TransferKind::MODBUS_POLL, sizeof(request) + sizeof(response) + byteCount,
+                             micros() - pollStart);
+    return true;
+}
+
+void BinTrac::buildReadRequest(uint8_t* request, uint16_t transactionID, uint8_t deviceID,
+                               uint16_t address, uint16_t length) {
     // Transaction ID (2 bytes)
     request[0] = (transactionID >> 8) & 0xFF;
     request[1] = transactionID & 0xFF;
-    transactionID++;
 
     // Protocol ID (2 bytes, always 0 for Modbus TCP)
     request[2] = 0;
@@ -190,7 +259,7 @@ bool BinTrac::modbusRead(uint16_t address, uint16_t length, uint16_t* buffer) {
     request[5] = 6;  // Unit ID (1) + Function Code (1) + Address (2) + Count (2)
 
     // Unit ID (1 byte)
-    request[6] = _deviceID;
+    request[6] = deviceID;
 
     // Function Code (1 byte) - 4 = Read Input Registers
     request[7] = 4;
@@ -202,65 +271,32 @@ bool BinTrac::modbusRead(uint16_t address, uint16_t length, uint16_t* buffer) {
     // Quantity of Registers (2 bytes)
     request[10] = (length >> 8) & 0xFF;
     request[11] = length & 0xFF;
+}
 
-    // Send request
-    client.write(request, 12);
-    client.flush();
-
-    // Wait for response with timeout
-    unsigned long startTime = millis();
-    while (client.available() < 9 && (millis() - startTime < BINTRAC_TIMEOUT)) {
-        delay(10);
-    }
-
-    if (client.available() < 9) {
-        client.stop();
-        snprintf(_lastError, sizeof(_lastError), "Timeout waiting for response from %s:%d", _ipAddress, _port);
-        return false;
-    }
-
-    // Read response header (9 bytes)
-    uint8_t response[9];
-    client.readBytes(response, 9);
-
+bool BinTrac::checkResponseHeader(const uint8_t* header, uint16_t length, uint8_t& byteCount,
+                                  char* error, size_t errorSize) {
     // Check function code for errors
-    if (response[7] & 0x80) {
-        uint8_t exceptionCode = response[8];
-        client.stop();
-        snprintf(_lastError, sizeof(_lastError), "Modbus exception code %d from %s:%d",
-                 exceptionCode, _ipAddress, _port);
+    if (header[7] & 0x80) {
+        snprintf(error, errorSize, "Modbus exception code %d", header[8]);
         return false;
     }
 
-    // Byte count
-    uint8_t byteCount = response[8];
-
-    if (byteCount != length * 2) {
-        client.stop();
-        snprintf(_lastError, sizeof(_lastError), "Unexpected byte count: expected %d, got %d",
-                 length * 2, byteCount);
+    if (header[7] != MODBUS_FUNCTION_CODE) {
+        snprintf(error, errorSize, "Unexpected function code %d", header[7]);
         return false;
     }
 
-    // Wait for data bytes
-    startTime = millis();
-    while (client.available() < byteCount && (millis() - startTime < BINTRAC_TIMEOUT)) {
-        delay(10);
-    }
-
-    if (client.available() < byteCount) {
-        client.stop();
-        snprintf(_lastError, sizeof(_lastError), "Timeout waiting for data bytes");
+    // Byte count: exactly the registers asked for (the data buffer holds no more)
+    byteCount = header[8];
+    if (byteCount != length * 2) {
+        snprintf(error, errorSize, "Unexpected byte count: expected %d, got %d", length * 2, byteCount);
         return false;
     }
+    return true;
+}
 
-    // Read register values (big-endian)
+void BinTrac::decodeRegisters(const uint8_t* data, uint16_t length, uint16_t* buffer) {
     for (uint16_t i = 0; i < length; i++) {
-        uint8_t high = client.read();
-        uint8_t low = client.read();
-        buffer[i] = (high << 8) | low;
+        buffer[i] = (data[i * 2] << 8) | data[i * 2 + 1];
     }
-
-    client.stop();
-    return true;
 }
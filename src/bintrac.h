@@ -17,6 +17,9 @@ public:
     // Read individual bin weight
     bool readBin(uint8_t binIndex, float& weight);
 
+    // Read HouseLink clock (register pair, big-endian 32-bit Unix time)
+    bool readTime(uint16_t address, unsigned long& epoch);
+
     // Check connection status
     bool isConnected();
 
@@ -29,6 +32,18 @@ public:
     // Update IP address, port, and device ID
     void setConnection(const char* ipAddress, uint16_t port, uint8_t deviceID);
 
+    // Modbus TCP framing (no I/O; also driven directly by the host benchmarks and fuzzers)
+    // Read Input Registers request, MODBUS_REQUEST_SIZE bytes
+    static void buildReadRequest(uint8_t* request, uint16_t transactionID, uint8_t deviceID,
+                                 uint16_t address, uint16_t length);
+    // Check a response header (MODBUS_RESPONSE_HEADER_SIZE bytes: MBAP, function
+    // code, byte count) against a read of `length` registers; on success the
+    // data bytes that follow number byteCount (= length * 2)
+    static bool checkResponseHeader(const uint8_t* header, uint16_t length, uint8_t& byteCount,
+                                    char* error, size_t errorSize);
+    // Big-endian register values from a response's data bytes (2 per register)
+    static void decodeRegisters(const uint8_t* data, uint16_t length, uint16_t* buffer);
+
 private:
     char _ipAddress[16];
     uint16_t _port;
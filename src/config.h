@@ -7,6 +7,31 @@
 // Network Configuration
 #define USE_ETHERNET
 
+// Compile-time features: 0 leaves a subsystem out of the image entirely (its
+// code, static buffers, libraries and task stack). Override per environment
+// in build_flags, e.g. -D FEATURE_TELEGRAM=0 (see env:esp32dev_lite).
+#ifndef FEATURE_TELEGRAM
+#define FEATURE_TELEGRAM 1  // Telegram bot: notifications and commands (SSLClient, BearSSL)
+#endif
+#ifndef FEATURE_WEB_UI
+#define FEATURE_WEB_UI 1    // Web page at / (the JSON API is always built)
+#endif
+#ifndef FEATURE_HISTORY
+#define FEATURE_HISTORY 1   // Feed history file, /api/history
+#endif
+#ifndef FEATURE_TRACES
+#define FEATURE_TRACES 1    // Per-stage task timing (loop profiler), /api/profile
+#endif
+#ifndef FEATURE_METRICS
+#define FEATURE_METRICS 1   // Socket, SPI throughput and task stack statistics, /api/sockets, /api/tasks
+#endif
+#ifndef FEATURE_MQTT
+#define FEATURE_MQTT 1      // MQTT telemetry publisher (idle until a broker is configured)
+#endif
+#ifndef FEATURE_INFLUX
+#define FEATURE_INFLUX 1    // InfluxDB line-protocol push (idle until a server is configured)
+#endif
+
 // Relay pins (LilyGo 8-channel board)
 #define RELAY_1_PIN 33  // Auger (swapped - physical wiring was backwards)
 #define RELAY_2_PIN 32  // Chain A
@@ -23,6 +48,8 @@
 #define W5500_MOSI_PIN 26
 #define W5500_SCK_PIN 22
 #define W5500_RESET_PIN 23
+#define W5500_INT_PIN -1   // GPIO wired to W5500 INT for event-driven networking, -1 = not wired (tasks poll)
+#define W5500_SPI_CLOCK 26000000  // Hz, burst TX path (these pins go through the GPIO matrix, so ~26 MHz max for reads), 0 = library only
 
 // MAC address for W5500
 #define W5500_MAC { 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED }
@@ -35,6 +62,30 @@
 #define MODBUS_PORT 502
 #define BINTRAC_TIMEOUT 5000    // milliseconds
 #define BINTRAC_RETRY_DELAY 2000
+#define NET_DATA_POLL_INTERVAL 10      // ms, socket data wait when the W5500 INT pin is not wired
+#define NET_DHCP_TIMEOUT 4000          // ms, give up on DHCP and use the fallback static IP
+#define NET_DHCP_RESPONSE_TIMEOUT 2000 // ms, per DHCP request
+#define NET_DNS_TIMEOUT 2000           // ms, wait for a DNS reply (two tries)
+#define NET_CONNECT_TIMEOUT 3000       // ms, TCP handshake in total
+#define NET_CONNECT_SLICE 50           // ms, first handshake wait under the NetLock (doubles per retry, to 1 s)
+#define W5500_SEND_TIMEOUT 500         // ms, wait for a burst send to leave the chip before dropping the connection
+
+// W5500 socket reservations (8 hardware sockets; the rest form a shared pool)
+#define SOCKET_RESERVE_WEB 2          // listener + one client being served
+#define SOCKET_RESERVE_MODBUS 2       // BinTrac reads + HouseLink clock
+#define SOCKET_RESERVE_TELEGRAM FEATURE_TELEGRAM
+#define SOCKET_RESERVE_MQTT FEATURE_MQTT  // broker connection, held while connected
+#define SOCKET_RESERVE_TIME (FEATURE_MQTT ? 0 : 1)  // NTP or HTTP Date, one at a time (borrows the shared socket next to MQTT)
+#define SOCKET_RESERVE_COORDINATOR 1
+#define SOCKET_RESERVE_LOG 0          // syslog borrows the shared socket while sending
+#define SOCKET_RESERVE_INFLUX 0       // one short HTTP POST per batch, borrows the shared socket
+
+// Multi-controller start coordination (UDP multicast)
+#define COORD_MULTICAST_IP 239, 255, 70, 66
+#define COORD_PORT 47066
+#define COORD_HELLO_INTERVAL 10000  // milliseconds
+#define COORD_PEER_TIMEOUT 35000    // drop peers not heard from in this long
+#define COORD_MAX_PEERS 16
 
 // BinTrac Modbus addresses
 // NOTE: This HouseLink firmware differs from manual!
@@ -47,27 +98,136 @@
 #define MODBUS_ALL_BINS_ADDR 1000
 #define MODBUS_ALL_BINS_LEN 6  // Changed from 8 - this HouseLink only supports 6!
 #define MODBUS_FUNCTION_CODE 4  // Input register
+#define MODBUS_REQUEST_SIZE 12  // MBAP header (7) + function, address, count
+#define MODBUS_RESPONSE_HEADER_SIZE 9  // MBAP header (7) + function, byte count
 
 // Feeding control constants
 #define WEIGHT_CHECK_INTERVAL 1000  // Check weight every second
 #define MIN_WEIGHT_CHANGE 0.1       // Minimum detectable weight change
 #define ALARM_CHECK_WINDOW 60000    // Check alarm condition over 1 minute
 #define EMERGENCY_STOP_WEIGHT -50.0 // Stop if weight increases (bin filling error)
+#define FLOW_ESTIMATE_ALPHA 0.1     // Smoothing for live flow estimate (per 1s sample)
+
+// Feed curve
+#define FEED_CURVE_MAX_POINTS 8     // Growth curve points (age -> daily target)
 
 // Storage
 #define CONFIG_FILE "/config.json"
 #define HISTORY_FILE "/history.csv"
+#define HISTORY_MARKER_FILE "/history.gen"  // missing = new filesystem, so a new history generation
 #define MAX_HISTORY_ENTRIES 1000
+#define HISTORY_LINE_MAX 160      // one CSV history record
+#define INFLUX_SPOOL_FILE "/influx.spool"
 
 // Time settings
 #define NTP_SERVER "pool.ntp.org"
 #define NTP_UPDATE_INTERVAL 3600000  // Update time every hour
+#define NTP_TIMEOUT 5000              // Wait per NTP attempt
+#define TIME_RETRY_INTERVAL 300000    // Retry sources every 5 minutes while unsynced/restored
+#define TIME_HTTP_TIMEOUT 3000        // HTTP Date header request timeout
+#define TIME_PERSIST_INTERVAL 600000  // Save last known time every 10 minutes
+#define TIME_MIN_VALID 1577836800UL   // 2020-01-01, anything earlier is not a real time
 
 // Watchdog
 #define WATCHDOG_TIMEOUT 30  // seconds
 
+// Logging
+#define LOG_LEVEL 3                   // compile-time filter: 1 error, 2 warn, 3 info, 4 debug
+#define LOG_BUFFER_ENTRIES 128        // records kept in RAM for /api/logs
+#define LOG_MESSAGE_LEN 96            // bytes per record, longer messages are truncated
+#define LOG_API_MAX_ENTRIES 32        // records per /api/logs response
+#define LOG_SYSLOG_SERVER ""          // syslog server IP, "" = off
+#define LOG_SYSLOG_PORT 514
+#define LOG_SYSLOG_LOCAL_PORT 5514
+
+// OTA updates (POST /api/ota/firmware, /api/ota/filesystem)
+// PEM ECDSA P-256 public key; images must carry a matching signature. "" = uploads refused
+#define OTA_SIGNING_PUBLIC_KEY ""
+#define OTA_SIGNATURE_MAX 80          // DER signature bytes (P-256 signatures are at most 72)
+#define OTA_RECEIVE_TIMEOUT 10000     // abort an upload after this long without data
+#define OTA_HEALTHY_TIME 60000        // network up and tasks running this long confirms a new image
+#define OTA_TASK_STALL_TIME 30000     // control or acquisition task silent this long: not healthy
+#define OTA_HEALTH_TIMEOUT 600000     // not healthy this long after boot: roll back
+#define OTA_MAX_BOOT_ATTEMPTS 3       // boots of an unconfirmed image before rolling back
+
 // Status update intervals
 #define STATUS_UPDATE_INTERVAL 5000    // 5 seconds
 #define TELEGRAM_UPDATE_INTERVAL 1000  // 1 second (for responsive bot commands)
 
+// MQTT telemetry (broker, credentials and topic prefix are in the config)
+#define MQTT_DEFAULT_PORT 1883
+#define MQTT_QOS 1                     // status, weights and events (0 = fire and forget, nothing resent)
+#define MQTT_KEEPALIVE 60              // seconds; a ping goes out after half of it without traffic
+#define MQTT_CONNECT_TIMEOUT 5000      // ms, TCP connect plus CONNACK
+#define MQTT_ACK_TIMEOUT 10000         // ms, PUBACK or PINGRESP before the connection is dropped
+#define MQTT_RECONNECT_MIN 2000        // ms, first retry after a failed or lost connection
+#define MQTT_RECONNECT_MAX 300000      // ms, backoff ceiling (the delay doubles per failure)
+#define MQTT_PACKET_MAX 512            // largest packet sent (topic, payload and headers)
+#define MQTT_PAYLOAD_MAX 320           // one buffered message (a weights batch is the largest)
+#define MQTT_BUFFER_MESSAGES 16        // events and weight batches kept while the broker is unreachable
+#define MQTT_WEIGHT_INTERVAL 10000     // ms, bin readings averaged into one point
+#define MQTT_WEIGHT_BATCH 6            // points per weights message
+
+// InfluxDB push (server, write path and token are in the config)
+#define INFLUX_DEFAULT_PORT 8086
+#define INFLUX_SAMPLE_INTERVAL 5000    // ms, at most one bin weight point per interval
+#define INFLUX_BATCH_POINTS 40         // send once this many points are waiting...
+#define INFLUX_BATCH_INTERVAL 60000    // ms, ...or the oldest has waited this long
+#define INFLUX_BATCH_MAX 3072          // bytes of line protocol per batch (uncompressed)
+#define INFLUX_TIMEOUT 5000            // ms, connect plus response
+#define INFLUX_RETRY_MIN 5000          // ms, first retry after a failed push
+#define INFLUX_RETRY_MAX 300000        // ms, backoff ceiling (the delay doubles per failure)
+#define INFLUX_SPOOL_MAX 65536         // bytes of unsent batches kept in LittleFS (newest dropped past it)
+
+// Fixed buffers for the long-running paths (sized once, no heap growth)
+#define WEB_LINE_MAX 256            // longest HTTP request/header line kept
+#define WEB_PATH_MAX 128            // request path including query string
+#define WEB_BODY_MAX 3072           // largest POST body (config JSON)
+#define WEB_JSON_ARENA_SIZE 16384   // JsonDocument memory for one request
+#define WEB_RESPONSE_MAX 10240      // serialized JSON response (history is the largest)
+#define WEB_HISTORY_ENTRIES 50      // feed events in GET /api/history
+#define TELEGRAM_CHAT_ID_LEN 24
+
+// FreeRTOS tasks: priority (higher runs first), core, stack bytes
+// Control and acquisition own core 1; network services share core 0
+#define CONTROL_TASK_PRIORITY 5
+#define CONTROL_TASK_CORE 1
+#define CONTROL_TASK_STACK 6144
+#define ACQUISITION_TASK_PRIORITY 4
+#define ACQUISITION_TASK_CORE 1
+#define ACQUISITION_TASK_STACK 4096
+#define STORAGE_TASK_PRIORITY 3
+#define STORAGE_TASK_CORE 0
+#define STORAGE_TASK_STACK 4096
+#define WEB_TASK_PRIORITY 2
+#define WEB_TASK_CORE 0
+#define WEB_TASK_STACK 8192
+#define NOTIFY_TASK_PRIORITY 1
+#define NOTIFY_TASK_CORE 0
+#if FEATURE_TELEGRAM
+#define NOTIFY_TASK_STACK 12288  // TLS handshake needs a deep stack
+#else
+#define NOTIFY_TASK_STACK 4096
+#endif
+#define NETWORK_BOOT_TASK_PRIORITY 2  // one-shot W5500 bring-up at boot
+#define NETWORK_BOOT_TASK_CORE 0
+#define NETWORK_BOOT_TASK_STACK 4096
+#define LOG_TASK_PRIORITY 1           // drains the log ring to Serial/syslog
+#define LOG_TASK_CORE 0
+#define LOG_TASK_STACK 4096
+#define BOOT_TIMELINE_STEPS 16
+#define LOOP_TASK_STACK 8192          // Arduino core's loopTask (serial console)
+#define TASK_MONITOR_MAX 10           // tasks tracked for stack high-water marks
+#define TASK_STACK_MIN_FREE 512       // bytes; a task with less stack never used logs a warning
+#define TASK_STACK_CHECK_INTERVAL 60000  // ms between stack margin checks (notify task)
+
+#define CONTROL_PERIOD 100          // ms, state machine tick while feeding or under manual control
+#define WEB_POLL_INTERVAL 50        // ms, web task poll for new clients when the W5500 INT pin is not wired (adds up to this much to a request)
+#define NOTIFY_POLL_INTERVAL 100    // ms, notify task poll when the W5500 INT pin is not wired
+#define NET_IDLE_RECHECK 1000       // ms, longest interrupt-driven sleep (covers a missed edge)
+#define CONTROL_QUEUE_LENGTH 16
+#define NOTIFY_QUEUE_LENGTH 8
+#define STORAGE_QUEUE_LENGTH 8
+#define COMMAND_REPLY_TIMEOUT 15000 // ms, web request waiting on the control task
+
 #endif // CONFIG_H
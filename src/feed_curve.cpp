@@ -0,0 +1,97 @@
+#include "feed_curve.h"
+#include "logger.h"
+
+FeedCurve::FeedCurve() {
+    _enabled = false;
+    _flockStartDay = 0;
+    _pointCount = 0;
+    _valid = false;
+    _flockAgeDays = 0;
+    _dailyTarget = 0;
+
+    for (int i = 0; i < 4; i++) {
+        _slotShare[i] = 25;
+        _slotTargets[i] = 0;
+    }
+}
+
+void FeedCurve::configure(const Config& config, int timezoneOffset) {
+    _enabled = config.feedCurveEnabled;
+    time_t localStart = (time_t)config.flockStartDate + (timezoneOffset * 3600);
+    _flockStartDay = localStart > 0 ? localStart / 86400 : 0;
+    _pointCount = min(config.feedCurvePoints, (uint8_t)FEED_CURVE_MAX_POINTS);
+
+    for (int i = 0; i < _pointCount; i++) {
+        _points[i] = config.feedCurve[i];
+    }
+    for (int i = 0; i < 4; i++) {
+        _slotShare[i] = config.slotShare[i];
+    }
+
+    // Force rebuild with the new settings
+    _valid = false;
+}
+
+void FeedCurve::rebuild(uint32_t localDay, const uint16_t slotFires[4]) {
+    _valid = false;
+
+    if (!_enabled || _pointCount == 0 || localDay < _flockStartDay) {
+        return;
+    }
+
+    _flockAgeDays = localDay - _flockStartDay;
+    _dailyTarget = dailyTargetForAge(_flockAgeDays);
+
+    // Normalize shares across the slots that fire today
+    uint16_t shareTotal = 0;
+    uint8_t firingCount = 0;
+    for (int i = 0; i < 4; i++) {
+        if (slotFires[i] > 0) {
+            shareTotal += _slotShare[i];
+            firingCount++;
+        }
+    }
+
+    // A slot's part of the day is split across its fires (0 6,18 * * * feeds twice)
+    for (int i = 0; i < 4; i++) {
+        if (slotFires[i] == 0) {
+            _slotTargets[i] = 0;
+        } else if (shareTotal == 0) {
+            _slotTargets[i] = _dailyTarget / firingCount / slotFires[i];  // No shares set - split evenly
+        } else {
+            _slotTargets[i] = _dailyTarget * _slotShare[i] / shareTotal / slotFires[i];
+        }
+    }
+
+    _valid = true;
+    LOG_INFO("curve", "Feed curve: flock day %d, daily target %.2f (per feed: %.2f %.2f %.2f %.2f)",
+                  _flockAgeDays, _dailyTarget,
+                  _slotTargets[0], _slotTargets[1], _slotTargets[2], _slotTargets[3]);
+}
+
+float FeedCurve::getSlotTarget(uint8_t slot, float fallback) const {
+    if (!_valid || slot >= 4) {
+        return fallback;
+    }
+    return _slotTargets[slot];
+}
+
+float FeedCurve::dailyTargetForAge(int ageDays) const {
+    if (_pointCount == 0) return 0;
+
+    // Clamp before first and after last point
+    if (ageDays <= _points[0].day) return _points[0].dailyTarget;
+    if (ageDays >= _points[_pointCount - 1].day) return _points[_pointCount - 1].dailyTarget;
+
+    // Linear interpolation between surrounding points (points are sorted by day)
+    for (int i = 1; i < _pointCount; i++) {
+        if (ageDays <= _points[i].day) {
+            const FeedCurvePoint& a = _points[i - 1];
+            const FeedCurvePoint& b = _points[i];
+            float fraction = (float)(ageDays - a.day) / (float)(b.day - a.day);
+            return a.dailyTarget + (b.dailyTarget - a.dailyTarget) * fraction;
+        }
+    }
+
+    return _points[_pointCount - 1].dailyTarget;
+}
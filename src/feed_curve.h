@@ -0,0 +1,53 @@
+#ifndef FEED_CURVE_H
+#define FEED_CURVE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "types.h"
+
+// Flock-age based growth curve
+// Daily target is linearly interpolated between curve points by bird age,
+// then split across the schedule slots that fire that day by their configured
+// share, and each slot's part across its fires that day. The per-fire table
+// is rebuilt once per day so feeds just look up a value.
+class FeedCurve {
+public:
+    FeedCurve();
+
+    // Copy curve settings from config (call at startup and whenever config changes)
+    // timezoneOffset = hours from UTC, so the placement day is counted in local days like rebuild()
+    void configure(const Config& config, int timezoneOffset);
+
+    // Rebuild today's per-fire slot targets
+    // localDay = days since epoch in local time, slotFires = times each slot fires that day
+    void rebuild(uint32_t localDay, const uint16_t slotFires[4]);
+
+    // Invalidate table (e.g. time not synced yet)
+    void clear() { _valid = false; }
+
+    // Target for one fire of a slot (0 = nothing to feed), or fallback if the
+    // curve is disabled/not built
+    float getSlotTarget(uint8_t slot, float fallback) const;
+
+    bool isActive() const { return _valid; }
+    int getFlockAgeDays() const { return _valid ? _flockAgeDays : -1; }
+    float getDailyTarget() const { return _valid ? _dailyTarget : 0; }
+
+    // Interpolate daily target for an age in days
+    float dailyTargetForAge(int ageDays) const;
+
+private:
+    bool _enabled;
+    uint32_t _flockStartDay;  // local days since epoch of placement
+    FeedCurvePoint _points[FEED_CURVE_MAX_POINTS];
+    uint8_t _pointCount;
+    uint8_t _slotShare[4];
+
+    // Precomputed table for the current day
+    bool _valid;
+    int _flockAgeDays;
+    float _dailyTarget;
+    float _slotTargets[4];    // Per fire
+};
+
+#endif // FEED_CURVE_H
@@ -0,0 +1,171 @@
+#include "gzip.h"
+
+// Deflate length and distance codes: base value and extra bits (RFC 1951 3.2.5)
+static const uint16_t LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                         31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                         2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DISTANCE_BASE[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                           33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                           1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                           6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+static const uint16_t MIN_MATCH = 3;
+static const uint16_t MAX_MATCH = 258;
+static const uint32_t MAX_DISTANCE = 32768;
+
+// CRC-32 a nibble at a time (reflected polynomial 0xEDB88320)
+static const uint32_t CRC_TABLE[16] = {0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+                                       0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+                                       0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+
+Gzip::Gzip() {
+    memset(_head, 0, sizeof(_head));
+    _out = nullptr;
+    _size = 0;
+    _length = 0;
+    _bits = 0;
+    _bitCount = 0;
+    _overflow = false;
+}
+
+size_t Gzip::compress(const uint8_t* data, size_t length, uint8_t* out, size_t size) {
+    if (length > 0xFFFE) return 0;  // Positions are kept in 16 bits
+
+    _out = out;
+    _size = size;
+    _length = 0;
+    _bits = 0;
+    _bitCount = 0;
+    _overflow = false;
+    memset(_head, 0, sizeof(_head));
+
+    // Member header: deflate, no flags, no mtime, unknown OS
+    static const uint8_t header[10] = {0x1F, 0x8B, 0x08, 0, 0, 0, 0, 0, 0, 0xFF};
+    for (uint8_t b : header) putByte(b);
+
+    putBits(1, 1);  // BFINAL: the only block
+    putBits(1, 2);  // BTYPE 01: fixed Huffman codes
+
+    size_t pos = 0;
+    while (pos < length && !_overflow) {
+        uint16_t matchLength = 0;
+        uint16_t matchDistance = 0;
+
+        if (pos + MIN_MATCH <= length) {
+            uint16_t h = hash(data + pos);
+            uint16_t candidate = _head[h];
+            _head[h] = pos + 1;
+
+            if (candidate != 0 && pos - (candidate - 1) <= MAX_DISTANCE) {
+                const uint8_t* a = data + candidate - 1;
+                const uint8_t* b = data + pos;
+                size_t limit = min(length - pos, (size_t)MAX_MATCH);
+                size_t n = 0;
+                while (n < limit && a[n] == b[n]) n++;
+                if (n >= MIN_MATCH) {
+                    matchLength = n;
+                    matchDistance = pos - (candidate - 1);
+                }
+            }
+        }
+
+        if (matchLength == 0) {
+            putLiteral(data[pos]);
+            pos++;
+            continue;
+        }
+
+        putMatch(matchLength, matchDistance);
+        // Index the positions inside the match so later repeats find them
+        for (size_t i = pos + 1; i < pos + matchLength && i + MIN_MATCH <= length; i++) {
+            _head[hash(data + i)] = i + 1;
+        }
+        pos += matchLength;
+    }
+
+    putLiteral(256);  // End of block
+    flushBits();
+
+    // Trailer: CRC-32 and input size, little-endian
+    uint32_t crc = crc32(0, data, length);
+    for (int i = 0; i < 4; i++) putByte(crc >> (8 * i));
+    for (int i = 0; i < 4; i++) putByte(length >> (8 * i));
+
+    return _overflow ? 0 : _length;
+}
+
+uint32_t Gzip::crc32(uint32_t crc, const uint8_t* data, size_t length) {
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ CRC_TABLE[crc & 0x0F];
+        crc = (crc >> 4) ^ CRC_TABLE[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+void Gzip::putBits(uint32_t value, uint8_t count) {
+    _bits |= value << _bitCount;
+    _bitCount += count;
+    while (_bitCount >= 8) {
+        putByte(_bits & 0xFF);
+        _bits >>= 8;
+        _bitCount -= 8;
+    }
+}
+
+// Huffman codes go out most significant bit first
+void Gzip::putHuffman(uint16_t code, uint8_t count) {
+    uint16_t reversed = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        reversed = (reversed << 1) | (code & 1);
+        code >>= 1;
+    }
+    putBits(reversed, count);
+}
+
+// Fixed literal/length code (RFC 1951 3.2.6)
+void Gzip::putLiteral(uint16_t symbol) {
+    if (symbol < 144) {
+        putHuffman(0x30 + symbol, 8);
+    } else if (symbol < 256) {
+        putHuffman(0x190 + symbol - 144, 9);
+    } else if (symbol < 280) {
+        putHuffman(symbol - 256, 7);
+    } else {
+        putHuffman(0xC0 + symbol - 280, 8);
+    }
+}
+
+void Gzip::putMatch(uint16_t length, uint16_t distance) {
+    uint8_t code = 28;
+    while (LENGTH_BASE[code] > length) code--;
+    putLiteral(257 + code);
+    putBits(length - LENGTH_BASE[code], LENGTH_EXTRA[code]);
+
+    code = 29;
+    while (DISTANCE_BASE[code] > distance) code--;
+    putHuffman(code, 5);
+    putBits(distance - DISTANCE_BASE[code], DISTANCE_EXTRA[code]);
+}
+
+void Gzip::putByte(uint8_t b) {
+    if (_length >= _size) {
+        _overflow = true;
+        return;
+    }
+    _out[_length++] = b;
+}
+
+void Gzip::flushBits() {
+    if (_bitCount > 0) putByte(_bits & 0xFF);
+    _bits = 0;
+    _bitCount = 0;
+}
+
+uint16_t Gzip::hash(const uint8_t* p) {
+    uint32_t v = (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+    return (v * 2654435761u) >> (32 - 10);  // HASH_SIZE = 2^10
+}
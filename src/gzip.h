@@ -0,0 +1,46 @@
+#ifndef GZIP_H
+#define GZIP_H
+
+#include <Arduino.h>
+
+// Small in-memory gzip compressor (RFC 1952 around one RFC 1951 block)
+// Greedy LZ77 against a one-entry-per-hash table and the fixed Huffman
+// codes: no dynamic trees and no sliding window state, so it needs only the
+// hash table (2 KB) and no heap. Repetitive text such as line protocol
+// shrinks to a quarter or less. The whole input must be in memory (up to
+// 64 KB). One task at a time per instance.
+class Gzip {
+public:
+    Gzip();
+
+    // Compress data into out; returns the gzip stream's size, or 0 if it
+    // doesn't fit in size bytes (send the data uncompressed then)
+    size_t compress(const uint8_t* data, size_t length, uint8_t* out, size_t size);
+
+    // CRC-32 (IEEE) as used by gzip; pass 0 to start
+    static uint32_t crc32(uint32_t crc, const uint8_t* data, size_t length);
+
+private:
+    static const uint16_t HASH_SIZE = 1024;
+
+    uint16_t _head[HASH_SIZE];  // Last position + 1 for each 3-byte hash, 0 = none
+
+    // Output bit stream (deflate packs bits LSB first)
+    uint8_t* _out;
+    size_t _size;
+    size_t _length;
+    uint32_t _bits;
+    uint8_t _bitCount;
+    bool _overflow;
+
+    void putBits(uint32_t value, uint8_t count);
+    void putHuffman(uint16_t code, uint8_t count);
+    void putLiteral(uint16_t symbol);
+    void putMatch(uint16_t length, uint16_t distance);
+    void putByte(uint8_t b);
+    void flushBits();
+
+    static uint16_t hash(const uint8_t* p);
+};
+
+#endif // GZIP_H
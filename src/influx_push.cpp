@@ -0,0 +1,305 @@
+#include "influx_push.h"
+
+#if FEATURE_INFLUX
+#include "net_lock.h"
+#include "net_events.h"
+#include "logger.h"
+#include <time.h>
+
+InfluxPush::InfluxPush(Storage& storage) : _storage(storage) {
+    _enabled = false;
+    _host[0] = '\0';
+    _port = INFLUX_DEFAULT_PORT;
+    _path[0] = '\0';
+    _token[0] = '\0';
+    _node[0] = '\0';
+
+    _batchLength = 0;
+    _points = 0;
+    _batchStart = 0;
+
+    _lastSampleAt = 0;
+    _lastSampleTime = 0;
+
+    _nextAttempt = 0;
+    _retryDelay = INFLUX_RETRY_MIN;
+    _spoolSize = 0;
+    _spoolOffset = 0;
+    _dropped = 0;
+}
+
+void InfluxPush::configure(const Config& config, uint32_t nodeId) {
+    // "host" or "host:port"
+    char host[sizeof(_host)];
+    uint16_t port = INFLUX_DEFAULT_PORT;
+    strlcpy(host, config.influxServer, sizeof(host));
+    char* colon = strchr(host, ':');
+    if (colon != nullptr) {
+        *colon = '\0';
+        port = atoi(colon + 1);
+        if (port == 0) port = INFLUX_DEFAULT_PORT;
+    }
+
+    // Timestamps are whole seconds
+    char path[sizeof(_path)];
+    const char* base = config.influxPath[0] != '\0' ? config.influxPath : "/write?db=feeder";
+    snprintf(path, sizeof(path), "%s%sprecision=s", base, strchr(base, '?') != nullptr ? "&" : "?");
+
+    char node[sizeof(_node)];
+    snprintf(node, sizeof(node), "%08lX", (unsigned long)nodeId);
+
+    bool enabled = config.influxEnabled && host[0] != '\0';
+    if (enabled == _enabled && port == _port && strcmp(host, _host) == 0 && strcmp(path, _path) == 0 &&
+        strcmp(config.influxToken, _token) == 0 && strcmp(node, _node) == 0) {
+        return;
+    }
+
+    _enabled = enabled;
+    strlcpy(_host, host, sizeof(_host));
+    _port = port;
+    strlcpy(_path, path, sizeof(_path));
+    strlcpy(_token, config.influxToken, sizeof(_token));
+    strlcpy(_node, node, sizeof(_node));
+
+    // New settings get a fresh try; batches spooled before a restart go out first
+    _retryDelay = INFLUX_RETRY_MIN;
+    _nextAttempt = millis();
+    _spoolSize = _storage.getSpoolSize();
+    _spoolOffset = 0;
+
+    if (_enabled) {
+        LOG_INFO("influx", "Pushing to %s:%u%s (%u bytes spooled)", _host, _port, _path, (unsigned)_spoolSize);
+    } else {
+        LOG_INFO("influx", "Push disabled");
+    }
+}
+
+void InfluxPush::update(const SystemStatus& status) {
+    if (!_enabled) return;
+
+    sampleWeights(status);
+
+    if (_points >= INFLUX_BATCH_POINTS || (_points > 0 && millis() - _batchStart >= INFLUX_BATCH_INTERVAL)) {
+        flush();
+    }
+    // One spooled batch per pass keeps each pass short
+    if (_spoolOffset < _spoolSize && (long)(millis() - _nextAttempt) >= 0) {
+        drainSpool();
+    }
+}
+
+void InfluxPush::addNotification(const Notification& notification) {
+    if (!_enabled) return;
+    unsigned long now = wallClock();
+    if (now == 0) return;  // Clock not set: the point would land at 1970
+
+    const char* type = "warning";
+    if (notification.type == NotificationType::FEEDING_COMPLETE) type = "feed";
+    else if (notification.type == NotificationType::ALARM) type = "alarm";
+
+    char line[sizeof(notification.text) * 2 + 160];
+    size_t length = snprintf(line, sizeof(line),
+                             "feeder_events,node=%s,type=%s cycle=%ui,target=%.2f,actual=%.2f,duration=%ui,text=",
+                             _node, type, notification.feedCycle, notification.targetWeight,
+                             notification.actualWeight, notification.duration);
+    length = min(length, sizeof(line) - 1);
+    length += appendFieldString(line + length, sizeof(line) - length, notification.text);
+    length += snprintf(line + length, sizeof(line) - length, " %lu\n", now);
+    addLine(line, min(length, sizeof(line) - 1));
+}
+
+void InfluxPush::sampleWeights(const SystemStatus& status) {
+    // A fresh BinTrac reading, at most one per interval
+    if (!status.bintracConnected || status.lastBintracUpdate == _lastSampleAt) return;
+    if (_lastSampleTime != 0 && millis() - _lastSampleTime < INFLUX_SAMPLE_INTERVAL) return;
+
+    unsigned long now = wallClock();
+    if (now == 0) return;
+    _lastSampleAt = status.lastBintracUpdate;
+    _lastSampleTime = millis() != 0 ? millis() : 1;
+
+    char line[128];
+    size_t length = snprintf(line, sizeof(line), "feeder_weights,node=%s a=%.1f,b=%.1f,c=%.1f,d=%.1f %lu\n", _node,
+                             status.currentWeight[0], status.currentWeight[1], status.currentWeight[2],
+                             status.currentWeight[3], now);
+    addLine(line, min(length, sizeof(line) - 1));
+}
+
+bool InfluxPush::addLine(const char* line, size_t length) {
+    if (_batchLength + length > sizeof(_batch)) flush();
+    if (_batchLength + length > sizeof(_batch)) return false;
+
+    if (_points == 0) _batchStart = millis();
+    memcpy(_batch + _batchLength, line, length);
+    _batchLength += length;
+    _points++;
+    return true;
+}
+
+void InfluxPush::flush() {
+    if (_points == 0) return;
+
+    // Compressed unless that doesn't fit (it always does for line protocol)
+    const uint8_t* body = _body;
+    size_t length = _gzip.compress((const uint8_t*)_batch, _batchLength, _body, sizeof(_body));
+    if (length == 0) {
+        body = (const uint8_t*)_batch;
+        length = _batchLength;
+    }
+
+    if ((long)(millis() - _nextAttempt) < 0) {
+        spool(body, length, _points);  // Still backing off
+    } else {
+        switch (post(body, length)) {
+            case PushResult::SENT:
+                pushSucceeded();
+                break;
+            case PushResult::REJECTED:
+                _dropped += _points;
+                break;
+            case PushResult::FAILED:
+                pushFailed();
+                spool(body, length, _points);
+                break;
+        }
+    }
+
+    _batchLength = 0;
+    _points = 0;
+}
+
+void InfluxPush::drainSpool() {
+    size_t offset = _spoolOffset;
+    size_t length = _storage.readSpoolRecord(offset, _body, sizeof(_body));
+    if (length > 0) {
+        if (post(_body, length) == PushResult::FAILED) {
+            pushFailed();
+            return;
+        }
+        pushSucceeded();  // Or rejected: either way it's done with
+        _spoolOffset = offset;
+        if (_spoolOffset < _spoolSize) return;
+    } else {
+        LOG_WARN("influx", "Spool ends in a damaged record at %u, discarded", (unsigned)_spoolOffset);
+    }
+
+    // All sent
+    _storage.clearSpool();
+    _spoolSize = 0;
+    _spoolOffset = 0;
+}
+
+void InfluxPush::spool(const uint8_t* body, size_t length, uint16_t points) {
+    if (_spoolSize + 2 + length > INFLUX_SPOOL_MAX || !_storage.appendSpoolRecord(body, length)) {
+        _dropped += points;
+        LOG_WARN("influx", "Spool full - %u points dropped", points);
+        return;
+    }
+    _spoolSize += 2 + length;
+    LOG_DEBUG("influx", "Spooled %u points (%u bytes waiting)", points, (unsigned)getSpooled());
+}
+
+InfluxPush::PushResult InfluxPush::post(const uint8_t* body, size_t length) {
+    LockedEthernetClient client(SocketUser::INFLUX);
+    if (!client.connect(_host, _port)) {
+        LOG_WARN("influx", "Connection to %s:%u failed", _host, _port);
+        return PushResult::FAILED;
+    }
+
+    // Spooled records are gzip or, rarely, plain line protocol (never starts with 0x1F)
+    bool gzipped = length >= 2 && body[0] == 0x1F && body[1] == 0x8B;
+
+    char header[sizeof(_path) + sizeof(_host) + sizeof(_token) + 192];
+    size_t headerLength = snprintf(header, sizeof(header),
+                                   "POST %s HTTP/1.1\r\n"
+                                   "Host: %s:%u\r\n"
+                                   "%s%s%s"
+                                   "Content-Type: text/plain; charset=utf-8\r\n"
+                                   "%s"
+                                   "Content-Length: %u\r\n"
+                                   "Connection: close\r\n\r\n",
+                                   _path, _host, _port, _token[0] != '\0' ? "Authorization: Token " : "", _token,
+                                   _token[0] != '\0' ? "\r\n" : "", gzipped ? "Content-Encoding: gzip\r\n" : "",
+                                   (unsigned)length);
+    headerLength = min(headerLength, sizeof(header) - 1);
+
+    if (client.write((const uint8_t*)header, headerLength) != headerLength || client.write(body, length) != length) {
+        client.stop();
+        LOG_WARN("influx", "Write to %s:%u failed", _host, _port);
+        return PushResult::FAILED;
+    }
+
+    // Status line only ("HTTP/1.1 204 No Content")
+    char line[48];
+    size_t lineLength = 0;
+    bool complete = false;
+    unsigned long startTime = millis();
+    while (!complete && client.connected() && millis() - startTime < INFLUX_TIMEOUT) {
+        if (!client.available()) {
+            NetEvents::waitForSocket(startTime, INFLUX_TIMEOUT);
+            continue;
+        }
+        char c = client.read();
+        if (c == '\n') {
+            complete = true;
+        } else if (c != '\r' && lineLength < sizeof(line) - 1) {
+            line[lineLength++] = c;
+        }
+    }
+    line[lineLength] = '\0';
+    client.stop();
+
+    int code = 0;
+    if (strncmp(line, "HTTP/", 5) == 0) {
+        const char* space = strchr(line, ' ');
+        if (space != nullptr) code = atoi(space + 1);
+    }
+
+    if (code >= 200 && code < 300) return PushResult::SENT;
+    if (code == 0) {
+        LOG_WARN("influx", "No response from %s:%u", _host, _port);
+        return PushResult::FAILED;
+    }
+    if (code == 429 || code >= 500) {
+        LOG_WARN("influx", "Server busy (HTTP %d)", code);
+        return PushResult::FAILED;
+    }
+    LOG_WARN("influx", "Batch rejected (HTTP %d), check the write path and token", code);
+    return PushResult::REJECTED;
+}
+
+void InfluxPush::pushSucceeded() {
+    _retryDelay = INFLUX_RETRY_MIN;
+}
+
+void InfluxPush::pushFailed() {
+    // Back off, with up to a quarter of jitter so a fleet doesn't retry in step
+    uint32_t delayMs = _retryDelay + micros() % (_retryDelay / 4 + 1);
+    _nextAttempt = millis() + delayMs;
+    _retryDelay = min((uint32_t)INFLUX_RETRY_MAX, _retryDelay * 2);
+}
+
+unsigned long InfluxPush::wallClock() {
+    time_t now = time(nullptr);
+    return now >= (time_t)TIME_MIN_VALID ? (unsigned long)now : 0;
+}
+
+// Appends s as a quoted line protocol string field, cut short to fit size
+// (including the terminator); newlines end a line, so they become spaces
+size_t InfluxPush::appendFieldString(char* out, size_t size, const char* s) {
+    if (size < 3) return 0;
+    size_t length = 0;
+    out[length++] = '"';
+    for (; *s != '\0'; s++) {
+        char c = *s;
+        size_t n = (c == '"' || c == '\\') ? 2 : 1;
+        if (length + n + 2 > size) break;  // Room for the closing quote and terminator
+        if (n == 2) out[length++] = '\\';
+        out[length++] = (c == '\n' || c == '\r') ? ' ' : c;
+    }
+    out[length++] = '"';
+    out[length] = '\0';
+    return length;
+}
+
+#endif // FEATURE_INFLUX
@@ -0,0 +1,93 @@
+#ifndef INFLUX_PUSH_H
+#define INFLUX_PUSH_H
+
+#include "config.h"
+
+#if FEATURE_INFLUX
+#include <Arduino.h>
+#include "types.h"
+#include "task_messages.h"
+#include "storage.h"
+#include "gzip.h"
+
+// Bin weights and feed events pushed to an InfluxDB write endpoint
+// (v1 /write or v2 /api/v2/write) in line protocol, from the notify task:
+//   feeder_weights,node=<id> a=..,b=..,c=..,d=.. <time>
+//   feeder_events,node=<id>,type=feed|alarm|warning cycle=..i,target=..,actual=..,duration=..i,text=".." <time>
+// Points collect in one batch that is gzipped and POSTed once it holds
+// INFLUX_BATCH_POINTS points or its oldest is INFLUX_BATCH_INTERVAL old.
+// A batch the server can't take is appended to a spool file in LittleFS
+// and resent oldest first once pushes work again (after a restart too: a
+// resent point overwrites itself in InfluxDB, so nothing doubles). Failed
+// pushes back off exponentially (INFLUX_RETRY_MIN up to INFLUX_RETRY_MAX).
+class InfluxPush {
+public:
+    explicit InfluxPush(Storage& storage);
+
+    // Apply the server settings (at start and on every config change).
+    // nodeId is the node tag.
+    void configure(const Config& config, uint32_t nodeId);
+
+    // Sample the weights, push a due batch or one spooled batch (every notify task pass)
+    void update(const SystemStatus& status);
+
+    // Feed event, alarm or warning from the notification queue
+    void addNotification(const Notification& notification);
+
+    bool isEnabled() const { return _enabled; }
+    uint16_t getPending() const { return _points; }
+    size_t getSpooled() const { return _spoolSize - _spoolOffset; }
+    uint32_t getDropped() const { return _dropped; }
+
+private:
+    enum class PushResult : uint8_t {
+        SENT,
+        REJECTED,  // 4xx other than 429: the data is bad, resending won't help
+        FAILED     // Network error, 429 or 5xx: try again later
+    };
+
+    Storage& _storage;
+    Gzip _gzip;
+
+    // Settings
+    bool _enabled;
+    char _host[sizeof(Config::influxServer)];
+    uint16_t _port;
+    char _path[sizeof(Config::influxPath) + 16];  // With precision=s
+    char _token[sizeof(Config::influxToken)];
+    char _node[9];
+
+    // Batch being collected
+    char _batch[INFLUX_BATCH_MAX];
+    size_t _batchLength;
+    uint16_t _points;
+    unsigned long _batchStart;
+    uint8_t _body[INFLUX_BATCH_MAX];  // Compressed batch or a spooled record on its way out
+
+    // Weight sampling
+    unsigned long _lastSampleAt;    // lastBintracUpdate of the last reading taken
+    unsigned long _lastSampleTime;
+
+    // Retry and spool
+    unsigned long _nextAttempt;
+    uint32_t _retryDelay;
+    size_t _spoolSize;
+    size_t _spoolOffset;            // Records before this were sent
+    uint32_t _dropped;              // Points lost (spool full or rejected by the server)
+
+    void sampleWeights(const SystemStatus& status);
+    bool addLine(const char* line, size_t length);
+    void flush();
+    void drainSpool();
+    void spool(const uint8_t* body, size_t length, uint16_t points);
+    PushResult post(const uint8_t* body, size_t length);
+    void pushSucceeded();
+    void pushFailed();
+
+    static unsigned long wallClock();
+    static size_t appendFieldString(char* out, size_t size, const char* s);
+};
+
+#endif // FEATURE_INFLUX
+
+#endif // INFLUX_PUSH_H
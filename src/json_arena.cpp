@@ -0,0 +1,74 @@
+#include "json_arena.h"
+
+// Each block: header (payload size) then payload, all 8-byte aligned
+static const size_t HEADER_SIZE = 8;
+
+static size_t alignUp(size_t size) {
+    return (size + 7) & ~(size_t)7;
+}
+
+JsonArena::JsonArena(uint8_t* buffer, size_t size)
+    : _buffer(buffer), _size(size), _used(0), _peak(0), _last(nullptr) {
+}
+
+void JsonArena::reset() {
+    _used = 0;
+    _last = nullptr;
+}
+
+size_t JsonArena::blockSize(uint8_t* block) {
+    size_t size;
+    memcpy(&size, block, sizeof(size));
+    return size;
+}
+
+void* JsonArena::allocate(size_t size) {
+    size_t needed = HEADER_SIZE + alignUp(size);
+    if (needed > _size - _used) {
+        return nullptr;
+    }
+
+    uint8_t* block = _buffer + _used;
+    memcpy(block, &size, sizeof(size));
+    _last = block;
+    _used += needed;
+    if (_used > _peak) _peak = _used;
+    return block + HEADER_SIZE;
+}
+
+void JsonArena::deallocate(void* ptr) {
+    // Only the newest block can be given back before reset()
+    if (ptr != nullptr && (uint8_t*)ptr - HEADER_SIZE == _last) {
+        _used = _last - _buffer;
+        _last = nullptr;
+    }
+}
+
+void* JsonArena::reallocate(void* ptr, size_t newSize) {
+    if (ptr == nullptr) {
+        return allocate(newSize);
+    }
+
+    uint8_t* block = (uint8_t*)ptr - HEADER_SIZE;
+    size_t oldSize = blockSize(block);
+
+    // Newest block grows or shrinks in place
+    if (block == _last) {
+        size_t start = block - _buffer;
+        size_t needed = HEADER_SIZE + alignUp(newSize);
+        if (needed > _size - start) {
+            return nullptr;
+        }
+        memcpy(block, &newSize, sizeof(newSize));
+        _used = start + needed;
+        if (_used > _peak) _peak = _used;
+        return ptr;
+    }
+
+    // Anything else moves to a new block; the old one is reclaimed on reset()
+    void* moved = allocate(newSize);
+    if (moved != nullptr) {
+        memcpy(moved, ptr, oldSize < newSize ? oldSize : newSize);
+    }
+    return moved;
+}
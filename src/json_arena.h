@@ -0,0 +1,38 @@
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Bump allocator for JsonDocuments over a fixed buffer
+// Documents built while serving one request allocate from the arena and
+// reset() drops everything at once before the next request, so JSON work
+// never touches the heap. Freeing or growing the newest block is done in
+// place; other frees are no-ops until reset(). Allocations that don't fit
+// fail, which ArduinoJson reports as overflowed()/NoMemory.
+class JsonArena : public ArduinoJson::Allocator {
+public:
+    JsonArena(uint8_t* buffer, size_t size);
+
+    // Release all blocks (no documents may still be using the arena)
+    void reset();
+
+    size_t getUsed() const { return _used; }
+    size_t getPeak() const { return _peak; }
+    size_t getSize() const { return _size; }
+
+    void* allocate(size_t size) override;
+    void deallocate(void* ptr) override;
+    void* reallocate(void* ptr, size_t newSize) override;
+
+private:
+    uint8_t* _buffer;
+    size_t _size;
+    size_t _used;
+    size_t _peak;
+    uint8_t* _last;  // Newest block (header), nullptr if none
+
+    static size_t blockSize(uint8_t* block);
+};
+
+#endif // JSON_ARENA_H
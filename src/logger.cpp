@@ -0,0 +1,141 @@
+#include "logger.h"
+#include "task_monitor.h"
+#include <stdarg.h>
+
+Logger::Entry Logger::_ring[LOG_BUFFER_ENTRIES];
+bool Logger::_writing[LOG_BUFFER_ENTRIES];
+uint32_t Logger::_nextSeq = 1;
+volatile uint32_t Logger::_dropped = 0;
+portMUX_TYPE Logger::_lock = portMUX_INITIALIZER_UNLOCKED;
+TaskHandle_t Logger::_task = nullptr;
+LogSink* volatile Logger::_sink = nullptr;
+
+void Logger::begin() {
+    if (_task != nullptr) return;
+
+    xTaskCreatePinnedToCore(drainTask, "log", LOG_TASK_STACK, nullptr,
+                            LOG_TASK_PRIORITY, &_task, LOG_TASK_CORE);
+    TaskMonitor::add(_task, "log", LOG_TASK_STACK);
+    xTaskNotifyGive(_task);  // Drain anything logged before the task existed
+}
+
+void Logger::log(uint8_t level, const char* tag, const char* format, ...) {
+    uint32_t ms = millis();
+
+    // Reserve the next slot; only the index moves under the lock
+    portENTER_CRITICAL(&_lock);
+    uint32_t seq = _nextSeq;
+    uint32_t index = seq % LOG_BUFFER_ENTRIES;
+    bool busy = _writing[index];
+    if (busy) {
+        // A preempted caller is still writing the record the ring came round to
+        _dropped++;
+    } else {
+        _writing[index] = true;
+        _ring[index].seq = 0;
+        _nextSeq++;
+    }
+    portEXIT_CRITICAL(&_lock);
+    if (busy) return;
+
+    // Format straight into the slot; readers skip it until it's committed
+    Entry& entry = _ring[index];
+    entry.ms = ms;
+    entry.tag = tag;
+    entry.level = level;
+    va_list args;
+    va_start(args, format);
+    vsnprintf(entry.message, sizeof(entry.message), format, args);
+    va_end(args);
+
+    portENTER_CRITICAL(&_lock);
+    entry.seq = seq;
+    _writing[index] = false;
+    portEXIT_CRITICAL(&_lock);
+
+    if (_task != nullptr) {
+        xTaskNotifyGive(_task);
+    }
+}
+
+uint32_t Logger::oldestSeq() {
+    portENTER_CRITICAL(&_lock);
+    uint32_t oldest = _nextSeq > LOG_BUFFER_ENTRIES ? _nextSeq - LOG_BUFFER_ENTRIES : 1;
+    portEXIT_CRITICAL(&_lock);
+    return oldest;
+}
+
+uint32_t Logger::nextSeq() {
+    portENTER_CRITICAL(&_lock);
+    uint32_t next = _nextSeq;
+    portEXIT_CRITICAL(&_lock);
+    return next;
+}
+
+bool Logger::readEntry(uint32_t seq, Entry& entry) {
+    uint32_t index = seq % LOG_BUFFER_ENTRIES;
+
+    portENTER_CRITICAL(&_lock);
+    bool committed = seq < _nextSeq && _ring[index].seq == seq;
+    portEXIT_CRITICAL(&_lock);
+    if (!committed) return false;
+
+    // Copy without the lock; a writer reserving the slot meanwhile clears its seq
+    entry = _ring[index];
+
+    portENTER_CRITICAL(&_lock);
+    bool intact = _ring[index].seq == seq;
+    portEXIT_CRITICAL(&_lock);
+    return intact;
+}
+
+char Logger::levelLetter(uint8_t level) {
+    switch (level) {
+        case LOG_LEVEL_ERROR: return 'E';
+        case LOG_LEVEL_WARN:  return 'W';
+        case LOG_LEVEL_INFO:  return 'I';
+        case LOG_LEVEL_DEBUG: return 'D';
+        default:              return '?';
+    }
+}
+
+void Logger::printEntry(const Entry& entry) {
+    Serial.printf("[%8lu %c %-8s] %s\n", (unsigned long)entry.ms, levelLetter(entry.level),
+                  entry.tag, entry.message);
+}
+
+// Log task: drains new records to Serial and the sink; the only place that
+// waits on the UART
+void Logger::drainTask(void* param) {
+    uint32_t drained = 1;
+    Entry entry;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        LogSink* sink = _sink;
+        bool remote = sink != nullptr && drained < nextSeq() && sink->beginBatch();
+
+        while (drained < nextSeq()) {
+            if (readEntry(drained, entry)) {
+                printEntry(entry);
+                if (remote) sink->send(entry);
+                drained++;
+                continue;
+            }
+
+            // Still being written: its commit wakes us again
+            uint32_t oldest = oldestSeq();
+            if (drained >= oldest) break;
+
+            // Overwritten before we got to it
+            portENTER_CRITICAL(&_lock);
+            _dropped += oldest - drained;
+            portEXIT_CRITICAL(&_lock);
+            Serial.printf("[log: %lu records dropped]\n", (unsigned long)(oldest - drained));
+            drained = oldest;
+        }
+
+        if (remote) sink->endBatch();
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "config.h"
+
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+// Leveled log macros; anything above LOG_LEVEL (config.h) compiles away
+// Tag is a short string literal naming the subsystem ("feed", "bintrac", ...)
+#define LOG_AT(level, tag, ...) \
+    do { if ((level) <= LOG_LEVEL) Logger::log((level), (tag), __VA_ARGS__); } while (0)
+#define LOG_ERROR(tag, ...) LOG_AT(LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#define LOG_WARN(tag, ...)  LOG_AT(LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#define LOG_INFO(tag, ...)  LOG_AT(LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#define LOG_DEBUG(tag, ...) LOG_AT(LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+
+class LogSink;
+
+// Structured log with an in-RAM ring buffer
+// log() reserves the next record under the lock, formats straight into it
+// with the lock released, then commits it; a low priority task drains new
+// records to Serial (and a remote sink, if set), so callers never block on
+// the UART. Records are numbered from 1; the ring keeps the last
+// LOG_BUFFER_ENTRIES for /api/logs. Safe to call from any task (not from an
+// ISR).
+class Logger {
+public:
+    struct Entry {
+        uint32_t seq;
+        uint32_t ms;        // millis() when logged
+        const char* tag;
+        uint8_t level;
+        char message[LOG_MESSAGE_LEN];
+    };
+
+    // Start the drain task (call first thing in setup; earlier records are kept)
+    static void begin();
+
+    // Also send drained records to a remote sink (syslog); nullptr = Serial only
+    static void setSink(LogSink* sink) { _sink = sink; }
+
+    static void log(uint8_t level, const char* tag, const char* format, ...)
+        __attribute__((format(printf, 3, 4)));
+
+    // Ring access: records oldestSeq() .. nextSeq() - 1 are available
+    static uint32_t oldestSeq();
+    static uint32_t nextSeq();
+    static bool readEntry(uint32_t seq, Entry& entry);  // false if overwritten or not committed yet
+
+    // Records overwritten before the drain task got to them, or lost because
+    // their slot was still being written when the ring came round to it
+    static uint32_t getDropped() { return _dropped; }
+    static char levelLetter(uint8_t level);
+
+private:
+    static Entry _ring[LOG_BUFFER_ENTRIES];  // seq 0 = reserved, being written
+    static bool _writing[LOG_BUFFER_ENTRIES];
+    static uint32_t _nextSeq;
+    static volatile uint32_t _dropped;
+    static portMUX_TYPE _lock;
+    static TaskHandle_t _task;
+    static LogSink* volatile _sink;
+
+    static void drainTask(void* param);
+    static void printEntry(const Entry& entry);
+};
+
+// Remote destination for drained records, driven by the log task
+// beginBatch() is called before each run of new records; if it returns
+// false the batch is skipped (Serial still gets it).
+class LogSink {
+public:
+    virtual ~LogSink() {}
+    virtual bool beginBatch() = 0;
+    virtual void send(const Logger::Entry& entry) = 0;
+    virtual void endBatch() = 0;
+};
+
+#endif // LOGGER_H
@@ -0,0 +1,222 @@
+#include "loop_profiler.h"
+
+LoopProfiler loopProfiler;
+
+#if FEATURE_TRACES
+
+LoopProfiler::LoopProfiler() {
+#if defined(ESP32)
+    _cyclesPerUs = ESP.getCpuFreqMHz();
+#else
+    _cyclesPerUs = 1;  // readCycles() falls back to micros()
+#endif
+    if (_cyclesPerUs == 0) _cyclesPerUs = 1;
+
+    _lock = portMUX_INITIALIZER_UNLOCKED;
+    reset();
+}
+
+ProfileMark LoopProfiler::now() {
+    ProfileMark mark;
+    mark.cycles = readCycles();
+    mark.ms = millis();
+    return mark;
+}
+
+void LoopProfiler::record(ProfileStage stage, const ProfileMark& start) {
+    ProfileMark end = now();
+    uint32_t us = elapsedUs(start, end);
+
+    portENTER_CRITICAL(&_lock);
+    rollWindowIfDue(end.ms);
+    addSample(_current[stage], us);
+    if (stage < PROFILE_CONTROL_STAGES) {
+        _iterationUs[stage] += us;
+    }
+    portEXIT_CRITICAL(&_lock);
+}
+
+void LoopProfiler::recordCycle(const ProfileMark& start) {
+    ProfileMark end = now();
+    uint32_t totalUs = elapsedUs(start, end);
+
+    portENTER_CRITICAL(&_lock);
+    rollWindowIfDue(end.ms);
+    addSample(_current[PROFILE_STAGE_COUNT], totalUs);
+
+    // Capture the breakdown of the slowest control cycle
+    if (totalUs > _worstEver.totalUs) {
+        _worstEver.totalUs = totalUs;
+        memcpy(_worstEver.stageUs, _iterationUs, sizeof(_iterationUs));
+        _worstEver.atMillis = start.ms;
+    }
+    memset(_iterationUs, 0, sizeof(_iterationUs));
+    portEXIT_CRITICAL(&_lock);
+}
+
+void LoopProfiler::getStageStats(ProfileStage stage, StageStats& stats) {
+    portENTER_CRITICAL(&_lock);
+    fillStats(_last[stage].count > 0 ? _last[stage] : _current[stage], stats);
+    portEXIT_CRITICAL(&_lock);
+}
+
+void LoopProfiler::getLoopStats(StageStats& stats) {
+    portENTER_CRITICAL(&_lock);
+    const Window& last = _last[PROFILE_STAGE_COUNT];
+    fillStats(last.count > 0 ? last : _current[PROFILE_STAGE_COUNT], stats);
+    portEXIT_CRITICAL(&_lock);
+}
+
+void LoopProfiler::getWorstLoop(WorstLoop& worst) {
+    portENTER_CRITICAL(&_lock);
+    worst = _worstEver;
+    portEXIT_CRITICAL(&_lock);
+}
+
+void LoopProfiler::printReport() {
+    Serial.println("=== Task Profile (us, last 60s window) ===");
+    Serial.println("Stage            count      min      avg      max      p99");
+
+    StageStats stats;
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        getStageStats((ProfileStage)i, stats);
+        Serial.printf("%-14s %7lu %8lu %8lu %8lu %8lu\n", stageName((ProfileStage)i),
+                      (unsigned long)stats.count, (unsigned long)stats.minUs,
+                      (unsigned long)(stats.count ? stats.totalUs / stats.count : 0),
+                      (unsigned long)stats.maxUs, (unsigned long)stats.p99Us);
+    }
+
+    getLoopStats(stats);
+    Serial.printf("%-14s %7lu %8lu %8lu %8lu %8lu\n", "control cycle",
+                  (unsigned long)stats.count, (unsigned long)stats.minUs,
+                  (unsigned long)(stats.count ? stats.totalUs / stats.count : 0),
+                  (unsigned long)stats.maxUs, (unsigned long)stats.p99Us);
+
+    WorstLoop worst;
+    getWorstLoop(worst);
+    Serial.printf("Worst control cycle: %lu us at %lu ms:", (unsigned long)worst.totalUs, worst.atMillis);
+    for (int i = 0; i < PROFILE_CONTROL_STAGES; i++) {
+        if (worst.stageUs[i] > 0) {
+            Serial.printf(" %s=%lu", stageName((ProfileStage)i), (unsigned long)worst.stageUs[i]);
+        }
+    }
+    Serial.println();
+    Serial.println("==========================================");
+}
+
+void LoopProfiler::reset() {
+    portENTER_CRITICAL(&_lock);
+    for (int i = 0; i <= PROFILE_STAGE_COUNT; i++) {
+        clearWindow(_current[i]);
+        clearWindow(_last[i]);
+    }
+    memset(&_worstEver, 0, sizeof(_worstEver));
+    memset(_iterationUs, 0, sizeof(_iterationUs));
+    _windowStart = millis();
+    portEXIT_CRITICAL(&_lock);
+}
+
+const char* LoopProfiler::stageName(ProfileStage stage) {
+    switch (stage) {
+        case PROFILE_SCHEDULER:     return "scheduler";
+        case PROFILE_STATE_MACHINE: return "state_machine";
+        case PROFILE_STATUS:        return "status";
+        case PROFILE_BINTRAC:       return "bintrac";
+        case PROFILE_WEB:           return "web";
+        case PROFILE_TELEGRAM:      return "telegram";
+        case PROFILE_COORDINATOR:   return "coordinator";
+        case PROFILE_TIME_SYNC:     return "time_sync";
+        case PROFILE_MQTT:          return "mqtt";
+        case PROFILE_INFLUX:        return "influx";
+        case PROFILE_STORAGE:       return "storage";
+        default:                    return "unknown";
+    }
+}
+
+uint32_t LoopProfiler::elapsedUs(const ProfileMark& from, const ProfileMark& now) const {
+    // The cycle counter is per core; tasks are pinned, so a mark and its
+    // record always read the same counter. The 32-bit counter wraps every
+    // ~17 s at 240 MHz; long stages (blocking network timeouts) fall back
+    // to millisecond resolution
+    unsigned long elapsedMs = now.ms - from.ms;
+    if (elapsedMs > 10000) {
+        return elapsedMs * 1000UL;
+    }
+    return (now.cycles - from.cycles) / _cyclesPerUs;
+}
+
+void LoopProfiler::addSample(Window& window, uint32_t us) {
+    window.count++;
+    window.totalUs += us;
+    if (us < window.minUs) window.minUs = us;
+    if (us > window.maxUs) window.maxUs = us;
+
+    uint16_t& bucket = window.histogram[bucketFor(us)];
+    if (bucket < 0xFFFF) bucket++;
+}
+
+void LoopProfiler::rollWindowIfDue(unsigned long nowMs) {
+    if (nowMs - _windowStart < PROFILE_WINDOW_MS) return;
+
+    memcpy(_last, _current, sizeof(_last));
+    for (int i = 0; i <= PROFILE_STAGE_COUNT; i++) {
+        clearWindow(_current[i]);
+    }
+    _windowStart = nowMs;
+}
+
+void LoopProfiler::fillStats(const Window& window, StageStats& stats) const {
+    stats.count = window.count;
+    stats.minUs = window.count ? window.minUs : 0;
+    stats.maxUs = window.maxUs;
+    stats.totalUs = window.totalUs;
+    stats.p99Us = 0;
+
+    if (window.count == 0) return;
+
+    // Walk histogram until 99% of samples are covered
+    uint32_t target = window.count - window.count / 100;
+    uint32_t seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += window.histogram[i];
+        if (seen >= target) {
+            stats.p99Us = min(bucketUpperBound(i), window.maxUs);
+            return;
+        }
+    }
+    stats.p99Us = window.maxUs;
+}
+
+void LoopProfiler::clearWindow(Window& window) {
+    memset(&window, 0, sizeof(window));
+    window.minUs = 0xFFFFFFFF;
+}
+
+int LoopProfiler::bucketFor(uint32_t us) {
+    // Log-linear buckets: exact below SUB_BUCKETS, then SUB_BUCKETS per power of two
+    if (us < SUB_BUCKETS) return us;
+
+    int msb = 31 - __builtin_clz(us);
+    int sub = (us >> (msb - 2)) & (SUB_BUCKETS - 1);
+    int bucket = (msb - 1) * SUB_BUCKETS + sub;
+    return bucket < HISTOGRAM_BUCKETS ? bucket : HISTOGRAM_BUCKETS - 1;
+}
+
+uint32_t LoopProfiler::bucketUpperBound(int bucket) {
+    if (bucket < SUB_BUCKETS) return bucket;
+
+    int msb = bucket / SUB_BUCKETS + 1;
+    int sub = bucket % SUB_BUCKETS;
+    uint32_t lower = (uint32_t)(SUB_BUCKETS + sub) << (msb - 2);
+    return lower + (1UL << (msb - 2)) - 1;
+}
+
+uint32_t LoopProfiler::readCycles() {
+#if defined(ESP32)
+    return ESP.getCycleCount();
+#else
+    return micros();
+#endif
+}
+
+#endif // FEATURE_TRACES
@@ -0,0 +1,125 @@
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Stages timed by the profiler
+// Control task stages come first; they make up one control cycle.
+enum ProfileStage {
+    PROFILE_SCHEDULER,      // control: day rollover / schedule checks
+    PROFILE_STATE_MACHINE,  // control: feeding state machine
+    PROFILE_STATUS,         // control: status publish
+    PROFILE_BINTRAC,        // acquisition: Modbus weight read
+    PROFILE_WEB,            // web: one request
+    PROFILE_TELEGRAM,       // notify: bot poll and outbound messages
+    PROFILE_COORDINATOR,    // notify: start coordination packets
+    PROFILE_TIME_SYNC,      // notify: time source queries
+    PROFILE_MQTT,           // notify: telemetry publishing
+    PROFILE_INFLUX,         // notify: InfluxDB batch push or spool drain
+    PROFILE_STORAGE,        // storage: one queued write
+    PROFILE_STAGE_COUNT
+};
+
+#define PROFILE_CONTROL_STAGES (PROFILE_STATUS + 1)
+
+#if FEATURE_TRACES
+// Start point of a timed section
+struct ProfileMark {
+    uint32_t cycles;
+    unsigned long ms;
+};
+
+// Per-stage timing across tasks using the CPU cycle counter
+// Each task takes a mark with now() and calls record(stage, mark) when the
+// stage is done; the control task also calls recordCycle() once per cycle.
+// Stats cover a rolling window (PROFILE_WINDOW_MS): the last completed
+// window is reported, so numbers are always from a full window.
+// Safe to call from any task (short critical section per record).
+class LoopProfiler {
+public:
+    struct StageStats {
+        uint32_t count;
+        uint32_t minUs;
+        uint32_t maxUs;
+        uint64_t totalUs;
+        uint32_t p99Us;  // Upper bound of the histogram bucket holding the 99th percentile
+    };
+
+    struct WorstLoop {
+        uint32_t totalUs;
+        uint32_t stageUs[PROFILE_STAGE_COUNT];  // Control stages only
+        unsigned long atMillis;  // When it happened (millis)
+    };
+
+    LoopProfiler();
+
+    // Instrumentation (keep cheap - one counter read per call)
+    static ProfileMark now();
+    void record(ProfileStage stage, const ProfileMark& start);
+    void recordCycle(const ProfileMark& start);
+
+    // Reporting
+    void getStageStats(ProfileStage stage, StageStats& stats);
+    void getLoopStats(StageStats& stats);
+    void getWorstLoop(WorstLoop& worst);
+    uint32_t getWindowMs() const { return PROFILE_WINDOW_MS; }
+    void printReport();
+    void reset();
+
+    static const char* stageName(ProfileStage stage);
+
+private:
+    static const uint32_t PROFILE_WINDOW_MS = 60000;
+    static const int SUB_BUCKETS = 4;           // Histogram resolution per power of two
+    static const int HISTOGRAM_BUCKETS = 26 * SUB_BUCKETS;  // Up to ~67 s
+
+    struct Window {
+        uint32_t count;
+        uint32_t minUs;
+        uint32_t maxUs;
+        uint64_t totalUs;
+        uint16_t histogram[HISTOGRAM_BUCKETS];
+    };
+
+    // Stage windows plus control cycle window (index PROFILE_STAGE_COUNT)
+    Window _current[PROFILE_STAGE_COUNT + 1];
+    Window _last[PROFILE_STAGE_COUNT + 1];
+    unsigned long _windowStart;
+
+    // Control stages of the cycle in progress
+    uint32_t _iterationUs[PROFILE_STAGE_COUNT];
+
+    WorstLoop _worstEver;
+    uint32_t _cyclesPerUs;
+    portMUX_TYPE _lock;
+
+    uint32_t elapsedUs(const ProfileMark& from, const ProfileMark& now) const;
+    void addSample(Window& window, uint32_t us);
+    void rollWindowIfDue(unsigned long nowMs);
+    void fillStats(const Window& window, StageStats& stats) const;
+
+    static void clearWindow(Window& window);
+    static int bucketFor(uint32_t us);
+    static uint32_t bucketUpperBound(int bucket);
+    static uint32_t readCycles();
+};
+
+#else
+// Traces not built: the instrumentation compiles away (marks keep the
+// millis() start time, which callers also use for their own intervals)
+struct ProfileMark {
+    unsigned long ms;
+};
+
+class LoopProfiler {
+public:
+    static ProfileMark now() { return {millis()}; }
+    void record(ProfileStage, const ProfileMark&) {}
+    void recordCycle(const ProfileMark&) {}
+};
+#endif // FEATURE_TRACES
+
+extern LoopProfiler loopProfiler;
+
+#endif // LOOP_PROFILER_H
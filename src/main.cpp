@@ -9,38 +9,125 @@
 #include "scheduler.h"
 #include "web_server.h"
 #include "telegram_bot.h"
+#include "start_coordinator.h"
+#include "loop_profiler.h"
+#include "shared_state.h"
+#include "task_messages.h"
+#include "net_lock.h"
+#include "net_events.h"
+#include "w5500_spi.h"
+#include "logger.h"
+#include "syslog_sink.h"
+#include "ota_update.h"
+#include "task_monitor.h"
+#include "mqtt_telemetry.h"
+#include "influx_push.h"
 
 // Global objects
 Storage storage;
-BinTrac bintrac;
+BinTrac bintrac;          // Weight reads (acquisition task)
+BinTrac houseLinkClock;   // HouseLink time source (notify task, separate connection state)
 AugerControl augerControl;
 Scheduler scheduler;
+StartCoordinator startCoordinator;
+ConfigStore configStore;
+StatusStore statusStore;
+SyslogSink syslogSink;
+
+// Task handles (acquisitionTaskHandle lives in task_messages.cpp)
+TaskHandle_t controlTaskHandle = nullptr;
+TaskHandle_t webTaskHandle = nullptr;
+TaskHandle_t notifyTaskHandle = nullptr;
+TaskHandle_t storageTaskHandle = nullptr;
+
+// Control task state (only touched by the control task after setup)
 Config config;
 SystemStatus systemStatus;
-FeedWebServer* webServer;
-TelegramBot* telegramBot;
-
-// State tracking
 uint8_t currentFeedCycle = 0;
-unsigned long lastBintracRead = 0;
-unsigned long lastStatusUpdate = 0;
+unsigned long pendingStartTime = 0;
+bool manualStartPending = false;          // Waiting for a fresh weight sample
+TaskHandle_t manualStartReply = nullptr;  // Web task waiting for the start result
+uint16_t manualStartSequence = 0;         // Sequence number of that request
+
+// Boot timeline (serial 'b'), written by setup and the tasks coming up
+struct BootStepEntry {
+    unsigned long ms;
+    const char* step;
+};
+BootStepEntry bootTimeline[BOOT_TIMELINE_STEPS];
+uint8_t bootTimelineCount = 0;
+portMUX_TYPE bootTimelineLock = portMUX_INITIALIZER_UNLOCKED;
+
+// Notify task state
+Config notifyConfig;
+
+// Network services (constructed statically; started once the network is up)
+FeedWebServer webServer(storage, configStore, statusStore);
+#if FEATURE_TELEGRAM
+TelegramBot telegramBot(notifyConfig, configStore);
+#endif
+#if FEATURE_MQTT
+MqttTelemetry mqttTelemetry;
+#endif
+#if FEATURE_INFLUX
+InfluxPush influxPush(storage);
+#endif
+unsigned long lastCoordinatorBegin = 0;
 bool networkConnected = false;
 
+// Tasks
+void controlTask(void* param);
+void acquisitionTask(void* param);
+void webTask(void* param);
+void notifyTask(void* param);
+void storageTask(void* param);
+void networkBootTask(void* param);
+
 // Function declarations
 void setupNetwork();
-void updateBinWeights();
+void bootStep(const char* step);
+void printBootTimeline();
+void startTasks();
+unsigned long controlWaitTime(unsigned long lastLedToggle);
+void handleControlMessage(const ControlMessage& msg);
+void reloadConfig();
 void updateSystemStatus();
 void runStateMachine();
+void startScheduledFeeding();
+void startManualFeeding();
 void handleFeedingComplete();
 void handleFeedingFailed();
+void recordManualStop();
+void updateStartCoordinator();
+void updateNetworkStatus();
+void dispatchNotification(const Notification& notification);
+#if FEATURE_MQTT || FEATURE_INFLUX
+uint32_t telemetryNodeId();
+#endif
+void handleSerialCommands();
 
 void setup() {
     Serial.begin(115200);
-    delay(1000);
+
+    // Relays off before anything else can fail or stall
+    augerControl.begin();
+    bootStep("relays off");
+
+    Logger::begin();  // Log records (including the ones above) drain to Serial from here on
+    TaskMonitor::add(xTaskGetCurrentTaskHandle(), "loop", LOOP_TASK_STACK);  // setup() and loop() run here
+    if (strlen(LOG_SYSLOG_SERVER) > 0 && syslogSink.begin(LOG_SYSLOG_SERVER, LOG_SYSLOG_PORT)) {
+        Logger::setSink(&syslogSink);
+    }
+    OtaUpdate::begin();  // Counts boots of unconfirmed firmware; may roll back and restart
 
     Serial.println("\n\n=================================");
     Serial.println("Weight Feeder Control System");
     Serial.printf("Version: %s\n", FIRMWARE_VERSION);
+    Serial.printf("Features:%s%s%s%s%s%s%s\n",
+                  FEATURE_TELEGRAM ? " telegram" : "", FEATURE_MQTT ? " mqtt" : "",
+                  FEATURE_INFLUX ? " influx" : "", FEATURE_WEB_UI ? " web-ui" : "",
+                  FEATURE_HISTORY ? " history" : "", FEATURE_TRACES ? " traces" : "",
+                  FEATURE_METRICS ? " metrics" : "");
     Serial.println("=================================\n");
 
     // Initialize status LED
@@ -60,40 +147,27 @@ void setup() {
 
     // Load configuration
     if (!storage.loadConfig(config)) {
-        Serial.println("Using default configuration");
-    }
-
-    // Initialize Network
-    setupNetwork();
-
-    // Initialize auger control
-    augerControl.begin();
-
-    // Initialize BinTrac
-    Serial.printf("Connecting to BinTrac at %s:502...\n", config.bintracIP);
-    if (bintrac.begin(config.bintracIP, 502, config.bintracDeviceID)) {
-        Serial.println("BinTrac connected");
-    } else {
-        Serial.printf("BinTrac connection failed: %s\n", bintrac.getLastError());
-    }
-
-    // Initialize scheduler
-    scheduler.begin(config.timezone);
-
-    // Wait a bit for network stack to stabilize, then start NTP sync
-    // Do this after BinTrac connection proves network is working
-    delay(3000);
-    scheduler.startNTPSync();
-
-    // Initialize web server
-    webServer = new FeedWebServer(storage, augerControl, bintrac, config, systemStatus);
-    webServer->begin();
-
-    // Initialize Telegram bot
-    telegramBot = new TelegramBot(config);
-    if (config.telegramEnabled) {
-        telegramBot->begin();
+        LOG_INFO("main", "Using default configuration");
     }
+    bootStep("storage and config");
+
+    // Shared state and queues must exist before anything touches the network or tasks start
+    NetLock::begin();
+    NetEvents::begin();
+    createTaskQueues();
+    configStore.begin(config);
+    notifyConfig = config;
+
+    // BinTrac connects on the acquisition task's first read once the network is up
+    bintrac.setConnection(config.bintracIP, MODBUS_PORT, config.bintracDeviceID);
+    houseLinkClock.setConnection(config.bintracIP, MODBUS_PORT, config.bintracDeviceID);
+
+    // Initialize scheduler (restores last known time so scheduling can resume right away;
+    // the notify task syncs from the network later)
+    scheduler.begin(config.timezone, &storage);
+    scheduler.setTimeSources(notifyConfig, houseLinkClock);
+    scheduler.setSchedules(config.feedSchedules);
+    scheduler.setFeedCurve(config);
 
     // Initialize system status
     systemStatus.state = SystemState::IDLE;
@@ -105,95 +179,445 @@ void setup() {
     systemStatus.augerRunning = false;
     systemStatus.chainRunning = false;
     systemStatus.bintracConnected = false;
-    systemStatus.networkConnected = networkConnected;
+    systemStatus.networkConnected = false;
     systemStatus.lastBintracUpdate = 0;
+    systemStatus.pendingStartDelay = 0;
+    systemStatus.coordPeers = 0;
+    systemStatus.nextFeedTime = 0;
+    systemStatus.nextFeedCycle = 0;
+    systemStatus.nextFeedTarget = 0;
+    systemStatus.feedEtaSeconds = 0;
+    systemStatus.predictedCompletion = 0;
     strcpy(systemStatus.lastError, "");
+    updateSystemStatus();
+    statusStore.publish(systemStatus);
+
+    // Network, web, BinTrac and time sync come up concurrently in their tasks
+    startTasks();
+    bootStep("tasks started");
 
     digitalWrite(STATUS_LED_PIN, HIGH);
-    Serial.println("\n✓ System initialization complete\n");
+    LOG_INFO("main", "✓ System initialization complete (network starting in background)");
 }
 
 void loop() {
-    // Update scheduler time
-    scheduler.update();
+    // All work runs in the tasks started by setup(); the Arduino loop task
+    // only serves the serial console
+    handleSerialCommands();
+    vTaskDelay(pdMS_TO_TICKS(100));
+}
 
-    // Update Telegram bot
-    if (config.telegramEnabled) {
-        telegramBot->update();
+void startTasks() {
+    // Storage first so writes queued during setup are drained
+    xTaskCreatePinnedToCore(storageTask, "storage", STORAGE_TASK_STACK, nullptr,
+                            STORAGE_TASK_PRIORITY, &storageTaskHandle, STORAGE_TASK_CORE);
+    xTaskCreatePinnedToCore(controlTask, "control", CONTROL_TASK_STACK, nullptr,
+                            CONTROL_TASK_PRIORITY, &controlTaskHandle, CONTROL_TASK_CORE);
+    xTaskCreatePinnedToCore(acquisitionTask, "acquisition", ACQUISITION_TASK_STACK, nullptr,
+                            ACQUISITION_TASK_PRIORITY, &acquisitionTaskHandle, ACQUISITION_TASK_CORE);
+    xTaskCreatePinnedToCore(webTask, "web", WEB_TASK_STACK, nullptr,
+                            WEB_TASK_PRIORITY, &webTaskHandle, WEB_TASK_CORE);
+    xTaskCreatePinnedToCore(notifyTask, "notify", NOTIFY_TASK_STACK, nullptr,
+                            NOTIFY_TASK_PRIORITY, &notifyTaskHandle, NOTIFY_TASK_CORE);
+    xTaskCreatePinnedToCore(networkBootTask, "netboot", NETWORK_BOOT_TASK_STACK, nullptr,
+                            NETWORK_BOOT_TASK_PRIORITY, nullptr, NETWORK_BOOT_TASK_CORE);
+
+    TaskMonitor::add(storageTaskHandle, "storage", STORAGE_TASK_STACK);
+    TaskMonitor::add(controlTaskHandle, "control", CONTROL_TASK_STACK);
+    TaskMonitor::add(acquisitionTaskHandle, "acquisition", ACQUISITION_TASK_STACK);
+    TaskMonitor::add(webTaskHandle, "web", WEB_TASK_STACK);
+    TaskMonitor::add(notifyTaskHandle, "notify", NOTIFY_TASK_STACK);
+}
 
-        // Send status if requested
-        if (telegramBot->isStatusRequested()) {
-            String chatId = telegramBot->getStatusRequestChatId();
-            telegramBot->sendStatus(systemStatus, chatId);
-        }
+// Network boot task: brings up the W5500 and web server once, then exits
+// (the tasks that need the network wait for NetEvents::waitForNetwork())
+void networkBootTask(void* param) {
+    TaskMonitor::add(xTaskGetCurrentTaskHandle(), "netboot", NETWORK_BOOT_TASK_STACK);
+    setupNetwork();
+    if (W5500_SPI_CLOCK > 0) {
+        W5500Spi::begin(W5500_CS_PIN, W5500_SPI_CLOCK);
     }
+    bootStep("network up");
 
-    // Handle web server requests
-    webServer->handleClient();
+    NetEvents::enableInterrupt(W5500_INT_PIN);
+    webServer.begin();
+    bootStep("web server listening");
 
-    // Read bin weights when feeding, or periodically in idle (every 10 seconds to keep connection alive)
-    bool needWeightReading = (systemStatus.state == SystemState::FEEDING ||
-                              systemStatus.state == SystemState::WAITING_FOR_SCHEDULE);
+    TaskMonitor::exiting();  // Before anyone else can ask for stack figures
+    NetEvents::setNetworkReady();
+    vTaskDelete(nullptr);
+}
 
-    unsigned long readInterval = needWeightReading ? WEIGHT_CHECK_INTERVAL : 10000;
+// Control task: owns relays, feeding state machine and the published status
+void controlTask(void* param) {
+    ControlMessage msg;
+    unsigned long lastLedToggle = 0;
+
+    for (;;) {
+        // Sleep until a message arrives or the next deadline is due
+        if (xQueueReceive(controlQueue, &msg, pdMS_TO_TICKS(controlWaitTime(lastLedToggle))) == pdTRUE) {
+            do {
+                handleControlMessage(msg);
+            } while (xQueueReceive(controlQueue, &msg, 0) == pdTRUE);
+        }
 
-    if (millis() - lastBintracRead > readInterval) {
-        updateBinWeights();
-        lastBintracRead = millis();
-    }
+        ProfileMark cycleStart = LoopProfiler::now();
 
-    // Run main state machine
-    runStateMachine();
+        // Update scheduler day tracking
+        scheduler.update();
+        loopProfiler.record(PROFILE_SCHEDULER, cycleStart);
 
-    // Update system status periodically
-    if (millis() - lastStatusUpdate > STATUS_UPDATE_INTERVAL) {
+        // Run main state machine
+        ProfileMark start = LoopProfiler::now();
+        runStateMachine();
+        loopProfiler.record(PROFILE_STATE_MACHINE, start);
+
+        // Publish status snapshot for the other tasks
+        start = LoopProfiler::now();
         updateSystemStatus();
-        lastStatusUpdate = millis();
+        statusStore.publish(systemStatus);
 
         // Blink status LED
-        digitalWrite(STATUS_LED_PIN, !digitalRead(STATUS_LED_PIN));
+        if (millis() - lastLedToggle > STATUS_UPDATE_INTERVAL) {
+            lastLedToggle = millis();
+            digitalWrite(STATUS_LED_PIN, !digitalRead(STATUS_LED_PIN));
+        }
+        loopProfiler.record(PROFILE_STATUS, start);
+
+        loopProfiler.recordCycle(cycleStart);
+    }
+}
+
+// Time until the control task has something to do without a message
+unsigned long controlWaitTime(unsigned long lastLedToggle) {
+    unsigned long sinceToggle = millis() - lastLedToggle;
+    unsigned long wait = sinceToggle < STATUS_UPDATE_INTERVAL ? STATUS_UPDATE_INTERVAL - sinceToggle : 0;
+
+    switch (systemStatus.state) {
+        case SystemState::IDLE:
+        case SystemState::WAITING_FOR_SCHEDULE:
+            // Schedules only fire on a new minute
+            if (config.autoFeedEnabled && scheduler.isTimeSynced()) {
+                wait = min(wait, scheduler.millisToNextMinute());
+            }
+            break;
+
+        case SystemState::STAGGERED_START: {
+            unsigned long waited = millis() - pendingStartTime;
+            unsigned long remaining = waited < systemStatus.pendingStartDelay ?
+                                      systemStatus.pendingStartDelay - waited : 0;
+            // Held for an OTA upload: recheck on the control period, don't spin
+            wait = min(wait, OtaUpdate::isUploading() ? max(remaining, (unsigned long)CONTROL_PERIOD) : remaining);
+            break;
+        }
+
+        case SystemState::FEEDING:
+        case SystemState::MANUAL_OVERRIDE:
+            // Auger sequencing runs on its own timers
+            wait = min(wait, (unsigned long)CONTROL_PERIOD);
+            break;
+
+        case SystemState::ALARM:
+        case SystemState::ERROR:
+            break;
     }
 
-    delay(10);
+    // Relays left on by a manual command still need the stage timers
+    if (augerControl.isFeeding()) {
+        wait = min(wait, (unsigned long)CONTROL_PERIOD);
+    }
+    return wait;
+}
+
+// Acquisition task: reads bin weights and hands them to the control task
+void acquisitionTask(void* param) {
+    NetEvents::registerTask(NET_EVENT_ACQUISITION);
+    NetEvents::waitForNetwork();
+
+    uint32_t configGeneration = configStore.getGeneration();
+    unsigned long lastGoodRead = millis();
+    bool firstSample = true;
+    SystemStatus status;
+
+    for (;;) {
+        // Follow BinTrac address changes made in the web config
+        if (configStore.getGeneration() != configGeneration) {
+            configGeneration = configStore.getGeneration();
+            Config current;
+            configStore.get(current);
+            bintrac.setConnection(current.bintracIP, MODBUS_PORT, current.bintracDeviceID);
+        }
+
+        ProfileMark start = LoopProfiler::now();
+
+        ControlMessage msg = {};
+        msg.type = ControlMessageType::WEIGHT_SAMPLE;
+        msg.replyTo = nullptr;
+        msg.sample.ok = bintrac.readAllBins(msg.sample.weights);
+        msg.sample.timestamp = millis();
+
+        if (msg.sample.ok) {
+            if (firstSample) {
+                firstSample = false;
+                bootStep("first weight sample");
+            }
+            lastGoodRead = msg.sample.timestamp;
+            LOG_DEBUG("bintrac", "Bins: A=%.0f B=%.0f C=%.0f D=%.0f",
+                msg.sample.weights[0], msg.sample.weights[1],
+                msg.sample.weights[2], msg.sample.weights[3]);
+        } else {
+            LOG_WARN("bintrac", "BinTrac read failed: %s", bintrac.getLastError());
+
+            // Try to reconnect
+            if (millis() - lastGoodRead > 30000) {
+                LOG_INFO("bintrac", "Attempting BinTrac reconnection...");
+                bintrac.reconnect();
+            }
+        }
+        loopProfiler.record(PROFILE_BINTRAC, start);
+
+        xQueueSend(controlQueue, &msg, portMAX_DELAY);
+
+        // Read every second when feeding, otherwise every 10 seconds to keep connection alive
+        statusStore.read(status);
+        bool needWeightReading = (status.state == SystemState::FEEDING ||
+                                  status.state == SystemState::STAGGERED_START);
+        unsigned long readInterval = needWeightReading ? WEIGHT_CHECK_INTERVAL : 10000;
+        unsigned long elapsed = millis() - start.ms;
+
+        // requestWeightSample() (manual start) wakes us early
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(elapsed < readInterval ? readInterval - elapsed : 0));
+    }
+}
+
+// Web task: HTTP server
+void webTask(void* param) {
+    NetEvents::registerTask(NET_EVENT_WEB);
+    NetEvents::waitForNetwork();
+
+    for (;;) {
+        // Serve everything pending, then sleep until the W5500 reports socket activity
+        while (webServer.handleClient()) {
+        }
+        NetEvents::wait(NET_EVENT_WEB, NET_IDLE_RECHECK, WEB_POLL_INTERVAL);
+    }
+}
+
+// Notify task: Telegram, MQTT, InfluxDB, time sync, start coordination and link status
+// (all blocking network chores at the lowest priority)
+void notifyTask(void* param) {
+    NetEvents::registerTask(NET_EVENT_NOTIFY);
+    NetEvents::waitForNetwork();
+
+    // First sync in the background; the restored clock keeps schedules running meanwhile
+    TimeReading timeReading;
+    if (scheduler.syncTime(timeReading, 3)) {
+        notifyTimeSynced(timeReading);
+        bootStep("time synced");
+    } else {
+        bootStep("time sync failed (retrying)");
+    }
+
+#if FEATURE_TELEGRAM
+    if (notifyConfig.telegramEnabled) {
+        telegramBot.begin();
+        bootStep("telegram started");
+    }
+#endif
+#if FEATURE_MQTT
+    mqttTelemetry.configure(notifyConfig, telemetryNodeId());
+#endif
+#if FEATURE_INFLUX
+    influxPush.configure(notifyConfig, telemetryNodeId());
+#endif
+
+    uint32_t configGeneration = configStore.getGeneration();
+    unsigned long lastNetworkStatus = 0;
+    unsigned long lastStackCheck = 0;
+    Notification notification;
+
+    for (;;) {
+        // Refresh our config copy (used by TelegramBot and the time sources)
+        if (configStore.getGeneration() != configGeneration) {
+            configGeneration = configStore.getGeneration();
+            configStore.get(notifyConfig);
+            houseLinkClock.setConnection(notifyConfig.bintracIP, MODBUS_PORT, notifyConfig.bintracDeviceID);
+#if FEATURE_MQTT
+            mqttTelemetry.configure(notifyConfig, telemetryNodeId());
+#endif
+#if FEATURE_INFLUX
+            influxPush.configure(notifyConfig, telemetryNodeId());
+#endif
+        }
+
+        // Outbound messages queued by the control task
+        while (xQueueReceive(notificationQueue, &notification, 0) == pdTRUE) {
+            ProfileMark start = LoopProfiler::now();
+            dispatchNotification(notification);
+            loopProfiler.record(PROFILE_TELEGRAM, start);
+        }
+
+        // Periodic time re-sync
+        ProfileMark start = LoopProfiler::now();
+        if (scheduler.updateTimeSync(timeReading)) {
+            notifyTimeSynced(timeReading);
+        }
+        loopProfiler.record(PROFILE_TIME_SYNC, start);
+
+        // Exchange start slots with other controllers
+        start = LoopProfiler::now();
+        updateStartCoordinator();
+        loopProfiler.record(PROFILE_COORDINATOR, start);
+
+#if FEATURE_TELEGRAM
+        // Update Telegram bot
+        if (notifyConfig.telegramEnabled) {
+            start = LoopProfiler::now();
+            telegramBot.update();
+
+            // Send status if requested
+            if (telegramBot.isStatusRequested()) {
+                const char* chatId = telegramBot.getStatusRequestChatId();
+                SystemStatus status;
+                statusStore.read(status);
+                telegramBot.sendStatus(status, chatId);
+            }
+            loopProfiler.record(PROFILE_TELEGRAM, start);
+        }
+#endif
+
+#if FEATURE_MQTT
+        // Telemetry: status changes, weight batches, buffered events
+        if (mqttTelemetry.isEnabled()) {
+            start = LoopProfiler::now();
+            SystemStatus status;
+            statusStore.read(status);
+            mqttTelemetry.update(status);
+            loopProfiler.record(PROFILE_MQTT, start);
+        }
+#endif
+
+#if FEATURE_INFLUX
+        // Weight points, batch pushes and spooled batches
+        if (influxPush.isEnabled()) {
+            start = LoopProfiler::now();
+            SystemStatus status;
+            statusStore.read(status);
+            influxPush.update(status);
+            loopProfiler.record(PROFILE_INFLUX, start);
+        }
+#endif
+
+        if (millis() - lastNetworkStatus > STATUS_UPDATE_INTERVAL) {
+            updateNetworkStatus();
+            lastNetworkStatus = millis();
+
+            // Confirm freshly updated firmware once healthy (or roll it back)
+            if (OtaUpdate::isPendingVerify()) {
+                SystemStatus status;
+                statusStore.read(status);
+                OtaUpdate::checkHealth(status);
+            }
+        }
+
+        if (millis() - lastStackCheck > TASK_STACK_CHECK_INTERVAL) {
+            TaskMonitor::check();
+            lastStackCheck = millis();
+        }
+
+        // Sleep until a notification is queued or a packet arrives; time sync,
+        // coordinator hello, Telegram poll and link status run on intervals of a
+        // second or more, so the idle recheck covers them
+        NetEvents::wait(NET_EVENT_NOTIFY, NET_IDLE_RECHECK, NOTIFY_POLL_INTERVAL);
+    }
+}
+
+// Storage task: history appends, config and time saves
+void storageTask(void* param) {
+    for (;;) {
+        storage.processQueue(1000);
+    }
+}
+
+void handleSerialCommands() {
+    while (Serial.available()) {
+        char c = Serial.read();
+
+        if (c == 'b') {
+            printBootTimeline();
+#if FEATURE_TRACES
+        } else if (c == 'p') {
+            loopProfiler.printReport();
+        } else if (c == 'r') {
+            loopProfiler.reset();
+            Serial.println("Task profile reset");
+#endif
+#if FEATURE_METRICS
+        } else if (c == 's') {
+            // Unused stack (bytes) - the margin left for each task
+            TaskMonitor::TaskStats tasks[TASK_MONITOR_MAX];
+            int count = TaskMonitor::getStats(tasks, TASK_MONITOR_MAX);
+            Serial.println("Task          stack  never used");
+            for (int i = 0; i < count; i++) {
+                Serial.printf("%-12s %6u  %6u%s%s\n", tasks[i].name, tasks[i].stackSize, tasks[i].minFree,
+                              tasks[i].minFree < TASK_STACK_MIN_FREE ? "  LOW" : "",
+                              tasks[i].running ? "" : "  (exited)");
+            }
+#endif
+        } else if (c == '?') {
+            // Only the commands built into this firmware
+            Serial.println("Commands:"
+#if FEATURE_TRACES
+                           " p = task profile, r = reset profile,"
+#endif
+#if FEATURE_METRICS
+                           " s = task stacks,"
+#endif
+                           " b = boot timeline");
+        }
+    }
 }
 
 void setupNetwork() {
-    Serial.println("Initializing W5500 Ethernet...");
-    Serial.println("Pin configuration:");
-    Serial.printf("  CS:   GPIO %d\n", W5500_CS_PIN);
-    Serial.printf("  MISO: GPIO %d\n", W5500_MISO_PIN);
-    Serial.printf("  MOSI: GPIO %d\n", W5500_MOSI_PIN);
-    Serial.printf("  SCK:  GPIO %d\n", W5500_SCK_PIN);
-    Serial.printf("  RST:  GPIO %d\n", W5500_RESET_PIN);
-
-    // Hardware reset W5500
+    LOG_INFO("net", "Initializing W5500 Ethernet...");
+    LOG_INFO("net", "Pin configuration:");
+    LOG_INFO("net", "  CS:   GPIO %d", W5500_CS_PIN);
+    LOG_INFO("net", "  MISO: GPIO %d", W5500_MISO_PIN);
+    LOG_INFO("net", "  MOSI: GPIO %d", W5500_MOSI_PIN);
+    LOG_INFO("net", "  SCK:  GPIO %d", W5500_SCK_PIN);
+    LOG_INFO("net", "  RST:  GPIO %d", W5500_RESET_PIN);
+
+    // Hardware reset W5500 (RSTn low >= 500 us; the library waits for the PLL on first init)
     pinMode(W5500_RESET_PIN, OUTPUT);
     digitalWrite(W5500_RESET_PIN, LOW);
-    delay(50);
+    delay(1);
     digitalWrite(W5500_RESET_PIN, HIGH);
-    delay(200);
 
     // Initialize SPI with custom pins
     SPI.begin(W5500_SCK_PIN, W5500_MISO_PIN, W5500_MOSI_PIN, W5500_CS_PIN);
 
+    // Nothing else uses the network until setNetworkReady(), so hold the lock throughout
+    NetLock lock;
+
     // Initialize Ethernet library with CS pin
     Ethernet.init(W5500_CS_PIN);
 
     // MAC address
     byte mac[] = W5500_MAC;
 
-    // First, get DHCP to learn network configuration
-    Serial.println("Getting network info via DHCP...");
-    Ethernet.begin(mac);
-    delay(5000);  // Wait for DHCP to complete
+    // First, get DHCP to learn network configuration (returns as soon as a lease
+    // arrives, gives up after NET_DHCP_TIMEOUT)
+    LOG_INFO("net", "Getting network info via DHCP...");
+    bool dhcpOk = Ethernet.begin(mac, NET_DHCP_TIMEOUT, NET_DHCP_RESPONSE_TIMEOUT);
 
     IPAddress dhcpIP = Ethernet.localIP();
 
     // Check if we got a valid private network IP from DHCP
-    if (!((dhcpIP[0] == 192 && dhcpIP[1] == 168) ||
+    if (!dhcpOk ||
+        !((dhcpIP[0] == 192 && dhcpIP[1] == 168) ||
           (dhcpIP[0] == 10) ||
           (dhcpIP[0] == 172 && dhcpIP[1] >= 16 && dhcpIP[1] <= 31))) {
-        Serial.println("DHCP failed, using fallback static IP");
+        LOG_WARN("net", "DHCP failed, using fallback static IP");
 
         // Fallback to basic static IP
         IPAddress ip(192, 168, 1, 205);
@@ -202,73 +626,174 @@ void setupNetwork() {
         IPAddress subnet(255, 255, 255, 0);
 
         Ethernet.begin(mac, ip, dns, gateway, subnet);
-        delay(1000);
 
         networkConnected = true;
 
-        Serial.print("Fallback IP Address: ");
-        Serial.println(Ethernet.localIP());
+        LOG_INFO("net", "Fallback IP Address: %s", Ethernet.localIP().toString().c_str());
         return;
     }
 
-    // Give W5500 time to initialize
-    delay(1000);
-
     // Read network configuration from DHCP
     IPAddress gateway = Ethernet.gatewayIP();
     IPAddress subnet = Ethernet.subnetMask();
     IPAddress dns = Ethernet.dnsServerIP();
 
-    Serial.println("DHCP configuration obtained:");
-    Serial.print("  IP: ");
-    Serial.println(dhcpIP);
-    Serial.print("  Gateway: ");
-    Serial.println(gateway);
-    Serial.print("  Subnet: ");
-    Serial.println(subnet);
-    Serial.print("  DNS: ");
-    Serial.println(dns);
+    LOG_INFO("net", "DHCP configuration obtained:");
+    LOG_INFO("net", "  IP: %s", dhcpIP.toString().c_str());
+    LOG_INFO("net", "  Gateway: %s", gateway.toString().c_str());
+    LOG_INFO("net", "  Subnet: %s", subnet.toString().c_str());
+    LOG_INFO("net", "  DNS: %s", dns.toString().c_str());
 
     // Now reconnect with static IP ending in .205, using learned network config
+    // (static configuration takes effect immediately)
     IPAddress staticIP(dhcpIP[0], dhcpIP[1], dhcpIP[2], 205);
 
-    Serial.print("Reconnecting with static IP: ");
-    Serial.println(staticIP);
+    LOG_INFO("net", "Reconnecting with static IP: %s", staticIP.toString().c_str());
 
     Ethernet.begin(mac, staticIP, dns, gateway, subnet);
-    delay(1000);
 
     // Verify connection
-    Serial.println("Ethernet connected with static IP");
-    Serial.print("Final IP Address: ");
-    Serial.println(Ethernet.localIP());
+    LOG_INFO("net", "Ethernet connected with static IP");
+    LOG_INFO("net", "Final IP Address: %s", Ethernet.localIP().toString().c_str());
     networkConnected = true;
 }
 
-void updateBinWeights() {
-    if (bintrac.readAllBins(systemStatus.currentWeight)) {
-        systemStatus.bintracConnected = true;
-        systemStatus.lastBintracUpdate = millis();
-
-        // Debug: print weights every read (1 second)
-        static int readCount = 0;
-        if (++readCount % 1 == 0) {
-            Serial.printf("Bins: A=%.0f B=%.0f C=%.0f D=%.0f\n",
-                systemStatus.currentWeight[0],
-                systemStatus.currentWeight[1],
-                systemStatus.currentWeight[2],
-                systemStatus.currentWeight[3]);
-        }
-    } else {
-        systemStatus.bintracConnected = false;
-        Serial.printf("BinTrac read failed: %s\n", bintrac.getLastError());
+void bootStep(const char* step) {
+    unsigned long ms = millis();
 
-        // Try to reconnect
-        if (millis() - systemStatus.lastBintracUpdate > 30000) {
-            Serial.println("Attempting BinTrac reconnection...");
-            bintrac.reconnect();
-        }
+    portENTER_CRITICAL(&bootTimelineLock);
+    if (bootTimelineCount < BOOT_TIMELINE_STEPS) {
+        bootTimeline[bootTimelineCount].ms = ms;
+        bootTimeline[bootTimelineCount].step = step;
+        bootTimelineCount++;
     }
+    portEXIT_CRITICAL(&bootTimelineLock);
+
+    LOG_INFO("boot", "%6lu ms %s", ms, step);
+}
+
+void printBootTimeline() {
+    BootStepEntry steps[BOOT_TIMELINE_STEPS];
+    uint8_t count;
+
+    portENTER_CRITICAL(&bootTimelineLock);
+    count = bootTimelineCount;
+    memcpy(steps, bootTimeline, sizeof(steps));
+    portEXIT_CRITICAL(&bootTimelineLock);
+
+    Serial.println("=== Boot Timeline (ms since reset) ===");
+    for (uint8_t i = 0; i < count; i++) {
+        Serial.printf("%6lu  %s\n", steps[i].ms, steps[i].step);
+    }
+}
+
+void handleControlMessage(const ControlMessage& msg) {
+    switch (msg.type) {
+        case ControlMessageType::WEIGHT_SAMPLE:
+            systemStatus.lastSampleAttempt = msg.sample.timestamp;
+            if (msg.sample.ok) {
+                memcpy(systemStatus.currentWeight, msg.sample.weights, sizeof(systemStatus.currentWeight));
+                systemStatus.bintracConnected = true;
+                systemStatus.lastBintracUpdate = msg.sample.timestamp;
+            } else {
+                systemStatus.bintracConnected = false;
+            }
+
+            // A manual start waits for this fresh reading
+            if (manualStartPending) {
+                manualStartPending = false;
+                if (!msg.sample.ok) {
+                    LOG_ERROR("feed", "Failed to read bin weights: %s", bintrac.getLastError());
+                    sendCommandReply(manualStartReply, manualStartSequence, CommandResult::NO_WEIGHTS);
+                } else if (augerControl.isFeeding()) {
+                    sendCommandReply(manualStartReply, manualStartSequence, CommandResult::BUSY);
+                } else {
+                    startManualFeeding();
+                    sendCommandReply(manualStartReply, manualStartSequence, CommandResult::OK);
+                }
+            }
+            break;
+
+        case ControlMessageType::NETWORK_STATUS:
+            systemStatus.networkConnected = msg.network.connected;
+            systemStatus.coordPeers = msg.network.coordPeers;
+            break;
+
+        case ControlMessageType::START_FEED:
+            if (augerControl.isFeeding() || manualStartPending) {
+                LOG_ERROR("feed", "Feeding already in progress");
+                sendCommandReply(msg.replyTo, msg.sequence, CommandResult::BUSY);
+                break;
+            }
+            if (OtaUpdate::isUploading()) {
+                LOG_WARN("feed", "Manual feed refused - OTA upload in progress");
+                sendCommandReply(msg.replyTo, msg.sequence, CommandResult::BUSY);
+                break;
+            }
+
+            // Read fresh weight data before starting
+            LOG_INFO("feed", "Reading bin weights...");
+            manualStartPending = true;
+            manualStartReply = msg.replyTo;
+            manualStartSequence = msg.sequence;
+            requestWeightSample();
+            break;
+
+        case ControlMessageType::STOP_FEED:
+            // Only record if actually feeding
+            if (augerControl.isFeeding()) {
+                recordManualStop();
+            }
+            augerControl.stopAll();
+
+            if (systemStatus.state == SystemState::FEEDING ||
+                systemStatus.state == SystemState::STAGGERED_START) {
+                systemStatus.pendingStartDelay = 0;
+                systemStatus.state = SystemState::IDLE;
+            }
+            sendCommandReply(msg.replyTo, msg.sequence, CommandResult::OK);
+            break;
+
+        case ControlMessageType::MANUAL:
+            // Flash erases stall both cores; no motor starts under an upload
+            if (OtaUpdate::isUploading() &&
+                (msg.action == ManualAction::AUGER_ON || msg.action == ManualAction::CHAIN_ON)) {
+                LOG_WARN("feed", "Manual motor start refused - OTA upload in progress");
+                sendCommandReply(msg.replyTo, msg.sequence, CommandResult::BUSY);
+                break;
+            }
+            switch (msg.action) {
+                case ManualAction::AUGER_ON:  augerControl.setAuger(true); break;
+                case ManualAction::AUGER_OFF: augerControl.setAuger(false); break;
+                case ManualAction::CHAIN_ON:  augerControl.setChain(true); break;
+                case ManualAction::CHAIN_OFF: augerControl.setChain(false); break;
+                case ManualAction::STOP_ALL:  augerControl.stopAll(); break;
+            }
+            sendCommandReply(msg.replyTo, msg.sequence, CommandResult::OK);
+            break;
+
+        case ControlMessageType::SET_TIME:
+            sendCommandReply(msg.replyTo, msg.sequence, scheduler.setManualTime(msg.epoch) ?
+                             CommandResult::OK : CommandResult::INVALID);
+            break;
+
+        case ControlMessageType::TIME_SYNCED:
+            scheduler.applyTime(msg.time);
+            break;
+
+        case ControlMessageType::CONFIG_CHANGED:
+            reloadConfig();
+            break;
+    }
+}
+
+void reloadConfig() {
+    configStore.get(config);
+
+    // Recompile schedules and rebuild today's feed curve targets with the new settings
+    scheduler.setSchedules(config.feedSchedules);
+    scheduler.setFeedCurve(config);
+    LOG_INFO("main", "Configuration applied");
 }
 
 void updateSystemStatus() {
@@ -278,10 +803,116 @@ void updateSystemStatus() {
     systemStatus.weightDispensed = augerControl.getWeightDispensed();
     systemStatus.flowRate = augerControl.getFlowRate();
 
-    // Update network connection status (check if we have a valid IP)
-    IPAddress ip = Ethernet.localIP();
+    // Next scheduled feed (cached by the scheduler, recomputed once a minute)
+    unsigned long nextFeedTime;
+    uint8_t nextFeedCycle;
+    if (config.autoFeedEnabled && scheduler.getNextFeed(nextFeedTime, nextFeedCycle)) {
+        systemStatus.nextFeedTime = nextFeedTime;
+        systemStatus.nextFeedCycle = nextFeedCycle;
+        systemStatus.nextFeedTarget = scheduler.getSlotTarget(nextFeedCycle, config.targetWeight);
+    } else {
+        systemStatus.nextFeedTime = 0;
+    }
+
+    // Feed curve and clock
+    const FeedCurve& feedCurve = scheduler.getFeedCurve();
+    systemStatus.flockAgeDays = feedCurve.getFlockAgeDays();
+    systemStatus.dailyTarget = feedCurve.getDailyTarget();
+    for (int i = 0; i < 4; i++) {
+        systemStatus.slotTargets[i] = scheduler.getSlotTarget(i, config.targetWeight);
+    }
+    systemStatus.timeSource = scheduler.getTimeSource();
+    systemStatus.lastTimeSync = scheduler.getLastSyncTime();
+
+    systemStatus.heapFree = ESP.getFreeHeap();
+    systemStatus.heapMinFree = ESP.getMinFreeHeap();
+    systemStatus.heapLargestBlock = ESP.getMaxAllocHeap();
+
+    if (systemStatus.state != SystemState::FEEDING) {
+        systemStatus.feedEtaSeconds = 0;
+        systemStatus.predictedCompletion = 0;
+    }
+
+    systemStatus.publishTime = millis();
+}
+
+void updateStartCoordinator() {
+    if (!notifyConfig.coordEnabled) {
+        startCoordinator.end();  // Disabled via config: free the socket
+        return;
+    }
+    if (!networkConnected) {
+        return;
+    }
+
+    // Join the group when enabled (at boot or later via config), retrying on failure
+    if (!startCoordinator.isRunning()) {
+        if (lastCoordinatorBegin == 0 || millis() - lastCoordinatorBegin > 30000) {
+            lastCoordinatorBegin = millis();
+            startCoordinator.begin(notifyConfig.coordNodeId, notifyConfig.coordStaggerTime);
+        }
+        return;
+    }
+
+    // Announce our next start so peers sharing the same minute can rank themselves
+    // (nextFeedTime is 0 while auto-feed is disabled)
+    SystemStatus status;
+    statusStore.read(status);
+    startCoordinator.update(status.nextFeedTime / 60);
+}
+
+void updateNetworkStatus() {
+    // Check if we have a valid IP
+    IPAddress ip;
+    {
+        NetLock lock;
+        ip = Ethernet.localIP();
+    }
     networkConnected = (ip[0] != 0);
-    systemStatus.networkConnected = networkConnected;
+
+    ControlMessage msg = {};
+    msg.type = ControlMessageType::NETWORK_STATUS;
+    msg.replyTo = nullptr;
+    msg.network.connected = networkConnected;
+    msg.network.coordPeers = startCoordinator.isRunning() ? startCoordinator.getPeerCount() : 0;
+    xQueueSend(controlQueue, &msg, 0);
+}
+
+// Names the default MQTT topic prefix and client ID and the InfluxDB node tag
+// (same ID as start coordination)
+#if FEATURE_MQTT || FEATURE_INFLUX
+uint32_t telemetryNodeId() {
+    return notifyConfig.coordNodeId != 0 ? notifyConfig.coordNodeId : StartCoordinator::deriveNodeId();
+}
+#endif
+
+void dispatchNotification(const Notification& notification) {
+#if FEATURE_MQTT
+    mqttTelemetry.publishNotification(notification);
+#endif
+#if FEATURE_INFLUX
+    influxPush.addNotification(notification);
+#endif
+
+#if FEATURE_TELEGRAM
+    if (!notifyConfig.telegramEnabled) return;
+
+    switch (notification.type) {
+        case NotificationType::WARNING: {
+            char msg[sizeof(notification.text) + 32];
+            snprintf(msg, sizeof(msg), "🔔 Feed Cycle %d\n%s", notification.feedCycle + 1, notification.text);
+            telegramBot.sendMessage(msg);
+            break;
+        }
+        case NotificationType::FEEDING_COMPLETE:
+            telegramBot.sendFeedingComplete(notification.feedCycle, notification.actualWeight, notification.duration);
+            break;
+        case NotificationType::ALARM:
+            telegramBot.sendAlarm(notification.feedCycle, notification.targetWeight,
+                                   notification.actualWeight, notification.text);
+            break;
+    }
+#endif
 }
 
 void runStateMachine() {
@@ -290,27 +921,42 @@ void runStateMachine() {
         case SystemState::WAITING_FOR_SCHEDULE:
             if (config.autoFeedEnabled && scheduler.isTimeSynced()) {
                 // Check if it's time to feed
-                if (scheduler.shouldFeed(config.feedTimes, currentFeedCycle)) {
-                    Serial.printf("Starting scheduled feeding cycle %d\n", currentFeedCycle + 1);
-
-                    // Calculate total weight from all bins
-                    float totalWeight = 0;
-                    for (int i = 0; i < 4; i++) {
-                        totalWeight += systemStatus.currentWeight[i];
+                if (scheduler.shouldFeed(currentFeedCycle)) {
+                    // Stagger motor start against other controllers sharing this feed time
+                    unsigned long startDelay = 0;
+                    if (config.coordEnabled && startCoordinator.isRunning()) {
+                        startDelay = startCoordinator.claimStart(scheduler.getCurrentTime() / 60,
+                                                                 config.coordStaggerTime);
                     }
-                    systemStatus.weightAtStart = totalWeight;
 
-                    // Start feeding
-                    augerControl.startFeeding(config.targetWeight, config.chainPreRunTime, config.maxRuntime, config.fillDetectionThreshold, config.fillSettlingTime);
-                    systemStatus.state = SystemState::FEEDING;
-                    systemStatus.feedStartTime = millis();
-
-                    // Mark as started (will be marked complete when done)
-                    // scheduler.markFeedingComplete is called after successful completion
+                    if (startDelay > 0 || OtaUpdate::isUploading()) {
+                        LOG_INFO("feed", "Scheduled feeding cycle %d staggered by %lus%s",
+                                      currentFeedCycle + 1, startDelay / 1000,
+                                      OtaUpdate::isUploading() ? " (held for OTA upload)" : "");
+                        pendingStartTime = millis();
+                        systemStatus.pendingStartDelay = startDelay;
+                        systemStatus.state = SystemState::STAGGERED_START;
+                    } else {
+                        startScheduledFeeding();
+                    }
                 }
             }
             break;
 
+        case SystemState::STAGGERED_START:
+            // Staggered start pending - cancel if auto-feed was disabled meanwhile
+            if (!config.autoFeedEnabled) {
+                LOG_INFO("feed", "Staggered start cancelled - auto-feed disabled");
+                systemStatus.pendingStartDelay = 0;
+                systemStatus.state = SystemState::IDLE;
+            } else if (OtaUpdate::isUploading()) {
+                // Held until the upload ends (a successful one restarts the controller)
+            } else if (millis() - pendingStartTime >= systemStatus.pendingStartDelay) {
+                systemStatus.pendingStartDelay = 0;
+                startScheduledFeeding();
+            }
+            break;
+
         case SystemState::FEEDING: {
             // Update feeding progress
             float totalWeight = 0;
@@ -318,13 +964,21 @@ void runStateMachine() {
                 totalWeight += systemStatus.currentWeight[i];
             }
 
-            FeedingStage stage = augerControl.update(totalWeight);
+            FeedingStage stage = augerControl.update(totalWeight, systemStatus.lastBintracUpdate);
+
+            // Completion prediction is refined by AugerControl on every sample
+            systemStatus.feedEtaSeconds = augerControl.getEtaSeconds();
+            systemStatus.predictedCompletion = (systemStatus.feedEtaSeconds > 0 && scheduler.isTimeSynced()) ?
+                scheduler.getCurrentTime() + systemStatus.feedEtaSeconds : 0;
 
             // Check for warnings and send to Telegram
             const char* warning = augerControl.getNewWarning();
-            if (warning != nullptr && config.telegramEnabled) {
-                String msg = String("🔔 Feed Cycle ") + String(currentFeedCycle + 1) + "\n" + String(warning);
-                telegramBot->sendMessage(msg);
+            if (warning != nullptr) {
+                Notification notification = {};
+                notification.type = NotificationType::WARNING;
+                notification.feedCycle = currentFeedCycle;
+                strlcpy(notification.text, warning, sizeof(notification.text));
+                queueNotification(notification);
             }
 
             if (stage == FeedingStage::COMPLETED) {
@@ -354,33 +1008,73 @@ void runStateMachine() {
     }
 }
 
+void startScheduledFeeding() {
+    LOG_INFO("feed", "Starting scheduled feeding cycle %d", currentFeedCycle + 1);
+
+    // Calculate total weight from all bins
+    float totalWeight = 0;
+    for (int i = 0; i < 4; i++) {
+        totalWeight += systemStatus.currentWeight[i];
+    }
+    systemStatus.weightAtStart = totalWeight;
+
+    // Start feeding (target from today's feed curve if enabled)
+    float target = scheduler.getSlotTarget(currentFeedCycle, config.targetWeight);
+    augerControl.startFeeding(target, config.chainPreRunTime, config.maxRuntime, config.fillDetectionThreshold, config.fillSettlingTime);
+    systemStatus.state = SystemState::FEEDING;
+    systemStatus.feedStartTime = millis();
+
+    // scheduler.markFeedingComplete is called after successful completion
+}
+
+void startManualFeeding() {
+    LOG_INFO("feed", "Weights read: A=%.0f B=%.0f C=%.0f D=%.0f",
+                  systemStatus.currentWeight[0], systemStatus.currentWeight[1],
+                  systemStatus.currentWeight[2], systemStatus.currentWeight[3]);
+
+    // Calculate total weight from all bins
+    float totalWeight = 0;
+    for (int i = 0; i < 4; i++) {
+        totalWeight += systemStatus.currentWeight[i];
+    }
+    systemStatus.weightAtStart = totalWeight;
+
+    augerControl.startFeeding(config.targetWeight, config.chainPreRunTime, config.maxRuntime, config.fillDetectionThreshold, config.fillSettlingTime);
+    systemStatus.state = SystemState::FEEDING;
+    systemStatus.feedStartTime = millis();
+}
+
 void handleFeedingComplete() {
-    Serial.println("=== Feeding Complete ===");
+    LOG_INFO("feed", "=== Feeding Complete ===");
 
     // Create feed event record
     FeedEvent event;
     event.timestamp = scheduler.isTimeSynced() ? scheduler.getCurrentTime() : 0;
     event.feedCycle = currentFeedCycle;
-    event.targetWeight = config.targetWeight;
+    event.targetWeight = augerControl.getTargetWeight();
     event.actualWeight = augerControl.getWeightDispensed();
     event.duration = augerControl.getDuration();
     event.alarmTriggered = false;
     strcpy(event.alarmReason, "");
 
     // Save to history
-    storage.addFeedEvent(event);
+    storage.queueFeedEvent(event);
 
     if (!scheduler.isTimeSynced()) {
-        Serial.println("Warning: Time not synced, event saved with timestamp 0");
+        LOG_WARN("feed", "Time not synced, event saved with timestamp 0");
     }
 
     // Mark feeding as complete for this cycle
     scheduler.markFeedingComplete(currentFeedCycle);
 
     // Send Telegram notification
-    if (config.telegramEnabled) {
-        telegramBot->sendFeedingComplete(currentFeedCycle, event.actualWeight, event.duration);
-    }
+    Notification notification = {};
+    notification.type = NotificationType::FEEDING_COMPLETE;
+    notification.feedCycle = currentFeedCycle;
+    notification.targetWeight = event.targetWeight;
+    notification.actualWeight = event.actualWeight;
+    notification.duration = event.duration;
+    queueNotification(notification);
 
     // Reset auger control state for next feeding
     augerControl.stopAll();
@@ -388,34 +1082,38 @@ void handleFeedingComplete() {
     // Return to idle state
     systemStatus.state = SystemState::IDLE;
 
-    Serial.printf("Dispensed: %.2f lbs in %d seconds\n", event.actualWeight, event.duration);
+    LOG_INFO("feed", "Dispensed: %.2f lbs in %d seconds", event.actualWeight, event.duration);
 }
 
 void handleFeedingFailed() {
-    Serial.println("=== Feeding Failed ===");
+    LOG_WARN("feed", "=== Feeding Failed ===");
 
     // Create feed event record with alarm
     FeedEvent event;
     event.timestamp = scheduler.isTimeSynced() ? scheduler.getCurrentTime() : 0;
     event.feedCycle = currentFeedCycle;
-    event.targetWeight = config.targetWeight;
+    event.targetWeight = augerControl.getTargetWeight();
     event.actualWeight = augerControl.getWeightDispensed();
     event.duration = augerControl.getDuration();
     event.alarmTriggered = true;
     strncpy(event.alarmReason, augerControl.getAlarmReason(), sizeof(event.alarmReason) - 1);
 
     // Save to history
-    storage.addFeedEvent(event);
+    storage.queueFeedEvent(event);
 
     if (!scheduler.isTimeSynced()) {
-        Serial.println("Warning: Time not synced, event saved with timestamp 0");
+        LOG_WARN("feed", "Time not synced, event saved with timestamp 0");
     }
 
     // Send Telegram alarm
-    if (config.telegramEnabled) {
-        telegramBot->sendAlarm(currentFeedCycle, event.targetWeight,
-                               event.actualWeight, event.alarmReason);
-    }
+    Notification notification = {};
+    notification.type = NotificationType::ALARM;
+    notification.feedCycle = currentFeedCycle;
+    notification.targetWeight = event.targetWeight;
+    notification.actualWeight = event.actualWeight;
+    notification.duration = event.duration;
+    strlcpy(notification.text, event.alarmReason, sizeof(notification.text));
+    queueNotification(notification);
 
     // Reset auger control state
     augerControl.stopAll();
@@ -424,5 +1122,21 @@ void handleFeedingFailed() {
     systemStatus.state = SystemState::ALARM;
     strncpy(systemStatus.lastError, event.alarmReason, sizeof(systemStatus.lastError) - 1);
 
-    Serial.printf("Alarm: %s\n", event.alarmReason);
+    LOG_WARN("feed", "Alarm: %s", event.alarmReason);
+}
+
+void recordManualStop() {
+    // Create feed event record for manual stop
+    FeedEvent event;
+    event.timestamp = time(NULL);  // Get current Unix timestamp
+    event.feedCycle = 0;  // Manual feed has no cycle
+    event.targetWeight = augerControl.getTargetWeight();
+    event.actualWeight = augerControl.getWeightDispensed();
+    event.duration = augerControl.getDuration();
+    event.alarmTriggered = true;
+    strcpy(event.alarmReason, "Manually stopped");
+
+    // Save to history
+    storage.queueFeedEvent(event);
+    LOG_INFO("feed", "Manual stop recorded to history");
 }
@@ -0,0 +1,316 @@
+#include "mqtt_client.h"
+
+#if FEATURE_MQTT
+#include "net_events.h"
+
+// Packet types (fixed header, high nibble)
+static const uint8_t MQTT_CONNECT = 0x10;
+static const uint8_t MQTT_CONNACK = 0x20;
+static const uint8_t MQTT_PUBLISH = 0x30;
+static const uint8_t MQTT_PUBACK = 0x40;
+static const uint8_t MQTT_PINGREQ = 0xC0;
+static const uint8_t MQTT_PINGRESP = 0xD0;
+static const uint8_t MQTT_DISCONNECT = 0xE0;
+
+// CONNECT flags
+static const uint8_t FLAG_CLEAN_SESSION = 0x02;
+static const uint8_t FLAG_WILL = 0x04;
+static const uint8_t FLAG_WILL_QOS1 = 0x08;
+static const uint8_t FLAG_WILL_RETAIN = 0x20;
+static const uint8_t FLAG_PASSWORD = 0x40;
+static const uint8_t FLAG_USER = 0x80;
+
+MqttClient::MqttClient() : _client(SocketUser::MQTT) {
+    _lastError[0] = '\0';
+    _connected = false;
+    _lastSend = 0;
+    _pingSent = 0;
+    _connack = false;
+    _connackCode = 0;
+    memset(_acks, 0, sizeof(_acks));
+    _nextAck = 0;
+    resetParser();
+}
+
+bool MqttClient::connect(const char* host, uint16_t port, const char* clientId, const char* user,
+                         const char* password, const char* willTopic, const char* willMessage) {
+    if (_connected) drop();
+
+    // Variable header (protocol name, level, flags, keepalive) and payload
+    uint8_t flags = FLAG_CLEAN_SESSION;
+    uint32_t remaining = 10 + 2 + strlen(clientId);
+    if (willTopic != nullptr) {
+        flags |= FLAG_WILL | FLAG_WILL_QOS1 | FLAG_WILL_RETAIN;
+        remaining += 2 + strlen(willTopic) + 2 + strlen(willMessage);
+    }
+    bool hasUser = user != nullptr && user[0] != '\0';
+    bool hasPassword = hasUser && password != nullptr && password[0] != '\0';  // 3.1.1: no password without a user
+    if (hasUser) {
+        flags |= FLAG_USER;
+        remaining += 2 + strlen(user);
+    }
+    if (hasPassword) {
+        flags |= FLAG_PASSWORD;
+        remaining += 2 + strlen(password);
+    }
+    if (1 + lengthBytes(remaining) + remaining > sizeof(_packet)) {
+        snprintf(_lastError, sizeof(_lastError), "CONNECT too large (%lu bytes)", (unsigned long)remaining);
+        return false;
+    }
+
+    if (!_client.connect(host, port)) {
+        snprintf(_lastError, sizeof(_lastError), "TCP connection failed to %s:%u", host, port);
+        return false;
+    }
+
+    uint8_t* p = _packet;
+    *p++ = MQTT_CONNECT;
+    p = putLength(p, remaining);
+    p = putString(p, "MQTT");
+    *p++ = 4;  // Protocol level 3.1.1
+    *p++ = flags;
+    *p++ = MQTT_KEEPALIVE >> 8;
+    *p++ = MQTT_KEEPALIVE & 0xFF;
+    p = putString(p, clientId);
+    if (willTopic != nullptr) {
+        p = putString(p, willTopic);
+        p = putString(p, willMessage);
+    }
+    if (hasUser) p = putString(p, user);
+    if (hasPassword) p = putString(p, password);
+
+    resetParser();
+    _connack = false;
+    if (!send(p - _packet)) return false;
+
+    // Wait for CONNACK
+    unsigned long startTime = millis();
+    while (!_connack && millis() - startTime < MQTT_CONNECT_TIMEOUT) {
+        if (!receive() || !_client.connected()) break;
+        if (!_connack) NetEvents::waitForSocket(startTime, MQTT_CONNECT_TIMEOUT);
+    }
+
+    if (!_connack) {
+        snprintf(_lastError, sizeof(_lastError), "No CONNACK from %s:%u", host, port);
+        drop();
+        return false;
+    }
+    if (_connackCode != 0) {
+        // 4 = bad user name or password, 5 = not authorized
+        snprintf(_lastError, sizeof(_lastError), "Broker refused connection (code %u)", _connackCode);
+        drop();
+        return false;
+    }
+
+    memset(_acks, 0, sizeof(_acks));
+    _pingSent = 0;
+    _connected = true;
+    _lastError[0] = '\0';
+    return true;
+}
+
+void MqttClient::disconnect() {
+    if (!_connected) return;
+    _packet[0] = MQTT_DISCONNECT;
+    _packet[1] = 0;
+    send(2);
+    drop();
+}
+
+void MqttClient::drop() {
+    _client.stop();
+    _connected = false;
+    _pingSent = 0;
+    resetParser();
+}
+
+bool MqttClient::connected() {
+    return _connected;
+}
+
+bool MqttClient::publish(const char* topic, const char* payload, size_t length, uint8_t qos, bool retain,
+                         uint16_t packetId, bool dup) {
+    if (!_connected) return false;
+
+    uint32_t remaining = 2 + strlen(topic) + (qos > 0 ? 2 : 0) + length;
+    if (1 + lengthBytes(remaining) + remaining > sizeof(_packet)) {
+        snprintf(_lastError, sizeof(_lastError), "Message for %s too large (%lu bytes)", topic,
+                 (unsigned long)remaining);
+        return false;
+    }
+
+    uint8_t* p = _packet;
+    *p++ = MQTT_PUBLISH | (dup ? 0x08 : 0) | (qos << 1) | (retain ? 0x01 : 0);
+    p = putLength(p, remaining);
+    p = putString(p, topic);
+    if (qos > 0) {
+        *p++ = packetId >> 8;
+        *p++ = packetId & 0xFF;
+    }
+    memcpy(p, payload, length);
+    p += length;
+    return send(p - _packet);
+}
+
+bool MqttClient::loop() {
+    if (!_connected) return false;
+
+    if (!receive()) {
+        drop();
+        return false;
+    }
+    if (!_client.connected()) {
+        snprintf(_lastError, sizeof(_lastError), "Connection closed by broker");
+        drop();
+        return false;
+    }
+
+    // Keepalive: ping after half the interval without sending, drop if the broker stays quiet
+    unsigned long now = millis();
+    if (_pingSent != 0) {
+        if (now - _pingSent > MQTT_ACK_TIMEOUT) {
+            snprintf(_lastError, sizeof(_lastError), "No PINGRESP from broker");
+            drop();
+            return false;
+        }
+    } else if (now - _lastSend >= MQTT_KEEPALIVE * 1000UL / 2) {
+        _packet[0] = MQTT_PINGREQ;
+        _packet[1] = 0;
+        if (!send(2)) return false;
+        _pingSent = now != 0 ? now : 1;
+    }
+    return true;
+}
+
+bool MqttClient::acknowledged(uint16_t packetId) {
+    for (uint8_t i = 0; i < ACK_SLOTS; i++) {
+        if (_acks[i] == packetId && packetId != 0) {
+            _acks[i] = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MqttClient::send(size_t length) {
+    if (_client.write(_packet, length) != length) {
+        snprintf(_lastError, sizeof(_lastError), "Write to broker failed");
+        drop();
+        return false;
+    }
+    _lastSend = millis();
+    return true;
+}
+
+// Returns false on a malformed packet
+bool MqttClient::receive() {
+    uint8_t buffer[32];
+    int available;
+    while ((available = _client.available()) > 0) {
+        int n = _client.read(buffer, min((size_t)available, sizeof(buffer)));
+        if (n <= 0) break;
+        for (int i = 0; i < n; i++) {
+            if (!parseByte(buffer[i])) {
+                snprintf(_lastError, sizeof(_lastError), "Malformed packet from broker");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool MqttClient::parseByte(uint8_t b) {
+    switch (_rxStage) {
+        case RX_HEADER:
+            _rxHeader = b;
+            _rxRemaining = 0;
+            _rxLengthBytes = 0;
+            _rxBodyLength = 0;
+            _rxStage = RX_LENGTH;
+            return true;
+
+        case RX_LENGTH:
+            _rxRemaining |= (uint32_t)(b & 0x7F) << (7 * _rxLengthBytes);
+            _rxLengthBytes++;
+            if (b & 0x80) return _rxLengthBytes < 4;  // At most 4 length bytes
+            if (_rxRemaining == 0) {
+                handlePacket();
+                _rxStage = RX_HEADER;
+            } else {
+                _rxStage = RX_BODY;
+            }
+            return true;
+
+        case RX_BODY:
+            if (_rxBodyLength < sizeof(_rxBody)) _rxBody[_rxBodyLength++] = b;
+            if (--_rxRemaining == 0) {
+                handlePacket();
+                _rxStage = RX_HEADER;
+            }
+            return true;
+    }
+    return false;
+}
+
+void MqttClient::handlePacket() {
+    _pingSent = 0;  // Anything from the broker shows the connection is alive
+
+    switch (_rxHeader & 0xF0) {
+        case MQTT_CONNACK:
+            if (_rxBodyLength == 2) {
+                _connack = true;
+                _connackCode = _rxBody[1];
+            }
+            break;
+
+        case MQTT_PUBACK:
+            if (_rxBodyLength == 2) {
+                _acks[_nextAck] = (uint16_t)_rxBody[0] << 8 | _rxBody[1];
+                _nextAck = (_nextAck + 1) % ACK_SLOTS;
+            }
+            break;
+
+        case MQTT_PINGRESP:
+            break;  // Keepalive answered (cleared above)
+
+        default:
+            break;  // A PUBLISH we never subscribed to
+    }
+}
+
+void MqttClient::resetParser() {
+    _rxStage = RX_HEADER;
+    _rxHeader = 0;
+    _rxRemaining = 0;
+    _rxLengthBytes = 0;
+    _rxBodyLength = 0;
+}
+
+uint8_t* MqttClient::putLength(uint8_t* p, uint32_t length) {
+    do {
+        uint8_t b = length & 0x7F;
+        length >>= 7;
+        if (length > 0) b |= 0x80;
+        *p++ = b;
+    } while (length > 0);
+    return p;
+}
+
+uint8_t* MqttClient::putString(uint8_t* p, const char* s) {
+    size_t length = strlen(s);
+    *p++ = length >> 8;
+    *p++ = length & 0xFF;
+    memcpy(p, s, length);
+    return p + length;
+}
+
+size_t MqttClient::lengthBytes(uint32_t length) {
+    size_t bytes = 1;
+    while (length >= 128) {
+        length >>= 7;
+        bytes++;
+    }
+    return bytes;
+}
+
+#endif // FEATURE_MQTT
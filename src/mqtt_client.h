@@ -0,0 +1,85 @@
+#ifndef MQTT_CLIENT_H
+#define MQTT_CLIENT_H
+
+#include "config.h"
+
+#if FEATURE_MQTT
+#include <Arduino.h>
+#include "net_lock.h"
+
+// Minimal MQTT 3.1.1 client for publishing telemetry
+// Clean session, QoS 0/1 publishes, a retained last will and keepalive pings;
+// nothing is subscribed to, so PUBLISH packets from the broker are skipped.
+// The caller owns delivery: a QoS 1 message is sent again (after
+// reconnecting) until acknowledged() reports its PUBACK. connect() blocks for
+// the TCP connect and the CONNACK (MQTT_CONNECT_TIMEOUT); everything else
+// returns once the bytes are written. One task only.
+class MqttClient {
+public:
+    MqttClient();
+
+    // Open the connection; user/password may be empty, will* nullptr for no will
+    // (the will is published retained at QoS 1 if the connection dies)
+    bool connect(const char* host, uint16_t port, const char* clientId, const char* user, const char* password,
+                 const char* willTopic, const char* willMessage);
+
+    // Clean close (DISCONNECT, the broker discards the will)
+    void disconnect();
+
+    // Close without DISCONNECT (the broker publishes the will)
+    void drop();
+
+    bool connected();
+
+    // packetId is required (non-zero) for QoS 1; dup marks a resend
+    // Returns false if the packet doesn't fit MQTT_PACKET_MAX or the write failed
+    bool publish(const char* topic, const char* payload, size_t length, uint8_t qos, bool retain,
+                 uint16_t packetId = 0, bool dup = false);
+
+    // Read what the broker sent and keep the connection alive
+    // Returns false (and drops the connection) if it is gone or unresponsive
+    bool loop();
+
+    // True once the PUBACK for packetId has arrived (consumes it)
+    bool acknowledged(uint16_t packetId);
+
+    const char* getLastError() const { return _lastError; }
+
+private:
+    static const uint8_t ACK_SLOTS = 4;
+
+    LockedEthernetClient _client;
+    uint8_t _packet[MQTT_PACKET_MAX];
+    char _lastError[96];
+    bool _connected;
+    unsigned long _lastSend;
+    unsigned long _pingSent;     // 0 = no PINGRESP outstanding
+
+    // Incoming packet being parsed
+    enum RxStage : uint8_t { RX_HEADER, RX_LENGTH, RX_BODY };
+    RxStage _rxStage;
+    uint8_t _rxHeader;
+    uint32_t _rxRemaining;       // Remaining length, then body bytes still to come
+    uint8_t _rxLengthBytes;      // Remaining-length bytes read so far
+    uint8_t _rxBody[2];          // CONNACK and PUBACK bodies; anything longer is skipped
+    uint8_t _rxBodyLength;
+    bool _connack;
+    uint8_t _connackCode;
+
+    uint16_t _acks[ACK_SLOTS];   // PUBACK packet IDs not yet collected
+    uint8_t _nextAck;
+
+    bool send(size_t length);
+    bool receive();
+    bool parseByte(uint8_t b);
+    void handlePacket();
+    void resetParser();
+
+    static uint8_t* putLength(uint8_t* p, uint32_t length);
+    static uint8_t* putString(uint8_t* p, const char* s);
+    static size_t lengthBytes(uint32_t length);
+};
+
+#endif // FEATURE_MQTT
+
+#endif // MQTT_CLIENT_H
@@ -0,0 +1,381 @@
+#include "mqtt_telemetry.h"
+
+#if FEATURE_MQTT
+#include "logger.h"
+#include <time.h>
+
+MqttTelemetry::MqttTelemetry() {
+    _enabled = false;
+    _host[0] = '\0';
+    _port = MQTT_DEFAULT_PORT;
+    _user[0] = '\0';
+    _password[0] = '\0';
+    _prefix[0] = '\0';
+    _clientId[0] = '\0';
+
+    _nextAttempt = 0;
+    _retryDelay = MQTT_RECONNECT_MIN;
+    _wasConnected = false;
+    _nextPacketId = 1;
+
+    memset(&_status, 0, sizeof(_status));
+    _statusDirty = true;
+    _statusPacketId = 0;
+    _statusPayload[0] = '\0';
+
+    _lastSampleAt = 0;
+    _pointStart = 0;
+    memset(_sum, 0, sizeof(_sum));
+    _samples = 0;
+    _batchLength = 0;
+    _batchPoints = 0;
+
+    _queued = 0;
+    _inflightId = 0;
+    _inflightSince = 0;
+    _dropped = 0;
+}
+
+void MqttTelemetry::configure(const Config& config, uint32_t nodeId) {
+    // "host" or "host:port"
+    char host[sizeof(_host)];
+    uint16_t port = MQTT_DEFAULT_PORT;
+    strlcpy(host, config.mqttBroker, sizeof(host));
+    char* colon = strchr(host, ':');
+    if (colon != nullptr) {
+        *colon = '\0';
+        port = atoi(colon + 1);
+        if (port == 0) port = MQTT_DEFAULT_PORT;
+    }
+
+    char prefix[sizeof(_prefix)];
+    if (config.mqttTopic[0] != '\0') {
+        strlcpy(prefix, config.mqttTopic, sizeof(prefix));
+        size_t length = strlen(prefix);
+        if (length > 0 && prefix[length - 1] == '/') prefix[length - 1] = '\0';
+    } else {
+        snprintf(prefix, sizeof(prefix), "feeder/%08lX", (unsigned long)nodeId);
+    }
+
+    bool enabled = config.mqttEnabled && host[0] != '\0';
+    if (enabled == _enabled && port == _port && strcmp(host, _host) == 0 && strcmp(prefix, _prefix) == 0 &&
+        strcmp(config.mqttUser, _user) == 0 && strcmp(config.mqttPassword, _password) == 0) {
+        return;
+    }
+
+    if (_client.connected()) {
+        // Say goodbye on the old settings; a clean disconnect discards the will
+        char topic[sizeof(_prefix) + 8];
+        topicFor("online", topic, sizeof(topic));
+        _client.publish(topic, "offline", 7, 0, true);
+        _client.disconnect();
+        connectionLost();
+    }
+
+    _enabled = enabled;
+    strlcpy(_host, host, sizeof(_host));
+    _port = port;
+    strlcpy(_user, config.mqttUser, sizeof(_user));
+    strlcpy(_password, config.mqttPassword, sizeof(_password));
+    strlcpy(_prefix, prefix, sizeof(_prefix));
+    snprintf(_clientId, sizeof(_clientId), "feeder-%08lX", (unsigned long)nodeId);
+
+    _retryDelay = MQTT_RECONNECT_MIN;
+    _nextAttempt = millis();
+    _wasConnected = false;
+    _statusDirty = true;
+    _pointStart = millis();
+
+    if (_enabled) {
+        LOG_INFO("mqtt", "Telemetry to %s:%u under %s/", _host, _port, _prefix);
+    } else {
+        LOG_INFO("mqtt", "Telemetry disabled");
+    }
+}
+
+void MqttTelemetry::update(const SystemStatus& status) {
+    if (!_enabled) return;
+
+    // Collected whether or not the broker is reachable (buffered meanwhile)
+    sampleWeights(status);
+    checkStatus(status);
+
+    if (!_client.connected()) {
+        if (_wasConnected) {
+            LOG_WARN("mqtt", "Connection lost: %s", _client.getLastError());
+            connectionLost();
+        }
+        if ((long)(millis() - _nextAttempt) < 0 || !connect()) return;
+    }
+
+    if (!_client.loop()) {
+        LOG_WARN("mqtt", "Connection lost: %s", _client.getLastError());
+        connectionLost();
+        return;
+    }
+
+    if (_statusPacketId != 0 && _client.acknowledged(_statusPacketId)) {
+        _statusPacketId = 0;
+    }
+    if (_statusDirty && _statusPacketId == 0 && !publishStatus()) return;
+
+    publishQueued();
+}
+
+void MqttTelemetry::publishNotification(const Notification& notification) {
+    if (!_enabled) return;
+
+    const char* type = "warning";
+    if (notification.type == NotificationType::FEEDING_COMPLETE) type = "feed";
+    else if (notification.type == NotificationType::ALARM) type = "alarm";
+
+    Message* message = allocate(Topic::EVENTS);
+    if (message == nullptr) return;
+
+    size_t length = snprintf(message->payload, sizeof(message->payload),
+                             "{\"type\":\"%s\",\"time\":%lu,\"feedCycle\":%u,\"targetWeight\":%.2f,"
+                             "\"actualWeight\":%.2f,\"duration\":%u,\"text\":",
+                             type, wallClock(), notification.feedCycle, notification.targetWeight,
+                             notification.actualWeight, notification.duration);
+    length = min(length, sizeof(message->payload) - 2);
+    length += appendJsonString(message->payload + length, sizeof(message->payload) - length - 1, notification.text);
+    message->payload[length++] = '}';
+    message->length = length;
+}
+
+bool MqttTelemetry::connect() {
+    char willTopic[sizeof(_prefix) + 8];
+    topicFor("online", willTopic, sizeof(willTopic));
+
+    if (!_client.connect(_host, _port, _clientId, _user, _password, willTopic, "offline")) {
+        // Back off, with up to a quarter of jitter so a fleet doesn't retry in step
+        uint32_t delayMs = _retryDelay + micros() % (_retryDelay / 4 + 1);
+        LOG_WARN("mqtt", "%s (retry in %lus)", _client.getLastError(), (unsigned long)(delayMs / 1000));
+        _nextAttempt = millis() + delayMs;
+        _retryDelay = min((uint32_t)MQTT_RECONNECT_MAX, _retryDelay * 2);
+        return false;
+    }
+
+    LOG_INFO("mqtt", "Connected to %s:%u as %s (%u buffered)", _host, _port, _clientId, _queued);
+    _retryDelay = MQTT_RECONNECT_MIN;
+    _wasConnected = true;
+    _client.publish(willTopic, "online", 6, MQTT_QOS, true, nextPacketId());
+    return true;
+}
+
+void MqttTelemetry::connectionLost() {
+    // Unacknowledged messages stay queued and go out again on the next connection
+    _wasConnected = false;
+    _inflightId = 0;
+    _statusPacketId = 0;
+    _statusDirty = true;
+    _nextAttempt = millis() + _retryDelay;
+}
+
+void MqttTelemetry::sampleWeights(const SystemStatus& status) {
+    // One sample per fresh BinTrac reading
+    if (status.bintracConnected && status.lastBintracUpdate != _lastSampleAt) {
+        _lastSampleAt = status.lastBintracUpdate;
+        for (int i = 0; i < 4; i++) _sum[i] += status.currentWeight[i];
+        _samples++;
+    }
+
+    if (millis() - _pointStart < MQTT_WEIGHT_INTERVAL) return;
+    _pointStart = millis();
+    if (_samples == 0) return;  // No readings this interval (BinTrac down): no point
+
+    // [time, A, B, C, D]
+    if (_batchPoints == 0) _batchLength = snprintf(_batch, sizeof(_batch), "{\"points\":[");
+    _batchLength += snprintf(_batch + _batchLength, sizeof(_batch) - _batchLength, "%s[%lu,%.1f,%.1f,%.1f,%.1f]",
+                             _batchPoints > 0 ? "," : "", wallClock(), _sum[0] / _samples, _sum[1] / _samples,
+                             _sum[2] / _samples, _sum[3] / _samples);
+    _batchLength = min(_batchLength, sizeof(_batch) - 1);
+    _batchPoints++;
+    memset(_sum, 0, sizeof(_sum));
+    _samples = 0;
+
+    if (_batchPoints < MQTT_WEIGHT_BATCH) return;
+    _batchPoints = 0;
+
+    Message* message = allocate(Topic::WEIGHTS);
+    if (message == nullptr) return;
+    message->length = snprintf(message->payload, sizeof(message->payload), "%s]}", _batch);
+    message->length = min((size_t)message->length, sizeof(message->payload) - 1);
+}
+
+void MqttTelemetry::checkStatus(const SystemStatus& status) {
+    StatusKey key;
+    memset(&key, 0, sizeof(key));
+    key.state = status.state;
+    key.feedingStage = status.feedingStage;
+    key.augerRunning = status.augerRunning;
+    key.chainRunning = status.chainRunning;
+    key.bintracConnected = status.bintracConnected;
+    key.nextFeedTime = status.nextFeedTime;
+    strlcpy(key.lastError, status.lastError, sizeof(key.lastError));
+
+    if (_statusPayload[0] != '\0' && memcmp(&key, &_status, sizeof(key)) == 0) return;
+
+    _status = key;
+    _statusDirty = true;
+
+    size_t length = snprintf(_statusPayload, sizeof(_statusPayload),
+                             "{\"time\":%lu,\"state\":%d,\"feedingStage\":%d,\"augerRunning\":%s,"
+                             "\"chainRunning\":%s,\"bintracConnected\":%s,\"weightDispensed\":%.2f,"
+                             "\"nextFeedTime\":%lu,\"lastError\":",
+                             wallClock(), (int)key.state, (int)key.feedingStage, key.augerRunning ? "true" : "false",
+                             key.chainRunning ? "true" : "false", key.bintracConnected ? "true" : "false",
+                             status.weightDispensed, key.nextFeedTime);
+    length = min(length, sizeof(_statusPayload) - 2);
+    length += appendJsonString(_statusPayload + length, sizeof(_statusPayload) - length - 1, key.lastError);
+    _statusPayload[length++] = '}';
+    _statusPayload[length] = '\0';
+}
+
+bool MqttTelemetry::publishStatus() {
+    char topic[sizeof(_prefix) + 8];
+    topicFor("status", topic, sizeof(topic));
+
+    uint16_t packetId = MQTT_QOS > 0 ? nextPacketId() : 0;
+    if (!_client.publish(topic, _statusPayload, strlen(_statusPayload), MQTT_QOS, true, packetId)) {
+        if (!_client.connected()) {
+            LOG_WARN("mqtt", "Connection lost: %s", _client.getLastError());
+            connectionLost();
+        }
+        return false;
+    }
+    _statusPacketId = packetId;
+    _statusDirty = false;
+    return true;
+}
+
+void MqttTelemetry::publishQueued() {
+    // The oldest message first, one awaiting its PUBACK at a time (keeps the order)
+    if (_inflightId != 0) {
+        if (_client.acknowledged(_inflightId)) {
+            _inflightId = 0;
+            removeAt(0);
+        } else if (millis() - _inflightSince > MQTT_ACK_TIMEOUT) {
+            LOG_WARN("mqtt", "No PUBACK from broker, reconnecting");
+            _client.drop();
+            connectionLost();
+            return;
+        } else {
+            return;
+        }
+    }
+
+    while (_queued > 0) {
+        Message& message = _messages[_order[0]];
+        char topic[sizeof(_prefix) + 8];
+        topicFor(message.topic == Topic::WEIGHTS ? "weights" : "events", topic, sizeof(topic));
+
+        uint16_t packetId = MQTT_QOS > 0 ? nextPacketId() : 0;
+        if (!_client.publish(topic, message.payload, message.length, MQTT_QOS, false, packetId, message.sent)) {
+            if (_client.connected()) {
+                LOG_WARN("mqtt", "%s - dropped", _client.getLastError());
+                removeAt(0);
+                _dropped++;
+                continue;
+            }
+            LOG_WARN("mqtt", "Connection lost: %s", _client.getLastError());
+            connectionLost();
+            return;
+        }
+        message.sent = true;
+
+        if (MQTT_QOS == 0) {
+            removeAt(0);
+            continue;
+        }
+        _inflightId = packetId;
+        _inflightSince = millis();
+        return;
+    }
+}
+
+MqttTelemetry::Message* MqttTelemetry::allocate(Topic topic) {
+    if (_queued == MQTT_BUFFER_MESSAGES) {
+        // Full: the oldest weights give way (not the one awaiting a PUBACK), else the oldest event
+        uint8_t first = _inflightId != 0 ? 1 : 0;
+        int victim = -1;
+        for (uint8_t i = first; i < _queued && victim < 0; i++) {
+            if (_messages[_order[i]].topic == Topic::WEIGHTS) victim = i;
+        }
+        if (victim < 0) {
+            if (topic == Topic::WEIGHTS || first >= _queued) {
+                _dropped++;
+                return nullptr;
+            }
+            victim = first;
+        }
+        removeAt(victim);
+        _dropped++;
+        if (_dropped == 1 || _dropped % 100 == 0) {
+            LOG_WARN("mqtt", "Offline buffer full, %lu messages dropped", (unsigned long)_dropped);
+        }
+    }
+
+    // Free slot: the one not in the order list
+    bool used[MQTT_BUFFER_MESSAGES] = {};
+    for (uint8_t i = 0; i < _queued; i++) used[_order[i]] = true;
+    uint8_t slot = 0;
+    while (used[slot]) slot++;
+
+    _order[_queued++] = slot;
+    Message* message = &_messages[slot];
+    message->topic = topic;
+    message->sent = false;
+    message->length = 0;
+    return message;
+}
+
+void MqttTelemetry::removeAt(uint8_t position) {
+    memmove(&_order[position], &_order[position + 1], _queued - position - 1);
+    _queued--;
+}
+
+void MqttTelemetry::topicFor(const char* suffix, char* topic, size_t size) const {
+    snprintf(topic, size, "%s/%s", _prefix, suffix);
+}
+
+uint16_t MqttTelemetry::nextPacketId() {
+    uint16_t id = _nextPacketId++;
+    if (_nextPacketId == 0) _nextPacketId = 1;
+    return id;
+}
+
+unsigned long MqttTelemetry::wallClock() {
+    time_t now = time(nullptr);
+    return now >= (time_t)TIME_MIN_VALID ? (unsigned long)now : 0;
+}
+
+// Appends s as a quoted JSON string, cut short to fit size (including the terminator)
+size_t MqttTelemetry::appendJsonString(char* out, size_t size, const char* s) {
+    if (size < 3) return 0;
+    size_t length = 0;
+    out[length++] = '"';
+    for (; *s != '\0'; s++) {
+        char c = *s;
+        char escaped[7];
+        size_t n;
+        if (c == '"' || c == '\\') {
+            escaped[0] = '\\';
+            escaped[1] = c;
+            n = 2;
+        } else if ((uint8_t)c < 0x20) {
+            n = snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        } else {
+            escaped[0] = c;
+            n = 1;
+        }
+        if (length + n + 2 > size) break;  // Room for the closing quote and terminator
+        memcpy(out + length, escaped, n);
+        length += n;
+    }
+    out[length++] = '"';
+    out[length] = '\0';
+    return length;
+}
+
+#endif // FEATURE_MQTT
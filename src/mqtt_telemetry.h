@@ -0,0 +1,124 @@
+#ifndef MQTT_TELEMETRY_H
+#define MQTT_TELEMETRY_H
+
+#include "config.h"
+
+#if FEATURE_MQTT
+#include <Arduino.h>
+#include "types.h"
+#include "task_messages.h"
+#include "mqtt_client.h"
+
+// Telemetry to an MQTT broker (runs in the notify task, off the control path)
+// Topics under the configured prefix (default feeder/<node id>):
+//   <prefix>/online   "online", or "offline" as the retained last will
+//   <prefix>/status   state, relays, BinTrac link, next feed, last error; retained, on change
+//   <prefix>/weights  bin weights averaged over MQTT_WEIGHT_INTERVAL, MQTT_WEIGHT_BATCH points per message
+//   <prefix>/events   feed completions, alarms and warnings
+// Weights and events wait in a fixed buffer while the broker is unreachable
+// (the oldest weights make room first) and go out in order once it's back,
+// each held until its PUBACK. Failed connections are retried with an
+// exponential backoff (MQTT_RECONNECT_MIN up to MQTT_RECONNECT_MAX).
+class MqttTelemetry {
+public:
+    MqttTelemetry();
+
+    // Apply the broker settings (at start and on every config change);
+    // reconnects if they changed. nodeId names the default topic prefix.
+    void configure(const Config& config, uint32_t nodeId);
+
+    // Sample the status, keep the connection and publish what's due
+    // (every notify task pass)
+    void update(const SystemStatus& status);
+
+    // Feed event, alarm or warning from the notification queue
+    void publishNotification(const Notification& notification);
+
+    bool isEnabled() const { return _enabled; }
+    bool isConnected() { return _client.connected(); }
+    uint8_t getBuffered() const { return _queued; }
+    uint32_t getDropped() const { return _dropped; }
+
+private:
+    enum class Topic : uint8_t {
+        WEIGHTS,
+        EVENTS
+    };
+
+    struct Message {
+        Topic topic;
+        bool sent;       // Went out at least once (resent with DUP)
+        uint16_t length;
+        char payload[MQTT_PAYLOAD_MAX];
+    };
+
+    // Fields whose change publishes the status
+    struct StatusKey {
+        SystemState state;
+        FeedingStage feedingStage;
+        bool augerRunning;
+        bool chainRunning;
+        bool bintracConnected;
+        unsigned long nextFeedTime;
+        char lastError[sizeof(SystemStatus::lastError)];
+    };
+
+    MqttClient _client;
+
+    // Settings
+    bool _enabled;
+    char _host[sizeof(Config::mqttBroker)];
+    uint16_t _port;
+    char _user[sizeof(Config::mqttUser)];
+    char _password[sizeof(Config::mqttPassword)];
+    char _prefix[sizeof(Config::mqttTopic) + 16];
+    char _clientId[24];
+
+    // Connection
+    unsigned long _nextAttempt;
+    uint32_t _retryDelay;
+    bool _wasConnected;
+    uint16_t _nextPacketId;
+
+    // Status (latest only, never buffered)
+    StatusKey _status;
+    bool _statusDirty;
+    uint16_t _statusPacketId;   // Awaiting PUBACK, 0 = none
+    char _statusPayload[MQTT_PAYLOAD_MAX];
+
+    // Weights being downsampled
+    unsigned long _lastSampleAt;   // lastBintracUpdate of the last reading taken
+    unsigned long _pointStart;
+    float _sum[4];
+    uint16_t _samples;
+    char _batch[MQTT_PAYLOAD_MAX];
+    size_t _batchLength;
+    uint8_t _batchPoints;
+
+    // Offline buffer: slots plus their order (oldest first)
+    Message _messages[MQTT_BUFFER_MESSAGES];
+    uint8_t _order[MQTT_BUFFER_MESSAGES];
+    uint8_t _queued;
+    uint16_t _inflightId;          // PUBACK awaited for the oldest message, 0 = none
+    unsigned long _inflightSince;
+    uint32_t _dropped;
+
+    bool connect();
+    void connectionLost();
+    void sampleWeights(const SystemStatus& status);
+    void checkStatus(const SystemStatus& status);
+    bool publishStatus();
+    void publishQueued();
+
+    Message* allocate(Topic topic);
+    void removeAt(uint8_t position);
+    void topicFor(const char* suffix, char* topic, size_t size) const;
+    uint16_t nextPacketId();
+
+    static unsigned long wallClock();
+    static size_t appendJsonString(char* out, size_t size, const char* s);
+};
+
+#endif // FEATURE_MQTT
+
+#endif // MQTT_TELEMETRY_H
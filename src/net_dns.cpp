@@ -0,0 +1,150 @@
+#include "net_dns.h"
+#include <Ethernet.h>
+#include <EthernetUdp.h>
+#include "config.h"
+#include "net_lock.h"
+#include "net_events.h"
+#include "logger.h"
+
+static const uint16_t DNS_PORT = 53;
+static const size_t DNS_HEADER_SIZE = 12;
+static const size_t DNS_PACKET_SIZE = 512;  // Largest reply over UDP
+static const int DNS_ATTEMPTS = 2;
+
+static uint16_t read16(const uint8_t* p) { return ((uint16_t)p[0] << 8) | p[1]; }
+
+bool NetDns::resolve(const char* host, IPAddress& address) {
+    if (address.fromString(host)) return true;
+
+    uint8_t packet[DNS_PACKET_SIZE];
+    uint16_t id = (uint16_t)ESP.getCycleCount();
+    size_t queryLength = buildQuery(host, id, packet, sizeof(packet));
+    if (queryLength == 0) {
+        LOG_WARN("net", "DNS: bad host name \"%s\"", host);
+        return false;
+    }
+
+    EthernetUDP udp;
+    for (int attempt = 0; attempt < DNS_ATTEMPTS; attempt++) {
+        {
+            NetLock lock;
+            IPAddress server = Ethernet.dnsServerIP();
+            // Ephemeral local port like the library's DNSClient
+            if (!udp.begin(1024 + (ESP.getCycleCount() & 0x3FF)) ||
+                !udp.beginPacket(server, DNS_PORT) ||
+                udp.write(packet, queryLength) != queryLength ||
+                !udp.endPacket()) {
+                udp.stop();
+                LOG_WARN("net", "DNS: query for %s not sent", host);
+                return false;
+            }
+        }
+
+        // Wait for the answer (lock only while checking the socket)
+        unsigned long start = millis();
+        while (millis() - start < NET_DNS_TIMEOUT) {
+            int size;
+            {
+                NetLock lock;
+                size = udp.parsePacket();
+                if (size > 0) {
+                    size = udp.read(packet, sizeof(packet));
+                }
+            }
+
+            if (size > 0 && parseReply(packet, size, id, address)) {
+                NetLock lock;
+                udp.stop();
+                return true;
+            }
+            if (size <= 0) {
+                NetEvents::waitForSocket(start, NET_DNS_TIMEOUT);
+            }
+        }
+
+        NetLock lock;
+        udp.stop();
+
+        // The reply buffer overwrote the query
+        buildQuery(host, id, packet, sizeof(packet));
+    }
+
+    LOG_WARN("net", "DNS: no answer for %s", host);
+    return false;
+}
+
+size_t NetDns::buildQuery(const char* host, uint16_t id, uint8_t* packet, size_t size) {
+    // Header: ID, recursion desired, one question
+    const uint8_t header[DNS_HEADER_SIZE] = {(uint8_t)(id >> 8), (uint8_t)id, 0x01, 0x00, 0, 1, 0, 0, 0, 0, 0, 0};
+    memcpy(packet, header, sizeof(header));
+    size_t length = DNS_HEADER_SIZE;
+
+    // QNAME: length-prefixed labels
+    const char* label = host;
+    for (;;) {
+        const char* dot = strchr(label, '.');
+        size_t labelLength = dot != nullptr ? (size_t)(dot - label) : strlen(label);
+        if (labelLength == 0 || labelLength > 63 || length + labelLength + 6 > size) {
+            return 0;
+        }
+
+        packet[length++] = labelLength;
+        memcpy(packet + length, label, labelLength);
+        length += labelLength;
+
+        if (dot == nullptr || dot[1] == '\0') break;  // A trailing dot is allowed
+        label = dot + 1;
+    }
+
+    // Root label, QTYPE A, QCLASS IN
+    const uint8_t tail[5] = {0, 0, 1, 0, 1};
+    memcpy(packet + length, tail, sizeof(tail));
+    return length + sizeof(tail);
+}
+
+bool NetDns::parseReply(const uint8_t* packet, size_t size, uint16_t id, IPAddress& address) {
+    if (size < DNS_HEADER_SIZE || read16(packet) != id) return false;
+
+    // Must be a response with RCODE 0
+    if ((packet[2] & 0x80) == 0 || (packet[3] & 0x0F) != 0) return false;
+
+    uint16_t questions = read16(packet + 4);
+    uint16_t answers = read16(packet + 6);
+
+    size_t offset = DNS_HEADER_SIZE;
+    for (uint16_t i = 0; i < questions; i++) {
+        offset = skipName(packet, size, offset);
+        if (offset == 0 || offset + 4 > size) return false;
+        offset += 4;  // QTYPE, QCLASS
+    }
+
+    // First A record wins (CNAMEs come before it)
+    for (uint16_t i = 0; i < answers; i++) {
+        offset = skipName(packet, size, offset);
+        if (offset == 0 || offset + 10 > size) return false;
+
+        uint16_t type = read16(packet + offset);
+        uint16_t recordClass = read16(packet + offset + 2);
+        uint16_t dataLength = read16(packet + offset + 8);
+        offset += 10;
+        if (offset + dataLength > size) return false;
+
+        if (type == 1 && recordClass == 1 && dataLength == 4) {
+            const uint8_t* data = packet + offset;
+            address = IPAddress(data[0], data[1], data[2], data[3]);
+            return true;
+        }
+        offset += dataLength;
+    }
+    return false;
+}
+
+size_t NetDns::skipName(const uint8_t* packet, size_t size, size_t offset) {
+    while (offset < size) {
+        uint8_t length = packet[offset];
+        if (length == 0) return offset + 1;
+        if ((length & 0xC0) == 0xC0) return offset + 2;  // Compression pointer ends the name
+        offset += length + 1;
+    }
+    return 0;
+}
@@ -0,0 +1,24 @@
+#ifndef NET_DNS_H
+#define NET_DNS_H
+
+#include <Arduino.h>
+
+// Host name lookups that don't hold the NetLock while waiting
+// The Ethernet library's DNSClient waits for the reply inside one call (up to
+// 5 s per try), so every other task would be locked out of the W5500 for the
+// whole lookup. This sends an A query to the DHCP / static DNS server and
+// polls for the answer with the lock taken per socket call, like the NTP query.
+class NetDns {
+public:
+    // Dotted-quad hosts are parsed without a query
+    // Opens a UDP socket for the query: call before opening the socket the
+    // caller's lease is for, so the lease covers it
+    static bool resolve(const char* host, IPAddress& address);
+
+private:
+    static size_t buildQuery(const char* host, uint16_t id, uint8_t* packet, size_t size);
+    static bool parseReply(const uint8_t* packet, size_t size, uint16_t id, IPAddress& address);
+    static size_t skipName(const uint8_t* packet, size_t size, size_t offset);
+};
+
+#endif // NET_DNS_H
@@ -0,0 +1,143 @@
+#include "net_events.h"
+#include "net_lock.h"
+#include "config.h"
+#include <Ethernet.h>
+#include <utility/w5100.h>
+#include "logger.h"
+
+// W5500 interrupt registers (not wrapped by the Ethernet library)
+static const uint16_t W5500_SIMR = 0x0018;            // Socket interrupt mask (common block)
+static const uint16_t W5500_SN_IMR = 0x002C;          // Per-socket interrupt mask
+static const uint8_t SOCKET_EVENTS = 0x01 | 0x02 | 0x04;  // CON | DISCON | RECV
+
+// Socket register address as decoded by W5100Class::write() on a W5500
+static uint16_t socketRegister(uint8_t socket, uint16_t offset) {
+    return 0x1000 + ((uint16_t)socket << 8) + offset;
+}
+
+EventGroupHandle_t NetEvents::_events = nullptr;
+NetEvents::TaskBits NetEvents::_tasks[NetEvents::MAX_TASKS] = {};
+int NetEvents::_intPin = -1;
+volatile uint32_t NetEvents::_interruptCount = 0;
+
+void NetEvents::begin() {
+    _events = xEventGroupCreate();
+}
+
+bool NetEvents::enableInterrupt(int intPin) {
+    if (intPin < 0) {
+        LOG_INFO("net", "W5500 INT not wired - network tasks poll (web every %d ms, notify every %d ms)",
+                 WEB_POLL_INTERVAL, NOTIFY_POLL_INTERVAL);
+        return false;
+    }
+
+    {
+        NetLock lock;
+        if (Ethernet.hardwareStatus() != EthernetW5500) {
+            LOG_INFO("net", "Socket interrupts need a W5500 - network tasks poll");
+            return false;
+        }
+
+        // SEND_OK and TIMEOUT stay masked: the library waits on those itself
+        for (uint8_t s = 0; s < MAX_SOCK_NUM; s++) {
+            W5100.write(socketRegister(s, W5500_SN_IMR), SOCKET_EVENTS);
+            W5100.writeSnIR(s, SOCKET_EVENTS);
+        }
+        W5100.write(W5500_SIMR, (uint8_t)((1 << MAX_SOCK_NUM) - 1));
+    }
+
+    _intPin = intPin;
+    pinMode(intPin, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(intPin), onInterrupt, FALLING);
+    LOG_INFO("net", "W5500 socket interrupts on GPIO %d", intPin);
+    return true;
+}
+
+void NetEvents::setNetworkReady() {
+    xEventGroupSetBits(_events, NET_EVENT_READY);
+}
+
+bool NetEvents::isNetworkReady() {
+    return (xEventGroupGetBits(_events) & NET_EVENT_READY) != 0;
+}
+
+bool NetEvents::waitForNetwork(uint32_t timeoutMs) {
+    TickType_t ticks = timeoutMs == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+    EventBits_t set = xEventGroupWaitBits(_events, NET_EVENT_READY, pdFALSE, pdTRUE, ticks);
+    return (set & NET_EVENT_READY) != 0;
+}
+
+void NetEvents::registerTask(EventBits_t bits) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < MAX_TASKS; i++) {
+        if (_tasks[i].task == nullptr || _tasks[i].task == self) {
+            _tasks[i].bits = bits;
+            _tasks[i].task = self;
+            return;
+        }
+    }
+}
+
+void NetEvents::waitForSocket(unsigned long startMs, uint32_t timeoutMs) {
+    unsigned long elapsed = millis() - startMs;
+    if (elapsed >= timeoutMs) return;
+    timeoutMs -= elapsed;
+
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    EventBits_t bits = 0;
+    for (int i = 0; i < MAX_TASKS; i++) {
+        if (_tasks[i].task == self) {
+            bits = _tasks[i].bits;
+            break;
+        }
+    }
+
+    if (bits == 0 || !isInterruptDriven()) {
+        vTaskDelay(pdMS_TO_TICKS(min(timeoutMs, (uint32_t)NET_DATA_POLL_INTERVAL)));
+        return;
+    }
+    wait(bits, timeoutMs, NET_DATA_POLL_INTERVAL);
+}
+
+void NetEvents::signal(EventBits_t bits) {
+    if (_events != nullptr) {
+        xEventGroupSetBits(_events, bits);
+    }
+}
+
+bool NetEvents::wait(EventBits_t bits, uint32_t timeoutMs, uint32_t pollMs) {
+    if (!isInterruptDriven() && timeoutMs > pollMs) {
+        timeoutMs = pollMs;
+    }
+
+    EventBits_t set = xEventGroupWaitBits(_events, bits, pdTRUE, pdFALSE, pdMS_TO_TICKS(timeoutMs));
+    if ((set & bits) == 0) {
+        return false;
+    }
+
+    // Clear before the caller services its sockets, so anything arriving
+    // while it works raises a fresh edge instead of being lost
+    if (isInterruptDriven()) {
+        acknowledge();
+    }
+    return true;
+}
+
+void IRAM_ATTR NetEvents::onInterrupt() {
+    // Socket owners are not known here; wake every network task and let each
+    // check its own sockets
+    BaseType_t woken = pdFALSE;
+    _interruptCount++;
+    xEventGroupSetBitsFromISR(_events, NET_EVENT_ALL, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void NetEvents::acknowledge() {
+    NetLock lock;
+    for (uint8_t s = 0; s < MAX_SOCK_NUM; s++) {
+        uint8_t pending = W5100.readSnIR(s) & SOCKET_EVENTS;
+        if (pending) {
+            W5100.writeSnIR(s, pending);
+        }
+    }
+}
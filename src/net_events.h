@@ -0,0 +1,75 @@
+#ifndef NET_EVENTS_H
+#define NET_EVENTS_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/task.h>
+
+// Wake-up bits for tasks blocked in NetEvents::wait()
+#define NET_EVENT_WEB    (1 << 0)  // web task: incoming connection or request data
+#define NET_EVENT_NOTIFY (1 << 1)  // notify task: UDP packet, queued notification
+#define NET_EVENT_ACQUISITION (1 << 2)  // acquisition task: Modbus response
+#define NET_EVENT_ALL    (NET_EVENT_WEB | NET_EVENT_NOTIFY | NET_EVENT_ACQUISITION)
+#define NET_EVENT_READY  (1 << 7)  // network is up (set once at boot, never cleared)
+
+// Event-driven waiting for the network tasks
+// A task sleeps until its bit is signalled (W5500 socket interrupt or work
+// queued for it) or its next deadline. Without the INT pin wired, waits are
+// capped at a short poll interval instead.
+class NetEvents {
+public:
+    // Create the event group (call once in setup, before tasks start)
+    static void begin();
+
+    // Route W5500 socket interrupts (connect, disconnect, data received) to
+    // the INT pin. Call after the final Ethernet.begin() - it resets the chip.
+    // intPin < 0 leaves the tasks polling.
+    static bool enableInterrupt(int intPin);
+    static bool isInterruptDriven() { return _intPin >= 0; }
+
+    // Network bring-up finished (IP configured); releases waitForNetwork()
+    static void setNetworkReady();
+    static bool isNetworkReady();
+
+    // Block until the network is up or timeoutMs passes
+    static bool waitForNetwork(uint32_t timeoutMs = portMAX_DELAY);
+
+    // Associate the calling task with its wake bit (call at task start)
+    static void registerTask(EventBits_t bits);
+
+    // Wait for socket activity while a response is pending, at most until
+    // startMs + timeoutMs: the calling task's bit, or a NET_DATA_POLL_INTERVAL
+    // sleep if it has none or the INT pin is not wired. Returns early on an
+    // event; callers re-check their socket and deadline.
+    static void waitForSocket(unsigned long startMs, uint32_t timeoutMs);
+
+    // Wake tasks waiting on 'bits'
+    static void signal(EventBits_t bits);
+
+    // Block until one of 'bits' is signalled or timeoutMs passes
+    // (at most pollMs when interrupts are not available)
+    // Returns true if woken by an event
+    static bool wait(EventBits_t bits, uint32_t timeoutMs, uint32_t pollMs);
+
+    // Interrupts seen since boot
+    static uint32_t getInterruptCount() { return _interruptCount; }
+
+private:
+    static const int MAX_TASKS = 4;
+
+    struct TaskBits {
+        TaskHandle_t task;
+        EventBits_t bits;
+    };
+
+    static EventGroupHandle_t _events;
+    static TaskBits _tasks[MAX_TASKS];
+    static int _intPin;
+    static volatile uint32_t _interruptCount;
+
+    static void IRAM_ATTR onInterrupt();
+    static void acknowledge();
+};
+
+#endif // NET_EVENTS_H
@@ -0,0 +1,157 @@
+#include "net_lock.h"
+#include "config.h"
+#include "net_dns.h"
+#include "w5500_spi.h"
+
+SemaphoreHandle_t NetLock::_mutex = nullptr;
+
+void NetLock::begin() {
+    if (_mutex == nullptr) {
+        _mutex = xSemaphoreCreateRecursiveMutex();
+    }
+}
+
+LockedEthernetClient::~LockedEthernetClient() {
+    // The library leaves the socket open when a client goes out of scope
+    if (_leased) {
+        stop();
+    }
+}
+
+int LockedEthernetClient::connect(IPAddress ip, uint16_t port) {
+    if (!lease()) return 0;
+
+    // The library opens the socket and waits for the handshake inside one
+    // call (its socket calls are private), so bound each wait instead: a
+    // short slice under the lock, released between tries. A slice that comes
+    // back early was refused; one that runs out tries again with twice the
+    // wait, so a distant peer still gets through.
+    unsigned long start = millis();
+    uint16_t slice = NET_CONNECT_SLICE;
+    for (;;) {
+        unsigned long attemptStart = millis();
+        int result;
+        {
+            NetLock lock;
+            setConnectionTimeout(slice);
+            result = EthernetClient::connect(ip, port);
+        }
+        if (result) return result;
+
+        if (millis() - attemptStart < slice || millis() - start >= NET_CONNECT_TIMEOUT) break;
+        if (slice < 1000) slice *= 2;
+        vTaskDelay(1);
+    }
+
+    returnLease();
+    return 0;
+}
+
+int LockedEthernetClient::connect(const char* host, uint16_t port) {
+    if (!lease()) return 0;
+
+    // Look the name up first, without holding the lock through the wait
+    IPAddress ip;
+    if (!NetDns::resolve(host, ip)) {
+        returnLease();
+        return 0;
+    }
+    return connect(ip, port);
+}
+
+int LockedEthernetClient::availableForWrite() {
+    NetLock lock;
+    return EthernetClient::availableForWrite();
+}
+
+size_t LockedEthernetClient::write(uint8_t b) {
+    NetLock lock;
+    return EthernetClient::write(b);
+}
+
+size_t LockedEthernetClient::write(const uint8_t* buf, size_t size) {
+    if (!W5500Spi::isEnabled()) {
+        NetLock lock;
+        return EthernetClient::write(buf, size);
+    }
+
+    // Burst path: one SPI transaction per chunk, lock released between chunks
+    // so other tasks get the chip while the peer drains the TX buffer
+    uint8_t socket = getSocketNumber();
+    if (socket >= MAX_SOCK_NUM) return 0;
+
+    size_t written = 0;
+    while (written < size) {
+        size_t chunk = size - written;
+        if (chunk > W5500Spi::MAX_CHUNK) chunk = W5500Spi::MAX_CHUNK;
+
+        int sent;
+        {
+            NetLock lock;
+            sent = W5500Spi::send(socket, buf + written, chunk);
+        }
+        if (sent < 0) {
+            setWriteError();
+            break;
+        }
+        if (sent == 0) {
+            vTaskDelay(1);
+            continue;
+        }
+        written += sent;
+    }
+    return written;
+}
+
+int LockedEthernetClient::available() {
+    NetLock lock;
+    return EthernetClient::available();
+}
+
+int LockedEthernetClient::read() {
+    NetLock lock;
+    return EthernetClient::read();
+}
+
+int LockedEthernetClient::read(uint8_t* buf, size_t size) {
+    NetLock lock;
+    return EthernetClient::read(buf, size);
+}
+
+int LockedEthernetClient::peek() {
+    NetLock lock;
+    return EthernetClient::peek();
+}
+
+void LockedEthernetClient::flush() {
+    NetLock lock;
+    EthernetClient::flush();
+}
+
+void LockedEthernetClient::stop() {
+    {
+        NetLock lock;
+        EthernetClient::stop();
+    }
+    returnLease();
+}
+
+uint8_t LockedEthernetClient::connected() {
+    NetLock lock;
+    return EthernetClient::connected();
+}
+
+bool LockedEthernetClient::lease() {
+    // Reconnecting an open client reuses its lease
+    if (!_leased) {
+        _leased = SocketBudget::acquire(_user);
+    }
+    return _leased;
+}
+
+void LockedEthernetClient::returnLease() {
+    if (_leased) {
+        _leased = false;
+        SocketBudget::release(_user);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef NET_LOCK_H
+#define NET_LOCK_H
+
+#include <Arduino.h>
+#include <Ethernet.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "socket_budget.h"
+
+// Serializes access to the W5500
+// The Ethernet library keeps global driver state and is not thread-safe, so
+// every task holds this lock around each library call. Hold it only for the
+// call itself, never across a delay or wait loop. Recursive, so a locked
+// client can be used while the lock is already held.
+class NetLock {
+public:
+    NetLock() { xSemaphoreTakeRecursive(_mutex, portMAX_DELAY); }
+    ~NetLock() { xSemaphoreGiveRecursive(_mutex); }
+
+    // Create the mutex (call once in setup, before any task uses the network)
+    static void begin();
+
+private:
+    static SemaphoreHandle_t _mutex;
+
+    NetLock(const NetLock&) = delete;
+    NetLock& operator=(const NetLock&) = delete;
+};
+
+// EthernetClient that takes the NetLock around every library call
+// Drop-in for EthernetClient where a client is used outside of a NetLock
+// (libraries such as SSLClient that drive the client themselves).
+// Outbound clients lease a socket from the SocketBudget on connect() and
+// return it on stop(); connect() fails if the owner's budget is used up.
+// connect() never holds the lock through a DNS wait (NetDns) and only for
+// one short slice of the TCP handshake at a time.
+class LockedEthernetClient : public EthernetClient {
+public:
+    explicit LockedEthernetClient(SocketUser user) : EthernetClient(), _user(user), _leased(false) {}
+    // Wrap a socket accepted by the web server (counted from the hardware, no lease)
+    explicit LockedEthernetClient(uint8_t socket) : EthernetClient(socket), _user(SocketUser::WEB), _leased(false) {}
+    ~LockedEthernetClient();
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    int availableForWrite() override;
+    size_t write(uint8_t b) override;
+    size_t write(const uint8_t* buf, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buf, size_t size) override;
+    int peek() override;
+    void flush() override;
+    void stop() override;
+    uint8_t connected() override;
+
+private:
+    SocketUser _user;
+    bool _leased;
+
+    bool lease();
+    void returnLease();
+};
+
+#endif // NET_LOCK_H
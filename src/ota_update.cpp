@@ -0,0 +1,327 @@
+#include "ota_update.h"
+#include "config.h"
+#include "logger.h"
+#include <Update.h>
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include <mbedtls/md.h>
+#include <mbedtls/pk.h>
+
+OtaUpdate::Stats OtaUpdate::_stats = {OtaTarget::FIRMWARE, false, false, 0, 0, 0, 0};
+bool OtaUpdate::_pendingVerify = false;
+bool OtaUpdate::_rolledBack = false;
+uint8_t OtaUpdate::_bootAttempts = 0;
+unsigned long OtaUpdate::_healthySince = 0;
+unsigned long OtaUpdate::_startMs = 0;
+uint8_t OtaUpdate::_expectedHash[32];
+uint8_t OtaUpdate::_signature[OTA_SIGNATURE_MAX];
+size_t OtaUpdate::_signatureLength = 0;
+char OtaUpdate::_lastError[64] = "";
+portMUX_TYPE OtaUpdate::_statsLock = portMUX_INITIALIZER_UNLOCKED;
+
+// SHA-256 of the upload so far (valid while an upload is in progress)
+static mbedtls_md_context_t imageHash;
+
+// With a rollback-enabled bootloader, keep a new image in pending-verify
+// until checkHealth() confirms it (the Arduino core confirms at boot otherwise)
+extern "C" bool verifyRollbackLater() {
+    return true;
+}
+
+void OtaUpdate::begin() {
+    const char* running = getRunningPartition();
+    char partition[17] = "";
+
+    Preferences prefs;
+    prefs.begin("ota", false);
+    _pendingVerify = prefs.getBool("pending", false);
+    _rolledBack = prefs.getBool("rolledBack", false);
+    _bootAttempts = prefs.getUChar("boots", 0);
+    prefs.getString("part", partition, sizeof(partition));
+
+    // The bootloader may already have gone back to the old image
+    if (_pendingVerify && strcmp(partition, running) != 0) {
+        _pendingVerify = false;
+        _rolledBack = true;
+        prefs.putBool("pending", false);
+        prefs.putBool("rolledBack", true);
+        LOG_WARN("ota", "New firmware on %s did not start - running %s", partition, running);
+    } else if (_pendingVerify) {
+        _bootAttempts++;
+        prefs.putUChar("boots", _bootAttempts);
+    }
+    prefs.end();
+
+    if (!_pendingVerify) return;
+
+    LOG_WARN("ota", "Running unconfirmed firmware %s on %s (boot %u of %d)",
+             FIRMWARE_VERSION, running, _bootAttempts, OTA_MAX_BOOT_ATTEMPTS);
+    if (_bootAttempts > OTA_MAX_BOOT_ATTEMPTS) {
+        rollback("too many boots without becoming healthy");
+    }
+}
+
+bool OtaUpdate::start(OtaTarget target, size_t size, const char* sha256Hex, const char* signatureHex) {
+    // Without a key anyone on the LAN could flash the controller
+    if (!isEnabled()) {
+        setError("No signing key configured");
+        return false;
+    }
+    if (_stats.inProgress) {
+        setError("Upload already in progress");
+        return false;
+    }
+    if (size == 0) {
+        setError("Empty image");
+        return false;
+    }
+    if (parseHex(sha256Hex, _expectedHash, sizeof(_expectedHash)) != sizeof(_expectedHash)) {
+        setError("Missing or malformed SHA-256");
+        return false;
+    }
+
+    _signatureLength = parseHex(signatureHex, _signature, sizeof(_signature));
+    if (_signatureLength == 0) {
+        setError("Missing or malformed signature");
+        return false;
+    }
+
+    // Checks the image fits the partition; flash is erased sector by sector as data arrives
+    if (!Update.begin(size, target == OtaTarget::FIRMWARE ? U_FLASH : U_SPIFFS)) {
+        setError(Update.errorString());
+        return false;
+    }
+
+    mbedtls_md_init(&imageHash);
+    mbedtls_md_setup(&imageHash, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0);
+    mbedtls_md_starts(&imageHash);
+
+    portENTER_CRITICAL(&_statsLock);
+    _stats = {target, true, false, (uint32_t)size, 0, 0, 0};
+    portEXIT_CRITICAL(&_statsLock);
+    _startMs = millis();
+    _lastError[0] = '\0';
+
+    LOG_INFO("ota", "%s upload started (%u bytes)", targetName(target), (unsigned)size);
+    return true;
+}
+
+bool OtaUpdate::write(const uint8_t* data, size_t length) {
+    if (!_stats.inProgress) return false;
+
+    if (_stats.received + length > _stats.imageSize) {
+        abort("Image larger than announced");
+        return false;
+    }
+
+    mbedtls_md_update(&imageHash, data, length);
+
+    unsigned long start = micros();
+    size_t written = Update.write(const_cast<uint8_t*>(data), length);
+    uint32_t us = micros() - start;
+
+    portENTER_CRITICAL(&_statsLock);
+    _stats.received += written;
+    _stats.flashUs += us;
+    portEXIT_CRITICAL(&_statsLock);
+
+    if (written != length) {
+        abort(Update.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool OtaUpdate::finish() {
+    if (!_stats.inProgress) return false;
+
+    if (_stats.received != _stats.imageSize) {
+        abort("Upload incomplete");
+        return false;
+    }
+
+    uint8_t hash[32];
+    mbedtls_md_finish(&imageHash, hash);
+    if (!verify(hash)) {
+        abort(_lastError);
+        return false;
+    }
+
+    // Mark before activating: if we lose power right after, the new image
+    // still boots as unconfirmed
+    const esp_partition_t* next = esp_ota_get_next_update_partition(nullptr);
+    bool firmware = _stats.target == OtaTarget::FIRMWARE;
+    if (firmware) {
+        setPending(true, next != nullptr ? next->label : "");
+    }
+
+    if (!Update.end()) {
+        if (firmware) setPending(false, "");
+        abort(Update.errorString());
+        return false;
+    }
+
+    mbedtls_md_free(&imageHash);
+
+    portENTER_CRITICAL(&_statsLock);
+    _stats.inProgress = false;
+    _stats.succeeded = true;
+    _stats.elapsedMs = millis() - _startMs;
+    portEXIT_CRITICAL(&_statsLock);
+
+    LOG_INFO("ota", "%s update verified (%lu bytes in %lu ms, flash %lu KB/s)%s",
+             targetName(_stats.target), (unsigned long)_stats.received, (unsigned long)_stats.elapsedMs,
+             _stats.flashUs > 0 ? (unsigned long)((uint64_t)_stats.received * 1000 / _stats.flashUs) : 0UL,
+             firmware ? " - boots unconfirmed" : "");
+    return true;
+}
+
+void OtaUpdate::abort(const char* reason) {
+    if (reason != _lastError) setError(reason);
+    if (!_stats.inProgress) return;
+
+    Update.abort();
+    mbedtls_md_free(&imageHash);
+
+    portENTER_CRITICAL(&_statsLock);
+    _stats.inProgress = false;
+    _stats.succeeded = false;
+    _stats.elapsedMs = millis() - _startMs;
+    portEXIT_CRITICAL(&_statsLock);
+
+    LOG_WARN("ota", "%s upload aborted after %lu bytes: %s",
+             targetName(_stats.target), (unsigned long)_stats.received, _lastError);
+}
+
+void OtaUpdate::checkHealth(const SystemStatus& status) {
+    if (!_pendingVerify) return;
+
+    // Healthy = on the network with the control and acquisition tasks still
+    // running, continuously for OTA_HEALTHY_TIME (the HouseLink being down
+    // says nothing about the new firmware)
+    unsigned long now = millis();
+    bool tasksRunning = status.publishTime != 0 && now - status.publishTime < OTA_TASK_STALL_TIME &&
+                        status.lastSampleAttempt != 0 && now - status.lastSampleAttempt < OTA_TASK_STALL_TIME;
+    if (status.networkConnected && tasksRunning) {
+        if (_healthySince == 0) _healthySince = max(millis(), 1UL);
+        if (millis() - _healthySince >= OTA_HEALTHY_TIME) {
+            esp_ota_mark_app_valid_cancel_rollback();
+            setPending(false, "");
+            _pendingVerify = false;
+            LOG_INFO("ota", "Firmware %s on %s confirmed", FIRMWARE_VERSION, getRunningPartition());
+        }
+        return;
+    }
+
+    _healthySince = 0;
+
+    // Never restart with motors running; the rollback waits for the feed to end
+    if (millis() >= OTA_HEALTH_TIMEOUT && !status.augerRunning && !status.chainRunning) {
+        rollback("not healthy within the health timeout");
+    }
+}
+
+const char* OtaUpdate::getRunningPartition() {
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    return running != nullptr ? running->label : "unknown";
+}
+
+void OtaUpdate::getStats(Stats& stats) {
+    portENTER_CRITICAL(&_statsLock);
+    stats = _stats;
+    portEXIT_CRITICAL(&_statsLock);
+    if (stats.inProgress) stats.elapsedMs = millis() - _startMs;
+}
+
+const char* OtaUpdate::targetName(OtaTarget target) {
+    switch (target) {
+        case OtaTarget::FIRMWARE:   return "firmware";
+        case OtaTarget::FILESYSTEM: return "filesystem";
+        default:                    return "unknown";
+    }
+}
+
+void OtaUpdate::setError(const char* error) {
+    strlcpy(_lastError, error, sizeof(_lastError));
+}
+
+bool OtaUpdate::verify(const uint8_t hash[32]) {
+    if (memcmp(hash, _expectedHash, sizeof(_expectedHash)) != 0) {
+        setError("SHA-256 mismatch");
+        return false;
+    }
+
+    // ECDSA signature over the image's SHA-256
+    mbedtls_pk_context key;
+    mbedtls_pk_init(&key);
+    int result = mbedtls_pk_parse_public_key(&key, (const unsigned char*)OTA_SIGNING_PUBLIC_KEY,
+                                             sizeof(OTA_SIGNING_PUBLIC_KEY));
+    if (result != 0) {
+        mbedtls_pk_free(&key);
+        setError("Signing key in config.h is invalid");
+        return false;
+    }
+
+    result = mbedtls_pk_verify(&key, MBEDTLS_MD_SHA256, hash, 32, _signature, _signatureLength);
+    mbedtls_pk_free(&key);
+    if (result != 0) {
+        setError("Signature mismatch");
+        return false;
+    }
+    return true;
+}
+
+void OtaUpdate::setPending(bool pending, const char* partition) {
+    Preferences prefs;
+    prefs.begin("ota", false);
+    prefs.putBool("pending", pending);
+    prefs.putUChar("boots", 0);
+    prefs.putString("part", partition);
+    if (pending) prefs.putBool("rolledBack", false);
+    prefs.end();
+}
+
+void OtaUpdate::rollback(const char* reason) {
+    const esp_partition_t* previous = esp_ota_get_next_update_partition(nullptr);
+    LOG_ERROR("ota", "Rolling back firmware: %s", reason);
+
+    // set_boot_partition validates the old image; if it's gone there's nothing to go back to
+    if (previous == nullptr || esp_ota_set_boot_partition(previous) != ESP_OK) {
+        LOG_ERROR("ota", "No valid previous firmware - keeping %s", getRunningPartition());
+        setPending(false, "");
+        _pendingVerify = false;
+        return;
+    }
+
+    Preferences prefs;
+    prefs.begin("ota", false);
+    prefs.putBool("pending", false);
+    prefs.putBool("rolledBack", true);
+    prefs.end();
+
+    LOG_ERROR("ota", "Restarting into %s", previous->label);
+    delay(500);  // Let the log drain
+    ESP.restart();
+}
+
+// Hex string to bytes; returns the byte count, 0 if missing, malformed or too long
+size_t OtaUpdate::parseHex(const char* hex, uint8_t* out, size_t maxLength) {
+    if (hex == nullptr) return 0;
+
+    size_t length = strlen(hex);
+    if (length == 0 || length % 2 != 0 || length / 2 > maxLength) return 0;
+
+    for (size_t i = 0; i < length / 2; i++) {
+        uint8_t value = 0;
+        for (int n = 0; n < 2; n++) {
+            char c = hex[i * 2 + n];
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= c - '0';
+            else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            else return 0;
+        }
+        out[i] = value;
+    }
+    return length / 2;
+}
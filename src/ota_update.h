@@ -0,0 +1,80 @@
+#ifndef OTA_UPDATE_H
+#define OTA_UPDATE_H
+
+#include <Arduino.h>
+#include "types.h"
+
+// What an upload replaces
+enum class OtaTarget : uint8_t {
+    FIRMWARE,    // Inactive app partition; the running image stays until restart
+    FILESYSTEM   // LittleFS data partition (single copy, overwritten in place)
+};
+
+// Streaming firmware/filesystem updates with verification and rollback
+// An upload is written to flash chunk by chunk as it arrives (nothing is
+// buffered beyond the flash sector) while its SHA-256 is computed; finish()
+// only activates it if the hash and the signature match (no signing key
+// configured = uploads refused). A new firmware image boots unconfirmed: it's
+// confirmed once the controller has been healthy for OTA_HEALTHY_TIME, and
+// the previous image is restored if that doesn't happen within
+// OTA_HEALTH_TIMEOUT or OTA_MAX_BOOT_ATTEMPTS boots. One upload at a time
+// (web task); feeds don't start while one is in progress.
+class OtaUpdate {
+public:
+    struct Stats {
+        OtaTarget target;
+        bool inProgress;
+        bool succeeded;
+        uint32_t imageSize;
+        uint32_t received;
+        uint32_t elapsedMs;   // First byte to finish (network + flash)
+        uint32_t flashUs;     // Time spent in flash erase/write
+    };
+
+    // Count boots of an unconfirmed image, roll back after too many
+    // (call early in setup, before anything likely to crash)
+    static void begin();
+
+    // Streaming upload: start() checks the size and hex digests, write() the
+    // data in any chunk size, finish() verifies and activates. Any failure
+    // aborts the upload; getLastError() says why. Restart after finish().
+    static bool start(OtaTarget target, size_t size, const char* sha256Hex, const char* signatureHex);
+    static bool write(const uint8_t* data, size_t length);
+    static bool finish();
+    static void abort(const char* reason);
+    static bool isUploading() { return _stats.inProgress; }
+    static bool isEnabled() { return strlen(OTA_SIGNING_PUBLIC_KEY) > 0; }
+
+    // Confirm or roll back a new image from the published status
+    // (call periodically from any one task)
+    static void checkHealth(const SystemStatus& status);
+
+    static bool isPendingVerify() { return _pendingVerify; }
+    static bool wasRolledBack() { return _rolledBack; }
+    static uint8_t getBootAttempts() { return _bootAttempts; }
+    static const char* getRunningPartition();
+    static void getStats(Stats& stats);
+    static const char* getLastError() { return _lastError; }
+    static const char* targetName(OtaTarget target);
+
+private:
+    static Stats _stats;
+    static bool _pendingVerify;
+    static bool _rolledBack;
+    static uint8_t _bootAttempts;
+    static unsigned long _healthySince;
+    static unsigned long _startMs;
+    static uint8_t _expectedHash[32];
+    static uint8_t _signature[OTA_SIGNATURE_MAX];
+    static size_t _signatureLength;
+    static char _lastError[64];
+    static portMUX_TYPE _statsLock;
+
+    static void setError(const char* error);
+    static bool verify(const uint8_t hash[32]);
+    static void setPending(bool pending, const char* partition);
+    static void rollback(const char* reason);
+    static size_t parseHex(const char* hex, uint8_t* out, size_t maxLength);
+};
+
+#endif // OTA_UPDATE_H
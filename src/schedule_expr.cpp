@@ -0,0 +1,195 @@
+#include "schedule_expr.h"
+
+bool ScheduleExpr::compile(const char* expr, CompiledSchedule& out) {
+    out = CompiledSchedule();
+
+    if (expr == nullptr) return false;
+
+    // Split into 5 whitespace-separated fields
+    const char* fieldStart[5];
+    const char* fieldEnd[5];
+    int fieldCount = 0;
+    const char* p = expr;
+
+    while (*p != '\0') {
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0') break;
+
+        if (fieldCount == 5) return false;  // Too many fields
+
+        fieldStart[fieldCount] = p;
+        while (*p != '\0' && *p != ' ' && *p != '\t') p++;
+        fieldEnd[fieldCount] = p;
+        fieldCount++;
+    }
+
+    // Empty expression = slot disabled (not an error)
+    if (fieldCount == 0) return true;
+    if (fieldCount != 5) return false;
+
+    uint64_t mask;
+    bool restricted;
+
+    if (!parseField(fieldStart[0], fieldEnd[0], 0, 59, mask, restricted)) return false;
+    out.minutes = mask;
+
+    if (!parseField(fieldStart[1], fieldEnd[1], 0, 23, mask, restricted)) return false;
+    out.hours = (uint32_t)mask;
+
+    if (!parseField(fieldStart[2], fieldEnd[2], 1, 31, mask, restricted)) return false;
+    out.daysOfMonth = (uint32_t)mask;
+    out.domRestricted = restricted;
+
+    if (!parseField(fieldStart[3], fieldEnd[3], 1, 12, mask, restricted)) return false;
+    out.months = (uint16_t)mask;
+
+    if (!parseField(fieldStart[4], fieldEnd[4], 0, 7, mask, restricted)) return false;
+    // Fold 7 (Sunday) onto 0
+    if (mask & (1ULL << 7)) {
+        mask = (mask & 0x7F) | 1;
+    }
+    out.daysOfWeek = (uint8_t)mask;
+    out.dowRestricted = restricted;
+
+    out.enabled = true;
+    return true;
+}
+
+bool ScheduleExpr::matches(const CompiledSchedule& schedule, const struct tm& t) {
+    if (!schedule.enabled) return false;
+
+    return (schedule.minutes & (1ULL << t.tm_min)) &&
+           (schedule.hours & (1UL << t.tm_hour)) &&
+           dayMatches(schedule, t);
+}
+
+uint16_t ScheduleExpr::firesOnDay(const CompiledSchedule& schedule, const struct tm& t) {
+    if (!schedule.enabled || !dayMatches(schedule, t)) return 0;
+
+    // Every listed minute of every listed hour
+    return __builtin_popcountl(schedule.hours) * __builtin_popcountll(schedule.minutes);
+}
+
+bool ScheduleExpr::nextFire(const CompiledSchedule& schedule, time_t from, time_t& next) {
+    if (!schedule.enabled) return false;
+
+    // Round up to the next whole minute
+    time_t t = ((from + 59) / 60) * 60;
+
+    struct tm timeinfo;
+    gmtime_r(&t, &timeinfo);
+
+    time_t dayStart = t - (timeinfo.tm_hour * 3600 + timeinfo.tm_min * 60);
+    int fromHour = timeinfo.tm_hour;
+    int fromMinute = timeinfo.tm_min;
+
+    // Leap day combined with a day-of-week can take several years to come around
+    for (int day = 0; day < 4 * 366; day++) {
+        if (dayMatches(schedule, timeinfo)) {
+            uint32_t hourMask = schedule.hours & (0xFFFFFFFFUL << fromHour);
+
+            while (hourMask) {
+                int hour = __builtin_ctzl(hourMask);
+                uint64_t minuteMask = schedule.minutes;
+                if (hour == fromHour) {
+                    minuteMask &= (0xFFFFFFFFFFFFFFFFULL << fromMinute);
+                }
+
+                if (minuteMask) {
+                    next = dayStart + hour * 3600 + __builtin_ctzll(minuteMask) * 60;
+                    return true;
+                }
+
+                hourMask &= hourMask - 1;  // Clear lowest set bit
+            }
+        }
+
+        dayStart += 86400;
+        gmtime_r(&dayStart, &timeinfo);
+        fromHour = 0;
+        fromMinute = 0;
+    }
+
+    return false;
+}
+
+void ScheduleExpr::fromMinutes(uint16_t minutes, char* buffer, size_t size) {
+    // Legacy slots never matched 1440 or more (the old "12am" default): disabled
+    if (minutes >= 1440) {
+        if (size > 0) buffer[0] = '\0';
+        return;
+    }
+    snprintf(buffer, size, "%d %d * * *", minutes % 60, minutes / 60);
+}
+
+bool ScheduleExpr::dayMatches(const CompiledSchedule& schedule, const struct tm& t) {
+    if (!(schedule.months & (1U << (t.tm_mon + 1)))) return false;
+
+    bool domMatch = schedule.daysOfMonth & (1UL << t.tm_mday);
+    bool dowMatch = schedule.daysOfWeek & (1U << t.tm_wday);
+
+    // Standard cron rule: if both day fields are restricted, either may match
+    if (schedule.domRestricted && schedule.dowRestricted) {
+        return domMatch || dowMatch;
+    }
+    return domMatch && dowMatch;
+}
+
+bool ScheduleExpr::parseField(const char* start, const char* end, int minValue, int maxValue,
+                              uint64_t& mask, bool& restricted) {
+    mask = 0;
+    restricted = !(end - start == 1 && *start == '*');
+
+    const char* p = start;
+    while (p < end) {
+        int low, high, step = 1;
+
+        if (*p == '*') {
+            low = minValue;
+            high = maxValue;
+            p++;
+        } else {
+            p = parseNumber(p, end, low);
+            if (p == nullptr) return false;
+            high = low;
+
+            if (p < end && *p == '-') {
+                p = parseNumber(p + 1, end, high);
+                if (p == nullptr) return false;
+            }
+        }
+
+        if (p < end && *p == '/') {
+            p = parseNumber(p + 1, end, step);
+            if (p == nullptr || step == 0) return false;
+            // "N/S" means N through max every S
+            if (high == low) high = maxValue;
+        }
+
+        if (low < minValue || high > maxValue || low > high) return false;
+
+        for (int v = low; v <= high; v += step) {
+            mask |= (1ULL << v);
+        }
+
+        if (p < end) {
+            if (*p != ',') return false;
+            p++;
+            if (p == end) return false;  // Trailing comma
+        }
+    }
+
+    return mask != 0;
+}
+
+const char* ScheduleExpr::parseNumber(const char* p, const char* end, int& value) {
+    if (p >= end || *p < '0' || *p > '9') return nullptr;
+
+    value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        if (value > 1000) return nullptr;
+        p++;
+    }
+    return p;
+}
@@ -0,0 +1,50 @@
+#ifndef SCHEDULE_EXPR_H
+#define SCHEDULE_EXPR_H
+
+#include <Arduino.h>
+#include <time.h>
+
+// Cron-style schedule expression compiled to bitmasks
+// Format: "minute hour day-of-month month day-of-week"
+// Each field accepts *, N, N-M, lists (N,M) and steps (*/S, N-M/S, N/S)
+// Day-of-week: 0-7 (0 and 7 are Sunday)
+// An empty expression compiles to a disabled slot that never fires
+struct CompiledSchedule {
+    uint64_t minutes = 0;       // bits 0-59
+    uint32_t hours = 0;         // bits 0-23
+    uint32_t daysOfMonth = 0;   // bits 1-31
+    uint16_t months = 0;        // bits 1-12
+    uint8_t daysOfWeek = 0;     // bits 0-6 (0 = Sunday)
+    bool domRestricted = false; // day-of-month field was not '*'
+    bool dowRestricted = false; // day-of-week field was not '*'
+    bool enabled = false;       // false for empty/invalid expressions
+};
+
+class ScheduleExpr {
+public:
+    // Compile expression into bitmasks
+    // Returns false (and a disabled schedule) if the expression is malformed
+    static bool compile(const char* expr, CompiledSchedule& out);
+
+    // Check if a broken-down local time matches the schedule
+    static bool matches(const CompiledSchedule& schedule, const struct tm& t);
+
+    // How many times the schedule fires on the local day of t (0 if not that day)
+    static uint16_t firesOnDay(const CompiledSchedule& schedule, const struct tm& t);
+
+    // Find first fire time at or after 'from' (local seconds, rounded up to the minute)
+    // Returns false if the schedule is disabled or never fires within 4 years
+    static bool nextFire(const CompiledSchedule& schedule, time_t from, time_t& next);
+
+    // Build a daily expression ("M H * * *") from minutes since midnight
+    // (empty, a disabled slot, for 1440 and up)
+    static void fromMinutes(uint16_t minutes, char* buffer, size_t size);
+
+private:
+    static bool dayMatches(const CompiledSchedule& schedule, const struct tm& t);
+    static bool parseField(const char* start, const char* end, int minValue, int maxValue,
+                           uint64_t& mask, bool& restricted);
+    static const char* parseNumber(const char* p, const char* end, int& value);
+};
+
+#endif // SCHEDULE_EXPR_H
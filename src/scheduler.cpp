@@ -3,33 +3,123 @@
 #include <time.h>
 #include <sys/time.h>
 #include <EthernetUdp.h>
+#include "net_lock.h"
+#include "net_dns.h"
+#include "net_events.h"
+#include "logger.h"
 
 Scheduler::Scheduler() {
     _initialized = false;
     _timezoneOffset = 0;
+    _storage = nullptr;
+    _config = nullptr;
+    _bintrac = nullptr;
+    _timeSource = TimeSource::NONE;
+    _lastSyncTime = 0;
+    _lastSyncAttempt = 0;
+    _lastPersist = 0;
+    _sourceReached = false;
     _lastDay = 0;
+    _nextFeedComputedMinute = 0;
+    _nextFeedTime = 0;
+    _nextFeedCycle = 0;
 
     for (int i = 0; i < 4; i++) {
         _feedingCompleted[i] = false;
+        _lastFireMinute[i] = 0;
     }
 }
 
-void Scheduler::begin(int timezoneOffset) {
+void Scheduler::begin(int timezoneOffset, Storage* storage) {
     _timezoneOffset = timezoneOffset;
-    Serial.printf("Scheduler initialized with timezone offset: UTC%+d\n", timezoneOffset);
+    _storage = storage;
+    LOG_INFO("time", "Scheduler initialized with timezone offset: UTC%+d", timezoneOffset);
+
+    // Resume with the last known good time so scheduling works before any network sync
+    restoreTime();
+
+    if (_storage != nullptr) {
+        for (int i = 0; i < 4; i++) {
+            _lastFireMinute[i] = _storage->loadLastFireMinute(i);
+        }
+    }
 }
 
-void Scheduler::startNTPSync() {
-    Serial.println("Starting NTP sync via UDP (UTC time)");
+void Scheduler::setTimeSources(const Config& config, BinTrac& bintrac) {
+    _config = &config;
+    _bintrac = &bintrac;
+}
+
+bool Scheduler::syncTime(TimeReading& reading, uint8_t ntpAttempts) {
+    _lastSyncAttempt = millis();
+    reading.source = TimeSource::NONE;
+
+    // 1. NTP, 2. HTTP Date header from a local server, 3. HouseLink clock registers
+    if (queryNTP(reading.epoch, ntpAttempts)) {
+        reading.source = TimeSource::NTP;
+    } else if (_config != nullptr && strlen(_config->timeHttpServer) > 0 && queryHttpDate(reading.epoch)) {
+        reading.source = TimeSource::HTTP;
+    } else if (_config != nullptr && _bintrac != nullptr && _config->houseLinkTimeAddr != 0) {
+        if (_bintrac->readTime(_config->houseLinkTimeAddr, reading.epoch) && reading.epoch >= TIME_MIN_VALID) {
+            reading.source = TimeSource::HOUSELINK;
+        } else {
+            LOG_WARN("time", "HouseLink time read failed: %s", _bintrac->getLastError());
+        }
+    }
+
+    if (reading.source != TimeSource::NONE) {
+        reading.readAt = millis();
+        _sourceReached = true;
+        return true;
+    }
+
+    LOG_WARN("time", "✗ No time source reachable");
+    if (!isTimeSynced()) {
+        LOG_WARN("time", "Scheduled feeding will not work without time sync!");
+    }
+    return false;
+}
+
+void Scheduler::applyTime(const TimeReading& reading) {
+    // Account for the time the reading spent in the control queue
+    applyTime(reading.epoch + (millis() - reading.readAt) / 1000, reading.source);
+}
+
+bool Scheduler::setManualTime(unsigned long epoch) {
+    if (epoch < TIME_MIN_VALID) {
+        return false;
+    }
+
+    applyTime(epoch, TimeSource::MANUAL);
+    return true;
+}
+
+const char* Scheduler::timeSourceName(TimeSource source) {
+    switch (source) {
+        case TimeSource::RESTORED:  return "restored";
+        case TimeSource::NTP:       return "ntp";
+        case TimeSource::HTTP:      return "http";
+        case TimeSource::HOUSELINK: return "houselink";
+        case TimeSource::MANUAL:    return "manual";
+        default:                    return "none";
+    }
+}
+
+bool Scheduler::queryNTP(unsigned long& epoch, uint8_t attempts) {
+    LOG_INFO("time", "Starting NTP sync via UDP (UTC time)");
+
+    SocketLease lease(SocketUser::TIME);
+    if (!lease.held()) {
+        return false;
+    }
 
     EthernetUDP udp;
     const int NTP_PACKET_SIZE = 48;
     byte packetBuffer[NTP_PACKET_SIZE];
 
-    // Try up to 3 times
-    for (int attempt = 0; attempt < 3; attempt++) {
+    for (int attempt = 0; attempt < attempts; attempt++) {
         if (attempt > 0) {
-            Serial.printf("Retry attempt %d...\n", attempt + 1);
+            LOG_INFO("time", "Retry attempt %d...", attempt + 1);
             delay(2000);
         }
 
@@ -47,64 +137,216 @@ void Scheduler::startNTPSync() {
         packetBuffer[14] = 49;
         packetBuffer[15] = 52;
 
-        // Send NTP request
-        udp.begin(8888);  // Local port
-        if (udp.beginPacket(NTP_SERVER, 123) == 0) {
-            Serial.println("Failed to start UDP packet");
-            udp.stop();
+        // Look up the pool before taking the lock for the send
+        IPAddress server;
+        if (!NetDns::resolve(NTP_SERVER, server)) {
             continue;
         }
 
-        udp.write(packetBuffer, NTP_PACKET_SIZE);
-        if (udp.endPacket() == 0) {
-            Serial.println("Failed to send UDP packet");
-            udp.stop();
-            continue;
+        // Send NTP request
+        {
+            NetLock lock;
+            udp.begin(8888);  // Local port
+            if (udp.beginPacket(server, 123) == 0) {
+                LOG_WARN("time", "Failed to start UDP packet");
+                udp.stop();
+                continue;
+            }
+
+            udp.write(packetBuffer, NTP_PACKET_SIZE);
+            if (udp.endPacket() == 0) {
+                LOG_WARN("time", "Failed to send UDP packet");
+                udp.stop();
+                continue;
+            }
         }
 
-        Serial.print("NTP request sent, waiting for response");
+        LOG_DEBUG("time", "NTP request sent, waiting for response");
 
-        // Wait for response (up to 5 seconds)
+        // Wait for response (lock only while checking the socket)
         unsigned long startWait = millis();
-        while (millis() - startWait < 5000) {
-            int size = udp.parsePacket();
-            if (size >= NTP_PACKET_SIZE) {
-                Serial.println(" received!");
+        bool received = false;
+        while (!received && millis() - startWait < NTP_TIMEOUT) {
+            {
+                NetLock lock;
+                int size = udp.parsePacket();
+                if (size >= NTP_PACKET_SIZE) {
+                    udp.read(packetBuffer, NTP_PACKET_SIZE);
+                    udp.stop();
+                    received = true;
+                }
+            }
+            if (!received) {
+                NetEvents::waitForSocket(startWait, NTP_TIMEOUT);
+            }
+        }
 
-                udp.read(packetBuffer, NTP_PACKET_SIZE);
-                udp.stop();
+        if (received) {
+            LOG_DEBUG("time", "NTP response received");
 
-                // Extract timestamp (bytes 40-43)
-                unsigned long highWord = word(packetBuffer[40], packetBuffer[41]);
-                unsigned long lowWord = word(packetBuffer[42], packetBuffer[43]);
-                unsigned long secsSince1900 = highWord << 16 | lowWord;
-
-                // Convert to Unix timestamp (seconds since Jan 1 1970)
-                const unsigned long seventyYears = 2208988800UL;
-                unsigned long epoch = secsSince1900 - seventyYears;
-
-                // Set system time
-                struct timeval tv;
-                tv.tv_sec = epoch;
-                tv.tv_usec = 0;
-                settimeofday(&tv, NULL);
-
-                _initialized = true;
-                Serial.println("✓ Time synchronized with NTP");
-                char timeStr[32];
-                getCurrentTimeStr(timeStr, sizeof(timeStr));
-                Serial.printf("Current time: %s (timestamp: %lu)\n", timeStr, epoch);
-                return;
-            }
-            delay(100);
-            Serial.print(".");
+            // Extract timestamp (bytes 40-43)
+            unsigned long highWord = word(packetBuffer[40], packetBuffer[41]);
+            unsigned long lowWord = word(packetBuffer[42], packetBuffer[43]);
+            unsigned long secsSince1900 = highWord << 16 | lowWord;
+
+            // Convert to Unix timestamp (seconds since Jan 1 1970)
+            const unsigned long seventyYears = 2208988800UL;
+            epoch = secsSince1900 - seventyYears;
+            return epoch >= TIME_MIN_VALID;
         }
-        Serial.println(" timeout");
+        LOG_WARN("time", "NTP response timeout");
+        NetLock lock;
         udp.stop();
     }
 
-    Serial.println("✗ NTP sync failed after 3 attempts");
-    Serial.println("Scheduled feeding will not work without time sync!");
+    LOG_WARN("time", "✗ NTP sync failed after %d attempts", attempts);
+    return false;
+}
+
+bool Scheduler::queryHttpDate(unsigned long& epoch) {
+    // Server is "host" or "host:port"
+    char host[sizeof(_config->timeHttpServer)];
+    strlcpy(host, _config->timeHttpServer, sizeof(host));
+    uint16_t port = 80;
+    char* colon = strchr(host, ':');
+    if (colon != nullptr) {
+        *colon = '\0';
+        port = atoi(colon + 1);
+    }
+
+    LOG_INFO("time", "Requesting time from HTTP server %s:%d", host, port);
+
+    LockedEthernetClient client(SocketUser::TIME);
+    if (!client.connect(host, port)) {
+        LOG_WARN("time", "HTTP time server connection failed");
+        return false;
+    }
+
+    client.print("HEAD / HTTP/1.0\r\nHost: ");
+    client.print(host);
+    client.print("\r\nConnection: close\r\n\r\n");
+
+    // Scan response headers for "Date:"
+    char line[96];
+    size_t lineLength = 0;
+    bool found = false;
+    unsigned long startTime = millis();
+
+    while (!found && client.connected() && millis() - startTime < TIME_HTTP_TIMEOUT) {
+        if (!client.available()) {
+            NetEvents::waitForSocket(startTime, TIME_HTTP_TIMEOUT);
+            continue;
+        }
+
+        char c = client.read();
+        if (c == '\r') continue;
+
+        if (c != '\n') {
+            if (lineLength < sizeof(line) - 1) line[lineLength++] = c;
+            continue;
+        }
+
+        line[lineLength] = '\0';
+        if (lineLength == 0) break;  // End of headers
+
+        if (strncasecmp(line, "Date:", 5) == 0) {
+            found = parseHttpDate(line + 5, epoch);
+        }
+        lineLength = 0;
+    }
+
+    client.stop();
+
+    if (!found) {
+        LOG_WARN("time", "HTTP time server sent no usable Date header");
+    }
+    return found && epoch >= TIME_MIN_VALID;
+}
+
+bool Scheduler::parseHttpDate(const char* value, unsigned long& epoch) {
+    // RFC 7231 IMF-fixdate: "Sun, 06 Nov 1994 08:49:37 GMT"
+    const char* comma = strchr(value, ',');
+    if (comma == nullptr) return false;
+
+    int day, year, hour, minute, second;
+    char monthName[4];
+    if (sscanf(comma + 1, " %d %3s %d %d:%d:%d", &day, monthName, &year, &hour, &minute, &second) != 6) {
+        return false;
+    }
+
+    static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    const char* match = strstr(months, monthName);
+    if (match == nullptr || strlen(monthName) != 3 || (match - months) % 3 != 0) {
+        return false;
+    }
+    int month = (match - months) / 3 + 1;
+
+    if (day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60 || year < 1970) {
+        return false;
+    }
+
+    // Days since epoch from civil date (proleptic Gregorian)
+    int y = year - (month <= 2 ? 1 : 0);
+    int era = y / 400;
+    int yearOfEra = y - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    long days = (long)era * 146097 + dayOfEra - 719468;
+
+    epoch = (unsigned long)days * 86400UL + hour * 3600UL + minute * 60UL + second;
+    return true;
+}
+
+void Scheduler::applyTime(unsigned long epoch, TimeSource source) {
+    // Set system time
+    struct timeval tv;
+    tv.tv_sec = epoch;
+    tv.tv_usec = 0;
+    settimeofday(&tv, NULL);
+
+    _initialized = true;
+    _timeSource = source;
+    _lastSyncTime = epoch;
+    // The next-feed cache is keyed on the current minute, so it refreshes by itself
+
+    LOG_INFO("time", "✓ Time synchronized (source: %s)", getTimeSourceName());
+    char timeStr[32];
+    getCurrentTimeStr(timeStr, sizeof(timeStr));
+    LOG_INFO("time", "Current time: %s (timestamp: %lu)", timeStr, epoch);
+
+    persistTime();
+}
+
+void Scheduler::restoreTime() {
+    if (_storage == nullptr || isTimeSynced()) return;
+
+    unsigned long epoch = _storage->loadLastKnownTime();
+    if (epoch < TIME_MIN_VALID) {
+        LOG_INFO("time", "No saved time available - waiting for a time source");
+        return;
+    }
+
+    struct timeval tv;
+    tv.tv_sec = epoch;
+    tv.tv_usec = 0;
+    settimeofday(&tv, NULL);
+
+    _timeSource = TimeSource::RESTORED;
+    _lastSyncTime = epoch;
+
+    char timeStr[32];
+    getCurrentTimeStr(timeStr, sizeof(timeStr));
+    LOG_INFO("time", "Restored last known time: %s (behind by the power-off duration until next sync)", timeStr);
+}
+
+void Scheduler::persistTime() {
+    _lastPersist = millis();
+
+    // A restored time is only saved again once a source has confirmed the clock
+    bool confirmed = (_timeSource != TimeSource::NONE && _timeSource != TimeSource::RESTORED);
+    if (_storage != nullptr && confirmed && isTimeSynced()) {
+        _storage->queueSaveTime(getCurrentTime());
+    }
 }
 
 void Scheduler::update() {
@@ -112,25 +354,87 @@ void Scheduler::update() {
     if (isTimeSynced()) {
         checkDayRollover();
     }
+
+    // Save current time so a reboot can resume from it
+    if (millis() - _lastPersist > TIME_PERSIST_INTERVAL) {
+        persistTime();
+    }
 }
 
-bool Scheduler::shouldFeed(const uint16_t feedTimes[4], uint8_t& feedCycle) {
+bool Scheduler::updateTimeSync(TimeReading& reading) {
+    // Re-sync periodically; retry sooner until a source has answered
+    unsigned long syncInterval = _sourceReached ? NTP_UPDATE_INTERVAL : TIME_RETRY_INTERVAL;
+    if (millis() - _lastSyncAttempt > syncInterval) {
+        return syncTime(reading, 1);
+    }
+    return false;
+}
+
+bool Scheduler::setSchedules(const char schedules[4][48]) {
+    bool allValid = true;
+
+    for (int i = 0; i < 4; i++) {
+        if (!ScheduleExpr::compile(schedules[i], _schedules[i])) {
+            LOG_WARN("time", "Invalid schedule for slot %d: \"%s\" (slot disabled)", i + 1, schedules[i]);
+            allValid = false;
+        }
+    }
+
+    // Slot shares depend on which slots are enabled
+    rebuildFeedCurve();
+
+    // Force next-feed recomputation
+    _nextFeedComputedMinute = 0;
+
+    return allValid;
+}
+
+void Scheduler::setFeedCurve(const Config& config) {
+    _feedCurve.configure(config, _timezoneOffset);
+    rebuildFeedCurve();
+}
+
+bool Scheduler::shouldFeed(uint8_t& feedCycle) {
     if (!isTimeSynced()) {
         return false;
     }
 
-    uint16_t currentMinutes = getCurrentMinutes();
+    // Get UTC time and apply manual offset
+    time_t now = getCurrentTime() + (_timezoneOffset * 3600);
+    struct tm timeinfo;
+    gmtime_r(&now, &timeinfo);
+
+    uint32_t currentMinute = now / 60;
 
-    // Check each feeding time
+    // Check each schedule slot
     for (int i = 0; i < 4; i++) {
-        // Skip if already completed today
-        if (_feedingCompleted[i]) {
+        // A fire more than a day ahead was recorded under a wrong clock since corrected
+        if (_lastFireMinute[i] > currentMinute + 1440) {
+            _lastFireMinute[i] = currentMinute;
+        }
+
+        // Skip if this slot already fired in this minute, or later: the clock
+        // restored after a reboot may be back before the feed that already ran
+        if (currentMinute <= _lastFireMinute[i]) {
             continue;
         }
 
-        // Check if current time matches feeding time (within 1 minute window)
-        if (currentMinutes >= feedTimes[i] && currentMinutes < feedTimes[i] + 1) {
+        if (ScheduleExpr::matches(_schedules[i], timeinfo)) {
+            _lastFireMinute[i] = currentMinute;
             feedCycle = i;
+
+            // A reboot mid-feed must restore at least this far, not the last periodic save
+            // (a restored clock isn't saved, but the fire minute still stops a repeat)
+            if (_storage != nullptr) {
+                _storage->queueSaveFire(i, currentMinute);
+                persistTime();
+            }
+
+            // The curve gives this slot nothing today (share or curve point of 0)
+            if (_feedCurve.isActive() && _feedCurve.getSlotTarget(i, 0) <= 0) {
+                LOG_INFO("feed", "Schedule slot %d skipped - feed curve target is 0", i + 1);
+                continue;
+            }
             return true;
         }
     }
@@ -138,10 +442,49 @@ bool Scheduler::shouldFeed(const uint16_t feedTimes[4], uint8_t& feedCycle) {
     return false;
 }
 
+bool Scheduler::getNextFeed(unsigned long& feedTime, uint8_t& feedCycle) {
+    if (!isTimeSynced()) {
+        return false;
+    }
+
+    unsigned long now = getCurrentTime();
+    uint32_t currentMinute = now / 60;
+
+    if (currentMinute != _nextFeedComputedMinute) {
+        _nextFeedComputedMinute = currentMinute;
+        _nextFeedTime = 0;
+
+        // Schedules are evaluated in local time; include the current minute
+        // so a feed that is due right now is still reported as next
+        time_t localNow = (currentMinute * 60) + (_timezoneOffset * 3600);
+        time_t best = 0;
+
+        for (int i = 0; i < 4; i++) {
+            time_t next;
+            if (ScheduleExpr::nextFire(_schedules[i], localNow, next) && (best == 0 || next < best)) {
+                best = next;
+                _nextFeedCycle = i;
+            }
+        }
+
+        if (best != 0) {
+            _nextFeedTime = best - (_timezoneOffset * 3600);
+        }
+    }
+
+    if (_nextFeedTime == 0) {
+        return false;
+    }
+
+    feedTime = _nextFeedTime;
+    feedCycle = _nextFeedCycle;
+    return true;
+}
+
 void Scheduler::markFeedingComplete(uint8_t feedCycle) {
     if (feedCycle < 4) {
         _feedingCompleted[feedCycle] = true;
-        Serial.printf("Feeding cycle %d marked complete\n", feedCycle);
+        LOG_INFO("time", "Feeding cycle %d marked complete", feedCycle);
     }
 }
 
@@ -151,6 +494,13 @@ unsigned long Scheduler::getCurrentTime() {
     return tv.tv_sec;
 }
 
+unsigned long Scheduler::millisToNextMinute() {
+    // Timezone offset is whole hours, so UTC minute boundaries are local ones too
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (59 - tv.tv_sec % 60) * 1000UL + (1000 - tv.tv_usec / 1000);
+}
+
 void Scheduler::getCurrentTimeStr(char* buffer, size_t size) {
     if (!isTimeSynced()) {
         snprintf(buffer, size, "Time not synced");
@@ -195,17 +545,37 @@ void Scheduler::checkDayRollover() {
 
     if (_lastDay == 0) {
         _lastDay = currentDay;
+        rebuildFeedCurve();
         return;
     }
 
     if (currentDay != _lastDay) {
         // New day - reset all feeding completions
-        Serial.println("New day detected - resetting feeding schedule");
+        LOG_INFO("time", "New day detected - resetting feeding schedule");
         for (int i = 0; i < 4; i++) {
             _feedingCompleted[i] = false;
         }
         _lastDay = currentDay;
+        rebuildFeedCurve();
+    }
+}
+
+void Scheduler::rebuildFeedCurve() {
+    if (!isTimeSynced()) {
+        _feedCurve.clear();
+        return;
+    }
+
+    time_t now = getCurrentTime() + (_timezoneOffset * 3600);
+    struct tm timeinfo;
+    gmtime_r(&now, &timeinfo);
+
+    // Fires per slot on this local day (weekday-only, */2 or twice-daily slots)
+    uint16_t slotFires[4];
+    for (int i = 0; i < 4; i++) {
+        slotFires[i] = ScheduleExpr::firesOnDay(_schedules[i], timeinfo);
     }
+    _feedCurve.rebuild(now / 86400, slotFires);
 }
 
 uint16_t Scheduler::timeToMinutes(uint8_t hour, uint8_t minute) {
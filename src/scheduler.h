@@ -4,23 +4,62 @@
 #include <Arduino.h>
 #include <time.h>
 #include "types.h"
+#include "schedule_expr.h"
+#include "feed_curve.h"
+#include "storage.h"
+#include "bintrac.h"
 
 class Scheduler {
 public:
     Scheduler();
 
-    // Initialize SNTP time sync
-    void begin(int timezoneOffset = 0);
+    // Initialize scheduler and restore last known time from storage (if any)
+    void begin(int timezoneOffset = 0, Storage* storage = nullptr);
 
-    // Start NTP sync (call after network is fully ready)
-    void startNTPSync();
+    // Configure fallback time sources (HTTP Date server, HouseLink clock)
+    void setTimeSources(const Config& config, BinTrac& bintrac);
 
-    // Update time sync status (non-blocking)
+    // Read time from the first reachable source: NTP, HTTP Date header, HouseLink
+    // (notify task, blocks during queries; the control task applies the reading)
+    bool syncTime(TimeReading& reading, uint8_t ntpAttempts = 1);
+
+    // Set the clock from a source reading (control task)
+    void applyTime(const TimeReading& reading);
+
+    // Set time manually (e.g. from the web API, control task)
+    bool setManualTime(unsigned long epoch);
+
+    // Time source status (control task)
+    TimeSource getTimeSource() const { return _timeSource; }
+    const char* getTimeSourceName() const { return timeSourceName(_timeSource); }
+    unsigned long getLastSyncTime() const { return _lastSyncTime; }
+    static const char* timeSourceName(TimeSource source);
+
+    // Day rollover, feed curve refresh and time persistence (control task, non-blocking)
     void update();
 
+    // Periodic re-sync (notify task, blocks during queries)
+    // Returns true with a reading for applyTime() when a source answered
+    bool updateTimeSync(TimeReading& reading);
+
+    // Compile schedule expressions (call at startup and whenever config changes)
+    // Returns false if any expression is invalid (that slot is disabled)
+    bool setSchedules(const char schedules[4][48]);
+
+    // Load flock-age feed curve (call at startup and whenever config changes)
+    void setFeedCurve(const Config& config);
+
+    // Today's target for a slot from the feed curve, or fallback if the curve is inactive
+    float getSlotTarget(uint8_t feedCycle, float fallback) const { return _feedCurve.getSlotTarget(feedCycle, fallback); }
+    const FeedCurve& getFeedCurve() const { return _feedCurve; }
+
     // Check if it's time to feed
     // Returns true and sets feedCycle (0-3) if a feeding should start
-    bool shouldFeed(const uint16_t feedTimes[4], uint8_t& feedCycle);
+    bool shouldFeed(uint8_t& feedCycle);
+
+    // Next scheduled feed across all slots (UTC unix time), recomputed once a minute
+    // Returns false if time is not synced or no slot is enabled
+    bool getNextFeed(unsigned long& feedTime, uint8_t& feedCycle);
 
     // Mark feeding as completed for this cycle
     void markFeedingComplete(uint8_t feedCycle);
@@ -29,6 +68,9 @@ public:
     unsigned long getCurrentTime();  // Unix timestamp
     void getCurrentTimeStr(char* buffer, size_t size);  // Human readable
 
+    // Milliseconds until the clock reaches the next whole minute (schedules fire on minutes)
+    unsigned long millisToNextMinute();
+
     // Time conversion utilities
     static uint16_t timeToMinutes(uint8_t hour, uint8_t minute);
     static void minutesToTime(uint16_t minutes, uint8_t& hour, uint8_t& minute);
@@ -36,10 +78,48 @@ public:
     // Check if time is synchronized
     bool isTimeSynced();
 
+    // Parse an HTTP Date header value (RFC 7231 IMF-fixdate)
+    static bool parseHttpDate(const char* value, unsigned long& epoch);
+
 private:
     bool _initialized;
     int _timezoneOffset;  // hours
 
+    // Time sources
+    Storage* _storage;
+    const Config* _config;
+    BinTrac* _bintrac;
+
+    // Clock state, owned by the control task
+    TimeSource _timeSource;
+    unsigned long _lastSyncTime;     // Unix time of last successful sync
+    unsigned long _lastPersist;      // millis()
+
+    // Sync state, owned by the notify task
+    unsigned long _lastSyncAttempt;  // millis()
+    bool _sourceReached;             // A source has answered since boot
+
+    bool queryNTP(unsigned long& epoch, uint8_t attempts);
+    bool queryHttpDate(unsigned long& epoch);
+    void applyTime(unsigned long epoch, TimeSource source);
+    void restoreTime();
+    void persistTime();
+
+    // Compiled per-slot schedules
+    CompiledSchedule _schedules[4];
+
+    // Local minute (minutes since epoch) each slot last fired, to fire once per match
+    // (kept in NVS: the clock restored after a reboot can be back before it)
+    uint32_t _lastFireMinute[4];
+
+    // Cached next feed (recomputed when the minute changes or schedules change)
+    uint32_t _nextFeedComputedMinute;
+    unsigned long _nextFeedTime;
+    uint8_t _nextFeedCycle;
+
+    // Growth curve with per-day slot targets
+    FeedCurve _feedCurve;
+
     // Track which feedings have been completed today
     bool _feedingCompleted[4];
     uint8_t _lastDay;  // To reset completions at midnight
@@ -49,6 +129,9 @@ private:
 
     // Reset daily tracking at midnight
     void checkDayRollover();
+
+    // Recompute today's feed curve targets
+    void rebuildFeedCurve();
 };
 
 #endif // SCHEDULER_H
@@ -0,0 +1,57 @@
+#include "shared_state.h"
+
+ConfigStore::ConfigStore() {
+    _mutex = nullptr;
+    _generation = 0;
+}
+
+void ConfigStore::begin(const Config& initial) {
+    _mutex = xSemaphoreCreateMutex();
+    _config = initial;
+    _generation = 1;
+}
+
+void ConfigStore::get(Config& out) {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    out = _config;
+    xSemaphoreGive(_mutex);
+}
+
+void ConfigStore::set(const Config& config) {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _config = config;
+    _generation++;
+    xSemaphoreGive(_mutex);
+}
+
+StatusStore::StatusStore() : _sequence(0) {
+    memset(_buffers, 0, sizeof(_buffers));
+}
+
+void StatusStore::publish(const SystemStatus& status) {
+    uint32_t seq = _sequence.load(std::memory_order_relaxed);
+    uint32_t next = (seq >> 1) + 1;
+
+    _sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _buffers[next & 1] = status;
+    _sequence.store(seq + 2, std::memory_order_release);
+}
+
+void StatusStore::read(SystemStatus& out) const {
+    while (true) {
+        uint32_t before = _sequence.load(std::memory_order_acquire);
+        uint32_t published = before >> 1;
+
+        out = _buffers[published & 1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // The buffer we copied is only rewritten by publish (published + 2),
+        // which starts when the sequence reaches 2 * published + 3
+        uint32_t after = _sequence.load(std::memory_order_relaxed);
+        if (after - before <= 2 - (before & 1)) {
+            return;
+        }
+        taskYIELD();
+    }
+}
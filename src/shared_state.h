@@ -0,0 +1,65 @@
+#ifndef SHARED_STATE_H
+#define SHARED_STATE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "types.h"
+
+// Configuration shared between tasks
+// Tasks keep their own copy and refresh it when the generation changes;
+// writers modify under the mutex and then notify the control task.
+class ConfigStore {
+public:
+    ConfigStore();
+
+    // Create mutex and set initial config (call before starting tasks)
+    void begin(const Config& initial);
+
+    // Copy current config
+    void get(Config& out);
+
+    // Replace whole config
+    void set(const Config& config);
+
+    // Read-modify-write under the lock
+    template <typename F>
+    void modify(F fn) {
+        xSemaphoreTake(_mutex, portMAX_DELAY);
+        fn(_config);
+        _generation++;
+        xSemaphoreGive(_mutex);
+    }
+
+    // Incremented on every change
+    uint32_t getGeneration() const { return _generation; }
+
+private:
+    Config _config;
+    SemaphoreHandle_t _mutex;
+    volatile uint32_t _generation;
+};
+
+// System status published by the control task, read by everyone else
+// Seqlock over two buffers: the writer fills the buffer readers are not
+// using, then bumps the sequence. Readers never lock or block the writer;
+// they retry only if two publishes land while they are copying.
+// Single writer only (the control task).
+class StatusStore {
+public:
+    StatusStore();
+
+    // Publish a new status (control task only)
+    void publish(const SystemStatus& status);
+
+    // Copy latest complete status
+    void read(SystemStatus& out) const;
+
+private:
+    // Even = publish N complete in _buffers[N & 1]; odd = writing the other buffer
+    std::atomic<uint32_t> _sequence;
+    SystemStatus _buffers[2];
+};
+
+#endif // SHARED_STATE_H
@@ -0,0 +1,125 @@
+#include "socket_budget.h"
+#include "config.h"
+#include "logger.h"
+#include <Ethernet.h>
+#include <utility/w5100.h>
+
+static_assert(SOCKET_RESERVE_WEB + SOCKET_RESERVE_MODBUS + SOCKET_RESERVE_TELEGRAM + SOCKET_RESERVE_MQTT +
+              SOCKET_RESERVE_TIME + SOCKET_RESERVE_COORDINATOR + SOCKET_RESERVE_LOG + SOCKET_RESERVE_INFLUX <= MAX_SOCK_NUM,
+              "Socket reservations exceed the W5500's hardware sockets");
+
+SocketBudget::UserStats SocketBudget::_users[(int)SocketUser::COUNT] = {
+    {SOCKET_RESERVE_WEB, 0, 0, 0, 0},
+    {SOCKET_RESERVE_MODBUS, 0, 0, 0, 0},
+    {SOCKET_RESERVE_TELEGRAM, 0, 0, 0, 0},
+    {SOCKET_RESERVE_MQTT, 0, 0, 0, 0},
+    {SOCKET_RESERVE_TIME, 0, 0, 0, 0},
+    {SOCKET_RESERVE_COORDINATOR, 0, 0, 0, 0},
+    {SOCKET_RESERVE_LOG, 0, 0, 0, 0},
+    {SOCKET_RESERVE_INFLUX, 0, 0, 0, 0},
+};
+uint8_t SocketBudget::_hardwareInUse = 0;
+uint8_t SocketBudget::_hardwarePeak = 0;
+portMUX_TYPE SocketBudget::_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint8_t sharedTotal() {
+    return MAX_SOCK_NUM - (SOCKET_RESERVE_WEB + SOCKET_RESERVE_MODBUS + SOCKET_RESERVE_TELEGRAM + SOCKET_RESERVE_MQTT +
+                           SOCKET_RESERVE_TIME + SOCKET_RESERVE_COORDINATOR + SOCKET_RESERVE_LOG +
+                           SOCKET_RESERVE_INFLUX);
+}
+
+bool SocketBudget::acquire(SocketUser user) {
+    UserStats& stats = _users[(int)user];
+    bool granted;
+
+    portENTER_CRITICAL(&_lock);
+    granted = stats.inUse < stats.reserved ||
+              sharedInUse(SocketUser::COUNT) < sharedTotal();
+    if (granted) {
+        stats.inUse++;
+        stats.granted++;
+        if (stats.inUse > stats.peak) stats.peak = stats.inUse;
+    } else {
+        stats.denied++;
+    }
+    portEXIT_CRITICAL(&_lock);
+
+    // Syslog retries on its next drain; logging its denial would trigger another drain
+    if (!granted && user != SocketUser::LOG) {
+        LOG_WARN("net", "Socket budget: %s denied (%d in use)", userName(user), stats.inUse);
+    }
+    return granted;
+}
+
+void SocketBudget::release(SocketUser user) {
+    portENTER_CRITICAL(&_lock);
+    UserStats& stats = _users[(int)user];
+    if (stats.inUse > 0) stats.inUse--;
+    portEXIT_CRITICAL(&_lock);
+}
+
+uint8_t SocketBudget::scanHardware(uint16_t webPort) {
+    uint8_t busy = 0;
+    uint8_t web = 0;
+
+    for (uint8_t s = 0; s < MAX_SOCK_NUM; s++) {
+        if (W5100.readSnSR(s) == SnSR::CLOSED) continue;
+        busy++;
+        if (EthernetServer::server_port[s] == webPort) web++;
+    }
+
+    portENTER_CRITICAL(&_lock);
+    _hardwareInUse = busy;
+    if (busy > _hardwarePeak) _hardwarePeak = busy;
+
+    UserStats& stats = _users[(int)SocketUser::WEB];
+    if (web > stats.inUse) stats.granted += web - stats.inUse;  // Each new web socket counts as a grant
+    stats.inUse = web;
+    if (web > stats.peak) stats.peak = web;
+    portEXIT_CRITICAL(&_lock);
+
+    return web;
+}
+
+uint8_t SocketBudget::webLimit() {
+    portENTER_CRITICAL(&_lock);
+    uint8_t others = sharedInUse(SocketUser::WEB);
+    uint8_t limit = _users[(int)SocketUser::WEB].reserved + (others < sharedTotal() ? sharedTotal() - others : 0);
+    portEXIT_CRITICAL(&_lock);
+    return limit;
+}
+
+void SocketBudget::getStats(Stats& stats) {
+    portENTER_CRITICAL(&_lock);
+    memcpy(stats.users, _users, sizeof(stats.users));
+    stats.hardwareInUse = _hardwareInUse;
+    stats.hardwarePeak = _hardwarePeak;
+    portEXIT_CRITICAL(&_lock);
+    stats.shared = sharedTotal();
+}
+
+const char* SocketBudget::userName(SocketUser user) {
+    switch (user) {
+        case SocketUser::WEB:         return "web";
+        case SocketUser::MODBUS:      return "modbus";
+        case SocketUser::TELEGRAM:    return "telegram";
+        case SocketUser::MQTT:        return "mqtt";
+        case SocketUser::TIME:        return "time";
+        case SocketUser::COORDINATOR: return "coordinator";
+        case SocketUser::LOG:         return "log";
+        case SocketUser::INFLUX:      return "influx";
+        default:                      return "unknown";
+    }
+}
+
+// Shared sockets borrowed by everyone but 'except' (caller holds _lock)
+uint8_t SocketBudget::sharedInUse(SocketUser except) {
+    uint8_t borrowed = 0;
+    for (int i = 0; i < (int)SocketUser::COUNT; i++) {
+        if (i == (int)except) continue;
+        if (_users[i].inUse > _users[i].reserved) {
+            borrowed += _users[i].inUse - _users[i].reserved;
+        }
+    }
+    return borrowed;
+}
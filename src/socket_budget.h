@@ -0,0 +1,84 @@
+#ifndef SOCKET_BUDGET_H
+#define SOCKET_BUDGET_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+
+// Subsystems sharing the W5500's hardware sockets
+enum class SocketUser : uint8_t {
+    WEB,          // HTTP server (listener and accepted clients)
+    MODBUS,       // BinTrac reads and HouseLink clock
+    TELEGRAM,     // Bot TLS connection
+    MQTT,         // Telemetry broker connection
+    TIME,         // NTP UDP and HTTP Date queries
+    COORDINATOR,  // Start coordination multicast
+    LOG,          // Syslog UDP
+    INFLUX,       // InfluxDB HTTP pushes
+    COUNT
+};
+
+// Per-subsystem socket reservations on the W5500
+// Each subsystem is guaranteed its reserved sockets; sockets left over make
+// a shared pool anyone may borrow from. Outbound users lease a socket before
+// connecting; the web server is counted from the hardware (the Ethernet
+// library opens its listeners itself) and stops listening at its limit, so a
+// burst of HTTP clients can't starve Modbus.
+class SocketBudget {
+public:
+    struct UserStats {
+        uint8_t reserved;
+        uint8_t inUse;
+        uint8_t peak;
+        uint32_t granted;
+        uint32_t denied;
+    };
+
+    struct Stats {
+        UserStats users[(int)SocketUser::COUNT];
+        uint8_t shared;          // Sockets not reserved by anyone
+        uint8_t hardwareInUse;   // W5500 sockets not CLOSED at the last scan
+        uint8_t hardwarePeak;
+    };
+
+    // Take / give back a socket for an outbound connection or UDP socket
+    // Returns false (and counts a denial) if the user's reservation and the
+    // shared pool are exhausted
+    static bool acquire(SocketUser user);
+    static void release(SocketUser user);
+
+    // Count open W5500 sockets and those owned by the web server on webPort
+    // (caller holds the NetLock). Returns the web server's socket count.
+    static uint8_t scanHardware(uint16_t webPort);
+
+    // Sockets the web server may hold right now (its reservation plus free shared sockets)
+    static uint8_t webLimit();
+
+    static void getStats(Stats& stats);
+    static const char* userName(SocketUser user);
+
+private:
+    static UserStats _users[(int)SocketUser::COUNT];
+    static uint8_t _hardwareInUse;
+    static uint8_t _hardwarePeak;
+    static portMUX_TYPE _lock;
+
+    static uint8_t sharedInUse(SocketUser except);
+};
+
+// Holds a socket lease for its lifetime (UDP sockets opened and closed in one scope)
+class SocketLease {
+public:
+    explicit SocketLease(SocketUser user) : _user(user), _held(SocketBudget::acquire(user)) {}
+    ~SocketLease() { if (_held) SocketBudget::release(_user); }
+
+    bool held() const { return _held; }
+
+private:
+    SocketUser _user;
+    bool _held;
+
+    SocketLease(const SocketLease&) = delete;
+    SocketLease& operator=(const SocketLease&) = delete;
+};
+
+#endif // SOCKET_BUDGET_H
@@ -0,0 +1,269 @@
+#include "start_coordinator.h"
+#include "net_lock.h"
+#include "socket_budget.h"
+#include "logger.h"
+
+// Packet layout (big-endian): magic[4] version type instance[2] nodeId[4] minute[4]
+// instance is random per boot (0 from older firmware): it tells our own
+// multicast loopback apart from another controller using the same node ID
+static const uint8_t COORD_MAGIC[4] = {'F', 'B', 'W', 'C'};
+static const uint8_t COORD_VERSION = 1;
+static const int COORD_PACKET_SIZE = 16;
+
+enum CoordPacketType : uint8_t {
+    COORD_HELLO = 1,  // minute = next scheduled start
+    COORD_CLAIM = 2   // minute = start being claimed now
+};
+
+static void put32(uint8_t* p, uint32_t value) {
+    p[0] = (value >> 24) & 0xFF;
+    p[1] = (value >> 16) & 0xFF;
+    p[2] = (value >> 8) & 0xFF;
+    p[3] = value & 0xFF;
+}
+
+static uint32_t get32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+StartCoordinator::StartCoordinator() {
+    _running = false;
+    _nodeId = 0;
+    _staggerSeconds = 5;
+    _nextStartMinute = 0;
+    _lastHello = 0;
+    _pendingClaimMinute = 0;
+    _instance = 0;
+    memset(_peers, 0, sizeof(_peers));
+    _lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+bool StartCoordinator::begin(uint32_t nodeId, uint16_t staggerSeconds) {
+    NetLock lock;
+
+    _nodeId = nodeId != 0 ? nodeId : deriveNodeId();
+    _staggerSeconds = staggerSeconds;
+    do {
+        _instance = (uint16_t)esp_random();
+    } while (_instance == 0);
+
+    // The multicast socket stays open for as long as we run
+    if (!SocketBudget::acquire(SocketUser::COORDINATOR)) {
+        _running = false;
+        return false;
+    }
+
+    IPAddress group(COORD_MULTICAST_IP);
+    if (!_udp.beginMulticast(group, COORD_PORT)) {
+        LOG_WARN("coord", "Start coordinator: failed to join multicast group");
+        SocketBudget::release(SocketUser::COORDINATOR);
+        _running = false;
+        return false;
+    }
+
+    _running = true;
+    LOG_INFO("coord", "Start coordinator: node %08lX, stagger %ds", (unsigned long)_nodeId, _staggerSeconds);
+
+    // Announce immediately so peers learn about us before the next feed
+    sendPacket(COORD_HELLO, _nextStartMinute);
+    _lastHello = millis();
+    return true;
+}
+
+void StartCoordinator::end() {
+    if (!_running) return;
+
+    NetLock lock;
+    _udp.stop();
+    SocketBudget::release(SocketUser::COORDINATOR);
+    _running = false;
+
+    portENTER_CRITICAL(&_lock);
+    memset(_peers, 0, sizeof(_peers));
+    _pendingClaimMinute = 0;
+    portEXIT_CRITICAL(&_lock);
+    LOG_INFO("coord", "Start coordinator stopped");
+}
+
+void StartCoordinator::update(uint32_t nextStartMinute) {
+    if (!_running) return;
+
+    NetLock lock;
+
+    // Drain all pending packets
+    uint8_t buffer[COORD_PACKET_SIZE];
+    int size;
+    while ((size = _udp.parsePacket()) > 0) {
+        int length = _udp.read(buffer, sizeof(buffer));
+        handlePacket(buffer, length);
+    }
+
+    // CLAIM queued by claimStart()
+    portENTER_CRITICAL(&_lock);
+    uint32_t claimMinute = _pendingClaimMinute;
+    _pendingClaimMinute = 0;
+    portEXIT_CRITICAL(&_lock);
+    if (claimMinute != 0) {
+        sendPacket(COORD_CLAIM, claimMinute);
+    }
+
+    // Announce immediately when our next start changes, otherwise periodically
+    if (nextStartMinute != _nextStartMinute || millis() - _lastHello > COORD_HELLO_INTERVAL) {
+        _nextStartMinute = nextStartMinute;
+        sendPacket(COORD_HELLO, _nextStartMinute);
+        _lastHello = millis();
+        expirePeers();
+    }
+}
+
+unsigned long StartCoordinator::claimStart(uint32_t startMinute, uint16_t staggerSeconds) {
+    if (!_running) return 0;
+
+    _staggerSeconds = staggerSeconds;
+
+    // Rank = number of live contenders for this minute with a lower node ID
+    // (peers announce their next start ahead of time via HELLO)
+    uint8_t rank = 0;
+    uint8_t contenders = 1;
+
+    portENTER_CRITICAL(&_lock);
+    _pendingClaimMinute = startMinute;
+    for (int i = 0; i < COORD_MAX_PEERS; i++) {
+        const Peer& peer = _peers[i];
+        if (peer.nodeId == 0) continue;
+        if (peer.nextStartMinute != startMinute && peer.claimedMinute != startMinute) continue;
+
+        contenders++;
+        if (peer.nodeId < _nodeId) {
+            rank++;
+        }
+    }
+    portEXIT_CRITICAL(&_lock);
+
+    LOG_INFO("coord", "Start coordinator: rank %d of %d for minute %lu",
+                  rank + 1, contenders, (unsigned long)startMinute);
+
+    return (unsigned long)rank * _staggerSeconds * 1000UL;
+}
+
+uint8_t StartCoordinator::getPeerCount() {
+    expirePeers();
+
+    uint8_t count = 0;
+    portENTER_CRITICAL(&_lock);
+    for (int i = 0; i < COORD_MAX_PEERS; i++) {
+        if (_peers[i].nodeId != 0) count++;
+    }
+    portEXIT_CRITICAL(&_lock);
+    return count;
+}
+
+void StartCoordinator::sendPacket(uint8_t type, uint32_t minute) {
+    uint8_t packet[COORD_PACKET_SIZE];
+    memcpy(packet, COORD_MAGIC, 4);
+    packet[4] = COORD_VERSION;
+    packet[5] = type;
+    packet[6] = _instance >> 8;
+    packet[7] = _instance & 0xFF;
+    put32(packet + 8, _nodeId);
+    put32(packet + 12, minute);
+
+    IPAddress group(COORD_MULTICAST_IP);
+    if (_udp.beginPacket(group, COORD_PORT) == 0) {
+        return;
+    }
+    _udp.write(packet, COORD_PACKET_SIZE);
+    _udp.endPacket();
+}
+
+void StartCoordinator::handlePacket(const uint8_t* data, int length) {
+    if (length < COORD_PACKET_SIZE) return;
+    if (memcmp(data, COORD_MAGIC, 4) != 0 || data[4] != COORD_VERSION) return;
+
+    uint16_t instance = ((uint16_t)data[6] << 8) | data[7];
+    uint32_t nodeId = get32(data + 8);
+    uint32_t minute = get32(data + 12);
+
+    if (nodeId == 0) return;
+    if (nodeId == _nodeId) {
+        // Our own multicast loopback
+        if (instance == _instance) return;
+
+        // Another controller with our ID: neither could rank the other, so
+        // move to a random ID (the new one goes out with the next HELLO)
+        uint32_t newId;
+        do {
+            newId = esp_random();
+        } while (newId == 0 || newId == nodeId);
+        LOG_WARN("coord", "Start coordinator: another controller uses node %08lX - now %08lX",
+                 (unsigned long)nodeId, (unsigned long)newId);
+        portENTER_CRITICAL(&_lock);
+        _nodeId = newId;
+        portEXIT_CRITICAL(&_lock);
+        _lastHello = millis() - COORD_HELLO_INTERVAL - 1;  // Announce on this update()
+        return;
+    }
+
+    bool joined = false;
+    portENTER_CRITICAL(&_lock);
+    Peer* peer = findPeer(nodeId, true, joined);
+    if (peer != nullptr) {
+        peer->lastSeen = millis();
+        if (data[5] == COORD_HELLO) {
+            peer->nextStartMinute = minute;
+        } else if (data[5] == COORD_CLAIM) {
+            peer->claimedMinute = minute;
+        }
+    }
+    portEXIT_CRITICAL(&_lock);
+
+    if (joined) {
+        LOG_INFO("coord", "Start coordinator: peer %08lX joined", (unsigned long)nodeId);
+    }
+}
+
+StartCoordinator::Peer* StartCoordinator::findPeer(uint32_t nodeId, bool create, bool& created) {
+    Peer* freeSlot = nullptr;
+    created = false;
+
+    for (int i = 0; i < COORD_MAX_PEERS; i++) {
+        if (_peers[i].nodeId == nodeId) {
+            return &_peers[i];
+        }
+        if (_peers[i].nodeId == 0 && freeSlot == nullptr) {
+            freeSlot = &_peers[i];
+        }
+    }
+
+    if (create && freeSlot != nullptr) {
+        memset(freeSlot, 0, sizeof(Peer));
+        freeSlot->nodeId = nodeId;
+        created = true;
+    }
+    return create ? freeSlot : nullptr;
+}
+
+void StartCoordinator::expirePeers() {
+    for (int i = 0; i < COORD_MAX_PEERS; i++) {
+        uint32_t expired = 0;
+
+        portENTER_CRITICAL(&_lock);
+        if (_peers[i].nodeId != 0 && millis() - _peers[i].lastSeen > COORD_PEER_TIMEOUT) {
+            expired = _peers[i].nodeId;
+            _peers[i].nodeId = 0;
+        }
+        portEXIT_CRITICAL(&_lock);
+
+        if (expired != 0) {
+            LOG_INFO("coord", "Start coordinator: peer %08lX timed out", (unsigned long)expired);
+        }
+    }
+}
+
+uint32_t StartCoordinator::deriveNodeId() {
+    // The W5500 MAC and the IP come from config.h and are the same on every
+    // board; the ESP32's factory MAC isn't. Its last four bytes (bytes 0-5 sit
+    // lowest first) hold the 3-byte device part.
+    uint32_t id = (uint32_t)(ESP.getEfuseMac() >> 16);
+    return id != 0 ? id : 1;
+}
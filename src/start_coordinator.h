@@ -0,0 +1,70 @@
+#ifndef START_COORDINATOR_H
+#define START_COORDINATOR_H
+
+#include <Arduino.h>
+#include <Ethernet.h>
+#include <EthernetUdp.h>
+#include "config.h"
+
+// Leaderless motor-start coordination between controllers on the same LAN
+// Each controller multicasts a HELLO with its node ID and next scheduled start
+// minute. When a feed is due, every controller that shares that start minute
+// ranks itself by node ID among the contenders it has heard from and delays
+// its start by rank * stagger, so motor inrush is spread without a master.
+// A controller that hears its own node ID from another one moves to a random
+// ID, so a duplicated configured ID can't silently disable the stagger.
+//
+// begin()/update() do the network I/O and run in the network task;
+// claimStart() only reads the peer table, so the control task can call it
+// without touching the socket (the CLAIM goes out on the next update()).
+class StartCoordinator {
+public:
+    StartCoordinator();
+
+    // Join multicast group (call after network is up)
+    // nodeId 0 = derive from the ESP32's factory MAC
+    bool begin(uint32_t nodeId, uint16_t staggerSeconds);
+
+    // Leave the group and give the socket back (coordination disabled)
+    void end();
+
+    // Process incoming packets and send periodic HELLO (call frequently)
+    // nextStartMinute = UTC minute (unix time / 60) of next scheduled feed, 0 if none
+    void update(uint32_t nextStartMinute);
+
+    // Claim a start slot for this UTC minute, returns delay in milliseconds
+    unsigned long claimStart(uint32_t startMinute, uint16_t staggerSeconds);
+
+    uint32_t getNodeId() const { return _nodeId; }
+
+    // Node ID from the ESP32's factory (efuse) MAC, unique per board
+    static uint32_t deriveNodeId();
+    uint8_t getPeerCount();
+    bool isRunning() const { return _running; }
+
+private:
+    struct Peer {
+        uint32_t nodeId;
+        uint32_t nextStartMinute;  // From last HELLO
+        uint32_t claimedMinute;    // From last CLAIM
+        unsigned long lastSeen;
+    };
+
+    EthernetUDP _udp;
+    bool _running;
+    uint32_t _nodeId;
+    uint16_t _staggerSeconds;
+    uint32_t _nextStartMinute;
+    unsigned long _lastHello;
+    uint32_t _pendingClaimMinute;  // CLAIM waiting to be sent, 0 = none
+    uint16_t _instance;            // Random per begin(), recognizes our own loopback
+    Peer _peers[COORD_MAX_PEERS];
+    portMUX_TYPE _lock;            // Guards peer table and pending claim
+
+    void sendPacket(uint8_t type, uint32_t minute);
+    void handlePacket(const uint8_t* data, int length);
+    Peer* findPeer(uint32_t nodeId, bool create, bool& created);
+    void expirePeers();
+};
+
+#endif // START_COORDINATOR_H
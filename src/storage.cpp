@@ -3,37 +3,77 @@
 #include <LittleFS.h>
 #include <ArduinoJson.h>
 #include <Preferences.h>
+#include "schedule_expr.h"
+#include "loop_profiler.h"
+#include "logger.h"
 
 Preferences prefs;
 
 Storage::Storage() {
     _initialized = false;
+    _lock = nullptr;
+    _queue = nullptr;
+    _configPending = false;
+#if FEATURE_HISTORY
+    _historyGeneration = 0;
+#endif
 }
 
 bool Storage::begin() {
+    _lock = xSemaphoreCreateRecursiveMutex();
+    _queue = xQueueCreate(STORAGE_QUEUE_LENGTH, sizeof(Request));
+
     if (!LittleFS.begin(true)) {  // true = format on fail
-        Serial.println("LittleFS mount failed");
+        LOG_ERROR("storage", "LittleFS mount failed");
         return false;
     }
 
     _initialized = true;
-    Serial.println("LittleFS initialized");
+    LOG_INFO("storage", "LittleFS initialized");
     printFileSystemInfo();
 
+#if FEATURE_HISTORY
+    // The generation counter lives in NVS so a reformatted or uploaded
+    // filesystem (no marker) can't reuse one a client still holds
+    lock();
+    if (LittleFS.exists(HISTORY_MARKER_FILE)) {
+        prefs.begin("history", true);
+        _historyGeneration = prefs.getULong("gen", 0);
+        prefs.end();
+    }
+    if (_historyGeneration == 0) {
+        newHistoryGeneration();
+    }
+    unlock();
+#endif
+
     return true;
 }
 
 bool Storage::loadConfig(Config& config) {
+    lock();
     prefs.begin("config", true);  // read-only
 
     // Network
     strlcpy(config.bintracIP, prefs.getString("bintracIP", "192.168.1.100").c_str(), sizeof(config.bintracIP));
     config.bintracDeviceID = prefs.getUChar("bintracID", 1);
+    strlcpy(config.timeHttpServer, prefs.getString("timeHttp", "").c_str(), sizeof(config.timeHttpServer));
+    config.houseLinkTimeAddr = prefs.getUShort("hlTimeAddr", 0);
 
-    // Schedule - feed times (4 values)
+    // Schedule - feed schedule expressions (4 slots)
     for (int i = 0; i < 4; i++) {
-        String key = "feedTime" + String(i);
-        config.feedTimes[i] = prefs.getUShort(key.c_str(), config.feedTimes[i]);
+        char key[16];
+        snprintf(key, sizeof(key), "feedSched%d", i);
+        if (prefs.isKey(key)) {
+            strlcpy(config.feedSchedules[i], prefs.getString(key, "").c_str(), sizeof(config.feedSchedules[i]));
+        } else {
+            // Migrate legacy feed time (minutes from midnight) to a daily expression
+            snprintf(key, sizeof(key), "feedTime%d", i);
+            if (prefs.isKey(key)) {
+                ScheduleExpr::fromMinutes(prefs.getUShort(key, 0),
+                                          config.feedSchedules[i], sizeof(config.feedSchedules[i]));
+            }
+        }
     }
 
     // Feeding parameters
@@ -41,6 +81,13 @@ bool Storage::loadConfig(Config& config) {
     config.weightUnit = (WeightUnit)prefs.getUChar("weightUnit", 0);
     config.chainPreRunTime = prefs.getUShort("chainPreRun", 10);
 
+    // Feed curve
+    config.feedCurveEnabled = prefs.getBool("curveEn", false);
+    config.flockStartDate = prefs.getULong("flockStart", 0);
+    config.feedCurvePoints = min(prefs.getUChar("curvePts", 0), (uint8_t)FEED_CURVE_MAX_POINTS);
+    prefs.getBytes("curve", config.feedCurve, sizeof(config.feedCurve));
+    prefs.getBytes("slotShare", config.slotShare, sizeof(config.slotShare));
+
     // Alarm settings
     config.alarmThreshold = prefs.getFloat("alarmThresh", 10.0);
     config.maxRuntime = prefs.getUShort("maxRuntime", 600);
@@ -55,27 +102,48 @@ bool Storage::loadConfig(Config& config) {
     strlcpy(config.telegramAllowedUsers, prefs.getString("tgAllowed", "").c_str(), sizeof(config.telegramAllowedUsers));
     config.telegramEnabled = prefs.getBool("tgEnabled", false);
 
+    // MQTT
+    strlcpy(config.mqttBroker, prefs.getString("mqttHost", "").c_str(), sizeof(config.mqttBroker));
+    strlcpy(config.mqttUser, prefs.getString("mqttUser", "").c_str(), sizeof(config.mqttUser));
+    strlcpy(config.mqttPassword, prefs.getString("mqttPass", "").c_str(), sizeof(config.mqttPassword));
+    strlcpy(config.mqttTopic, prefs.getString("mqttTopic", "").c_str(), sizeof(config.mqttTopic));
+    config.mqttEnabled = prefs.getBool("mqttEn", false);
+    strlcpy(config.influxServer, prefs.getString("influxHost", "").c_str(), sizeof(config.influxServer));
+    strlcpy(config.influxPath, prefs.getString("influxPath", "").c_str(), sizeof(config.influxPath));
+    strlcpy(config.influxToken, prefs.getString("influxToken", "").c_str(), sizeof(config.influxToken));
+    config.influxEnabled = prefs.getBool("influxEn", false);
+
+    // Start coordination
+    config.coordEnabled = prefs.getBool("coordEn", false);
+    config.coordStaggerTime = prefs.getUShort("coordStagger", 5);
+    config.coordNodeId = prefs.getULong("coordNode", 0);
+
     // System
     config.autoFeedEnabled = prefs.getBool("autoFeed", true);
     config.timezone = prefs.getChar("timezone", 0);
 
     prefs.end();
+    unlock();
 
-    Serial.println("Config loaded from NVS");
+    LOG_INFO("storage", "Config loaded from NVS");
     return true;
 }
 
 bool Storage::saveConfig(const Config& config) {
+    lock();
     prefs.begin("config", false);  // read-write
 
     // Network
     prefs.putString("bintracIP", config.bintracIP);
     prefs.putUChar("bintracID", config.bintracDeviceID);
+    prefs.putString("timeHttp", config.timeHttpServer);
+    prefs.putUShort("hlTimeAddr", config.houseLinkTimeAddr);
 
-    // Schedule - feed times (4 values)
+    // Schedule - feed schedule expressions (4 slots)
     for (int i = 0; i < 4; i++) {
-        String key = "feedTime" + String(i);
-        prefs.putUShort(key.c_str(), config.feedTimes[i]);
+        char key[16];
+        snprintf(key, sizeof(key), "feedSched%d", i);
+        prefs.putString(key, config.feedSchedules[i]);
     }
 
     // Feeding parameters
@@ -83,6 +151,13 @@ bool Storage::saveConfig(const Config& config) {
     prefs.putUChar("weightUnit", (uint8_t)config.weightUnit);
     prefs.putUShort("chainPreRun", config.chainPreRunTime);
 
+    // Feed curve
+    prefs.putBool("curveEn", config.feedCurveEnabled);
+    prefs.putULong("flockStart", config.flockStartDate);
+    prefs.putUChar("curvePts", config.feedCurvePoints);
+    prefs.putBytes("curve", config.feedCurve, sizeof(config.feedCurve));
+    prefs.putBytes("slotShare", config.slotShare, sizeof(config.slotShare));
+
     // Alarm settings
     prefs.putFloat("alarmThresh", config.alarmThreshold);
     prefs.putUShort("maxRuntime", config.maxRuntime);
@@ -97,25 +172,87 @@ bool Storage::saveConfig(const Config& config) {
     prefs.putString("tgAllowed", config.telegramAllowedUsers);
     prefs.putBool("tgEnabled", config.telegramEnabled);
 
+    // MQTT
+    prefs.putString("mqttHost", config.mqttBroker);
+    prefs.putString("mqttUser", config.mqttUser);
+    prefs.putString("mqttPass", config.mqttPassword);
+    prefs.putString("mqttTopic", config.mqttTopic);
+    prefs.putBool("mqttEn", config.mqttEnabled);
+    prefs.putString("influxHost", config.influxServer);
+    prefs.putString("influxPath", config.influxPath);
+    prefs.putString("influxToken", config.influxToken);
+    prefs.putBool("influxEn", config.influxEnabled);
+
+    // Start coordination
+    prefs.putBool("coordEn", config.coordEnabled);
+    prefs.putUShort("coordStagger", config.coordStaggerTime);
+    prefs.putULong("coordNode", config.coordNodeId);
+
     // System
     prefs.putBool("autoFeed", config.autoFeedEnabled);
     prefs.putChar("timezone", config.timezone);
 
     prefs.end();
+    unlock();
+
+    LOG_INFO("storage", "Config saved to NVS");
+    return true;
+}
+
+bool Storage::saveLastKnownTime(unsigned long epoch) {
+    lock();
+    prefs.begin("time", false);
+    prefs.putULong("epoch", epoch);
+    prefs.end();
+    unlock();
+    return true;
+}
+
+unsigned long Storage::loadLastKnownTime() {
+    lock();
+    prefs.begin("time", true);
+    unsigned long epoch = prefs.getULong("epoch", 0);
+    prefs.end();
+    unlock();
+    return epoch;
+}
 
-    Serial.println("Config saved to NVS");
+bool Storage::saveLastFireMinute(uint8_t slot, uint32_t minute) {
+    char key[8];
+    snprintf(key, sizeof(key), "fire%u", slot);
+
+    lock();
+    prefs.begin("time", false);
+    prefs.putULong(key, minute);
+    prefs.end();
+    unlock();
     return true;
 }
 
+uint32_t Storage::loadLastFireMinute(uint8_t slot) {
+    char key[8];
+    snprintf(key, sizeof(key), "fire%u", slot);
+
+    lock();
+    prefs.begin("time", true);
+    uint32_t minute = prefs.getULong(key, 0);
+    prefs.end();
+    unlock();
+    return minute;
+}
+
 // Removed configToJson and jsonToConfig - no longer needed with NVS
 
+#if FEATURE_HISTORY
 bool Storage::addFeedEvent(const FeedEvent& event) {
     if (!_initialized) return false;
 
     // Append to CSV file
+    lock();
     File file = LittleFS.open(HISTORY_FILE, "a");
     if (!file) {
-        Serial.println("Failed to open history file");
+        unlock();
+        LOG_WARN("storage", "Failed to open history file");
         return false;
     }
 
@@ -130,6 +267,7 @@ bool Storage::addFeedEvent(const FeedEvent& event) {
                 event.alarmReason);
 
     file.close();
+    unlock();
 
     // TODO: Implement circular buffer (keep only last MAX_HISTORY_ENTRIES)
     // This would require reading the file, removing oldest entries if > MAX_HISTORY_ENTRIES
@@ -137,79 +275,286 @@ bool Storage::addFeedEvent(const FeedEvent& event) {
     return true;
 }
 
-bool Storage::getFeedHistory(FeedEvent* events, int& count, int maxCount) {
+bool Storage::getFeedHistory(FeedEvent* events, int& count, int maxCount, size_t* cursor,
+                             uint32_t* generation) {
     if (!_initialized) return false;
 
+    lock();
+    if (generation != nullptr) {
+        if (cursor != nullptr && *generation != 0 && *generation != _historyGeneration) {
+            *cursor = 0;  // Cleared since that cursor was handed out
+        }
+        *generation = _historyGeneration;
+    }
+
     if (!LittleFS.exists(HISTORY_FILE)) {
+        unlock();
         count = 0;
+        if (cursor != nullptr) *cursor = 0;
         return true;
     }
 
     File file = LittleFS.open(HISTORY_FILE, "r");
     if (!file) {
-        Serial.println("Failed to open history file");
+        unlock();
+        LOG_WARN("storage", "Failed to open history file");
         return false;
     }
 
+    // The cursor is a byte offset at the start of a line (the file only grows
+    // within a generation)
+    if (cursor != nullptr && *cursor <= file.size()) {
+        file.seek(*cursor);
+    }
+
     count = 0;
-    String line;
+    char line[HISTORY_LINE_MAX];
 
-    // Read lines and parse (note: this reads from beginning, should read from end for latest)
+    // Read lines and parse, oldest first (page through with the cursor)
     while (file.available() && count < maxCount) {
-        line = file.readStringUntil('\n');
-        line.trim();
+        size_t len = file.readBytesUntil('\n', line, sizeof(line) - 1);
+        line[len] = '\0';
+        while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == ' ')) line[--len] = '\0';
+
+        if (len == 0) continue;
+
+        // Parse CSV in place: timestamp,cycle,target,actual,duration,alarm,reason
+        FeedEvent& event = events[count];
+        char* p = line;
+        event.timestamp = strtoul(p, &p, 10);
+        if (*p == ',') p++;
+        event.feedCycle = strtol(p, &p, 10);
+        if (*p == ',') p++;
+        event.targetWeight = strtof(p, &p);
+        if (*p == ',') p++;
+        event.actualWeight = strtof(p, &p);
+        if (*p == ',') p++;
+        event.duration = strtol(p, &p, 10);
+        if (*p == ',') p++;
+        event.alarmTriggered = strtol(p, &p, 10) == 1;
+        if (*p == ',') p++;
+        strlcpy(event.alarmReason, p, sizeof(event.alarmReason));
 
-        if (line.length() == 0) continue;
+        count++;
+    }
 
-        // Parse CSV: timestamp,cycle,target,actual,duration,alarm,reason
-        int pos = 0;
-        int nextPos;
+    if (cursor != nullptr) *cursor = file.position();
+    file.close();
+    unlock();
+    return true;
+}
 
-        nextPos = line.indexOf(',', pos);
-        events[count].timestamp = line.substring(pos, nextPos).toInt();
-        pos = nextPos + 1;
+bool Storage::clearHistory() {
+    if (!_initialized) return false;
 
-        nextPos = line.indexOf(',', pos);
-        events[count].feedCycle = line.substring(pos, nextPos).toInt();
-        pos = nextPos + 1;
+    lock();
+    bool success = !LittleFS.exists(HISTORY_FILE) || LittleFS.remove(HISTORY_FILE);
+    if (success) {
+        newHistoryGeneration();
+    }
+    unlock();
+    return success;
+}
 
-        nextPos = line.indexOf(',', pos);
-        events[count].targetWeight = line.substring(pos, nextPos).toFloat();
-        pos = nextPos + 1;
+// Call with the lock held
+void Storage::newHistoryGeneration() {
+    prefs.begin("history", false);
+    uint32_t generation = prefs.getULong("gen", 0) + 1;
+    prefs.putULong("gen", generation);
+    prefs.end();
+    _historyGeneration = generation;
 
-        nextPos = line.indexOf(',', pos);
-        events[count].actualWeight = line.substring(pos, nextPos).toFloat();
-        pos = nextPos + 1;
+    File marker = LittleFS.open(HISTORY_MARKER_FILE, "w");
+    if (marker) {
+        marker.close();
+    } else {
+        LOG_WARN("storage", "Failed to write history marker");
+    }
+    LOG_INFO("storage", "History generation %lu", (unsigned long)generation);
+}
 
-        nextPos = line.indexOf(',', pos);
-        events[count].duration = line.substring(pos, nextPos).toInt();
-        pos = nextPos + 1;
+bool Storage::queueFeedEvent(const FeedEvent& event) {
+    Request request;
+    request.type = RequestType::FEED_EVENT;
+    request.event = event;
+    return enqueue(request);
+}
+#endif // FEATURE_HISTORY
 
-        nextPos = line.indexOf(',', pos);
-        events[count].alarmTriggered = line.substring(pos, nextPos).toInt() == 1;
-        pos = nextPos + 1;
+#if FEATURE_INFLUX
+bool Storage::appendSpoolRecord(const uint8_t* data, size_t length) {
+    if (!_initialized || length == 0 || length > 0xFFFF) return false;
 
-        String reason = line.substring(pos);
-        strlcpy(events[count].alarmReason, reason.c_str(), sizeof(events[count].alarmReason));
+    lock();
+    File file = LittleFS.open(INFLUX_SPOOL_FILE, "a");
+    if (!file) {
+        unlock();
+        LOG_WARN("storage", "Failed to open spool file");
+        return false;
+    }
 
-        count++;
+    uint8_t header[2] = {(uint8_t)(length & 0xFF), (uint8_t)(length >> 8)};
+    bool success = file.write(header, sizeof(header)) == sizeof(header) && file.write(data, length) == length;
+    file.close();
+    unlock();
+    return success;
+}
+
+size_t Storage::readSpoolRecord(size_t& offset, uint8_t* data, size_t size) {
+    if (!_initialized) return 0;
+
+    lock();
+    File file = LittleFS.open(INFLUX_SPOOL_FILE, "r");
+    if (!file) {
+        unlock();
+        return 0;
+    }
+
+    size_t length = 0;
+    uint8_t header[2];
+    if (file.seek(offset) && file.read(header, sizeof(header)) == sizeof(header)) {
+        length = header[0] | header[1] << 8;
+        // A record cut short by a reset or larger than any batch ends the spool
+        if (length == 0 || length > size || file.read(data, length) != length) {
+            length = 0;
+        } else {
+            offset += sizeof(header) + length;
+        }
     }
 
     file.close();
-    return true;
+    unlock();
+    return length;
 }
 
-bool Storage::clearHistory() {
+size_t Storage::getSpoolSize() {
+    if (!_initialized) return 0;
+
+    lock();
+    size_t size = 0;
+    if (LittleFS.exists(INFLUX_SPOOL_FILE)) {
+        File file = LittleFS.open(INFLUX_SPOOL_FILE, "r");
+        if (file) {
+            size = file.size();
+            file.close();
+        }
+    }
+    unlock();
+    return size;
+}
+
+bool Storage::clearSpool() {
     if (!_initialized) return false;
 
-    if (LittleFS.exists(HISTORY_FILE)) {
-        return LittleFS.remove(HISTORY_FILE);
+    lock();
+    bool success = !LittleFS.exists(INFLUX_SPOOL_FILE) || LittleFS.remove(INFLUX_SPOOL_FILE);
+    unlock();
+    return success;
+}
+#endif // FEATURE_INFLUX
+
+bool Storage::queueSaveConfig(const Config& config) {
+    // Only the latest config matters; a save already queued picks it up
+    lock();
+    _pendingConfig = config;
+    bool alreadyQueued = _configPending;
+    _configPending = true;
+    unlock();
+
+    if (alreadyQueued) return true;
+
+    Request request;
+    request.type = RequestType::SAVE_CONFIG;
+    return enqueue(request);
+}
+
+bool Storage::queueSaveTime(unsigned long epoch) {
+    Request request;
+    request.type = RequestType::SAVE_TIME;
+    request.epoch = epoch;
+    return enqueue(request);
+}
+
+bool Storage::queueSaveFire(uint8_t slot, uint32_t minute) {
+    Request request;
+    request.type = RequestType::SAVE_FIRE;
+    request.fire.slot = slot;
+    request.fire.minute = minute;
+    return enqueue(request);
+}
+
+void Storage::processQueue(uint32_t timeoutMs) {
+    Request request;
+    TickType_t wait = pdMS_TO_TICKS(timeoutMs);
+
+    while (xQueueReceive(_queue, &request, wait) == pdTRUE) {
+        wait = 0;  // Drain the rest without blocking
+        ProfileMark start = LoopProfiler::now();
+
+        switch (request.type) {
+#if FEATURE_HISTORY
+            case RequestType::FEED_EVENT:
+                addFeedEvent(request.event);
+                break;
+#endif
+
+            case RequestType::SAVE_CONFIG: {
+                Config config;
+                lock();
+                config = _pendingConfig;
+                _configPending = false;
+                unlock();
+                saveConfig(config);
+                break;
+            }
+
+            case RequestType::SAVE_TIME:
+                saveLastKnownTime(request.epoch);
+                break;
+
+            case RequestType::SAVE_FIRE:
+                saveLastFireMinute(request.fire.slot, request.fire.minute);
+                break;
+        }
+
+        loopProfiler.record(PROFILE_STORAGE, start);
+    }
+}
+
+bool Storage::enqueue(const Request& request) {
+    if (_queue == nullptr || xQueueSend(_queue, &request, 0) != pdTRUE) {
+        LOG_WARN("storage", "Storage queue full - write dropped");
+        return false;
     }
     return true;
 }
 
+void Storage::lock() {
+    if (_lock != nullptr) xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
+}
+
+void Storage::unlock() {
+    if (_lock != nullptr) xSemaphoreGiveRecursive(_lock);
+}
+
 bool Storage::formatFilesystem() {
-    return LittleFS.format();
+    lock();
+    bool success = LittleFS.format();
+#if FEATURE_HISTORY
+    if (success) {
+        newHistoryGeneration();  // The history went with it
+    }
+#endif
+    unlock();
+    return success;
+}
+
+void Storage::unmountFilesystem() {
+    lock();
+    _initialized = false;
+    LittleFS.end();
+    unlock();
+    LOG_INFO("storage", "LittleFS unmounted");
 }
 
 void Storage::printFileSystemInfo() {
@@ -2,8 +2,16 @@
 #define STORAGE_H
 
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
 #include "types.h"
+#include "config.h"
 
+// Config and history persistence
+// All methods are safe to call from any task (one lock around flash access).
+// The queue* methods return immediately; the storage task performs the write
+// in processQueue(), so time-critical tasks never wait on a flash erase.
 class Storage {
 public:
     Storage();
@@ -15,17 +23,99 @@ public:
     bool loadConfig(Config& config);
     bool saveConfig(const Config& config);
 
+    // Last known wall-clock time (to resume scheduling after reboot)
+    bool saveLastKnownTime(unsigned long epoch);
+    unsigned long loadLastKnownTime();
+
+    // Local minute (minutes since epoch) each schedule slot last fired, so a
+    // reboot into a restored clock doesn't fire the same match again
+    bool saveLastFireMinute(uint8_t slot, uint32_t minute);
+    uint32_t loadLastFireMinute(uint8_t slot);
+
+#if FEATURE_HISTORY
     // History management
     bool addFeedEvent(const FeedEvent& event);
-    bool getFeedHistory(FeedEvent* events, int& count, int maxCount = 50);
+    // With a cursor: read from *cursor (0 = oldest) and leave it after the
+    // last event read. The cursor is only valid in the history generation it
+    // was read under: pass that in *generation (0 = unknown) and a different
+    // one starts over; *generation is left at the current one
+    bool getFeedHistory(FeedEvent* events, int& count, int maxCount = 50, size_t* cursor = nullptr,
+                        uint32_t* generation = nullptr);
     bool clearHistory();
+    // Changes whenever the history starts over (cleared, or a new filesystem)
+    uint32_t getHistoryGeneration() const { return _historyGeneration; }
+#endif
+
+#if FEATURE_INFLUX
+    // Unsent InfluxDB batches (INFLUX_SPOOL_FILE), one length-prefixed record
+    // each. Written by the notify task directly: a batch is too large for the
+    // queue and nothing time-critical waits on it.
+    bool appendSpoolRecord(const uint8_t* data, size_t length);
+    // Read the record at offset (up to size bytes) and move offset past it
+    // Returns its length, 0 at the end of the spool or on a damaged record
+    size_t readSpoolRecord(size_t& offset, uint8_t* data, size_t size);
+    size_t getSpoolSize();
+    bool clearSpool();
+#endif
+
+    // Asynchronous writes (return false if the queue is full)
+#if FEATURE_HISTORY
+    bool queueFeedEvent(const FeedEvent& event);
+#else
+    bool queueFeedEvent(const FeedEvent&) { return true; }  // History not built
+#endif
+    bool queueSaveConfig(const Config& config);
+    bool queueSaveTime(unsigned long epoch);
+    bool queueSaveFire(uint8_t slot, uint32_t minute);
+
+    // Perform queued writes, waiting up to timeoutMs for the first (storage task)
+    void processQueue(uint32_t timeoutMs);
 
     // Utility
     bool formatFilesystem();
+    void unmountFilesystem();  // Before its partition is overwritten (OTA); history fails until restart
     void printFileSystemInfo();
 
 private:
+    enum class RequestType : uint8_t {
+#if FEATURE_HISTORY
+        FEED_EVENT,
+#endif
+        SAVE_CONFIG,
+        SAVE_TIME,
+        SAVE_FIRE
+    };
+
+    struct Request {
+        RequestType type;
+        union {
+#if FEATURE_HISTORY
+            FeedEvent event;
+#endif
+            unsigned long epoch;
+            struct {
+                uint8_t slot;
+                uint32_t minute;
+            } fire;
+        };
+    };
+
     bool _initialized;
+    SemaphoreHandle_t _lock;
+    QueueHandle_t _queue;
+
+    // Latest config waiting to be saved (too large to pass through the queue)
+    Config _pendingConfig;
+    bool _configPending;
+
+#if FEATURE_HISTORY
+    volatile uint32_t _historyGeneration;
+    void newHistoryGeneration();
+#endif
+
+    bool enqueue(const Request& request);
+    void lock();
+    void unlock();
 };
 
 #endif // STORAGE_H
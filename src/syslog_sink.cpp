@@ -0,0 +1,50 @@
+#include "syslog_sink.h"
+#include "config.h"
+#include "net_lock.h"
+#include "net_events.h"
+#include "socket_budget.h"
+
+SyslogSink::SyslogSink() : _port(0), _configured(false) {
+}
+
+bool SyslogSink::begin(const char* server, uint16_t port) {
+    _configured = _server.fromString(server);
+    _port = port;
+    return _configured;
+}
+
+bool SyslogSink::beginBatch() {
+    if (!_configured || !NetEvents::isNetworkReady()) return false;
+    if (!SocketBudget::acquire(SocketUser::LOG)) return false;
+
+    NetLock lock;
+    if (!_udp.begin(LOG_SYSLOG_LOCAL_PORT)) {
+        SocketBudget::release(SocketUser::LOG);
+        return false;
+    }
+    return true;
+}
+
+void SyslogSink::send(const Logger::Entry& entry) {
+    // Facility local0; severity error 3, warning 4, info 6, debug 7
+    static const uint8_t severity[] = {7, 3, 4, 6, 7};
+    char packet[LOG_MESSAGE_LEN + 48];
+    int len = snprintf(packet, sizeof(packet), "<%d>feeder %s: %s",
+                       16 * 8 + severity[entry.level <= LOG_LEVEL_DEBUG ? entry.level : 0],
+                       entry.tag, entry.message);
+    if (len >= (int)sizeof(packet)) len = sizeof(packet) - 1;
+
+    NetLock lock;
+    if (_udp.beginPacket(_server, _port)) {
+        _udp.write((const uint8_t*)packet, len);
+        _udp.endPacket();
+    }
+}
+
+void SyslogSink::endBatch() {
+    {
+        NetLock lock;
+        _udp.stop();
+    }
+    SocketBudget::release(SocketUser::LOG);
+}
@@ -0,0 +1,30 @@
+#ifndef SYSLOG_SINK_H
+#define SYSLOG_SINK_H
+
+#include <Arduino.h>
+#include <Ethernet.h>
+#include <EthernetUdp.h>
+#include "logger.h"
+
+// Sends log records as RFC 3164 syslog over UDP
+// The socket is opened per drain batch from the shared pool (SocketUser::LOG)
+// and skipped while the network is down or no socket is free.
+class SyslogSink : public LogSink {
+public:
+    SyslogSink();
+
+    // Returns false if the server address doesn't parse
+    bool begin(const char* server, uint16_t port);
+
+    bool beginBatch() override;
+    void send(const Logger::Entry& entry) override;
+    void endBatch() override;
+
+private:
+    EthernetUDP _udp;
+    IPAddress _server;
+    uint16_t _port;
+    bool _configured;
+};
+
+#endif // SYSLOG_SINK_H
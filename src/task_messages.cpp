@@ -0,0 +1,84 @@
+#include "task_messages.h"
+#include "config.h"
+#include "net_events.h"
+#include "logger.h"
+
+QueueHandle_t controlQueue = nullptr;
+QueueHandle_t notificationQueue = nullptr;
+TaskHandle_t acquisitionTaskHandle = nullptr;
+
+void createTaskQueues() {
+    controlQueue = xQueueCreate(CONTROL_QUEUE_LENGTH, sizeof(ControlMessage));
+    notificationQueue = xQueueCreate(NOTIFY_QUEUE_LENGTH, sizeof(Notification));
+}
+
+// Replies carry the command's sequence number in the upper 16 bits of the
+// notification value, so a late reply to a command that already timed out
+// is not taken for the result of the next one
+static portMUX_TYPE sequenceLock = portMUX_INITIALIZER_UNLOCKED;
+static uint16_t nextSequence = 0;
+
+CommandResult sendControlCommand(ControlMessage& msg, uint32_t timeoutMs) {
+    msg.replyTo = xTaskGetCurrentTaskHandle();
+    portENTER_CRITICAL(&sequenceLock);
+    msg.sequence = ++nextSequence;
+    portEXIT_CRITICAL(&sequenceLock);
+
+    // Discard any stale reply from an earlier command that timed out
+    xTaskNotifyWait(0, 0xFFFFFFFF, nullptr, 0);
+
+    unsigned long start = millis();
+    if (xQueueSend(controlQueue, &msg, pdMS_TO_TICKS(timeoutMs)) != pdTRUE) {
+        return CommandResult::TIMEOUT;
+    }
+
+    for (;;) {
+        unsigned long elapsed = millis() - start;
+        if (elapsed >= timeoutMs) return CommandResult::TIMEOUT;
+
+        uint32_t reply;
+        if (xTaskNotifyWait(0, 0xFFFFFFFF, &reply, pdMS_TO_TICKS(timeoutMs - elapsed)) != pdTRUE) {
+            return CommandResult::TIMEOUT;
+        }
+        if ((uint16_t)(reply >> 16) == msg.sequence) {
+            return (CommandResult)(reply & 0xFFFF);
+        }
+        LOG_WARN("task", "Discarded late reply to command #%u", (unsigned)(reply >> 16));
+    }
+}
+
+void sendCommandReply(TaskHandle_t replyTo, uint16_t sequence, CommandResult result) {
+    if (replyTo != nullptr) {
+        xTaskNotify(replyTo, ((uint32_t)sequence << 16) | (uint32_t)result, eSetValueWithOverwrite);
+    }
+}
+
+void notifyConfigChanged() {
+    ControlMessage msg = {};
+    msg.type = ControlMessageType::CONFIG_CHANGED;
+    msg.replyTo = nullptr;
+    xQueueSend(controlQueue, &msg, portMAX_DELAY);
+}
+
+void notifyTimeSynced(const TimeReading& reading) {
+    ControlMessage msg = {};
+    msg.type = ControlMessageType::TIME_SYNCED;
+    msg.replyTo = nullptr;
+    msg.time = reading;
+    xQueueSend(controlQueue, &msg, portMAX_DELAY);
+}
+
+bool queueNotification(const Notification& notification) {
+    if (xQueueSend(notificationQueue, &notification, 0) != pdTRUE) {
+        LOG_WARN("task", "Notification queue full - message dropped");
+        return false;
+    }
+    NetEvents::signal(NET_EVENT_NOTIFY);
+    return true;
+}
+
+void requestWeightSample() {
+    if (acquisitionTaskHandle != nullptr) {
+        xTaskNotifyGive(acquisitionTaskHandle);
+    }
+}
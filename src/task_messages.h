@@ -0,0 +1,106 @@
+#ifndef TASK_MESSAGES_H
+#define TASK_MESSAGES_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include "types.h"
+
+// Messages to the control task
+// The control task owns the relays, the feeding state machine and the
+// published SystemStatus; other tasks only ask it to do things.
+enum class ControlMessageType : uint8_t {
+    WEIGHT_SAMPLE,   // Acquisition task: new bin weights
+    NETWORK_STATUS,  // Notify task: link and coordinator state
+    START_FEED,      // Manual feed request
+    STOP_FEED,       // Manual stop request
+    MANUAL,          // Relay override
+    SET_TIME,        // Set clock manually
+    TIME_SYNCED,     // Notify task: time read from a source
+    CONFIG_CHANGED   // ConfigStore was modified
+};
+
+enum class ManualAction : uint8_t {
+    AUGER_ON,
+    AUGER_OFF,
+    CHAIN_ON,
+    CHAIN_OFF,
+    STOP_ALL
+};
+
+// Result sent back to the requesting task (task notification value)
+enum class CommandResult : uint32_t {
+    OK = 1,
+    BUSY,        // Feeding already in progress
+    NO_WEIGHTS,  // Could not read bin weights
+    INVALID,     // Rejected argument
+    TIMEOUT      // No reply from the control task
+};
+
+struct WeightSample {
+    float weights[4];
+    bool ok;
+    unsigned long timestamp;  // millis()
+};
+
+struct NetworkStatus {
+    bool connected;
+    uint8_t coordPeers;
+};
+
+struct ControlMessage {
+    ControlMessageType type;
+    TaskHandle_t replyTo;  // Task to notify with a CommandResult, nullptr = no reply
+    uint16_t sequence;     // Echoed in the reply (set by sendControlCommand)
+    union {
+        WeightSample sample;
+        NetworkStatus network;
+        ManualAction action;
+        unsigned long epoch;
+        TimeReading time;
+    };
+};
+
+// Outbound notifications, sent by the notify task to Telegram and MQTT (if enabled)
+enum class NotificationType : uint8_t {
+    WARNING,
+    FEEDING_COMPLETE,
+    ALARM
+};
+
+struct Notification {
+    NotificationType type;
+    uint8_t feedCycle;
+    float targetWeight;
+    float actualWeight;
+    uint16_t duration;
+    char text[96];  // Warning text or alarm reason
+};
+
+// Queues between tasks (created by createTaskQueues before tasks start)
+extern QueueHandle_t controlQueue;       // ControlMessage -> control task
+extern QueueHandle_t notificationQueue;  // Notification -> notify task
+extern TaskHandle_t acquisitionTaskHandle;
+
+void createTaskQueues();
+
+// Send a command to the control task and wait for its result
+CommandResult sendControlCommand(ControlMessage& msg, uint32_t timeoutMs);
+
+// Reply to a command (control task); no-op if replyTo is nullptr
+void sendCommandReply(TaskHandle_t replyTo, uint16_t sequence, CommandResult result);
+
+// Tell the control task the ConfigStore changed (no reply)
+void notifyConfigChanged();
+
+// Hand a time source reading to the control task (no reply)
+void notifyTimeSynced(const TimeReading& reading);
+
+// Queue a notification without blocking (dropped if the queue is full)
+bool queueNotification(const Notification& notification);
+
+// Wake the acquisition task for an immediate weight read
+void requestWeightSample();
+
+#endif // TASK_MESSAGES_H
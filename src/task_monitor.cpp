@@ -0,0 +1,78 @@
+#include "task_monitor.h"
+#include "logger.h"
+
+#if FEATURE_METRICS
+
+TaskMonitor::Entry TaskMonitor::_tasks[TASK_MONITOR_MAX];
+int TaskMonitor::_count = 0;
+portMUX_TYPE TaskMonitor::_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void TaskMonitor::add(TaskHandle_t task, const char* name, uint32_t stackSize) {
+    if (task == nullptr) return;
+
+    portENTER_CRITICAL(&_lock);
+    if (_count < TASK_MONITOR_MAX) {
+        _tasks[_count++] = {task, name, stackSize, stackSize, false};
+    }
+    portEXIT_CRITICAL(&_lock);
+}
+
+void TaskMonitor::exiting() {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    uint32_t minFree = uxTaskGetStackHighWaterMark(nullptr);
+
+    portENTER_CRITICAL(&_lock);
+    for (int i = 0; i < _count; i++) {
+        if (_tasks[i].task == self) {
+            _tasks[i].minFree = minFree;
+            _tasks[i].task = nullptr;
+        }
+    }
+    portEXIT_CRITICAL(&_lock);
+}
+
+// Latest mark of a running task (a stack scan, so not from the control path)
+// The handle is read and scanned under the lock: exiting() clears it under the
+// same lock before vTaskDelete, so a task can't be freed mid-scan
+uint32_t TaskMonitor::sample(Entry& entry) {
+    portENTER_CRITICAL(&_lock);
+    if (entry.task != nullptr) {
+        entry.minFree = uxTaskGetStackHighWaterMark(entry.task);
+    }
+    uint32_t minFree = entry.minFree;
+    portEXIT_CRITICAL(&_lock);
+    return minFree;
+}
+
+int TaskMonitor::getStats(TaskStats* stats, int max) {
+    int count = 0;
+    for (int i = 0; i < _count && count < max; i++) {
+        stats[count].name = _tasks[i].name;
+        stats[count].stackSize = _tasks[i].stackSize;
+        stats[count].minFree = sample(_tasks[i]);
+        portENTER_CRITICAL(&_lock);
+        stats[count].running = _tasks[i].task != nullptr;
+        portEXIT_CRITICAL(&_lock);
+        count++;
+    }
+    return count;
+}
+
+bool TaskMonitor::check() {
+    bool ok = true;
+    for (int i = 0; i < _count; i++) {
+        Entry& entry = _tasks[i];
+        uint32_t minFree = sample(entry);
+        if (minFree >= TASK_STACK_MIN_FREE) continue;
+
+        ok = false;
+        if (!entry.warned) {
+            entry.warned = true;
+            LOG_WARN("tasks", "Stack margin low: %s has %u of %u bytes never used (budget %u)",
+                     entry.name, minFree, entry.stackSize, TASK_STACK_MIN_FREE);
+        }
+    }
+    return ok;
+}
+
+#endif // FEATURE_METRICS
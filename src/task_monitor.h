@@ -0,0 +1,61 @@
+#ifndef TASK_MONITOR_H
+#define TASK_MONITOR_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "config.h"
+
+// Stack use per FreeRTOS task against its allocation
+// Tasks are registered as they start; the high-water mark (the least unused
+// stack since the task started) is read from FreeRTOS on request. check()
+// warns once per task whose margin falls under TASK_STACK_MIN_FREE, so a
+// change that deepens a call chain shows up in the log before it overflows.
+#if FEATURE_METRICS
+class TaskMonitor {
+public:
+    struct TaskStats {
+        const char* name;
+        uint32_t stackSize;  // bytes, as created
+        uint32_t minFree;    // bytes never touched since the task started
+        bool running;        // false once a one-shot task has exited
+    };
+
+    // Track a task (stackSize in bytes, as passed to xTaskCreate)
+    static void add(TaskHandle_t task, const char* name, uint32_t stackSize);
+
+    // Called by a one-shot task right before vTaskDelete(nullptr): keeps its final mark
+    static void exiting();
+
+    // Current figures for every tracked task; returns the count
+    static int getStats(TaskStats* stats, int max);
+
+    // Logs tasks under the margin (once each); returns false if any are
+    static bool check();
+
+private:
+    struct Entry {
+        TaskHandle_t task;   // nullptr once exited
+        const char* name;
+        uint32_t stackSize;
+        uint32_t minFree;
+        bool warned;
+    };
+
+    static Entry _tasks[TASK_MONITOR_MAX];
+    static int _count;
+    static portMUX_TYPE _lock;
+
+    static uint32_t sample(Entry& entry);
+};
+#else
+// Metrics not built: registrations compile away
+class TaskMonitor {
+public:
+    static void add(TaskHandle_t, const char*, uint32_t) {}
+    static void exiting() {}
+    static bool check() { return true; }
+};
+#endif // FEATURE_METRICS
+
+#endif // TASK_MONITOR_H
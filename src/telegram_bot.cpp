@@ -1,32 +1,37 @@
 #include "telegram_bot.h"
+
+#if FEATURE_TELEGRAM
 #include "config.h"
+#include "task_messages.h"
+#include "logger.h"
 #include <time.h>
 
-TelegramBot::TelegramBot(Config& config) : _config(config),
-    _client(_ethClient, nullptr, 0, A0)  // SSLClient with insecure mode
+TelegramBot::TelegramBot(Config& config, ConfigStore& configStore) : _config(config), _configStore(configStore),
+    _ethClient(SocketUser::TELEGRAM),
+    _client(_ethClient, nullptr, 0, A0),  // SSLClient with insecure mode
+    _bot("", _client)                     // Token set in begin()
 {
-    _bot = nullptr;
     _initialized = false;
     _lastUpdateTime = 0;
     _statusRequested = false;
-    _statusRequestChatId = "";
+    _statusRequestChatId[0] = '\0';
 }
 
 bool TelegramBot::begin() {
     if (!isEnabled()) {
-        Serial.println("Telegram bot not configured or disabled");
+        LOG_INFO("telegram", "Telegram bot not configured or disabled");
         return false;
     }
 
-    Serial.println("Initializing Telegram bot over Ethernet...");
+    LOG_INFO("telegram", "Initializing Telegram bot over Ethernet...");
     // Note: Using nullptr trust anchors = no certificate validation (insecure)
     // For production, add proper Telegram API certificates
 
     // Initialize Telegram bot with SSL client
-    _bot = new UniversalTelegramBot(_config.telegramToken, _client);
+    _bot.updateToken(_config.telegramToken);
 
     _initialized = true;
-    Serial.println("Telegram bot initialized (SSL over Ethernet)");
+    LOG_INFO("telegram", "Telegram bot initialized (SSL over Ethernet)");
     sendMessage("🤖 Weight Feeder System Online (Ethernet)");
 
     return true;
@@ -37,7 +42,7 @@ void TelegramBot::update() {
 
     // Check for new messages every minute
     if (millis() - _lastUpdateTime > TELEGRAM_UPDATE_INTERVAL) {
-        int numNewMessages = _bot->getUpdates(_bot->last_message_received + 1);
+        int numNewMessages = _bot.getUpdates(_bot.last_message_received + 1);
 
         if (numNewMessages > 0) {
             handleNewMessages(numNewMessages);
@@ -84,7 +89,8 @@ void TelegramBot::sendFeedingComplete(uint8_t feedCycle, float weight, uint16_t
 void TelegramBot::sendDailySummary(FeedEvent* events, int count) {
     if (!isEnabled()) return;
 
-    String message = "📊 *Daily Feeding Summary*\n\n";
+    char message[512];
+    size_t len = snprintf(message, sizeof(message), "📊 *Daily Feeding Summary*\n\n");
 
     float totalWeight = 0;
     int alarmCount = 0;
@@ -93,35 +99,29 @@ void TelegramBot::sendDailySummary(FeedEvent* events, int count) {
         totalWeight += events[i].actualWeight;
         if (events[i].alarmTriggered) alarmCount++;
 
-        message += "Cycle ";
-        message += String(events[i].feedCycle + 1);
-        message += ": ";
-        message += String(events[i].actualWeight, 2);
-        message += " lbs";
-
-        if (events[i].alarmTriggered) {
-            message += " ⚠️";
+        if (len < sizeof(message)) {
+            len += snprintf(message + len, sizeof(message) - len, "Cycle %d: %.2f lbs%s\n",
+                            events[i].feedCycle + 1, events[i].actualWeight,
+                            events[i].alarmTriggered ? " ⚠️" : "");
         }
-        message += "\n";
     }
 
-    message += "\nTotal: ";
-    message += String(totalWeight, 2);
-    message += " lbs\n";
-    message += "Alarms: ";
-    message += String(alarmCount);
+    if (len < sizeof(message)) {
+        snprintf(message + len, sizeof(message) - len, "\nTotal: %.2f lbs\nAlarms: %d",
+                 totalWeight, alarmCount);
+    }
 
     sendMessage(message);
 }
 
-void TelegramBot::sendStatus(const SystemStatus& status, const String& chat_id) {
-    if (!_bot) return;
+void TelegramBot::sendStatus(const SystemStatus& status, const char* chat_id) {
+    if (!_initialized) return;
 
-    char message[512];
-    const char* stateStr[] = {"IDLE", "WAITING", "FEEDING", "ALARM", "MANUAL", "ERROR"};
+    char message[640];
+    const char* stateStr[] = {"IDLE", "WAITING", "FEEDING", "ALARM", "MANUAL", "ERROR", "STARTING"};
     const char* stageStr[] = {"STOPPED", "CHAIN_ONLY", "BOTH_RUNNING", "PAUSED_FOR_FILL", "COMPLETED", "FAILED"};
 
-    snprintf(message, sizeof(message),
+    int len = snprintf(message, sizeof(message),
              "📈 *System Status*\n\n"
              "State: %s\n"
              "Stage: %s\n"
@@ -145,8 +145,36 @@ void TelegramBot::sendStatus(const SystemStatus& status, const String& chat_id)
              status.bintracConnected ? "Connected" : "Disconnected",
              status.networkConnected ? "Connected" : "Disconnected");
 
-    _bot->sendMessage(chat_id, message, "Markdown");
-    Serial.printf("Telegram status sent to %s\n", chat_id.c_str());
+    // Feed timeline (times shown in local time)
+    if (status.state == SystemState::FEEDING && status.feedEtaSeconds > 0 && len < (int)sizeof(message)) {
+        char timeStr[8];
+        formatLocalTime(status.predictedCompletion, timeStr, sizeof(timeStr));
+        len += snprintf(message + len, sizeof(message) - len,
+                        "\nDone in: %lum %02lus (~%s)",
+                        status.feedEtaSeconds / 60, status.feedEtaSeconds % 60, timeStr);
+    }
+    if (status.nextFeedTime > 0 && len < (int)sizeof(message)) {
+        char timeStr[8];
+        formatLocalTime(status.nextFeedTime, timeStr, sizeof(timeStr));
+        snprintf(message + len, sizeof(message) - len,
+                 "\nNext feed: %s (cycle %d, %.1f lbs)",
+                 timeStr, status.nextFeedCycle + 1, status.nextFeedTarget);
+    }
+
+    _bot.sendMessage(chat_id, message, "Markdown");
+    LOG_INFO("telegram", "Telegram status sent to %s", chat_id);
+}
+
+void TelegramBot::formatLocalTime(unsigned long utc, char* buffer, size_t size) {
+    if (utc == 0) {
+        snprintf(buffer, size, "--:--");
+        return;
+    }
+
+    time_t local = utc + (_config.timezone * 3600);
+    struct tm timeinfo;
+    gmtime_r(&local, &timeinfo);
+    strftime(buffer, size, "%H:%M", &timeinfo);
 }
 
 bool TelegramBot::isEnabled() {
@@ -155,39 +183,33 @@ bool TelegramBot::isEnabled() {
            strlen(_config.telegramChatID) > 0;
 }
 
-void TelegramBot::sendMessage(const String& text) {
-    if (!_bot || !isEnabled() || strlen(_config.telegramChatID) == 0) return;
+void TelegramBot::sendMessage(const char* text) {
+    if (!_initialized || !isEnabled() || strlen(_config.telegramChatID) == 0) return;
 
-    _bot->sendMessage(_config.telegramChatID, text, "");
-    Serial.printf("Telegram sent: %s\n", text.c_str());
+    _bot.sendMessage(_config.telegramChatID, text, "");
+    LOG_INFO("telegram", "Telegram sent: %s", text);
 }
 
-bool TelegramBot::isUserAuthorized(const String& chat_id) {
+bool TelegramBot::isUserAuthorized(const char* chat_id) {
     // If no allowed users configured, allow all
     if (strlen(_config.telegramAllowedUsers) == 0) {
         return true;
     }
 
-    // Parse comma-separated list of allowed chat IDs
-    String allowedList = String(_config.telegramAllowedUsers);
-    allowedList.trim();
+    // Walk the comma-separated list of allowed chat IDs in place
+    size_t idLen = strlen(chat_id);
+    const char* p = _config.telegramAllowedUsers;
+    while (*p) {
+        while (*p == ' ' || *p == ',') p++;
+        const char* start = p;
+        while (*p && *p != ',') p++;
 
-    // Check if chat_id is in the list
-    int startPos = 0;
-    while (startPos < allowedList.length()) {
-        int commaPos = allowedList.indexOf(',', startPos);
-        if (commaPos == -1) {
-            commaPos = allowedList.length();
-        }
-
-        String allowedChatId = allowedList.substring(startPos, commaPos);
-        allowedChatId.trim();
+        const char* end = p;
+        while (end > start && end[-1] == ' ') end--;
 
-        if (allowedChatId == chat_id) {
+        if ((size_t)(end - start) == idLen && idLen > 0 && strncmp(start, chat_id, idLen) == 0) {
             return true;
         }
-
-        startPos = commaPos + 1;
     }
 
     return false;
@@ -195,22 +217,24 @@ bool TelegramBot::isUserAuthorized(const String& chat_id) {
 
 void TelegramBot::handleNewMessages(int numNewMessages) {
     for (int i = 0; i < numNewMessages; i++) {
-        String chat_id = _bot->messages[i].chat_id;
-        String text = _bot->messages[i].text;
-        String from_name = _bot->messages[i].from_name;
+        // The library's own message strings, not copies
+        const String& chatIdString = _bot.messages[i].chat_id;
+        const String& text = _bot.messages[i].text;
+        const char* chat_id = chatIdString.c_str();
+        const char* from_name = _bot.messages[i].from_name.c_str();
 
-        Serial.printf("Telegram command: %s from %s (chat_id: %s)\n",
-                     text.c_str(), from_name.c_str(), chat_id.c_str());
+        LOG_INFO("telegram", "Telegram command: %s from %s (chat_id: %s)",
+                     text.c_str(), from_name, chat_id);
 
         // Check if user is authorized (use chat_id)
         if (!isUserAuthorized(chat_id)) {
-            Serial.printf("Unauthorized chat_id: %s (%s)\n", chat_id.c_str(), from_name.c_str());
-            _bot->sendMessage(chat_id, "⛔ Unauthorized. Contact system administrator.", "");
+            LOG_WARN("telegram", "Unauthorized chat_id: %s (%s)", chat_id, from_name);
+            _bot.sendMessage(chat_id, "⛔ Unauthorized. Contact system administrator.", "");
             continue;
         }
 
         if (text == "/start") {
-            _bot->sendMessage(chat_id,
+            _bot.sendMessage(chat_id,
                        "👋 Welcome to Weight Feeder Control!\n\n"
                        "Available commands:\n"
                        "/status - System status\n"
@@ -220,18 +244,22 @@ void TelegramBot::handleNewMessages(int numNewMessages) {
         else if (text == "/status") {
             // Trigger status request
             _statusRequested = true;
-            _statusRequestChatId = chat_id;
+            strlcpy(_statusRequestChatId, chat_id, sizeof(_statusRequestChatId));
         }
         else if (text == "/disable") {
-            _config.autoFeedEnabled = false;
-            _bot->sendMessage(chat_id, "✋ Auto-feeding disabled", "");
+            _configStore.modify([](Config& config) { config.autoFeedEnabled = false; });
+            notifyConfigChanged();
+            _bot.sendMessage(chat_id, "✋ Auto-feeding disabled", "");
         }
         else if (text == "/enable") {
-            _config.autoFeedEnabled = true;
-            _bot->sendMessage(chat_id, "✅ Auto-feeding enabled", "");
+            _configStore.modify([](Config& config) { config.autoFeedEnabled = true; });
+            notifyConfigChanged();
+            _bot.sendMessage(chat_id, "✅ Auto-feeding enabled", "");
         }
         else {
-            _bot->sendMessage(chat_id, "❓ Unknown command. Send /start for help.", "");
+            _bot.sendMessage(chat_id, "❓ Unknown command. Send /start for help.", "");
         }
     }
 }
+
+#endif // FEATURE_TELEGRAM
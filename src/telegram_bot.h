@@ -1,16 +1,23 @@
 #ifndef TELEGRAM_BOT_H
 #define TELEGRAM_BOT_H
 
+#include "config.h"
+
+#if FEATURE_TELEGRAM
 #include <Arduino.h>
 #include <UniversalTelegramBot.h>
 #include <SSLClient.h>
 #include <Ethernet.h>
-#include "config.h"
 #include "types.h"
+#include "net_lock.h"
+#include "shared_state.h"
 
+// Telegram notifications and commands (runs in the notify task)
+// config is the notify task's own copy; commands that change settings go
+// through the ConfigStore so the control task picks them up.
 class TelegramBot {
 public:
-    TelegramBot(Config& config);
+    TelegramBot(Config& config, ConfigStore& configStore);
 
     // Initialize bot
     bool begin();
@@ -28,31 +35,37 @@ public:
     void sendDailySummary(FeedEvent* events, int count);
 
     // Send status update
-    void sendStatus(const SystemStatus& status, const String& chat_id);
+    void sendStatus(const SystemStatus& status, const char* chat_id);
 
     // Send a simple message (for warnings)
-    void sendMessage(const String& text);
+    void sendMessage(const char* text);
 
     // Check if bot is enabled and configured
     bool isEnabled();
 
     // Check if status was requested
     bool isStatusRequested() { return _statusRequested; }
-    String getStatusRequestChatId() { _statusRequested = false; return _statusRequestChatId; }
+    const char* getStatusRequestChatId() { _statusRequested = false; return _statusRequestChatId; }
 
 private:
     Config& _config;
-    EthernetClient _ethClient;
+    ConfigStore& _configStore;
+    LockedEthernetClient _ethClient;
     SSLClient _client;
-    UniversalTelegramBot* _bot;
+    UniversalTelegramBot _bot;
     unsigned long _lastUpdateTime;
     bool _initialized;
     bool _statusRequested;
-    String _statusRequestChatId;
+    char _statusRequestChatId[TELEGRAM_CHAT_ID_LEN];
 
     // Handle incoming commands
     void handleNewMessages(int numNewMessages);
-    bool isUserAuthorized(const String& chat_id);
+    bool isUserAuthorized(const char* chat_id);
+
+    // Format a UTC timestamp as local HH:MM
+    void formatLocalTime(unsigned long utc, char* buffer, size_t size);
 };
 
+#endif // FEATURE_TELEGRAM
+
 #endif // TELEGRAM_BOT_H
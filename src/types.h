@@ -2,6 +2,7 @@
 #define TYPES_H
 
 #include <Arduino.h>
+#include "config.h"
 
 // Weight units enumeration
 enum class WeightUnit {
@@ -11,12 +12,13 @@ enum class WeightUnit {
 
 // System state enumeration
 enum class SystemState {
-    IDLE,
-    WAITING_FOR_SCHEDULE,
+    IDLE,                  // Also waits for the next scheduled feed
+    WAITING_FOR_SCHEDULE,  // No longer entered; kept so the numbers in /api/status don't move
     FEEDING,
     ALARM,
     MANUAL_OVERRIDE,
-    ERROR
+    ERROR,
+    STAGGERED_START        // Scheduled feed due, motor start held back behind other controllers
 };
 
 // Feeding stage enumeration
@@ -29,20 +31,54 @@ enum class FeedingStage {
     FAILED
 };
 
+// Where the current wall-clock time came from
+enum class TimeSource {
+    NONE,
+    RESTORED,   // Last known time from flash (stale by the power-off duration)
+    NTP,
+    HTTP,       // Date header from a local HTTP server
+    HOUSELINK,
+    MANUAL
+};
+
+// Time read from a source by the notify task, applied by the control task
+struct TimeReading {
+    unsigned long epoch;   // Unix time when read
+    unsigned long readAt;  // millis() when read
+    TimeSource source;
+};
+
+// Growth curve point (bird age in days -> total daily feed)
+struct FeedCurvePoint {
+    uint16_t day;
+    float dailyTarget;
+};
+
 // Configuration structure
 struct Config {
     // Network settings
     char bintracIP[16] = "192.168.1.100";
     uint8_t bintracDeviceID = 1;  // Device ID from HouseLink discovery
 
-    // Feeding schedule (minutes from midnight)
-    uint16_t feedTimes[4] = {360, 720, 1080, 1440};  // 6am, 12pm, 6pm, 12am
+    // Fallback time sources (used when NTP is unreachable)
+    char timeHttpServer[40] = "";     // "host" or "host:port" answering with a Date header
+    uint16_t houseLinkTimeAddr = 0;   // Input register pair holding Unix time (0 = disabled)
+
+    // Feeding schedule (cron-style "minute hour day-of-month month day-of-week", empty = disabled)
+    char feedSchedules[4][48] = {"0 6 * * *", "0 12 * * *", "0 18 * * *", ""};  // 6am, 12pm, 6pm, 4th slot off
 
     // Feeding parameters
     float targetWeight = 50.0;
     WeightUnit weightUnit = WeightUnit::POUNDS;
     uint16_t chainPreRunTime = 10;  // seconds
 
+    // Flock-age feed curve (overrides targetWeight for scheduled feeds when enabled)
+    bool feedCurveEnabled = false;
+    uint32_t flockStartDate = 0;           // Unix timestamp of placement day (day 0)
+    uint8_t feedCurvePoints = 0;           // Number of valid entries in feedCurve
+    FeedCurvePoint feedCurve[FEED_CURVE_MAX_POINTS] = {};  // Sorted by day
+    uint8_t slotShare[4] = {25, 25, 25, 25};  // Relative share of daily target per slot
+
     // Alarm settings
     float alarmThreshold = 10.0;  // weight per minute
     uint16_t maxRuntime = 600;    // maximum feeding time in seconds
@@ -57,6 +93,24 @@ struct Config {
     char telegramAllowedUsers[200] = "";  // Comma-separated usernames
     bool telegramEnabled = false;
 
+    // MQTT telemetry
+    char mqttBroker[40] = "";     // "host" or "host:port" (default 1883)
+    char mqttUser[32] = "";       // Empty = anonymous
+    char mqttPassword[32] = "";
+    char mqttTopic[40] = "";      // Topic prefix, empty = "feeder/<node id>"
+    bool mqttEnabled = false;
+
+    // InfluxDB push
+    char influxServer[40] = "";   // "host" or "host:port" (default 8086)
+    char influxPath[96] = "";     // Write endpoint, empty = "/write?db=feeder"
+    char influxToken[100] = "";   // Sent as "Authorization: Token ...", empty = none
+    bool influxEnabled = false;
+
+    // Multi-controller start coordination
+    bool coordEnabled = false;
+    uint16_t coordStaggerTime = 5;  // seconds between motor starts of controllers sharing a feed time
+    uint32_t coordNodeId = 0;       // 0 = derive from the factory MAC
+
     // System settings
     bool autoFeedEnabled = true;
     int8_t timezone = 0;  // UTC offset in hours (-12 to +12)
@@ -88,6 +142,32 @@ struct SystemStatus {
     bool networkConnected;
     char lastError[128];
     unsigned long lastBintracUpdate;
+    unsigned long lastSampleAttempt;  // millis() of the last BinTrac read, ok or not
+    unsigned long pendingStartDelay;  // ms, left in STAGGERED_START
+    uint8_t coordPeers;               // Other controllers seen by the start coordinator
+
+    // Timeline
+    unsigned long nextFeedTime;       // Unix time of next scheduled feed, 0 = none
+    uint8_t nextFeedCycle;
+    float nextFeedTarget;
+    unsigned long feedEtaSeconds;     // Predicted seconds until current feed reaches target, 0 = unknown
+    unsigned long predictedCompletion;  // Unix time of predicted completion, 0 = unknown
+
+    // Feed curve (flockAgeDays is -1 when the curve is inactive)
+    int16_t flockAgeDays;
+    float dailyTarget;
+    float slotTargets[4];
+
+    // Clock
+    TimeSource timeSource;
+    unsigned long lastTimeSync;       // Unix time of last successful sync
+
+    // Heap health (bytes); a shrinking largest block with steady free space means fragmentation
+    uint32_t heapFree;
+    uint32_t heapMinFree;             // Low-water mark since boot
+    uint32_t heapLargestBlock;        // Largest single allocation possible now
+
+    unsigned long publishTime;        // millis() when the control task published this snapshot
 };
 
 #endif // TYPES_H
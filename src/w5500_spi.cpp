@@ -0,0 +1,152 @@
+#include "w5500_spi.h"
+#include <SPI.h>
+#include <Ethernet.h>
+#include "logger.h"
+
+// W5500 frame: address[2], control (block select << 3 | read/write << 2), data
+static const uint8_t CONTROL_WRITE = 0x04;
+static uint8_t socketRegisterBlock(uint8_t socket) { return (socket * 4 + 1) << 3; }
+static uint8_t socketTxBlock(uint8_t socket) { return (socket * 4 + 2) << 3; }
+
+// Socket registers
+static const uint16_t SN_CR = 0x0001;
+static const uint16_t SN_IR = 0x0002;
+static const uint16_t SN_SR = 0x0003;
+static const uint16_t SN_TX_FSR = 0x0020;
+static const uint16_t SN_TX_WR = 0x0024;
+
+static const uint8_t CMD_SEND = 0x20;
+static const uint8_t IR_SEND_OK = 0x10;
+static const uint8_t SR_CLOSED = 0x00;
+static const uint8_t SR_ESTABLISHED = 0x17;
+static const uint8_t SR_CLOSE_WAIT = 0x1C;
+
+bool W5500Spi::_enabled = false;
+uint8_t W5500Spi::_csPin = 0;
+uint32_t W5500Spi::_clockHz = 0;
+#if FEATURE_METRICS
+W5500Spi::TransferStats W5500Spi::_stats[(int)TransferKind::COUNT] = {};
+portMUX_TYPE W5500Spi::_statsLock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+bool W5500Spi::begin(uint8_t csPin, uint32_t clockHz) {
+    if (Ethernet.hardwareStatus() != EthernetW5500) {
+        LOG_INFO("net", "Burst SPI path needs a W5500 - using library transfers");
+        return false;
+    }
+
+    _csPin = csPin;
+    _clockHz = clockHz;
+    _enabled = true;
+    LOG_INFO("net", "W5500 burst SPI path at %lu Hz", (unsigned long)clockHz);
+    return true;
+}
+
+int W5500Spi::send(uint8_t socket, const uint8_t* buf, uint16_t len) {
+    if (len > MAX_CHUNK) len = MAX_CHUNK;
+
+    uint8_t status = read8(socket, SN_SR);
+    if (status != SR_ESTABLISHED && status != SR_CLOSE_WAIT) {
+        return -1;
+    }
+    if (read16(socket, SN_TX_FSR) < len) {
+        return 0;
+    }
+
+    // Copy into the TX ring (the W5500 wraps the 16-bit pointer itself)
+    uint16_t ptr = read16(socket, SN_TX_WR);
+    transfer(ptr, socketTxBlock(socket) | CONTROL_WRITE, (uint8_t*)buf, len);
+    write16(socket, SN_TX_WR, ptr + len);
+
+    write8(socket, SN_CR, CMD_SEND);
+    while (read8(socket, SN_CR) != 0) {
+    }
+
+    // The caller holds the NetLock: a peer that stops taking data (zero
+    // window) must not keep every other task off the chip
+    unsigned long start = millis();
+    while ((read8(socket, SN_IR) & IR_SEND_OK) == 0) {
+        if (read8(socket, SN_SR) == SR_CLOSED) {
+            return -1;
+        }
+        if (millis() - start >= W5500_SEND_TIMEOUT) {
+            LOG_WARN("net", "Socket %d send stalled - dropping the connection", socket);
+            return -1;
+        }
+        yield();
+    }
+    write8(socket, SN_IR, IR_SEND_OK);
+    return len;
+}
+
+#if FEATURE_METRICS
+void W5500Spi::recordTransfer(TransferKind kind, uint32_t bytes, uint32_t us) {
+    if (us == 0) us = 1;
+
+    portENTER_CRITICAL(&_statsLock);
+    TransferStats& stats = _stats[(int)kind];
+    stats.count++;
+    stats.bytes += bytes;
+    stats.us += us;
+    stats.lastBytesPerSec = (uint32_t)((uint64_t)bytes * 1000000ULL / us);
+    portEXIT_CRITICAL(&_statsLock);
+}
+
+void W5500Spi::getStats(TransferKind kind, TransferStats& stats) {
+    portENTER_CRITICAL(&_statsLock);
+    stats = _stats[(int)kind];
+    portEXIT_CRITICAL(&_statsLock);
+}
+
+const char* W5500Spi::kindName(TransferKind kind) {
+    switch (kind) {
+        case TransferKind::FILE_SERVE:  return "fileServe";
+        case TransferKind::MODBUS_POLL: return "modbusPoll";
+        default:                        return "unknown";
+    }
+}
+#endif // FEATURE_METRICS
+
+void W5500Spi::transfer(uint16_t address, uint8_t control, uint8_t* data, uint16_t len) {
+    uint8_t header[3] = {(uint8_t)(address >> 8), (uint8_t)(address & 0xFF), control};
+
+    SPI.beginTransaction(SPISettings(_clockHz, MSBFIRST, SPI_MODE0));
+    digitalWrite(_csPin, LOW);
+    SPI.writeBytes(header, sizeof(header));
+    if (control & CONTROL_WRITE) {
+        SPI.writeBytes(data, len);        // FIFO burst, no read-back
+    } else {
+        SPI.transferBytes(nullptr, data, len);
+    }
+    digitalWrite(_csPin, HIGH);
+    SPI.endTransaction();
+}
+
+uint8_t W5500Spi::read8(uint8_t socket, uint16_t reg) {
+    uint8_t value;
+    transfer(reg, socketRegisterBlock(socket), &value, 1);
+    return value;
+}
+
+uint16_t W5500Spi::read16(uint8_t socket, uint16_t reg) {
+    // The chip may update the register between the two bytes; read until stable
+    uint16_t first;
+    uint16_t second;
+    do {
+        uint8_t bytes[2];
+        transfer(reg, socketRegisterBlock(socket), bytes, 2);
+        first = ((uint16_t)bytes[0] << 8) | bytes[1];
+        transfer(reg, socketRegisterBlock(socket), bytes, 2);
+        second = ((uint16_t)bytes[0] << 8) | bytes[1];
+    } while (first != second);
+    return second;
+}
+
+void W5500Spi::write8(uint8_t socket, uint16_t reg, uint8_t value) {
+    transfer(reg, socketRegisterBlock(socket) | CONTROL_WRITE, &value, 1);
+}
+
+void W5500Spi::write16(uint8_t socket, uint16_t reg, uint16_t value) {
+    uint8_t bytes[2] = {(uint8_t)(value >> 8), (uint8_t)(value & 0xFF)};
+    transfer(reg, socketRegisterBlock(socket) | CONTROL_WRITE, bytes, 2);
+}
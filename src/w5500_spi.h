@@ -0,0 +1,66 @@
+#ifndef W5500_SPI_H
+#define W5500_SPI_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Transfers timed for throughput stats (bytes/s)
+enum class TransferKind : uint8_t {
+    FILE_SERVE,   // Static file sent by the web server
+    MODBUS_POLL,  // One BinTrac request/response round trip
+    COUNT
+};
+
+// Burst SPI path for W5500 socket transmit buffers
+// The Ethernet library writes TX data one byte per SPI transfer at 14 MHz;
+// this writes the whole chunk in one transaction at W5500_SPI_CLOCK. It keeps
+// no socket state of its own (the library doesn't cache TX pointers either),
+// so both paths can be mixed on one socket. Caller holds the NetLock.
+class W5500Spi {
+public:
+    // Largest chunk per send: the library gives each of its 8 sockets a 2 KB TX buffer
+    static const uint16_t MAX_CHUNK = 2048;
+
+    struct TransferStats {
+        uint32_t count;
+        uint64_t bytes;
+        uint64_t us;
+        uint32_t lastBytesPerSec;
+    };
+
+    // Enable after the final Ethernet.begin() (W5500 only)
+    static bool begin(uint8_t csPin, uint32_t clockHz);
+    static bool isEnabled() { return _enabled; }
+    static uint32_t getClock() { return _clockHz; }
+
+    // Queue and send up to MAX_CHUNK bytes on a connected TCP socket
+    // Returns bytes sent, 0 if the TX buffer has no room yet, -1 if the
+    // connection is gone or the chip didn't finish sending in W5500_SEND_TIMEOUT
+    static int send(uint8_t socket, const uint8_t* buf, uint16_t len);
+
+    // Throughput bookkeeping
+#if FEATURE_METRICS
+    static void recordTransfer(TransferKind kind, uint32_t bytes, uint32_t us);
+    static void getStats(TransferKind kind, TransferStats& stats);
+    static const char* kindName(TransferKind kind);
+#else
+    static void recordTransfer(TransferKind, uint32_t, uint32_t) {}
+#endif
+
+private:
+    static bool _enabled;
+    static uint8_t _csPin;
+    static uint32_t _clockHz;
+#if FEATURE_METRICS
+    static TransferStats _stats[(int)TransferKind::COUNT];
+    static portMUX_TYPE _statsLock;
+#endif
+
+    static void transfer(uint16_t address, uint8_t control, uint8_t* data, uint16_t len);
+    static uint8_t read8(uint8_t socket, uint16_t reg);
+    static uint16_t read16(uint8_t socket, uint16_t reg);
+    static void write8(uint8_t socket, uint16_t reg, uint8_t value);
+    static void write16(uint8_t socket, uint16_t reg, uint16_t value);
+};
+
+#endif // W5500_SPI_H
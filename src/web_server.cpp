@@ -2,6 +2,16 @@
 #include "config.h"
 #include <ArduinoJson.h>
 #include <LittleFS.h>
+#include "loop_profiler.h"
+#include "net_lock.h"
+#include "net_events.h"
+#include "socket_budget.h"
+#include "w5500_spi.h"
+#include <utility/w5100.h>
+#include "schedule_expr.h"
+#include "scheduler.h"
+#include "logger.h"
+#include "task_monitor.h"
 
 // Concrete server class to workaround ESP32 abstract Server issue
 class ConcreteEthernetServer : public EthernetServer {
@@ -15,146 +25,324 @@ public:
 // Global server instance
 static ConcreteEthernetServer webServer(WEB_SERVER_PORT);
 
-FeedWebServer::FeedWebServer(Storage& storage, AugerControl& augerControl, BinTrac& bintrac,
-                             Config& config, SystemStatus& status)
-    : _storage(storage), _augerControl(augerControl), _bintrac(bintrac),
-      _config(config), _status(status), _port(WEB_SERVER_PORT) {
+// GET /api/config never returns stored secrets; a set secret reads back as
+// this mask and posting the mask unchanged keeps the stored value
+static const char SECRET_MASK[] = "********";
+
+static const char* maskSecret(const char* secret) {
+    return secret[0] ? SECRET_MASK : "";
+}
+
+FeedWebServer::FeedWebServer(Storage& storage, ConfigStore& configStore, StatusStore& statusStore)
+    : _storage(storage), _configStore(configStore), _statusStore(statusStore), _port(WEB_SERVER_PORT),
+      _arena(_arenaBuffer, sizeof(_arenaBuffer)) {
 }
 
 void FeedWebServer::begin() {
+    NetLock lock;
     webServer.begin();
-    Serial.printf("Web server started on port %d\n", WEB_SERVER_PORT);
+    LOG_INFO("web", "Web server started on port %d", WEB_SERVER_PORT);
+}
+
+bool FeedWebServer::handleClient() {
+    EthernetClient accepted = nextClient();
+    if (!accepted) return false;
+
+    // Serve through a locked client so other tasks can use the W5500 between reads/writes
+    ProfileMark start = LoopProfiler::now();
+    LockedEthernetClient client(accepted.getSocketNumber());
+    if (client.connected()) {
+        handleRequest(client);
+    }
+    client.stop();
+    loopProfiler.record(PROFILE_WEB, start);
+    return true;
 }
 
-void FeedWebServer::handleClient() {
-    EthernetClient client = webServer.available();
-    if (client) {
-        if (client.connected()) {
-            handleRequest(client);
+EthernetClient FeedWebServer::nextClient() {
+    NetLock lock;
+
+    // available() opens a new listener whenever none is left; below our
+    // socket limit that's fine, at the limit only serve clients already
+    // connected so the other subsystems keep their sockets
+    if (SocketBudget::scanHardware(_port) < SocketBudget::webLimit()) {
+        return webServer.available();
+    }
+
+    for (uint8_t s = 0; s < MAX_SOCK_NUM; s++) {
+        if (EthernetServer::server_port[s] != _port) continue;
+
+        uint8_t status = W5100.readSnSR(s);
+        if (status != SnSR::ESTABLISHED && status != SnSR::CLOSE_WAIT) continue;
+
+        EthernetClient client(s);
+        if (client.available() > 0) {
+            return client;
         }
-        client.stop();
     }
+    return EthernetClient();
 }
 
 void FeedWebServer::handleRequest(EthernetClient& client) {
-    // Read the HTTP request
-    String currentLine = "";
-    String requestLine = "";
-    String method = "";
-    String path = "";
-    String body = "";
-    int contentLength = 0;
+    // Request parsed into fixed buffers; JSON for this request comes from the arena
+    char line[WEB_LINE_MAX];
+    size_t lineLength = 0;
+    char method[8] = "";
+    char path[WEB_PATH_MAX] = "";
+    bool requestLineSeen = false;
+    size_t contentLength = 0;
     bool headersDone = false;
 
-    // Read request with timeout
+    _arena.reset();
+    _imageHash[0] = '\0';
+    _imageSignature[0] = '\0';
+
+    // Read request with timeout (in blocks; one SPI transaction per block
+    // instead of one per byte)
+    uint8_t buffer[128];
+    int buffered = 0;
+    int pos = 0;
     unsigned long startTime = millis();
     while (client.connected() && (millis() - startTime < 5000)) {
-        if (client.available()) {
-            char c = client.read();
-
-            if (c == '\n') {
-                if (currentLine.length() == 0) {
-                    headersDone = true;
-                    break;  // End of headers
-                } else {
-                    // Process header line
-                    if (requestLine == "") {
-                        requestLine = currentLine;
-                        // Parse method and path
-                        int firstSpace = requestLine.indexOf(' ');
-                        int secondSpace = requestLine.indexOf(' ', firstSpace + 1);
-                        if (firstSpace > 0 && secondSpace > 0) {
-                            method = requestLine.substring(0, firstSpace);
-                            path = requestLine.substring(firstSpace + 1, secondSpace);
-                        }
-                    } else if (currentLine.startsWith("Content-Length: ")) {
-                        contentLength = currentLine.substring(16).toInt();
-                    }
-                    currentLine = "";
-                }
-            } else if (c != '\r') {
-                currentLine += c;
+        if (pos == buffered) {
+            pos = 0;
+            buffered = client.available() ? client.read(buffer, sizeof(buffer)) : 0;
+            if (buffered <= 0) {
+                buffered = 0;
+                NetEvents::waitForSocket(startTime, 5000);
+                continue;
+            }
+        }
+
+        char c = buffer[pos++];
+
+        if (c == '\n') {
+            line[lineLength] = '\0';
+            if (lineLength == 0) {
+                headersDone = true;
+                break;  // End of headers
             }
+
+            // Process header line
+            if (!requestLineSeen) {
+                requestLineSeen = true;
+                parseRequestLine(line, method, sizeof(method), path, sizeof(path));
+            } else if (strncasecmp(line, "Content-Length: ", 16) == 0) {
+                contentLength = strtoul(line + 16, nullptr, 10);
+            } else if (strncasecmp(line, "X-Image-SHA256: ", 16) == 0) {
+                strlcpy(_imageHash, line + 16, sizeof(_imageHash));
+            } else if (strncasecmp(line, "X-Image-Signature: ", 19) == 0) {
+                strlcpy(_imageSignature, line + 19, sizeof(_imageSignature));
+            }
+            lineLength = 0;
+        } else if (c != '\r' && lineLength < sizeof(line) - 1) {
+            line[lineLength++] = c;  // Longer lines are truncated (only the first few bytes matter)
+        }
+    }
+
+    // Image uploads stream straight to flash instead of into the body buffer
+    if (headersDone && strcmp(method, "POST") == 0 && strncmp(path, "/api/ota/", 9) == 0) {
+        if (strcmp(path, "/api/ota/firmware") == 0) {
+            handleOtaUpload(client, OtaTarget::FIRMWARE, contentLength, buffer + pos, buffered - pos);
+        } else if (strcmp(path, "/api/ota/filesystem") == 0) {
+            handleOtaUpload(client, OtaTarget::FILESYSTEM, contentLength, buffer + pos, buffered - pos);
+        } else {
+            sendNotFound(client);
         }
+        return;
+    }
+
+    if (contentLength > WEB_BODY_MAX) {
+        sendResponse(client, 400, "application/json", "{\"error\":\"Request body too large\"}");
+        return;
     }
 
-    // Read body if present
+    // Read body if present (starting with whatever followed the headers in the last block)
+    size_t bodyLength = 0;
     if (headersDone && contentLength > 0) {
-        body.reserve(contentLength);
+        while (pos < buffered && bodyLength < contentLength) {
+            _body[bodyLength++] = buffer[pos++];
+        }
         startTime = millis();
-        while (body.length() < contentLength && (millis() - startTime < 5000)) {
-            if (client.available()) {
-                body += (char)client.read();
+        while (bodyLength < contentLength && (millis() - startTime < 5000)) {
+            int got = client.available() ? client.read((uint8_t*)_body + bodyLength, contentLength - bodyLength) : 0;
+            if (got > 0) {
+                bodyLength += got;
+            } else {
+                NetEvents::waitForSocket(startTime, 5000);
             }
         }
     }
+    _body[bodyLength] = '\0';
+    const char* body = _body;
+
+    // Split off the query string
+    const char* query = "";
+    char* queryStart = strchr(path, '?');
+    if (queryStart != nullptr) {
+        *queryStart = '\0';
+        query = queryStart + 1;
+    }
 
     // Route the request
-    if (method == "GET") {
-        if (path == "/" || path == "/index.html") {
-            handleRoot(client);
-        } else if (path == "/api/status") {
+    if (strcmp(method, "GET") == 0) {
+        if (strcmp(path, "/api/status") == 0) {
             handleGetStatus(client);
-        } else if (path == "/api/config") {
+        } else if (strcmp(path, "/api/config") == 0) {
             handleGetConfig(client);
-        } else if (path == "/api/history") {
-            handleGetHistory(client);
+#if FEATURE_WEB_UI
+        } else if (strcmp(path, "/") == 0 || strcmp(path, "/index.html") == 0) {
+            handleRoot(client);
+#endif
+#if FEATURE_HISTORY
+        } else if (strcmp(path, "/api/history") == 0) {
+            handleGetHistory(client, query);
+#endif
+#if FEATURE_TRACES
+        } else if (strcmp(path, "/api/profile") == 0) {
+            handleGetProfile(client);
+#endif
+#if FEATURE_METRICS
+        } else if (strcmp(path, "/api/sockets") == 0) {
+            handleGetSockets(client);
+        } else if (strcmp(path, "/api/tasks") == 0) {
+            handleGetTasks(client);
+#endif
+        } else if (strcmp(path, "/api/logs") == 0) {
+            handleGetLogs(client, query);
+        } else if (strcmp(path, "/api/ota") == 0) {
+            handleGetOta(client);
         } else {
             sendNotFound(client);
         }
-    } else if (method == "POST") {
-        if (path == "/api/config") {
+    } else if (strcmp(method, "POST") == 0) {
+        if (strcmp(path, "/api/config") == 0) {
             handleSetConfig(client, body);
-        } else if (path == "/api/manual") {
+        } else if (strcmp(path, "/api/manual") == 0) {
             handleManualControl(client, body);
-        } else if (path == "/api/feed/start") {
+        } else if (strcmp(path, "/api/feed/start") == 0) {
             handleStartFeed(client);
-        } else if (path == "/api/feed/stop") {
+        } else if (strcmp(path, "/api/feed/stop") == 0) {
             handleStopFeed(client);
+        } else if (strcmp(path, "/api/time") == 0) {
+            handleSetTime(client, body);
         } else {
             sendNotFound(client);
         }
-    } else if (method == "DELETE") {
-        if (path == "/api/history") {
+    } else if (strcmp(method, "DELETE") == 0) {
+#if FEATURE_HISTORY
+        if (strcmp(path, "/api/history") == 0) {
             handleClearHistory(client);
-        } else {
-            sendNotFound(client);
+            return;
+        }
+#endif
+#if FEATURE_TRACES
+        if (strcmp(path, "/api/profile") == 0) {
+            handleResetProfile(client);
+            return;
         }
+#endif
+        sendNotFound(client);
     } else {
         sendNotFound(client);
     }
 }
 
-void FeedWebServer::sendResponse(EthernetClient& client, int code, const char* contentType, const String& body) {
-    client.print("HTTP/1.1 ");
-    client.print(code);
-    client.println(code == 200 ? " OK" : code == 400 ? " Bad Request" : code == 404 ? " Not Found" : " Error");
-    client.print("Content-Type: ");
-    client.println(contentType);
-    client.println("Connection: close");
-    client.print("Content-Length: ");
-    client.println(body.length());
-    client.println("Access-Control-Allow-Origin: *");
-    client.println();
-    client.print(body);
+void FeedWebServer::parseRequestLine(const char* line, char* method, size_t methodSize, char* path, size_t pathSize) {
+    // "METHOD /path HTTP/1.1"
+    const char* firstSpace = strchr(line, ' ');
+    if (firstSpace == nullptr || firstSpace == line) return;
+    const char* secondSpace = strchr(firstSpace + 1, ' ');
+    if (secondSpace == nullptr) return;
+
+    size_t methodLength = firstSpace - line;
+    size_t pathLength = secondSpace - (firstSpace + 1);
+    if (methodLength >= methodSize || pathLength >= pathSize) return;  // Unknown method / too long: 404
+
+    memcpy(method, line, methodLength);
+    method[methodLength] = '\0';
+    memcpy(path, firstSpace + 1, pathLength);
+    path[pathLength] = '\0';
+}
+
+void FeedWebServer::sendHeaders(EthernetClient& client, int code, const char* contentType, size_t contentLength) {
+    // One write, so the headers go out in a single segment
+    char headers[256];
+    int len = snprintf(headers, sizeof(headers),
+                       "HTTP/1.1 %d %s\r\n"
+                       "Content-Type: %s\r\n"
+                       "Connection: close\r\n"
+                       "Content-Length: %u\r\n"
+                       "Access-Control-Allow-Origin: *\r\n"
+                       "\r\n",
+                       code,
+                       code == 200 ? "OK" : code == 400 ? "Bad Request" : code == 404 ? "Not Found" :
+                       code == 409 ? "Conflict" : "Error",
+                       contentType,
+                       (unsigned)contentLength);
+    client.write((const uint8_t*)headers, len);
+}
+
+void FeedWebServer::sendResponse(EthernetClient& client, int code, const char* contentType, const char* body) {
+    sendResponse(client, code, contentType, body, strlen(body));
+}
+
+void FeedWebServer::sendResponse(EthernetClient& client, int code, const char* contentType, const char* body, size_t length) {
+    sendHeaders(client, code, contentType, length);
+    client.write((const uint8_t*)body, length);
 }
 
-void FeedWebServer::sendJsonResponse(EthernetClient& client, const String& json) {
+void FeedWebServer::sendJsonResponse(EthernetClient& client, const char* json) {
     sendResponse(client, 200, "application/json", json);
 }
 
+void FeedWebServer::sendJsonDocument(EthernetClient& client, const JsonDocument& doc, int code) {
+    // Serialized into the fixed response buffer; too big for it (or for the arena) is an error
+    size_t length = measureJson(doc);
+    if (doc.overflowed() || length >= sizeof(_response)) {
+        LOG_WARN("web", "JSON response too large (%u bytes, arena peak %u)",
+                 (unsigned)length, (unsigned)_arena.getPeak());
+        sendResponse(client, 500, "application/json", "{\"error\":\"Response too large\"}");
+        return;
+    }
+
+    serializeJson(doc, _response, sizeof(_response));
+    sendResponse(client, code, "application/json", _response, length);
+}
+
 void FeedWebServer::sendNotFound(EthernetClient& client) {
     sendResponse(client, 404, "application/json", "{\"error\":\"Not found\"}");
 }
 
+void FeedWebServer::sendCommandResult(EthernetClient& client, CommandResult result) {
+    switch (result) {
+        case CommandResult::OK:
+            sendJsonResponse(client, "{\"success\":true}");
+            break;
+        case CommandResult::BUSY:
+            sendResponse(client, 400, "application/json", "{\"error\":\"Feeding already in progress\"}");
+            break;
+        case CommandResult::NO_WEIGHTS:
+            sendResponse(client, 500, "application/json", "{\"error\":\"Failed to read bin weights\"}");
+            break;
+        case CommandResult::INVALID:
+            sendResponse(client, 400, "application/json", "{\"error\":\"Invalid request\"}");
+            break;
+        default:
+            sendResponse(client, 500, "application/json", "{\"error\":\"Controller did not respond\"}");
+            break;
+    }
+}
+
+#if FEATURE_WEB_UI
 void FeedWebServer::handleRoot(EthernetClient& client) {
     // Serve index.html from LittleFS
     if (!LittleFS.exists("/index.html")) {
-        String html = "<html><body><h1>Weight Feeder Control</h1>"
+        sendResponse(client, 200, "text/html",
+                     "<html><body><h1>Weight Feeder Control</h1>"
                      "<p>Web interface not installed. Use API endpoints:</p>"
                      "<ul><li>/api/status</li><li>/api/config</li><li>/api/history</li></ul>"
-                     "</body></html>";
-        sendResponse(client, 200, "text/html", html);
+                     "</body></html>");
         return;
     }
 
@@ -168,40 +356,37 @@ void FeedWebServer::handleRoot(EthernetClient& client) {
     // Get file size
     size_t fileSize = file.size();
 
-    // Send HTTP headers
-    client.println("HTTP/1.1 200 OK");
-    client.println("Content-Type: text/html");
-    client.println("Connection: close");
-    client.print("Content-Length: ");
-    client.println(fileSize);
-    client.println("Access-Control-Allow-Origin: *");
-    client.println();
-
-    // Send file in chunks
-    const size_t chunkSize = 512;
-    uint8_t buffer[chunkSize];
+    sendHeaders(client, 200, "text/html", fileSize);
+
+    // Send file in socket-buffer-sized chunks (write() waits for TX room itself)
+    static uint8_t buffer[W5500Spi::MAX_CHUNK];  // web task only
+    unsigned long start = micros();
+    size_t sent = 0;
     while (file.available()) {
-        size_t bytesRead = file.read(buffer, chunkSize);
-        client.write(buffer, bytesRead);
-        client.flush();  // Ensure data is sent
-        delay(1);  // Small delay to prevent buffer overflow
+        size_t bytesRead = file.read(buffer, sizeof(buffer));
+        if (bytesRead == 0 || client.write(buffer, bytesRead) != bytesRead) break;
+        sent += bytesRead;
     }
+    W5500Spi::recordTransfer(TransferKind::FILE_SERVE, sent, micros() - start);
 
     file.close();
 }
+#endif // FEATURE_WEB_UI
 
 void FeedWebServer::handleGetStatus(EthernetClient& client) {
-    String json = statusToJson();
-    sendJsonResponse(client, json);
+    JsonDocument doc(&_arena);
+    statusToJson(doc);
+    sendJsonDocument(client, doc);
 }
 
 void FeedWebServer::handleGetConfig(EthernetClient& client) {
-    String json = configToJson();
-    sendJsonResponse(client, json);
+    JsonDocument doc(&_arena);
+    configToJson(doc);
+    sendJsonDocument(client, doc);
 }
 
-void FeedWebServer::handleSetConfig(EthernetClient& client, const String& body) {
-    JsonDocument doc;
+void FeedWebServer::handleSetConfig(EthernetClient& client, const char* body) {
+    JsonDocument doc(&_arena);
     DeserializationError error = deserializeJson(doc, body);
 
     if (error) {
@@ -209,74 +394,199 @@ void FeedWebServer::handleSetConfig(EthernetClient& client, const String& body)
         return;
     }
 
-    // Update configuration
+    // Apply changes to a copy; nothing is published unless all of it is valid
+    Config config;
+    _configStore.get(config);
+
     if (doc["bintracIP"].is<const char*>()) {
-        strlcpy(_config.bintracIP, doc["bintracIP"], sizeof(_config.bintracIP));
+        strlcpy(config.bintracIP, doc["bintracIP"], sizeof(config.bintracIP));
     }
     if (doc["bintracDeviceID"].is<int>()) {
-        _config.bintracDeviceID = doc["bintracDeviceID"];
+        config.bintracDeviceID = doc["bintracDeviceID"];
+    }
+    if (doc["timeHttpServer"].is<const char*>()) {
+        strlcpy(config.timeHttpServer, doc["timeHttpServer"], sizeof(config.timeHttpServer));
+    }
+    if (doc["houseLinkTimeAddr"].is<int>()) {
+        config.houseLinkTimeAddr = doc["houseLinkTimeAddr"];
     }
-    if (doc["feedTimes"].is<JsonArray>()) {
-        JsonArray times = doc["feedTimes"];
-        for (int i = 0; i < 4 && i < times.size(); i++) {
-            _config.feedTimes[i] = times[i];
+    if (doc["feedSchedules"].is<JsonArray>()) {
+        JsonArray schedules = doc["feedSchedules"];
+
+        // Validate all expressions before applying any
+        for (int i = 0; i < 4 && i < schedules.size(); i++) {
+            // Too long to store whole would be saved cut short, as a different schedule
+            CompiledSchedule compiled;
+            if (!schedules[i].is<const char*>() ||
+                strlen(schedules[i].as<const char*>()) >= sizeof(config.feedSchedules[i]) ||
+                !ScheduleExpr::compile(schedules[i], compiled)) {
+                char error[96];
+                snprintf(error, sizeof(error), "{\"error\":\"Invalid schedule expression for slot %d\"}", i + 1);
+                sendResponse(client, 400, "application/json", error);
+                return;
+            }
+        }
+
+        for (int i = 0; i < 4 && i < schedules.size(); i++) {
+            strlcpy(config.feedSchedules[i], schedules[i], sizeof(config.feedSchedules[i]));
         }
     }
     if (doc["targetWeight"].is<float>()) {
-        _config.targetWeight = doc["targetWeight"];
+        config.targetWeight = doc["targetWeight"];
     }
     if (doc["weightUnit"].is<int>()) {
-        _config.weightUnit = (WeightUnit)(int)doc["weightUnit"];
+        config.weightUnit = (WeightUnit)(int)doc["weightUnit"];
     }
     if (doc["chainPreRunTime"].is<int>()) {
-        _config.chainPreRunTime = doc["chainPreRunTime"];
+        config.chainPreRunTime = doc["chainPreRunTime"];
+    }
+    if (doc["feedCurve"].is<JsonArray>()) {
+        JsonArray curve = doc["feedCurve"];
+
+        // Points must be sorted by strictly increasing day
+        if (curve.size() > FEED_CURVE_MAX_POINTS) {
+            sendResponse(client, 400, "application/json", "{\"error\":\"Too many feed curve points\"}");
+            return;
+        }
+        for (int i = 0; i < curve.size(); i++) {
+            // Stored as uint16_t: anything else would wrap to a different day
+            if (!curve[i]["day"].is<long>() || (long)curve[i]["day"] < 0 || (long)curve[i]["day"] > 65535) {
+                sendResponse(client, 400, "application/json", "{\"error\":\"Feed curve day out of range (0-65535)\"}");
+                return;
+            }
+        }
+        for (int i = 1; i < curve.size(); i++) {
+            if ((long)curve[i]["day"] <= (long)curve[i - 1]["day"]) {
+                sendResponse(client, 400, "application/json", "{\"error\":\"Feed curve days must be increasing\"}");
+                return;
+            }
+        }
+
+        config.feedCurvePoints = curve.size();
+        for (int i = 0; i < curve.size(); i++) {
+            config.feedCurve[i].day = curve[i]["day"];
+            config.feedCurve[i].dailyTarget = curve[i]["target"];
+        }
+    }
+    if (doc["feedCurveEnabled"].is<bool>()) {
+        config.feedCurveEnabled = doc["feedCurveEnabled"];
+    }
+    if (doc["flockStartDate"].is<unsigned long>()) {
+        config.flockStartDate = doc["flockStartDate"];
+    }
+    if (doc["slotShare"].is<JsonArray>()) {
+        JsonArray shares = doc["slotShare"];
+
+        // Stored as uint8_t: anything else would wrap to a different share
+        for (int i = 0; i < 4 && i < shares.size(); i++) {
+            if (!shares[i].is<long>() || (long)shares[i] < 0 || (long)shares[i] > 100) {
+                sendResponse(client, 400, "application/json", "{\"error\":\"Slot share out of range (0-100)\"}");
+                return;
+            }
+        }
+        for (int i = 0; i < 4 && i < shares.size(); i++) {
+            config.slotShare[i] = shares[i];
+        }
     }
     if (doc["alarmThreshold"].is<float>()) {
-        _config.alarmThreshold = doc["alarmThreshold"];
+        config.alarmThreshold = doc["alarmThreshold"];
     }
     if (doc["maxRuntime"].is<int>()) {
-        _config.maxRuntime = doc["maxRuntime"];
+        config.maxRuntime = doc["maxRuntime"];
     }
     if (doc["fillDetectionThreshold"].is<float>()) {
-        _config.fillDetectionThreshold = doc["fillDetectionThreshold"];
+        config.fillDetectionThreshold = doc["fillDetectionThreshold"];
     }
     if (doc["fillSettlingTime"].is<int>()) {
-        _config.fillSettlingTime = doc["fillSettlingTime"];
+        config.fillSettlingTime = doc["fillSettlingTime"];
     }
-    if (doc["telegramToken"].is<const char*>()) {
-        strlcpy(_config.telegramToken, doc["telegramToken"], sizeof(_config.telegramToken));
+    if (doc["telegramToken"].is<const char*>() && strcmp(doc["telegramToken"], SECRET_MASK) != 0) {
+        strlcpy(config.telegramToken, doc["telegramToken"], sizeof(config.telegramToken));
     }
     if (doc["telegramChatID"].is<const char*>()) {
-        strlcpy(_config.telegramChatID, doc["telegramChatID"], sizeof(_config.telegramChatID));
+        strlcpy(config.telegramChatID, doc["telegramChatID"], sizeof(config.telegramChatID));
     }
     if (doc["telegramAllowedUsers"].is<const char*>()) {
-        strlcpy(_config.telegramAllowedUsers, doc["telegramAllowedUsers"], sizeof(_config.telegramAllowedUsers));
+        strlcpy(config.telegramAllowedUsers, doc["telegramAllowedUsers"], sizeof(config.telegramAllowedUsers));
     }
     if (doc["telegramEnabled"].is<bool>()) {
-        _config.telegramEnabled = doc["telegramEnabled"];
-        Serial.printf("Set telegramEnabled = %d\n", _config.telegramEnabled);
+        config.telegramEnabled = doc["telegramEnabled"];
+        LOG_INFO("web", "Set telegramEnabled = %d", config.telegramEnabled);
+    }
+    if (doc["mqttBroker"].is<const char*>()) {
+        strlcpy(config.mqttBroker, doc["mqttBroker"], sizeof(config.mqttBroker));
+    }
+    if (doc["mqttUser"].is<const char*>()) {
+        strlcpy(config.mqttUser, doc["mqttUser"], sizeof(config.mqttUser));
+    }
+    if (doc["mqttPassword"].is<const char*>() && strcmp(doc["mqttPassword"], SECRET_MASK) != 0) {
+        strlcpy(config.mqttPassword, doc["mqttPassword"], sizeof(config.mqttPassword));
+    }
+    if (doc["mqttTopic"].is<const char*>()) {
+        strlcpy(config.mqttTopic, doc["mqttTopic"], sizeof(config.mqttTopic));
+    }
+    if (doc["mqttEnabled"].is<bool>()) {
+        config.mqttEnabled = doc["mqttEnabled"];
+    }
+    if (doc["influxServer"].is<const char*>()) {
+        strlcpy(config.influxServer, doc["influxServer"], sizeof(config.influxServer));
+    }
+    if (doc["influxPath"].is<const char*>()) {
+        strlcpy(config.influxPath, doc["influxPath"], sizeof(config.influxPath));
+    }
+    if (doc["influxToken"].is<const char*>() && strcmp(doc["influxToken"], SECRET_MASK) != 0) {
+        strlcpy(config.influxToken, doc["influxToken"], sizeof(config.influxToken));
+    }
+    if (doc["influxEnabled"].is<bool>()) {
+        config.influxEnabled = doc["influxEnabled"];
+    }
+    if (doc["coordEnabled"].is<bool>()) {
+        config.coordEnabled = doc["coordEnabled"];
+    }
+    if (doc["coordStaggerTime"].is<int>()) {
+        config.coordStaggerTime = doc["coordStaggerTime"];
+    }
+    if (doc["coordNodeId"].is<unsigned long>()) {
+        config.coordNodeId = doc["coordNodeId"];
     }
     if (doc["autoFeedEnabled"].is<bool>()) {
-        _config.autoFeedEnabled = doc["autoFeedEnabled"];
+        config.autoFeedEnabled = doc["autoFeedEnabled"];
     }
     if (doc["timezone"].is<int>()) {
-        _config.timezone = doc["timezone"];
+        config.timezone = doc["timezone"];
     }
 
-    // Save to filesystem
-    Serial.println("Saving configuration to filesystem...");
-    if (_storage.saveConfig(_config)) {
-        Serial.println("Configuration saved successfully");
+    // Publish, let the control task apply schedules/feed curve, and persist in the background
+    _configStore.set(config);
+    notifyConfigChanged();
+
+    if (_storage.queueSaveConfig(config)) {
         sendJsonResponse(client, "{\"success\":true}");
     } else {
-        Serial.println("ERROR: Failed to save configuration");
+        LOG_ERROR("web", "Failed to queue configuration save");
         sendResponse(client, 500, "application/json", "{\"error\":\"Failed to save configuration\"}");
     }
 }
 
-void FeedWebServer::handleGetHistory(EthernetClient& client) {
-    String json = historyToJson();
-    sendJsonResponse(client, json);
+#if FEATURE_HISTORY
+void FeedWebServer::handleGetHistory(EthernetClient& client, const char* query) {
+    // ?since=<cursor>&generation=<id> returns events recorded from the cursor
+    // on ("next" and "generation" from an earlier reply); a cursor from another
+    // generation (history cleared since) starts over from the oldest event
+    size_t since = 0;
+    const char* sinceParam = strstr(query, "since=");
+    if (sinceParam != nullptr) {
+        since = strtoul(sinceParam + 6, nullptr, 10);
+    }
+    uint32_t generation = 0;
+    const char* generationParam = strstr(query, "generation=");
+    if (generationParam != nullptr) {
+        generation = strtoul(generationParam + 11, nullptr, 10);
+    }
+
+    JsonDocument doc(&_arena);
+    historyToJson(doc, since, generation);
+    sendJsonDocument(client, doc);
 }
 
 void FeedWebServer::handleClearHistory(EthernetClient& client) {
@@ -286,9 +596,10 @@ void FeedWebServer::handleClearHistory(EthernetClient& client) {
         sendResponse(client, 500, "application/json", "{\"error\":\"Failed to clear history\"}");
     }
 }
+#endif // FEATURE_HISTORY
 
-void FeedWebServer::handleManualControl(EthernetClient& client, const String& body) {
-    JsonDocument doc;
+void FeedWebServer::handleManualControl(EthernetClient& client, const char* body) {
+    JsonDocument doc(&_arena);
     DeserializationError error = deserializeJson(doc, body);
 
     if (error) {
@@ -296,149 +607,304 @@ void FeedWebServer::handleManualControl(EthernetClient& client, const String& bo
         return;
     }
 
-    String action = doc["action"].as<String>();
+    const char* action = doc["action"] | "";
+
+    ControlMessage msg = {};
+    msg.type = ControlMessageType::MANUAL;
 
-    if (action == "auger_on") {
-        _augerControl.setAuger(true);
-    } else if (action == "auger_off") {
-        _augerControl.setAuger(false);
-    } else if (action == "chain_on") {
-        _augerControl.setChain(true);
-    } else if (action == "chain_off") {
-        _augerControl.setChain(false);
-    } else if (action == "stop_all") {
-        _augerControl.stopAll();
+    if (strcmp(action, "auger_on") == 0) {
+        msg.action = ManualAction::AUGER_ON;
+    } else if (strcmp(action, "auger_off") == 0) {
+        msg.action = ManualAction::AUGER_OFF;
+    } else if (strcmp(action, "chain_on") == 0) {
+        msg.action = ManualAction::CHAIN_ON;
+    } else if (strcmp(action, "chain_off") == 0) {
+        msg.action = ManualAction::CHAIN_OFF;
+    } else if (strcmp(action, "stop_all") == 0) {
+        msg.action = ManualAction::STOP_ALL;
     } else {
         sendResponse(client, 400, "application/json", "{\"error\":\"Unknown action\"}");
         return;
     }
 
-    sendJsonResponse(client, "{\"success\":true}");
+    sendCommandResult(client, sendControlCommand(msg, COMMAND_REPLY_TIMEOUT));
 }
 
 void FeedWebServer::handleStartFeed(EthernetClient& client) {
-    Serial.println("Start feed request received");
+    LOG_INFO("web", "Start feed request received");
+
+    // Control task takes a fresh weight reading before starting
+    ControlMessage msg = {};
+    msg.type = ControlMessageType::START_FEED;
+    sendCommandResult(client, sendControlCommand(msg, COMMAND_REPLY_TIMEOUT));
+}
 
-    if (_augerControl.isFeeding()) {
-        Serial.println("ERROR: Feeding already in progress");
-        sendResponse(client, 400, "application/json", "{\"error\":\"Feeding already in progress\"}");
+void FeedWebServer::handleStopFeed(EthernetClient& client) {
+    // Control task records the manual stop to history if a feed was running
+    ControlMessage msg = {};
+    msg.type = ControlMessageType::STOP_FEED;
+    sendCommandResult(client, sendControlCommand(msg, COMMAND_REPLY_TIMEOUT));
+}
+
+void FeedWebServer::handleSetTime(EthernetClient& client, const char* body) {
+    JsonDocument doc(&_arena);
+    DeserializationError error = deserializeJson(doc, body);
+
+    if (error || !doc["epoch"].is<unsigned long>()) {
+        sendResponse(client, 400, "application/json", "{\"error\":\"Expected {\\\"epoch\\\": <unix time>}\"}");
         return;
     }
 
-    // Read fresh weight data before starting
-    Serial.println("Reading bin weights...");
-    if (_bintrac.readAllBins(_status.currentWeight)) {
-        _status.bintracConnected = true;
-        _status.lastBintracUpdate = millis();
-        Serial.printf("Weights read: A=%.0f B=%.0f C=%.0f D=%.0f\n",
-                     _status.currentWeight[0], _status.currentWeight[1],
-                     _status.currentWeight[2], _status.currentWeight[3]);
-    } else {
-        Serial.printf("ERROR: Failed to read bin weights: %s\n", _bintrac.getLastError());
-        sendResponse(client, 500, "application/json", "{\"error\":\"Failed to read bin weights\"}");
+    ControlMessage msg = {};
+    msg.type = ControlMessageType::SET_TIME;
+    msg.epoch = doc["epoch"];
+
+    CommandResult result = sendControlCommand(msg, COMMAND_REPLY_TIMEOUT);
+    if (result == CommandResult::INVALID) {
+        sendResponse(client, 400, "application/json", "{\"error\":\"Invalid time\"}");
         return;
     }
+    sendCommandResult(client, result);
+}
 
-    // Calculate total weight from all bins
-    float totalWeight = 0;
-    for (int i = 0; i < 4; i++) {
-        totalWeight += _status.currentWeight[i];
+#if FEATURE_TRACES
+void FeedWebServer::handleGetProfile(EthernetClient& client) {
+    JsonDocument doc(&_arena);
+    profileToJson(doc);
+    sendJsonDocument(client, doc);
+}
+#endif
+
+#if FEATURE_METRICS
+void FeedWebServer::handleGetSockets(EthernetClient& client) {
+    JsonDocument doc(&_arena);
+    socketsToJson(doc);
+    sendJsonDocument(client, doc);
+}
+
+void FeedWebServer::handleGetTasks(EthernetClient& client) {
+    JsonDocument doc(&_arena);
+    tasksToJson(doc);
+    sendJsonDocument(client, doc);
+}
+#endif // FEATURE_METRICS
+
+void FeedWebServer::handleGetLogs(EthernetClient& client, const char* query) {
+    // ?since=<seq> returns records from seq on (0 or absent = oldest kept)
+    uint32_t since = 0;
+    const char* sinceParam = strstr(query, "since=");
+    if (sinceParam != nullptr) {
+        since = strtoul(sinceParam + 6, nullptr, 10);
     }
-    _status.weightAtStart = totalWeight;
 
-    _augerControl.startFeeding(_config.targetWeight, _config.chainPreRunTime, _config.maxRuntime, _config.fillDetectionThreshold, _config.fillSettlingTime);
-    _status.state = SystemState::FEEDING;
-    _status.feedStartTime = millis();
+    JsonDocument doc(&_arena);
+    logsToJson(doc, since);
+    sendJsonDocument(client, doc);
+}
 
-    sendJsonResponse(client, "{\"success\":true}");
+void FeedWebServer::handleGetOta(EthernetClient& client) {
+    JsonDocument doc(&_arena);
+    otaToJson(doc);
+    sendJsonDocument(client, doc);
 }
 
-void FeedWebServer::handleStopFeed(EthernetClient& client) {
-    // Only record if actually feeding
-    if (_augerControl.isFeeding()) {
-        // Create feed event record for manual stop
-        FeedEvent event;
-        event.timestamp = time(NULL);  // Get current Unix timestamp
-        event.feedCycle = 0;  // Manual feed has no cycle
-        event.targetWeight = _config.targetWeight;
-        event.actualWeight = _augerControl.getWeightDispensed();
-        event.duration = _augerControl.getDuration();
-        event.alarmTriggered = true;
-        strcpy(event.alarmReason, "Manually stopped");
-
-        // Save to history
-        _storage.addFeedEvent(event);
-        Serial.println("Manual stop recorded to history");
-    }
-
-    _augerControl.stopAll();
+void FeedWebServer::handleOtaUpload(EthernetClient& client, OtaTarget target, size_t contentLength,
+                                    const uint8_t* received, size_t receivedLength) {
+    // No signing key, no remote flashing
+    if (!OtaUpdate::isEnabled()) {
+        sendResponse(client, 403, "application/json", "{\"error\":\"OTA disabled: no signing key configured\"}");
+        return;
+    }
+
+    // Flash erases stall both cores for tens of ms; don't start one with motors running
+    SystemStatus status;
+    _statusStore.read(status);
+    if (status.augerRunning || status.chainRunning) {
+        sendResponse(client, 409, "application/json", "{\"error\":\"Feeding in progress\"}");
+        return;
+    }
+
+    if (!OtaUpdate::start(target, contentLength, _imageHash, _imageSignature)) {
+        JsonDocument doc(&_arena);
+        doc["success"] = false;
+        doc["error"] = OtaUpdate::getLastError();
+        sendJsonDocument(client, doc, 400);
+        return;
+    }
+
+    // The data partition is overwritten in place; nothing may use it from here on
+    if (target == OtaTarget::FILESYSTEM) {
+        _storage.unmountFilesystem();
+    }
+
+    // Stream the body to flash in socket-sized reads, through the response
+    // buffer (unused until we reply); whatever arrived with the headers goes first
+    size_t total = min(receivedLength, contentLength);
+    bool ok = OtaUpdate::write(received, total);
+    uint8_t* chunk = (uint8_t*)_response;
+    unsigned long lastData = millis();
+
+    while (ok && total < contentLength) {
+        size_t want = min(sizeof(_response), contentLength - total);
+        int got = client.available() ? client.read(chunk, want) : 0;
+        if (got > 0) {
+            ok = OtaUpdate::write(chunk, got);
+            total += got;
+            lastData = millis();
+        } else if (!client.connected()) {
+            OtaUpdate::abort("Connection closed");
+            ok = false;
+        } else if (millis() - lastData >= OTA_RECEIVE_TIMEOUT) {
+            OtaUpdate::abort("Upload timed out");
+            ok = false;
+        } else {
+            NetEvents::waitForSocket(lastData, OTA_RECEIVE_TIMEOUT);
+        }
+    }
+
+    if (ok) ok = OtaUpdate::finish();
+
+    // A failed firmware upload leaves the running image untouched; the
+    // filesystem has been (partly) overwritten either way, so remount by restarting
+    bool restart = ok || target == OtaTarget::FILESYSTEM;
+
+    JsonDocument doc(&_arena);
+    otaToJson(doc);
+    doc["success"] = ok;
+    doc["restarting"] = restart;
+    sendJsonDocument(client, doc, ok ? 200 : 400);
+
+    if (restart) {
+        client.stop();
+        LOG_WARN("ota", "Restarting to apply %s update", OtaUpdate::targetName(target));
+        vTaskDelay(pdMS_TO_TICKS(1000));  // Let the log drain
+        ESP.restart();
+    }
+}
+
+#if FEATURE_TRACES
+void FeedWebServer::handleResetProfile(EthernetClient& client) {
+    loopProfiler.reset();
     sendJsonResponse(client, "{\"success\":true}");
 }
+#endif
+
+void FeedWebServer::configToJson(JsonDocument& doc) {
+    Config config;
+    _configStore.get(config);
+
+    doc["bintracIP"] = config.bintracIP;
+    doc["bintracDeviceID"] = config.bintracDeviceID;
+    doc["timeHttpServer"] = config.timeHttpServer;
+    doc["houseLinkTimeAddr"] = config.houseLinkTimeAddr;
+
+    JsonArray schedules = doc["feedSchedules"].to<JsonArray>();
+    for (int i = 0; i < 4; i++) {
+        schedules.add(config.feedSchedules[i]);
+    }
 
-String FeedWebServer::configToJson() {
-    JsonDocument doc;
+    doc["targetWeight"] = config.targetWeight;
+    doc["weightUnit"] = (int)config.weightUnit;
+    doc["chainPreRunTime"] = config.chainPreRunTime;
+    doc["feedCurveEnabled"] = config.feedCurveEnabled;
+    doc["flockStartDate"] = config.flockStartDate;
 
-    doc["bintracIP"] = _config.bintracIP;
-    doc["bintracDeviceID"] = _config.bintracDeviceID;
+    JsonArray curve = doc["feedCurve"].to<JsonArray>();
+    for (int i = 0; i < config.feedCurvePoints; i++) {
+        JsonObject point = curve.add<JsonObject>();
+        point["day"] = config.feedCurve[i].day;
+        point["target"] = config.feedCurve[i].dailyTarget;
+    }
 
-    JsonArray times = doc["feedTimes"].to<JsonArray>();
+    JsonArray shares = doc["slotShare"].to<JsonArray>();
     for (int i = 0; i < 4; i++) {
-        times.add(_config.feedTimes[i]);
+        shares.add(config.slotShare[i]);
     }
 
-    doc["targetWeight"] = _config.targetWeight;
-    doc["weightUnit"] = (int)_config.weightUnit;
-    doc["chainPreRunTime"] = _config.chainPreRunTime;
-    doc["alarmThreshold"] = _config.alarmThreshold;
-    doc["maxRuntime"] = _config.maxRuntime;
-    doc["fillDetectionThreshold"] = _config.fillDetectionThreshold;
-    doc["fillSettlingTime"] = _config.fillSettlingTime;
-    doc["telegramToken"] = _config.telegramToken;
-    doc["telegramChatID"] = _config.telegramChatID;
-    doc["telegramAllowedUsers"] = _config.telegramAllowedUsers;
-    doc["telegramEnabled"] = _config.telegramEnabled;
-    doc["autoFeedEnabled"] = _config.autoFeedEnabled;
-    doc["timezone"] = _config.timezone;
+    doc["alarmThreshold"] = config.alarmThreshold;
+    doc["maxRuntime"] = config.maxRuntime;
+    doc["fillDetectionThreshold"] = config.fillDetectionThreshold;
+    doc["fillSettlingTime"] = config.fillSettlingTime;
+    doc["telegramToken"] = maskSecret(config.telegramToken);
+    doc["telegramChatID"] = config.telegramChatID;
+    doc["telegramAllowedUsers"] = config.telegramAllowedUsers;
+    doc["telegramEnabled"] = config.telegramEnabled;
+    doc["mqttBroker"] = config.mqttBroker;
+    doc["mqttUser"] = config.mqttUser;
+    doc["mqttPassword"] = maskSecret(config.mqttPassword);
+    doc["mqttTopic"] = config.mqttTopic;
+    doc["mqttEnabled"] = config.mqttEnabled;
+    doc["influxServer"] = config.influxServer;
+    doc["influxPath"] = config.influxPath;
+    doc["influxToken"] = maskSecret(config.influxToken);
+    doc["influxEnabled"] = config.influxEnabled;
+    doc["coordEnabled"] = config.coordEnabled;
+    doc["coordStaggerTime"] = config.coordStaggerTime;
+    doc["coordNodeId"] = config.coordNodeId;
+    doc["autoFeedEnabled"] = config.autoFeedEnabled;
+    doc["timezone"] = config.timezone;
 
-    String json;
-    serializeJson(doc, json);
-    return json;
 }
 
-String FeedWebServer::statusToJson() {
-    JsonDocument doc;
+void FeedWebServer::statusToJson(JsonDocument& doc) {
+    SystemStatus status;
+    _statusStore.read(status);
 
-    doc["state"] = (int)_status.state;
-    doc["feedingStage"] = (int)_status.feedingStage;
-    doc["feedStartTime"] = _status.feedStartTime;
+    doc["state"] = (int)status.state;
+    doc["feedingStage"] = (int)status.feedingStage;
+    doc["feedStartTime"] = status.feedStartTime;
 
     JsonArray bins = doc["currentWeight"].to<JsonArray>();
     for (int i = 0; i < 4; i++) {
-        bins.add(_status.currentWeight[i]);
+        bins.add(status.currentWeight[i]);
+    }
+
+    doc["weightAtStart"] = status.weightAtStart;
+    doc["weightDispensed"] = status.weightDispensed;
+    doc["flowRate"] = status.flowRate;
+    doc["augerRunning"] = status.augerRunning;
+    doc["chainRunning"] = status.chainRunning;
+    doc["bintracConnected"] = status.bintracConnected;
+    doc["networkConnected"] = status.networkConnected;
+    doc["lastError"] = status.lastError;
+    doc["lastBintracUpdate"] = status.lastBintracUpdate;
+    doc["pendingStartDelay"] = status.pendingStartDelay;
+    doc["nextFeedTime"] = status.nextFeedTime;
+    doc["nextFeedCycle"] = status.nextFeedCycle;
+    doc["nextFeedTarget"] = status.nextFeedTarget;
+    doc["feedEtaSeconds"] = status.feedEtaSeconds;
+    doc["predictedCompletion"] = status.predictedCompletion;
+    time_t now = time(nullptr);
+    doc["currentTime"] = now >= (time_t)TIME_MIN_VALID ? (unsigned long)now : 0;
+    doc["timeSource"] = Scheduler::timeSourceName(status.timeSource);
+    doc["lastTimeSync"] = status.lastTimeSync;
+    doc["coordPeers"] = status.coordPeers;
+
+    // Feed curve (flockAgeDays is -1 when the curve is inactive)
+    doc["flockAgeDays"] = status.flockAgeDays;
+    doc["dailyTarget"] = status.dailyTarget;
+    JsonArray slotTargets = doc["slotTargets"].to<JsonArray>();
+    for (int i = 0; i < 4; i++) {
+        slotTargets.add(status.slotTargets[i]);
     }
 
-    doc["weightAtStart"] = _status.weightAtStart;
-    doc["weightDispensed"] = _status.weightDispensed;
-    doc["flowRate"] = _status.flowRate;
-    doc["augerRunning"] = _status.augerRunning;
-    doc["chainRunning"] = _status.chainRunning;
-    doc["bintracConnected"] = _status.bintracConnected;
-    doc["networkConnected"] = _status.networkConnected;
-    doc["lastError"] = _status.lastError;
-    doc["lastBintracUpdate"] = _status.lastBintracUpdate;
+    // Heap health
+    JsonObject heap = doc["heap"].to<JsonObject>();
+    heap["free"] = status.heapFree;
+    heap["minFree"] = status.heapMinFree;
+    heap["largestBlock"] = status.heapLargestBlock;
+    heap["jsonArenaPeak"] = _arena.getPeak();
 
-    String json;
-    serializeJson(doc, json);
-    return json;
 }
 
-String FeedWebServer::historyToJson() {
-    FeedEvent events[50];
+#if FEATURE_HISTORY
+void FeedWebServer::historyToJson(JsonDocument& doc, size_t since, uint32_t generation) {
+    FeedEvent* events = _history;  // Member buffer, too big for the web task stack
     int count = 0;
+    size_t cursor = since;
 
-    _storage.getFeedHistory(events, count, 50);
+    _storage.getFeedHistory(events, count, WEB_HISTORY_ENTRIES, &cursor, &generation);
 
-    JsonDocument doc;
     JsonArray arr = doc["history"].to<JsonArray>();
 
     for (int i = 0; i < count; i++) {
@@ -452,7 +918,159 @@ String FeedWebServer::historyToJson() {
         obj["alarmReason"] = events[i].alarmReason;
     }
 
-    String json;
-    serializeJson(doc, json);
-    return json;
+    // Cursor for the next page; equal to since when nothing new was recorded
+    doc["next"] = (unsigned long)cursor;
+    doc["generation"] = generation;
+}
+#endif // FEATURE_HISTORY
+
+#if FEATURE_TRACES
+void FeedWebServer::profileToJson(JsonDocument& doc) {
+    LoopProfiler::StageStats stats;
+
+    doc["windowMs"] = loopProfiler.getWindowMs();
+
+    JsonObject stages = doc["stages"].to<JsonObject>();
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        loopProfiler.getStageStats((ProfileStage)i, stats);
+        JsonObject stage = stages[LoopProfiler::stageName((ProfileStage)i)].to<JsonObject>();
+        stage["count"] = stats.count;
+        stage["minUs"] = stats.minUs;
+        stage["avgUs"] = stats.count ? (uint32_t)(stats.totalUs / stats.count) : 0;
+        stage["maxUs"] = stats.maxUs;
+        stage["p99Us"] = stats.p99Us;
+    }
+
+    loopProfiler.getLoopStats(stats);
+    JsonObject cycle = doc["controlCycle"].to<JsonObject>();
+    cycle["count"] = stats.count;
+    cycle["minUs"] = stats.minUs;
+    cycle["avgUs"] = stats.count ? (uint32_t)(stats.totalUs / stats.count) : 0;
+    cycle["maxUs"] = stats.maxUs;
+    cycle["p99Us"] = stats.p99Us;
+
+    // Slowest single control cycle since reset, with per-stage breakdown
+    LoopProfiler::WorstLoop worst;
+    loopProfiler.getWorstLoop(worst);
+    JsonObject worstObj = doc["worst"].to<JsonObject>();
+    worstObj["totalUs"] = worst.totalUs;
+    worstObj["atMillis"] = worst.atMillis;
+    JsonObject worstStages = worstObj["stages"].to<JsonObject>();
+    for (int i = 0; i < PROFILE_CONTROL_STAGES; i++) {
+        worstStages[LoopProfiler::stageName((ProfileStage)i)] = worst.stageUs[i];
+    }
+
+}
+#endif // FEATURE_TRACES
+
+#if FEATURE_METRICS
+void FeedWebServer::tasksToJson(JsonDocument& doc) {
+    TaskMonitor::TaskStats tasks[TASK_MONITOR_MAX];
+    int count = TaskMonitor::getStats(tasks, TASK_MONITOR_MAX);
+
+    doc["minFreeBudget"] = TASK_STACK_MIN_FREE;
+    JsonArray arr = doc["tasks"].to<JsonArray>();
+    for (int i = 0; i < count; i++) {
+        JsonObject entry = arr.add<JsonObject>();
+        entry["name"] = tasks[i].name;
+        entry["stack"] = tasks[i].stackSize;
+        entry["minFree"] = tasks[i].minFree;
+        entry["running"] = tasks[i].running;
+    }
+
+}
+
+void FeedWebServer::socketsToJson(JsonDocument& doc) {
+    SocketBudget::Stats stats;
+    SocketBudget::getStats(stats);
+
+    doc["total"] = MAX_SOCK_NUM;
+    doc["shared"] = stats.shared;
+    doc["inUse"] = stats.hardwareInUse;
+    doc["peak"] = stats.hardwarePeak;
+    doc["interruptDriven"] = NetEvents::isInterruptDriven();
+    doc["interrupts"] = NetEvents::getInterruptCount();
+
+    JsonObject users = doc["users"].to<JsonObject>();
+    for (int i = 0; i < (int)SocketUser::COUNT; i++) {
+        const SocketBudget::UserStats& user = stats.users[i];
+        JsonObject entry = users[SocketBudget::userName((SocketUser)i)].to<JsonObject>();
+        entry["reserved"] = user.reserved;
+        entry["inUse"] = user.inUse;
+        entry["peak"] = user.peak;
+        entry["granted"] = user.granted;
+        entry["denied"] = user.denied;
+    }
+
+    // Transfer throughput (bytes/s), burst SPI path or library fallback
+    JsonObject throughput = doc["throughput"].to<JsonObject>();
+    throughput["burstSpi"] = W5500Spi::isEnabled();
+    throughput["spiClock"] = W5500Spi::getClock();
+    for (int i = 0; i < (int)TransferKind::COUNT; i++) {
+        W5500Spi::TransferStats transfer;
+        W5500Spi::getStats((TransferKind)i, transfer);
+        JsonObject entry = throughput[W5500Spi::kindName((TransferKind)i)].to<JsonObject>();
+        entry["count"] = transfer.count;
+        entry["bytes"] = transfer.bytes;
+        entry["avgBytesPerSec"] = transfer.us > 0 ? (uint32_t)(transfer.bytes * 1000000ULL / transfer.us) : 0;
+        entry["lastBytesPerSec"] = transfer.lastBytesPerSec;
+    }
+
+}
+#endif // FEATURE_METRICS
+
+void FeedWebServer::logsToJson(JsonDocument& doc, uint32_t since) {
+    uint32_t seq = Logger::oldestSeq();
+    if (since > seq) seq = since;
+    uint32_t next = Logger::nextSeq();
+    if (seq > next) seq = next;
+
+    JsonArray entries = doc["entries"].to<JsonArray>();
+    Logger::Entry entry;
+    int count = 0;
+    for (; seq < next && count < LOG_API_MAX_ENTRIES; seq++) {
+        if (!Logger::readEntry(seq, entry)) {
+            if (seq >= Logger::oldestSeq()) break;  // Still being written: next time
+            continue;                                // Overwritten meanwhile
+        }
+
+        JsonObject obj = entries.add<JsonObject>();
+        obj["seq"] = entry.seq;
+        obj["ms"] = entry.ms;
+        char level[2] = {Logger::levelLetter(entry.level), '\0'};
+        obj["level"] = level;
+        obj["tag"] = entry.tag;
+        obj["msg"] = entry.message;
+        count++;
+    }
+
+    // Ask for next with ?since=<next>; more=true if this response was capped
+    doc["next"] = seq;
+    doc["more"] = seq < next;
+    doc["dropped"] = Logger::getDropped();
+}
+
+void FeedWebServer::otaToJson(JsonDocument& doc) {
+    doc["version"] = FIRMWARE_VERSION;
+    doc["partition"] = OtaUpdate::getRunningPartition();
+    doc["pendingVerify"] = OtaUpdate::isPendingVerify();
+    doc["bootAttempts"] = OtaUpdate::getBootAttempts();
+    doc["rolledBack"] = OtaUpdate::wasRolledBack();
+    doc["enabled"] = OtaUpdate::isEnabled();  // Uploads need a signing key
+
+    // Last (or current) upload; flash rate is over the time spent writing,
+    // transfer rate over the whole upload
+    OtaUpdate::Stats stats;
+    OtaUpdate::getStats(stats);
+    JsonObject upload = doc["upload"].to<JsonObject>();
+    upload["target"] = OtaUpdate::targetName(stats.target);
+    upload["inProgress"] = stats.inProgress;
+    upload["succeeded"] = stats.succeeded;
+    upload["size"] = stats.imageSize;
+    upload["received"] = stats.received;
+    upload["elapsedMs"] = stats.elapsedMs;
+    upload["flashMs"] = stats.flashUs / 1000;
+    upload["flashBytesPerSec"] = stats.flashUs > 0 ? (uint32_t)((uint64_t)stats.received * 1000000 / stats.flashUs) : 0;
+    upload["transferBytesPerSec"] = stats.elapsedMs > 0 ? (uint32_t)((uint64_t)stats.received * 1000 / stats.elapsedMs) : 0;
+    upload["error"] = OtaUpdate::getLastError();
 }
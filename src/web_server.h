@@ -3,51 +3,107 @@
 
 #include <Arduino.h>
 #include <Ethernet.h>
+#include <ArduinoJson.h>
+#include "config.h"
 #include "types.h"
 #include "storage.h"
-#include "auger_control.h"
-#include "bintrac.h"
+#include "shared_state.h"
+#include "task_messages.h"
+#include "json_arena.h"
+#include "ota_update.h"
 
+// HTTP server and JSON API (runs in the web task)
+// Reads the published status snapshot and config copies; anything that
+// changes hardware or feeding state is sent to the control task as a command.
+// Request, body, JSON and response buffers are members sized in config.h, so
+// serving requests doesn't allocate (construct once, statically).
 class FeedWebServer {
 public:
-    FeedWebServer(Storage& storage, AugerControl& augerControl, BinTrac& bintrac,
-                  Config& config, SystemStatus& status);
+    FeedWebServer(Storage& storage, ConfigStore& configStore, StatusStore& statusStore);
 
     // Initialize web server
     void begin();
 
-    // Handle client requests (call in main loop)
-    void handleClient();
+    // Serve one pending request (call from the web task)
+    // Returns false if no client was waiting
+    bool handleClient();
 
 private:
-    uint16_t _port;
+    friend struct WebServerProbe;  // Host benchmarks drive the JSON builders directly
+
     Storage& _storage;
-    AugerControl& _augerControl;
-    BinTrac& _bintrac;
-    Config& _config;
-    SystemStatus& _status;
+    ConfigStore& _configStore;
+    StatusStore& _statusStore;
+    uint16_t _port;
+
+    // Per-request buffers (web task only)
+    alignas(8) uint8_t _arenaBuffer[WEB_JSON_ARENA_SIZE];
+    JsonArena _arena;
+    char _body[WEB_BODY_MAX + 1];
+    char _response[WEB_RESPONSE_MAX];
+#if FEATURE_HISTORY
+    FeedEvent _history[WEB_HISTORY_ENTRIES];
+#endif
+    char _imageHash[65];                             // X-Image-SHA256 header (hex)
+    char _imageSignature[OTA_SIGNATURE_MAX * 2 + 1]; // X-Image-Signature header (hex DER)
+
+    // Next client with a request waiting, within the web socket budget
+    EthernetClient nextClient();
 
     // HTTP request handling
     void handleRequest(EthernetClient& client);
-    void sendResponse(EthernetClient& client, int code, const char* contentType, const String& body);
-    void sendJsonResponse(EthernetClient& client, const String& json);
+    static void parseRequestLine(const char* line, char* method, size_t methodSize, char* path, size_t pathSize);
+    void sendHeaders(EthernetClient& client, int code, const char* contentType, size_t contentLength);
+    void sendResponse(EthernetClient& client, int code, const char* contentType, const char* body);
+    void sendResponse(EthernetClient& client, int code, const char* contentType, const char* body, size_t length);
+    void sendJsonResponse(EthernetClient& client, const char* json);
+    void sendJsonDocument(EthernetClient& client, const JsonDocument& doc, int code = 200);
     void sendNotFound(EthernetClient& client);
+    void sendCommandResult(EthernetClient& client, CommandResult result);
 
     // HTTP handlers
+#if FEATURE_WEB_UI
     void handleRoot(EthernetClient& client);
+#endif
     void handleGetStatus(EthernetClient& client);
     void handleGetConfig(EthernetClient& client);
-    void handleSetConfig(EthernetClient& client, const String& body);
-    void handleGetHistory(EthernetClient& client);
+    void handleSetConfig(EthernetClient& client, const char* body);
+#if FEATURE_HISTORY
+    void handleGetHistory(EthernetClient& client, const char* query);
     void handleClearHistory(EthernetClient& client);
-    void handleManualControl(EthernetClient& client, const String& body);
+#endif
+    void handleManualControl(EthernetClient& client, const char* body);
     void handleStartFeed(EthernetClient& client);
     void handleStopFeed(EthernetClient& client);
+    void handleSetTime(EthernetClient& client, const char* body);
+#if FEATURE_TRACES
+    void handleGetProfile(EthernetClient& client);
+    void handleResetProfile(EthernetClient& client);
+#endif
+#if FEATURE_METRICS
+    void handleGetSockets(EthernetClient& client);
+    void handleGetTasks(EthernetClient& client);
+#endif
+    void handleGetLogs(EthernetClient& client, const char* query);
+    void handleGetOta(EthernetClient& client);
+    void handleOtaUpload(EthernetClient& client, OtaTarget target, size_t contentLength,
+                         const uint8_t* received, size_t receivedLength);
 
-    // Utility functions
-    String configToJson();
-    String statusToJson();
-    String historyToJson();
+    // JSON builders (into a document on the arena)
+    void configToJson(JsonDocument& doc);
+    void statusToJson(JsonDocument& doc);
+#if FEATURE_HISTORY
+    void historyToJson(JsonDocument& doc, size_t since = 0, uint32_t generation = 0);
+#endif
+#if FEATURE_TRACES
+    void profileToJson(JsonDocument& doc);
+#endif
+#if FEATURE_METRICS
+    void socketsToJson(JsonDocument& doc);
+    void tasksToJson(JsonDocument& doc);
+#endif
+    void logsToJson(JsonDocument& doc, uint32_t since);
+    void otaToJson(JsonDocument& doc);
 };
 
 #endif // WEB_SERVER_H
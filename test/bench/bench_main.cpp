@@ -0,0 +1,300 @@
+// Host micro-benchmarks for the control and web hot paths
+// Built by the native_bench environment against the shims in test/native,
+// with Google Benchmark from the host (libbenchmark-dev):
+//
+//   pio run -e native_bench
+//   python3 test/bench/track.py            # run, record, compare with the last run
+//
+// Each benchmark runs one unit of work the firmware repeats: an auger
+// update, a Modbus frame, a JSON response, a history read or append, a
+// schedule check. The simulated clock is frozen (see native_shim.h), so the
+// numbers are CPU time only; flash and W5500 latency are not modelled.
+
+#include <Arduino.h>
+#include <benchmark/benchmark.h>
+#include "config.h"
+#include "types.h"
+#include "auger_control.h"
+#include "bintrac.h"
+#include "schedule_expr.h"
+#include "scheduler.h"
+#include "shared_state.h"
+#include "storage.h"
+#include "web_server.h"
+
+#define BENCH_DATA_DIR ".native_bench_data"
+#define BENCH_EPOCH 1760000000UL  // 2025-10-09, so the scheduler counts as synced
+
+// ---- Feeder under test ----
+// Built once like the firmware's globals (the web server is too big for a stack)
+
+static Config config;
+static ConfigStore configStore;
+static StatusStore statusStore;
+static Storage storage;
+static FeedWebServer webServer(storage, configStore, statusStore);
+static AugerControl augerControl;
+static Scheduler scheduler;
+static FeedEvent historyEvents[WEB_HISTORY_ENTRIES];
+
+struct WebServerProbe {
+    // JSON builder plus serialization into the response buffer, as a GET does
+    template <typename Builder>
+    static size_t render(FeedWebServer& server, Builder build) {
+        server._arena.reset();
+        JsonDocument doc(&server._arena);
+        build(server, doc);
+        return serializeJson(doc, server._response, sizeof(server._response));
+    }
+
+    static size_t status(FeedWebServer& server) {
+        return render(server, [](FeedWebServer& s, JsonDocument& doc) { s.statusToJson(doc); });
+    }
+
+    static size_t config(FeedWebServer& server) {
+        return render(server, [](FeedWebServer& s, JsonDocument& doc) { s.configToJson(doc); });
+    }
+
+    static size_t history(FeedWebServer& server) {
+        return render(server, [](FeedWebServer& s, JsonDocument& doc) { s.historyToJson(doc); });
+    }
+};
+
+static FeedEvent sampleEvent(unsigned long timestamp, uint8_t cycle) {
+    FeedEvent event;
+    event.timestamp = timestamp;
+    event.feedCycle = cycle;
+    event.targetWeight = 150.0;
+    event.actualWeight = 149.25;
+    event.duration = 312;
+    event.alarmTriggered = cycle == 3;
+    strlcpy(event.alarmReason, cycle == 3 ? "Max runtime exceeded" : "", sizeof(event.alarmReason));
+    return event;
+}
+
+// A full history page: WEB_HISTORY_ENTRIES records on "flash"
+static void writeHistory() {
+    storage.clearHistory();
+    for (int i = 0; i < WEB_HISTORY_ENTRIES; i++) {
+        storage.addFeedEvent(sampleEvent(BENCH_EPOCH + i * 21600UL, i % 4));
+    }
+}
+
+static void setupFeeder() {
+    NativeShim::setDataDir(BENCH_DATA_DIR);
+    NativeShim::clearDataDir();
+    NativeShim::setMillis(60000);
+    NativeShim::setWallClock(BENCH_EPOCH);
+
+    storage.begin();
+    configStore.begin(config);
+    augerControl.begin();
+    scheduler.begin(0, nullptr);
+    scheduler.setSchedules(config.feedSchedules);
+    scheduler.setFeedCurve(config);
+
+    SystemStatus status;
+    status.state = SystemState::FEEDING;
+    status.feedingStage = FeedingStage::BOTH_RUNNING;
+    for (int i = 0; i < 4; i++) status.currentWeight[i] = 4000.0 - i * 250.0;
+    status.augerRunning = true;
+    status.chainRunning = true;
+    status.weightDispensed = 82.5;
+    status.flowRate = 61.0;
+    statusStore.publish(status);
+
+    writeHistory();
+}
+
+// ---- Auger control ----
+
+// One weight sample per call (the 1 s WEIGHT_CHECK_INTERVAL elapses each time),
+// through whole feed cycles: chain pre-run, both running, completion
+static void BM_AugerUpdateSample(benchmark::State& state) {
+    float weight = 4000.0;
+    augerControl.startFeeding(150.0, 10, 900);
+
+    for (auto _ : state) {
+        if (augerControl.isAugerRunning()) weight -= 1.0;
+        NativeShim::advanceMillis(WEIGHT_CHECK_INTERVAL);
+        FeedingStage stage = augerControl.update(weight, millis());
+        benchmark::DoNotOptimize(stage);
+
+        if (stage == FeedingStage::COMPLETED || stage == FeedingStage::FAILED) {
+            augerControl.stopAll();
+            if (weight < 1000.0) weight += 3000.0;
+            augerControl.startFeeding(150.0, 10, 900);
+        }
+    }
+    augerControl.stopAll();
+}
+BENCHMARK(BM_AugerUpdateSample);
+
+// Control loop passes between samples (most calls return early)
+static void BM_AugerUpdateBetweenSamples(benchmark::State& state) {
+    augerControl.startFeeding(1.0e6, 0, 65535);
+    NativeShim::advanceMillis(WEIGHT_CHECK_INTERVAL);
+    unsigned long sampleTime = millis();
+    augerControl.update(4000.0, sampleTime);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(augerControl.update(4000.0, sampleTime));
+    }
+    augerControl.stopAll();
+}
+BENCHMARK(BM_AugerUpdateBetweenSamples);
+
+// ---- Modbus framing ----
+
+static void BM_ModbusBuildRequest(benchmark::State& state) {
+    uint8_t request[MODBUS_REQUEST_SIZE];
+    uint16_t transactionID = 1;
+
+    for (auto _ : state) {
+        BinTrac::buildReadRequest(request, transactionID++, 1, MODBUS_ALL_BINS_ADDR, MODBUS_ALL_BINS_LEN);
+        benchmark::DoNotOptimize(request);
+    }
+}
+BENCHMARK(BM_ModbusBuildRequest);
+
+// Registers per response: bin D, the three-bin read, the Modbus maximum
+static void BM_ModbusDecodeRegisters(benchmark::State& state) {
+    uint16_t length = state.range(0);
+    uint8_t data[256];
+    uint16_t registers[128];
+    for (int i = 0; i < 256; i++) data[i] = i * 37;
+
+    for (auto _ : state) {
+        BinTrac::decodeRegisters(data, length, registers);
+        benchmark::DoNotOptimize(registers);
+    }
+    state.SetBytesProcessed(state.iterations() * length * 2);
+}
+BENCHMARK(BM_ModbusDecodeRegisters)->Arg(2)->Arg(MODBUS_ALL_BINS_LEN)->Arg(125);
+
+// ---- JSON responses ----
+
+static void BM_StatusToJson(benchmark::State& state) {
+    size_t length = 0;
+    for (auto _ : state) {
+        length = WebServerProbe::status(webServer);
+        benchmark::DoNotOptimize(length);
+    }
+    state.counters["bytes"] = length;
+}
+BENCHMARK(BM_StatusToJson);
+
+static void BM_ConfigToJson(benchmark::State& state) {
+    size_t length = 0;
+    for (auto _ : state) {
+        length = WebServerProbe::config(webServer);
+        benchmark::DoNotOptimize(length);
+    }
+    state.counters["bytes"] = length;
+}
+BENCHMARK(BM_ConfigToJson);
+
+// Includes reading and parsing the history file, as GET /api/history does
+static void BM_HistoryToJson(benchmark::State& state) {
+    size_t length = 0;
+    for (auto _ : state) {
+        length = WebServerProbe::history(webServer);
+        benchmark::DoNotOptimize(length);
+    }
+    state.counters["bytes"] = length;
+}
+BENCHMARK(BM_HistoryToJson);
+
+// ---- History file ----
+
+static void BM_HistoryParse(benchmark::State& state) {
+    int count = 0;
+    for (auto _ : state) {
+        storage.getFeedHistory(historyEvents, count, WEB_HISTORY_ENTRIES);
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_HistoryParse);
+
+// Appends start over from an empty file every 1000 records
+static void BM_HistoryAppend(benchmark::State& state) {
+    storage.clearHistory();
+    FeedEvent event = sampleEvent(BENCH_EPOCH, 0);
+    int appended = 0;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(storage.addFeedEvent(event));
+        event.timestamp += 21600;
+        if (++appended == 1000) {
+            state.PauseTiming();
+            storage.clearHistory();
+            appended = 0;
+            state.ResumeTiming();
+        }
+    }
+    writeHistory();
+}
+BENCHMARK(BM_HistoryAppend);
+
+// ---- Scheduling ----
+
+static void BM_ScheduleMatches(benchmark::State& state) {
+    CompiledSchedule schedule;
+    ScheduleExpr::compile("30 6,10,14,18 * * 1-5", schedule);
+    time_t now = BENCH_EPOCH;
+    struct tm t;
+
+    for (auto _ : state) {
+        gmtime_r(&now, &t);
+        benchmark::DoNotOptimize(ScheduleExpr::matches(schedule, t));
+        now += 60;
+    }
+}
+BENCHMARK(BM_ScheduleMatches);
+
+static void BM_ScheduleNextFire(benchmark::State& state) {
+    CompiledSchedule schedule;
+    ScheduleExpr::compile("30 6,10,14,18 * * 1-5", schedule);
+    time_t now = BENCH_EPOCH;
+    time_t next;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ScheduleExpr::nextFire(schedule, now, next));
+        now += 60;
+    }
+}
+BENCHMARK(BM_ScheduleNextFire);
+
+// The control task's once-a-pass check, a new minute every call
+static void BM_SchedulerShouldFeed(benchmark::State& state) {
+    uint8_t cycle;
+    for (auto _ : state) {
+        NativeShim::advanceMillis(60000);
+        benchmark::DoNotOptimize(scheduler.shouldFeed(cycle));
+    }
+}
+BENCHMARK(BM_SchedulerShouldFeed);
+
+// Next feed for the status page: recomputed once per minute, cached in between
+static void BM_SchedulerNextFeed(benchmark::State& state) {
+    bool newMinute = state.range(0) != 0;
+    unsigned long feedTime;
+    uint8_t cycle;
+
+    for (auto _ : state) {
+        if (newMinute) NativeShim::advanceMillis(60000);
+        benchmark::DoNotOptimize(scheduler.getNextFeed(feedTime, cycle));
+    }
+}
+BENCHMARK(BM_SchedulerNextFeed)->ArgName("newMinute")->Arg(0)->Arg(1);
+
+int main(int argc, char** argv) {
+    setupFeeder();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
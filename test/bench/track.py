@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""
+Run the host benchmarks and track the results over commits.
+
+Each run is appended to test/bench/history.jsonl as one line (commit, date,
+host, CPU time per benchmark in ns) and compared with the latest earlier
+run from the same host, or with a given commit. Exits with 1 if any
+benchmark got slower than the threshold, so it can gate a change:
+
+  pio run -e native_bench
+  python3 test/bench/track.py                     # run, compare, record
+  python3 test/bench/track.py --baseline 6082653  # compare with that commit's run
+  python3 test/bench/track.py --no-record --filter Json
+
+Timings only compare on the same machine; runs are matched by host name.
+"""
+
+import argparse
+import datetime
+import json
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(os.path.dirname(HERE))
+DEFAULT_BINARY = os.path.join(ROOT, ".pio", "build", "native_bench", "program")
+HISTORY_FILE = os.path.join(HERE, "history.jsonl")
+
+
+def git(*args):
+    try:
+        return subprocess.check_output(["git", *args], cwd=ROOT, text=True, stderr=subprocess.DEVNULL).strip()
+    except (OSError, subprocess.CalledProcessError):
+        return ""
+
+
+def run_benchmarks(binary, bench_filter, repetitions):
+    with tempfile.NamedTemporaryFile(suffix=".json", delete=False) as out:
+        out_path = out.name
+    command = [binary, f"--benchmark_out={out_path}", "--benchmark_out_format=json",
+               f"--benchmark_repetitions={repetitions}", "--benchmark_report_aggregates_only=true"]
+    if bench_filter:
+        command.append(f"--benchmark_filter={bench_filter}")
+
+    # The program keeps its flash and NVS files in the working directory
+    subprocess.run(command, cwd=tempfile.gettempdir(), check=True)
+    with open(out_path) as f:
+        report = json.load(f)
+    os.unlink(out_path)
+
+    # Median over the repetitions (a single run reports no aggregates)
+    results = {}
+    for bench in report["benchmarks"]:
+        name = bench.get("run_name", bench["name"])
+        if bench.get("run_type") == "aggregate" and bench.get("aggregate_name") != "median":
+            continue
+        results[name] = round(to_ns(bench["cpu_time"], bench.get("time_unit", "ns")), 3)
+    return results
+
+
+def to_ns(value, unit):
+    return value * {"ns": 1, "us": 1e3, "ms": 1e6, "s": 1e9}[unit]
+
+
+def load_history():
+    if not os.path.exists(HISTORY_FILE):
+        return []
+    with open(HISTORY_FILE) as f:
+        return [json.loads(line) for line in f if line.strip()]
+
+
+def find_baseline(history, host, commit):
+    for entry in reversed(history):
+        if entry["host"] != host:
+            continue
+        if commit is None or entry["commit"].startswith(commit):
+            return entry
+    return None
+
+
+def compare(baseline, results, threshold):
+    """Print old/new per benchmark; returns the names that regressed"""
+    regressed = []
+    print(f"\n{'Benchmark':<40} {'before ns':>12} {'after ns':>12} {'change':>8}")
+    for name, after in results.items():
+        before = baseline["results"].get(name)
+        if before is None or before == 0:
+            print(f"{name:<40} {'-':>12} {after:>12.1f} {'new':>8}")
+            continue
+        change = (after - before) / before
+        flag = ""
+        if change > threshold:
+            regressed.append(name)
+            flag = "  SLOWER"
+        print(f"{name:<40} {before:>12.1f} {after:>12.1f} {change:>+7.1%}{flag}")
+    return regressed
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run the host benchmarks and track results over commits")
+    parser.add_argument("--binary", default=DEFAULT_BINARY, help="Benchmark program (pio run -e native_bench)")
+    parser.add_argument("--filter", help="Only benchmarks matching this regex")
+    parser.add_argument("--repetitions", type=int, default=5, help="Runs per benchmark (median is kept)")
+    parser.add_argument("--threshold", type=float, default=0.15, help="Allowed slowdown (0.15 = 15%%)")
+    parser.add_argument("--baseline", help="Compare with the run recorded for this commit")
+    parser.add_argument("--no-record", action="store_true", help="Don't append this run to the history")
+    args = parser.parse_args()
+
+    if not os.path.exists(args.binary):
+        sys.exit(f"{args.binary} not found; build it with: pio run -e native_bench")
+
+    results = run_benchmarks(args.binary, args.filter, args.repetitions)
+    host = socket.gethostname()
+    commit = git("rev-parse", "--short", "HEAD") or "unknown"
+    if git("status", "--porcelain", "--untracked-files=no"):
+        commit += "-dirty"
+
+    history = load_history()
+    baseline = find_baseline(history, host, args.baseline)
+    regressed = []
+    if baseline is not None:
+        print(f"Baseline: {baseline['commit']} ({baseline['date']})")
+        regressed = compare(baseline, results, args.threshold)
+    elif args.baseline:
+        print(f"No run recorded for {args.baseline} on {host}")
+    else:
+        print(f"First run on {host}, nothing to compare")
+
+    if not args.no_record:
+        entry = {"commit": commit, "date": datetime.datetime.now().isoformat(timespec="seconds"),
+                 "host": host, "results": results}
+        with open(HISTORY_FILE, "a") as f:
+            f.write(json.dumps(entry) + "\n")
+
+    if regressed:
+        print(f"\n{len(regressed)} benchmark(s) more than {args.threshold:.0%} slower than {baseline['commit']}")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
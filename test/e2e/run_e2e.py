@@ -0,0 +1,630 @@
+#!/usr/bin/env python3
+"""
+End-to-end rig: the firmware's host build against a simulated world
+
+One command runs scripted days of operation at accelerated time:
+- the firmware (pio env native_firmware) as a child process, clock scaled by
+  FEEDER_TIME_SCALE, all its network traffic redirected to the pieces below
+- the simulated HouseLink (test_bintrac_simulator.py's FeedModel): bins drain
+  while the firmware's auger relay is on (relay changes come in over
+  FEEDER_RELAY_FEED), fills and jams land when the scenario says
+- a fake Telegram Bot API (api.telegram.org:443) recording every message and
+  serving the commands the scenario sends
+- a fake NTP server giving the simulated time
+- an HTTP client configuring the firmware and reading status, history and
+  the control loop profile
+
+Then it checks dispensed weights, history, notifications, timing and
+restarts against the scenario's "expect", prints a JSON summary per scenario
+and exits non-zero if any check failed.
+
+Examples:
+  python3 test/e2e/run_e2e.py                          # every scenario in test/e2e/scenarios
+  python3 test/e2e/run_e2e.py test/e2e/scenarios/quick.json --scale 60
+  python3 test/e2e/run_e2e.py --binary .pio/build/native_firmware/program --keep
+
+SCENARIO FILE (JSON):
+  start        Simulated start, ISO 8601 UTC ("2026-03-02T05:50:00Z")
+  end          When to stop: "dN HH:MM[:SS]" (day N after the start date,
+               UTC) or seconds after the start
+  scale        Simulated seconds per real second (default 120)
+  simulator    FeedModel scenario: bins, flow_rate, draw, noise, latency_ms
+  config       Posted to /api/config before the run (feedSchedules,
+               targetWeight, maxRuntime...); Telegram settings are filled in
+  events       [{"at": <time>, <action>}...], actions:
+                 "fill": bin, "amount": lb, "duration": s
+                 "jam": true|false            Auger flow to 0 and back
+                 "flow_rate": lb/s
+                 "network": "down"|"up"       HouseLink, Telegram and NTP
+                 "reboot": true               Power cut: kill -9 and start again
+                 "telegram": "/status"        Command from the configured chat
+                 "api": {"method", "path", "body"}
+  expect       feeds, alarms                 History entries (completed, alarmed)
+               weight_tolerance              lb, each completed feed vs its target
+               dispensed_tolerance           lb per history entry, HouseLink's
+                                             dispensed total vs the history sum
+               notifications                 Substrings each sent message list must contain
+               max_cycle_us, p99_cycle_us    Control cycle limits in host microseconds
+                                             (the profile's simulated us / scale)
+               restarts                      Restarts the rig didn't cause (default 0)
+"""
+
+import argparse
+import asyncio
+import datetime
+import glob
+import http.server
+import json
+import os
+import shutil
+import signal
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+import urllib.request
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(os.path.dirname(HERE))
+sys.path.insert(0, ROOT)
+
+from test_bintrac_simulator import ControlServer, FeedModel, ModbusTCPServer, bin_index  # noqa: E402
+
+DEFAULT_BINARY = os.path.join(ROOT, ".pio", "build", "native_firmware", "program")
+DEFAULT_SCALE = 120
+RESTART_EXIT_CODE = 3  # ESP.restart() in the native shims
+
+TELEGRAM_TOKEN = "123456:e2e-rig"
+TELEGRAM_CHAT_ID = "424242"
+
+NTP_EPOCH_OFFSET = 2208988800  # 1900 -> 1970
+MODBUS_PORT = 502
+NTP_PORT = 123
+TELEGRAM_PORT = 443
+WEB_PORT = 80
+
+
+def free_port():
+    with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as s:
+        s.bind(("127.0.0.1", 0))
+        return s.getsockname()[1]
+
+
+class Clock:
+    """Simulated time: start epoch plus real time since the rig started, times scale"""
+
+    def __init__(self, start_epoch, scale):
+        self.start_epoch = start_epoch
+        self.scale = scale
+        self.real_start = time.monotonic()
+
+    def seconds(self):
+        return (time.monotonic() - self.real_start) * self.scale
+
+    def epoch(self):
+        return self.start_epoch + self.seconds()
+
+    def offset(self, at):
+        """Scenario time ("dN HH:MM[:SS]" or seconds) to seconds after the start"""
+        if isinstance(at, (int, float)):
+            return float(at)
+        day, _, clock = at.strip().partition(" ")
+        if not day.startswith("d"):
+            raise ValueError(f"Bad time {at!r}, expected 'dN HH:MM'")
+        parts = [int(p) for p in clock.split(":")]
+        midnight = self.start_epoch - self.start_epoch % 86400
+        target = midnight + int(day[1:]) * 86400 + parts[0] * 3600 + parts[1] * 60 + (parts[2] if len(parts) > 2 else 0)
+        return float(target - self.start_epoch)
+
+    def real_wait(self, sim_seconds):
+        return max(0.0, sim_seconds - self.seconds()) / self.scale
+
+    def label(self, epoch=None):
+        return datetime.datetime.fromtimestamp(epoch if epoch is not None else self.epoch(),
+                                               datetime.timezone.utc).strftime("%Y-%m-%d %H:%M:%S")
+
+
+class FakeNtp:
+    """Answers NTP requests with the simulated time (silent while offline)"""
+
+    def __init__(self, clock):
+        self.clock = clock
+        self.online = True
+        self.served = 0
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.bind(("127.0.0.1", 0))
+        self.sock.settimeout(0.2)
+        self.port = self.sock.getsockname()[1]
+        self.stopped = False
+        threading.Thread(target=self._serve, daemon=True).start()
+
+    def _serve(self):
+        while not self.stopped:
+            try:
+                data, addr = self.sock.recvfrom(512)
+            except socket.timeout:
+                continue
+            except OSError:
+                break
+            if not self.online or len(data) < 48:
+                continue
+            epoch = self.clock.epoch()
+            seconds = int(epoch) + NTP_EPOCH_OFFSET
+            fraction = int((epoch % 1) * 2**32)
+            reply = bytearray(48)
+            reply[0] = 0x24  # LI 0, version 4, server
+            reply[1] = 1     # Stratum 1
+            reply[24:32] = data[40:48]  # Originate = client's transmit
+            struct.pack_into("!IIII", reply, 32, seconds, fraction, seconds, fraction)
+            self.sock.sendto(bytes(reply), addr)
+            self.served += 1
+
+    def stop(self):
+        self.stopped = True
+        self.sock.close()
+
+
+class FakeTelegram:
+    """Bot API subset the firmware uses: getUpdates and sendMessage
+
+    Records every message sent (with the simulated time) and hands out the
+    commands queued by the scenario. Answers 503 while offline.
+    """
+
+    def __init__(self, clock, token):
+        self.clock = clock
+        self.token = token
+        self.online = True
+        self.lock = threading.Lock()
+        self.sent = []
+        self.updates = []
+        self.next_update_id = 1
+        self.polls = 0
+
+        rig = self
+
+        class Handler(http.server.BaseHTTPRequestHandler):
+            def log_message(self, format, *args):
+                pass
+
+            def do_POST(self):
+                length = int(self.headers.get("Content-Length", 0))
+                body = self.rfile.read(length) if length else b""
+                status, reply = rig.handle(self.path, body)
+                data = json.dumps(reply).encode()
+                self.send_response(status)
+                self.send_header("Content-Type", "application/json")
+                self.send_header("Content-Length", str(len(data)))
+                self.end_headers()
+                self.wfile.write(data)
+
+        self.server = http.server.ThreadingHTTPServer(("127.0.0.1", 0), Handler)
+        self.server.daemon_threads = True
+        self.port = self.server.server_address[1]
+        threading.Thread(target=self.server.serve_forever, daemon=True).start()
+
+    def handle(self, path, body):
+        if not self.online:
+            return 503, {"ok": False, "error_code": 503, "description": "Service Unavailable"}
+        prefix = f"/bot{self.token}/"
+        if not path.startswith(prefix):
+            return 401, {"ok": False, "error_code": 401, "description": "Unauthorized"}
+        try:
+            request = json.loads(body or b"{}")
+        except ValueError:
+            return 400, {"ok": False, "error_code": 400, "description": "Bad Request: can't parse JSON"}
+
+        method = path[len(prefix):]
+        with self.lock:
+            if method == "getUpdates":
+                self.polls += 1
+                offset = int(request.get("offset", 0))
+                self.updates = [u for u in self.updates if u["update_id"] >= offset]
+                return 200, {"ok": True, "result": self.updates[:int(request.get("limit", 100))]}
+            if method == "sendMessage":
+                message = {"time": self.clock.label(), "chat_id": str(request.get("chat_id", "")),
+                           "text": request.get("text", "")}
+                self.sent.append(message)
+                print(f"  [{message['time']}] telegram -> {message['chat_id']}: "
+                      f"{message['text'].splitlines()[0] if message['text'] else ''}")
+                return 200, {"ok": True, "result": {"message_id": len(self.sent), "text": message["text"]}}
+        return 404, {"ok": False, "error_code": 404, "description": "Not Found"}
+
+    def queue_command(self, text, chat_id):
+        with self.lock:
+            epoch = int(self.clock.epoch())
+            self.updates.append({
+                "update_id": self.next_update_id,
+                "message": {"message_id": self.next_update_id, "date": epoch, "text": text,
+                            "chat": {"id": int(chat_id), "type": "private"},
+                            "from": {"id": int(chat_id), "first_name": "Rig", "is_bot": False}},
+            })
+            self.next_update_id += 1
+
+    def stop(self):
+        self.server.shutdown()
+
+
+class Simulator:
+    """FeedModel with its Modbus and control servers on a background event loop"""
+
+    def __init__(self, spec, clock):
+        scenario = dict(spec)
+        scenario.pop("events", None)
+        scenario["start"] = 0  # Simulated seconds since the rig started, like Clock
+        scenario.pop("end", None)
+        self.model = FeedModel(scenario, speed=clock.scale)
+        self.model.real_base = clock.real_start
+        self.base_flow_rate = self.model.flow_rate
+        self.modbus_port = free_port()
+        self.control_port = free_port()
+
+        self.loop = asyncio.new_event_loop()
+        ready = threading.Event()
+
+        async def serve():
+            self.stop_event = asyncio.Event()
+            await ModbusTCPServer(self.modbus_port, self.model, "127.0.0.1").listen()
+            await ControlServer(self.control_port, self.model, self.stop_event, "127.0.0.1").listen()
+            ready.set()
+            await self.stop_event.wait()
+
+        def run():
+            asyncio.set_event_loop(self.loop)
+            self.loop.run_until_complete(serve())
+
+        threading.Thread(target=run, daemon=True).start()
+        if not ready.wait(5):
+            raise RuntimeError("Simulator did not start")
+
+    def stop(self):
+        self.loop.call_soon_threadsafe(self.stop_event.set)
+
+
+class Firmware:
+    """The host firmware as a child process; Serial output goes to a log file"""
+
+    def __init__(self, binary, env, workdir):
+        self.binary = binary
+        self.env = env
+        self.workdir = workdir
+        self.log_path = os.path.join(workdir, "firmware.log")
+        self.process = None
+        self.boots = 0
+
+    def start(self):
+        log = open(self.log_path, "ab")
+        log.write(f"==== boot {self.boots + 1} ====\n".encode())
+        log.flush()
+        self.process = subprocess.Popen([self.binary], env=self.env, cwd=self.workdir,
+                                        stdout=log, stderr=subprocess.STDOUT)
+        log.close()
+        self.boots += 1
+
+    def kill(self):
+        if self.process and self.process.poll() is None:
+            self.process.send_signal(signal.SIGKILL)
+            self.process.wait()
+
+    def exited(self):
+        """Exit code if the process has ended by itself, else None"""
+        return self.process.poll() if self.process else None
+
+
+class Rig:
+    def __init__(self, scenario, binary, scale, workdir, verbose=False):
+        self.scenario = scenario
+        self.workdir = workdir
+        self.verbose = verbose
+        start = datetime.datetime.fromisoformat(scenario["start"].replace("Z", "+00:00"))
+        self.clock = Clock(int(start.timestamp()), float(scale or scenario.get("scale", DEFAULT_SCALE)))
+
+        self.simulator = Simulator(scenario.get("simulator", {}), self.clock)
+        self.ntp = FakeNtp(self.clock)
+        self.telegram = FakeTelegram(self.clock, TELEGRAM_TOKEN)
+
+        port_offset = free_port() // 100 * 100
+        self.web_port = port_offset + WEB_PORT
+        env = dict(os.environ)
+        env.update({
+            "FEEDER_DATA_DIR": os.path.join(workdir, "data"),
+            "FEEDER_PORT_OFFSET": str(port_offset),
+            "FEEDER_TIME_SCALE": str(self.clock.scale),
+            "FEEDER_RELAY_FEED": f"127.0.0.1:{self.simulator.control_port}",
+            "FEEDER_REDIRECT": ",".join([
+                f"{MODBUS_PORT}=127.0.0.1:{self.simulator.modbus_port}",
+                f"{NTP_PORT}=127.0.0.1:{self.ntp.port}",
+                f"{TELEGRAM_PORT}=127.0.0.1:{self.telegram.port}",
+            ]),
+        })
+        os.makedirs(env["FEEDER_DATA_DIR"], exist_ok=True)
+        self.firmware = Firmware(binary, env, workdir)
+
+        self.rig_reboots = 0
+        self.restarts = []  # Exits the rig didn't cause: (time, exit code)
+        self.states = []    # (time, state, stage) transitions
+        self.worst_cycle_us = 0
+        self.worst_p99_us = 0
+        self.late_events = 0
+
+    # ---- Firmware API ----
+
+    def api(self, method, path, body=None, timeout=5):
+        data = json.dumps(body).encode() if body is not None else None
+        request = urllib.request.Request(f"http://127.0.0.1:{self.web_port}{path}", data=data, method=method,
+                                         headers={"Content-Type": "application/json"} if data else {})
+        with urllib.request.urlopen(request, timeout=timeout) as response:
+            reply = json.loads(response.read() or b"{}")
+            return reply if isinstance(reply, dict) else {}
+
+    def wait_for_web(self, timeout=20):
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            self.check_process()
+            try:
+                return self.api("GET", "/api/status", timeout=1)
+            except (OSError, ValueError):
+                time.sleep(0.1)
+        raise RuntimeError("Firmware web server did not come up (see firmware.log)")
+
+    # ---- Supervision ----
+
+    def check_process(self):
+        code = self.firmware.exited()
+        if code is None:
+            return
+        self.restarts.append({"time": self.clock.label(), "exitCode": code})
+        print(f"  [{self.clock.label()}] firmware exited with {code}"
+              f"{' (restart requested)' if code == RESTART_EXIT_CODE else ''}, starting it again")
+        self.firmware.start()
+
+    def sample_profile(self):
+        try:
+            profile = self.api("GET", "/api/profile", timeout=2)
+        except (OSError, ValueError):
+            return
+        cycle = profile.get("controlCycle", {})
+        self.worst_cycle_us = max(self.worst_cycle_us, cycle.get("maxUs", 0) / self.clock.scale)
+        self.worst_p99_us = max(self.worst_p99_us, cycle.get("p99Us", 0) / self.clock.scale)
+
+    def sample_status(self):
+        try:
+            status = self.api("GET", "/api/status", timeout=2)
+        except (OSError, ValueError):
+            return
+        state = (status.get("state"), status.get("feedingStage"))
+        if not self.states or self.states[-1][1:] != state:
+            self.states.append((self.clock.label(), *state))
+            if self.verbose:
+                print(f"  [{self.clock.label()}] state {state[0]} stage {state[1]} "
+                      f"dispensed {status.get('weightDispensed', 0):.1f}")
+
+    def run_until(self, sim_seconds):
+        """Supervise and sample until the simulated time is reached"""
+        last_profile = 0
+        while True:
+            wait = self.clock.real_wait(sim_seconds)
+            if wait <= 0:
+                return
+            time.sleep(min(wait, 0.25))
+            self.check_process()
+            self.sample_status()
+            if time.monotonic() - last_profile > 5:
+                self.sample_profile()
+                last_profile = time.monotonic()
+
+    def reboot(self):
+        self.sample_profile()
+        self.firmware.kill()
+        self.rig_reboots += 1
+        self.firmware.start()
+
+    # ---- Scenario ----
+
+    def apply(self, event):
+        model = self.simulator.model
+        if "fill" in event:
+            model.fill(bin_index(event["fill"]), float(event.get("amount", 0)), float(event.get("duration", 0)))
+        if "jam" in event:
+            model.set_flow_rate(0 if event["jam"] else self.simulator.base_flow_rate)
+        if "flow_rate" in event:
+            model.set_flow_rate(float(event["flow_rate"]))
+        if "network" in event:
+            online = event["network"] == "up"
+            model.set_fault("offline" if not online else "clear", {})
+            self.telegram.online = online
+            self.ntp.online = online
+        if "telegram" in event:
+            self.telegram.queue_command(event["telegram"], TELEGRAM_CHAT_ID)
+        if "api" in event:
+            call = event["api"]
+            try:
+                self.api(call.get("method", "POST"), call["path"], call.get("body"))
+            except (OSError, ValueError) as e:
+                print(f"  [{self.clock.label()}] api {call['path']} failed: {e}")
+        if event.get("reboot"):
+            self.reboot()
+
+    def configure(self):
+        config = dict(self.scenario.get("config", {}))
+        config.setdefault("bintracIP", "127.0.0.1")
+        config.setdefault("timezone", 0)
+        config.setdefault("autoFeedEnabled", True)
+        config.update({"telegramEnabled": True, "telegramToken": TELEGRAM_TOKEN,
+                       "telegramChatID": TELEGRAM_CHAT_ID, "telegramAllowedUsers": TELEGRAM_CHAT_ID})
+        self.api("POST", "/api/config", config)
+
+    def run(self):
+        print(f"Scenario: {self.scenario.get('description', '')}")
+        print(f"  {self.clock.label()} at {self.clock.scale:g}x, work dir {self.workdir}")
+
+        # First boot takes the config; Telegram starts on the next boot
+        self.firmware.start()
+        self.wait_for_web()
+        self.configure()
+        self.reboot()
+        self.rig_reboots = 0
+        self.wait_for_web()
+
+        for event in sorted(self.scenario.get("events", []), key=lambda e: self.clock.offset(e["at"])):
+            at = self.clock.offset(event["at"])
+            self.run_until(at)
+            if self.clock.seconds() - at > 60:
+                self.late_events += 1
+            described = {k: v for k, v in event.items() if k != "at"}
+            print(f"  [{self.clock.label()}] {json.dumps(described)}")
+            self.apply(event)
+
+        self.run_until(self.clock.offset(self.scenario["end"]))
+        return self.collect()
+
+    def collect(self):
+        self.check_process()
+        self.sample_profile()
+        history = []
+        for _ in range(20):
+            try:
+                history = self.api("GET", "/api/history").get("history", [])
+                break
+            except (OSError, ValueError):
+                time.sleep(0.25)
+        simulator = self.simulator.model.status()
+        with self.telegram.lock:
+            sent = list(self.telegram.sent)
+            polls = self.telegram.polls
+        return {"history": history, "simulator": simulator, "sent": sent, "telegramPolls": polls}
+
+    def stop(self):
+        self.firmware.kill()
+        self.simulator.stop()
+        self.telegram.stop()
+        self.ntp.stop()
+
+
+def check(scenario, rig, results):
+    """Each expectation as {name, ok, detail}"""
+    expect = scenario.get("expect", {})
+    checks = []
+
+    def add(name, ok, detail):
+        checks.append({"name": name, "ok": bool(ok), "detail": detail})
+
+    history = results["history"]
+    completed = [e for e in history if not e.get("alarmTriggered")]
+    alarmed = [e for e in history if e.get("alarmTriggered")]
+
+    if "feeds" in expect:
+        add("feeds", len(completed) == expect["feeds"], f"{len(completed)} completed, expected {expect['feeds']}")
+    if "alarms" in expect:
+        add("alarms", len(alarmed) == expect["alarms"],
+            f"{len(alarmed)} alarmed ({', '.join(e.get('alarmReason', '') for e in alarmed) or 'none'}), "
+            f"expected {expect['alarms']}")
+
+    if "weight_tolerance" in expect:
+        tolerance = expect["weight_tolerance"]
+        off = [e for e in completed if abs(e["actualWeight"] - e["targetWeight"]) > tolerance]
+        add("weights", not off and completed,
+            f"{len(completed) - len(off)}/{len(completed)} feeds within {tolerance} lb of target"
+            + "".join(f"; cycle {e['feedCycle'] + 1} {e['actualWeight']:.1f}/{e['targetWeight']:.1f}" for e in off))
+
+    if "dispensed_tolerance" in expect:
+        recorded = sum(e["actualWeight"] for e in history)
+        dispensed = results["simulator"]["stats"]["dispensed"]
+        allowed = expect["dispensed_tolerance"] * max(1, len(history))
+        add("dispensed", abs(dispensed - recorded) <= allowed,
+            f"HouseLink dispensed {dispensed:.1f} lb, history {recorded:.1f} lb (allowed {allowed:.1f})")
+
+    for text in expect.get("notifications", []):
+        found = sum(1 for m in results["sent"] if text in m["text"])
+        add(f"notification '{text}'", found > 0, f"{found} sent")
+
+    if "max_cycle_us" in expect:
+        add("max control cycle", rig.worst_cycle_us <= expect["max_cycle_us"],
+            f"{rig.worst_cycle_us:.0f} us (limit {expect['max_cycle_us']})")
+    if "p99_cycle_us" in expect:
+        add("p99 control cycle", rig.worst_p99_us <= expect["p99_cycle_us"],
+            f"{rig.worst_p99_us:.0f} us (limit {expect['p99_cycle_us']})")
+
+    allowed_restarts = expect.get("restarts", 0)
+    add("restarts", len(rig.restarts) <= allowed_restarts,
+        f"{len(rig.restarts)} unexpected ({rig.restarts}), {rig.rig_reboots} by the rig")
+    return checks
+
+
+def run_scenario(path, args):
+    with open(path) as f:
+        scenario = json.load(f)
+    workdir = tempfile.mkdtemp(prefix="feeder_e2e_", dir=args.workdir)
+    rig = Rig(scenario, args.binary, args.scale, workdir, args.verbose)
+    try:
+        results = rig.run()
+    finally:
+        rig.stop()
+
+    checks = check(scenario, rig, results)
+    passed = all(c["ok"] for c in checks)
+    summary = {
+        "scenario": os.path.relpath(path, ROOT),
+        "passed": passed,
+        "scale": rig.clock.scale,
+        "checks": checks,
+        "history": results["history"],
+        "notifications": results["sent"],
+        "telegramPolls": results["telegramPolls"],
+        "ntpServed": rig.ntp.served,
+        "simulator": results["simulator"],
+        "states": rig.states,
+        "boots": rig.firmware.boots,
+        "lateEvents": rig.late_events,
+        "workdir": workdir,
+    }
+
+    for c in checks:
+        print(f"  {'PASS' if c['ok'] else 'FAIL'}  {c['name']}: {c['detail']}")
+    if passed and not args.keep:
+        shutil.rmtree(workdir, ignore_errors=True)
+        summary["workdir"] = None
+    else:
+        print(f"  Firmware log: {rig.firmware.log_path}")
+    return summary
+
+
+def main():
+    parser = argparse.ArgumentParser(description="End-to-end rig for the feeder firmware's host build",
+                                     formatter_class=argparse.RawDescriptionHelpFormatter, epilog=__doc__)
+    parser.add_argument("scenarios", nargs="*", help="Scenario files (default: test/e2e/scenarios/*.json)")
+    parser.add_argument("--binary", help="Firmware program (default: build env native_firmware with pio)")
+    parser.add_argument("--scale", type=float, help=f"Time scale (default: the scenario's, else {DEFAULT_SCALE})")
+    parser.add_argument("--report", help="Write the JSON summary here as well")
+    parser.add_argument("--workdir", help="Where run directories go (default: system temp)")
+    parser.add_argument("--keep", action="store_true", help="Keep run directories of passing scenarios")
+    parser.add_argument("--verbose", action="store_true", help="Print firmware state changes")
+    args = parser.parse_args()
+
+    if args.binary is None:
+        print("Building env native_firmware...")
+        if subprocess.run(["pio", "run", "-e", "native_firmware"], cwd=ROOT).returncode != 0:
+            return 2
+        args.binary = DEFAULT_BINARY
+    args.binary = os.path.abspath(args.binary)
+
+    paths = args.scenarios or sorted(glob.glob(os.path.join(HERE, "scenarios", "*.json")))
+    summaries = [run_scenario(path, args) for path in paths]
+
+    report = json.dumps(summaries, indent=2)
+    print(report)
+    if args.report:
+        with open(args.report, "w") as f:
+            f.write(report + "\n")
+
+    failed = [s["scenario"] for s in summaries if not s["passed"]]
+    print(f"{len(summaries) - len(failed)}/{len(summaries)} scenarios passed" +
+          (f"; failed: {', '.join(failed)}" if failed else ""))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
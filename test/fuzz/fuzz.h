@@ -0,0 +1,48 @@
+#ifndef FUZZ_H
+#define FUZZ_H
+
+// Fuzz target entry points for the native build
+// Built with clang -fsanitize=fuzzer each FUZZ_TARGET is libFuzzer's
+// LLVMFuzzerTestOneInput (one target per program, see platformio.ini).
+// With FUZZ_REPLAY every target registers with replay_main.cpp instead, so
+// one gcc-built program replays all the corpora under ASan/UBSan.
+
+#include <Arduino.h>
+
+typedef int (*FuzzTargetFunction)(const uint8_t* data, size_t size);
+
+struct FuzzTarget {
+    const char* name;
+    FuzzTargetFunction run;
+    FuzzTarget* next;
+
+    FuzzTarget(const char* targetName, FuzzTargetFunction function)
+        : name(targetName), run(function), next(first) {
+        first = this;
+    }
+
+    static FuzzTarget* first;
+};
+
+#ifdef FUZZ_REPLAY
+#define FUZZ_TARGET(name) \
+    static int fuzz_##name(const uint8_t* data, size_t size); \
+    static FuzzTarget fuzzTarget_##name(#name, fuzz_##name); \
+    static int fuzz_##name(const uint8_t* data, size_t size)
+#else
+#define FUZZ_TARGET(name) extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+#endif
+
+// Shared once-per-process setup: frozen clock, a scratch data dir, network lock
+void fuzzSetup();
+
+// Abort (a finding) when an invariant of the code under test doesn't hold
+#define FUZZ_CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            abort(); \
+        } \
+    } while (0)
+
+#endif // FUZZ_H
@@ -0,0 +1,20 @@
+// Setup shared by the fuzz targets (and the replay driver's target table)
+
+#include "fuzz.h"
+#include "net_lock.h"
+
+#define FUZZ_DATA_DIR ".native_fuzz_data"
+
+FuzzTarget* FuzzTarget::first = nullptr;
+
+void fuzzSetup() {
+    static bool done = false;
+    if (done) return;
+    done = true;
+
+    NativeShim::setDataDir(FUZZ_DATA_DIR);
+    NativeShim::clearDataDir();
+    NativeShim::setMillis(60000);
+    NativeShim::setWallClock(1760000000UL);
+    NetLock::begin();
+}
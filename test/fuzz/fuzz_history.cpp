@@ -0,0 +1,41 @@
+// Fuzz target: feed history CSV parsing (Storage::getFeedHistory())
+// The input is the history file as found on flash: possibly truncated by a
+// power cut, hand edited, or written by an older firmware.
+// Corpus: test/fuzz/corpus/history (files pulled from units).
+
+#include "fuzz.h"
+#include "config.h"
+#include "types.h"
+#include "storage.h"
+#include <LittleFS.h>
+
+static Storage storage;
+static FeedEvent events[WEB_HISTORY_ENTRIES];
+
+FUZZ_TARGET(history) {
+    static bool started = false;
+    if (!started) {
+        started = true;
+        fuzzSetup();
+        storage.begin();
+    }
+
+    File file = LittleFS.open(HISTORY_FILE, "w");
+    if (!file) return 0;
+    file.write(data, size);
+    file.close();
+
+    int count = -1;
+    FUZZ_CHECK(storage.getFeedHistory(events, count, WEB_HISTORY_ENTRIES));
+    FUZZ_CHECK(count >= 0 && count <= WEB_HISTORY_ENTRIES);
+
+    for (int i = 0; i < count; i++) {
+        FUZZ_CHECK(memchr(events[i].alarmReason, '\0', sizeof(events[i].alarmReason)) != nullptr);
+    }
+
+    // The next record appends cleanly whatever the file held
+    FeedEvent event = {};
+    event.timestamp = 1760000000UL;
+    FUZZ_CHECK(storage.addFeedEvent(event));
+    return 0;
+}
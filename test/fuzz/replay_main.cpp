@@ -0,0 +1,98 @@
+// Corpus replay for builds without libFuzzer (FUZZ_REPLAY)
+// Runs files through the registered fuzz targets once each, under whatever
+// sanitizers the program was built with:
+//
+//   program                       every target over test/fuzz/corpus/<target>
+//   program <target> [paths...]   one target over the given files/directories
+//
+// Exits non-zero if a target returns non-zero; crashes and sanitizer
+// reports abort the run with the offending file printed first.
+
+#include "fuzz.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+
+#ifndef FUZZ_CORPUS_DIR
+#define FUZZ_CORPUS_DIR "test/fuzz/corpus"
+#endif
+
+static bool readFile(const char* path, std::vector<uint8_t>& data) {
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) return false;
+    data.clear();
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) data.insert(data.end(), chunk, chunk + n);
+    fclose(file);
+    return true;
+}
+
+// Returns the number of failures; files counts the inputs run
+static int replayPath(FuzzTarget* target, const std::string& path, int& files) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        fprintf(stderr, "%s: not found\n", path.c_str());
+        return 1;
+    }
+
+    if (S_ISDIR(st.st_mode)) {
+        DIR* dir = opendir(path.c_str());
+        if (dir == nullptr) return 1;
+        std::vector<std::string> names;
+        while (dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') names.push_back(entry->d_name);
+        }
+        closedir(dir);
+        std::sort(names.begin(), names.end());
+
+        int failures = 0;
+        for (const std::string& name : names) failures += replayPath(target, path + "/" + name, files);
+        return failures;
+    }
+
+    std::vector<uint8_t> data;
+    if (!readFile(path.c_str(), data)) {
+        fprintf(stderr, "%s: unreadable\n", path.c_str());
+        return 1;
+    }
+    fprintf(stderr, "%s: %s (%u bytes)\n", target->name, path.c_str(), (unsigned)data.size());
+    files++;
+    return target->run(data.data(), data.size()) == 0 ? 0 : 1;
+}
+
+static FuzzTarget* findTarget(const char* name) {
+    for (FuzzTarget* target = FuzzTarget::first; target != nullptr; target = target->next) {
+        if (strcmp(target->name, name) == 0) return target;
+    }
+    return nullptr;
+}
+
+int main(int argc, char** argv) {
+    // Paths are relative to where the program was started
+    char corpusDir[512];
+    const char* env = getenv("FUZZ_CORPUS_DIR");
+    strlcpy(corpusDir, env != nullptr ? env : FUZZ_CORPUS_DIR, sizeof(corpusDir));
+
+    int failures = 0;
+    int files = 0;
+    if (argc > 1) {
+        FuzzTarget* target = findTarget(argv[1]);
+        if (target == nullptr) {
+            fprintf(stderr, "No fuzz target '%s'\n", argv[1]);
+            return 2;
+        }
+        if (argc == 2) {
+            failures += replayPath(target, std::string(corpusDir) + "/" + target->name, files);
+        }
+        for (int i = 2; i < argc; i++) failures += replayPath(target, argv[i], files);
+    } else {
+        for (FuzzTarget* target = FuzzTarget::first; target != nullptr; target = target->next) {
+            failures += replayPath(target, std::string(corpusDir) + "/" + target->name, files);
+        }
+    }
+
+    printf("Replayed %d inputs, %d failures\n", files, failures);
+    return failures == 0 ? 0 : 1;
+}
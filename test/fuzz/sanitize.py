@@ -0,0 +1,14 @@
+# PlatformIO pre-script for the fuzz environments
+# Adds -fsanitize=<custom_sanitize> to compile and link; libFuzzer
+# ("fuzzer") comes with clang only, so those builds switch compilers.
+
+Import("env")
+
+sanitizers = env.GetProjectOption("custom_sanitize")
+if "fuzzer" in sanitizers.split(","):
+    env.Replace(CC="clang", CXX="clang++", LINK="clang++")
+
+env.Append(
+    CCFLAGS=["-fsanitize=" + sanitizers, "-fno-omit-frame-pointer", "-g"],
+    LINKFLAGS=["-fsanitize=" + sanitizers],
+)
@@ -0,0 +1,195 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Host stand-in for the ESP32 Arduino core (native test environment)
+// Covers what the firmware modules use: timing (simulated, see
+// native_shim.h), GPIO, String, Print/Stream, IPAddress, Serial and ESP.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdarg.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <string>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "native_shim.h"
+
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define RISING 1
+#define FALLING 2
+#define CHANGE 3
+
+#define A0 36  // ADC1_CH0 (SSLClient's entropy pin)
+
+#define IRAM_ATTR
+#define digitalPinToInterrupt(pin) (pin)
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+inline uint16_t word(uint8_t high, uint8_t low) { return (uint16_t)(high << 8 | low); }
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+void detachInterrupt(uint8_t pin);
+
+#if defined(__GLIBC__) && !(__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 38))
+extern "C" size_t strlcpy(char* dst, const char* src, size_t size);
+#endif
+
+// Arduino String over std::string (only the members the firmware uses)
+class String {
+public:
+    String(const char* text = "") : _text(text != nullptr ? text : "") {}
+    String(const std::string& text) : _text(text) {}
+    explicit String(int value) : _text(std::to_string(value)) {}
+    explicit String(unsigned int value) : _text(std::to_string(value)) {}
+    explicit String(long value) : _text(std::to_string(value)) {}
+    explicit String(unsigned long value) : _text(std::to_string(value)) {}
+
+    const char* c_str() const { return _text.c_str(); }
+    unsigned int length() const { return _text.length(); }
+    bool isEmpty() const { return _text.empty(); }
+    bool concat(const char* text) { _text += text; return true; }
+    String& operator+=(const char* text) { _text += text; return *this; }
+    String& operator+=(const String& text) { _text += text._text; return *this; }
+    String& operator+=(char c) { _text += c; return *this; }
+    bool operator==(const char* text) const { return _text == text; }
+    bool operator==(const String& text) const { return _text == text._text; }
+    bool operator!=(const char* text) const { return _text != text; }
+    char operator[](unsigned int index) const { return index < _text.size() ? _text[index] : 0; }
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t pos = _text.find(c, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    String substring(unsigned int from, unsigned int to = 0xFFFFFFFF) const {
+        if (from > _text.size()) return String();
+        return String(_text.substr(from, to == 0xFFFFFFFF ? std::string::npos : to - from));
+    }
+    long toInt() const { return strtol(_text.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(_text.c_str(), nullptr); }
+    void trim() {
+        size_t start = _text.find_first_not_of(" \t\r\n");
+        size_t end = _text.find_last_not_of(" \t\r\n");
+        _text = start == std::string::npos ? "" : _text.substr(start, end - start + 1);
+    }
+
+private:
+    std::string _text;
+};
+
+inline String operator+(const String& a, const String& b) { String s(a); s += b; return s; }
+inline String operator+(const String& a, const char* b) { String s(a); s += b; return s; }
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buf, size_t size) {
+        size_t n = 0;
+        while (size-- > 0 && write(*buf++) == 1) n++;
+        return n;
+    }
+    size_t write(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+    size_t print(const char* text) { return write(text); }
+    size_t print(const String& text) { return write(text.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int value) { return printf("%d", value); }
+    size_t print(unsigned int value) { return printf("%u", value); }
+    size_t print(long value) { return printf("%ld", value); }
+    size_t print(unsigned long value) { return printf("%lu", value); }
+    size_t print(double value, int digits = 2) { return printf("%.*f", digits, value); }
+    template <typename T>
+    size_t println(const T& value) { return print(value) + write("\r\n"); }
+    size_t println() { return write("\r\n"); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    virtual void flush() {}
+    void setWriteError(int error = 1) { _writeError = error; }
+    int getWriteError() const { return _writeError; }
+
+private:
+    int _writeError = 0;
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    void setTimeout(unsigned long timeoutMs) { _timeout = timeoutMs; }
+    size_t readBytes(uint8_t* buf, size_t length);
+    size_t readBytes(char* buf, size_t length) { return readBytes((uint8_t*)buf, length); }
+    size_t readBytesUntil(char terminator, char* buf, size_t length);
+
+protected:
+    unsigned long _timeout = 1000;
+    int timedRead();
+};
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) {}
+    size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+    size_t write(const uint8_t* buf, size_t size) override { return fwrite(buf, 1, size, stdout); }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() override { fflush(stdout); }
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+class IPAddress {
+public:
+    IPAddress() : _address(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : _address((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {}
+    IPAddress(uint32_t address) : _address(address) {}
+
+    bool fromString(const char* text);
+    String toString() const;
+    operator uint32_t() const { return _address; }
+    uint8_t operator[](int index) const { return (_address >> (index * 8)) & 0xFF; }
+    bool operator==(const IPAddress& other) const { return _address == other._address; }
+
+private:
+    uint32_t _address;  // Network order, like the core: [0] is the first octet
+};
+
+class EspClass {
+public:
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getCycleCount();        // From the host's monotonic clock at 240 MHz
+    uint64_t getEfuseMac();          // $FEEDER_EFUSE_MAC (hex), else one per process
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    void restart();                  // Exits with NativeShim::RESTART_EXIT_CODE
+};
+
+extern EspClass ESP;
+
+uint32_t esp_random();  // Host random device
+
+#endif // NATIVE_ARDUINO_H
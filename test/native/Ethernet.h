@@ -0,0 +1,154 @@
+#ifndef NATIVE_ETHERNET_H
+#define NATIVE_ETHERNET_H
+
+// Host stand-in for the Ethernet 2.x library over POSIX sockets (native test environment)
+// Keeps the W5500's model: MAX_SOCK_NUM hardware sockets, clients that are
+// just socket numbers, and a server whose listening socket becomes the
+// connection when a client arrives (and a new listener is opened). Servers
+// listen on NativeShim::hostPort(port); outbound traffic follows
+// NativeShim::redirect(). The chip reports EthernetNoHardware, so the
+// W5500-only paths (burst SPI, socket interrupts) stay off.
+
+#include <Arduino.h>
+
+#define MAX_SOCK_NUM 8
+
+enum EthernetLinkStatus {
+    Unknown,
+    LinkON,
+    LinkOFF
+};
+
+enum EthernetHardwareStatus {
+    EthernetNoHardware,
+    EthernetW5100,
+    EthernetW5200,
+    EthernetW5500
+};
+
+class Client : public Stream {
+public:
+    virtual int connect(IPAddress ip, uint16_t port) = 0;
+    virtual int connect(const char* host, uint16_t port) = 0;
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t* buf, size_t size) = 0;
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int read(uint8_t* buf, size_t size) = 0;
+    virtual int peek() = 0;
+    virtual void flush() = 0;
+    virtual void stop() = 0;
+    virtual uint8_t connected() = 0;
+    virtual operator bool() = 0;
+    using Print::write;
+};
+
+class EthernetClass {
+public:
+    int begin(uint8_t* mac, unsigned long timeout = 60000, unsigned long responseTimeout = 4000);
+    void begin(uint8_t* mac, IPAddress ip);
+    void begin(uint8_t* mac, IPAddress ip, IPAddress dns);
+    void begin(uint8_t* mac, IPAddress ip, IPAddress dns, IPAddress gateway);
+    void begin(uint8_t* mac, IPAddress ip, IPAddress dns, IPAddress gateway, IPAddress subnet);
+    void init(uint8_t csPin) {}
+    int maintain() { return 0; }
+    EthernetLinkStatus linkStatus() { return LinkON; }
+    EthernetHardwareStatus hardwareStatus() { return EthernetNoHardware; }
+    void MACAddress(uint8_t* mac);
+    IPAddress localIP() { return _localIP; }
+    IPAddress subnetMask() { return IPAddress(255, 255, 255, 0); }
+    IPAddress gatewayIP() { return IPAddress(127, 0, 0, 1); }
+    IPAddress dnsServerIP() { return IPAddress(127, 0, 0, 1); }
+
+private:
+    uint8_t _mac[6] = {0};
+    IPAddress _localIP = IPAddress(127, 0, 0, 1);
+};
+
+extern EthernetClass Ethernet;
+
+class EthernetClient : public Client {
+public:
+    EthernetClient() : _sockindex(MAX_SOCK_NUM), _timeout(1000) {}
+    EthernetClient(uint8_t s) : _sockindex(s), _timeout(1000) {}
+
+    uint8_t status();
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    virtual int availableForWrite();
+    size_t write(uint8_t b) override;
+    size_t write(const uint8_t* buf, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buf, size_t size) override;
+    int peek() override;
+    void flush() override {}
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override { return _sockindex < MAX_SOCK_NUM; }
+    uint8_t getSocketNumber() const { return _sockindex; }
+    virtual uint16_t localPort();
+    virtual IPAddress remoteIP();
+    virtual uint16_t remotePort();
+    virtual void setConnectionTimeout(uint16_t timeout) { _timeout = timeout; }
+    using Print::write;
+
+private:
+    uint8_t _sockindex;  // MAX_SOCK_NUM = not in use
+    uint16_t _timeout;
+
+    int connectTo(const char* host, uint16_t port);
+};
+
+class EthernetServer {
+public:
+    EthernetServer(uint16_t port) : _port(port) {}
+    virtual ~EthernetServer() {}
+    virtual void begin(uint16_t port = 0);
+    EthernetClient available();
+    EthernetClient accept();
+
+    // Port each hardware socket is serving (0 = none), as in the library
+    static uint16_t server_port[MAX_SOCK_NUM];
+
+private:
+    uint16_t _port;
+};
+
+class EthernetUDP : public Stream {
+public:
+    uint8_t begin(uint16_t port);
+    uint8_t beginMulticast(IPAddress ip, uint16_t port);
+    void stop();
+    int beginPacket(IPAddress ip, uint16_t port);
+    int beginPacket(const char* host, uint16_t port);
+    int endPacket();
+    size_t write(uint8_t b) override;
+    size_t write(const uint8_t* buf, size_t size) override;
+    int parsePacket();
+    int available() override;
+    int read() override;
+    int read(uint8_t* buf, size_t size);
+    int read(char* buf, size_t size) { return read((uint8_t*)buf, size); }
+    int peek() override;
+    void flush() override {}
+    IPAddress remoteIP() { return _remoteIP; }
+    uint16_t remotePort() { return _remotePort; }
+    uint16_t localPort() { return _port; }
+    using Print::write;
+
+private:
+    uint8_t _sockindex = MAX_SOCK_NUM;
+    uint16_t _port = 0;
+    uint8_t _txBuffer[1472];
+    size_t _txLength = 0;
+    char _txHost[64] = "";
+    uint16_t _txPort = 0;
+    uint8_t _rxBuffer[1472];
+    size_t _rxLength = 0;
+    size_t _rxPos = 0;
+    IPAddress _remoteIP;
+    uint16_t _remotePort = 0;
+};
+
+#endif // NATIVE_ETHERNET_H
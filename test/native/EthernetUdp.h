@@ -0,0 +1,7 @@
+#ifndef NATIVE_ETHERNET_UDP_H
+#define NATIVE_ETHERNET_UDP_H
+
+// EthernetUDP lives in Ethernet.h, as in the library
+#include "Ethernet.h"
+
+#endif // NATIVE_ETHERNET_UDP_H
@@ -0,0 +1,58 @@
+#ifndef NATIVE_LITTLEFS_H
+#define NATIVE_LITTLEFS_H
+
+// Host stand-in for LittleFS (native test environment)
+// Paths map into <data dir>/fs/, so "/history.csv" is a plain file tests can
+// inspect or seed.
+
+#include <Arduino.h>
+
+class File : public Stream {
+public:
+    File() : _file(nullptr), _size(0) {}
+    File(FILE* file, const char* path);
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t size) override;
+    int available() override;
+    int read() override;
+    size_t read(uint8_t* buf, size_t size);
+    int peek() override;
+    void flush() override;
+    bool seek(size_t position);
+    size_t position();
+    size_t size();
+    void close();
+    const char* name() const { return _name; }
+    operator bool() const { return _file != nullptr; }
+    using Print::write;
+
+private:
+    FILE* _file;
+    size_t _size;
+    char _name[64] = "";
+};
+
+class LittleFSFS {
+public:
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = "spiffs");
+    void end() { _mounted = false; }
+    bool format();
+    File open(const char* path, const char* mode = "r");
+    bool exists(const char* path);
+    bool remove(const char* path);
+    bool rename(const char* from, const char* to);
+    bool mkdir(const char* path);
+    size_t totalBytes();
+    size_t usedBytes();
+
+private:
+    bool _mounted = false;
+
+    bool hostPath(const char* path, char* out, size_t size);
+};
+
+extern LittleFSFS LittleFS;
+
+#endif // NATIVE_LITTLEFS_H
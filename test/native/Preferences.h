@@ -0,0 +1,63 @@
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+// Host stand-in for the ESP32 NVS Preferences library (native test environment)
+// Each key is a file under <data dir>/nvs/<namespace>/ holding the value's
+// raw bytes, so settings survive a restart of the host process like they
+// survive a reboot.
+
+#include <Arduino.h>
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false);
+    void end();
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putChar(const char* key, int8_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putUChar(const char* key, uint8_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putShort(const char* key, int16_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putUShort(const char* key, uint16_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putInt(const char* key, int32_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putLong(const char* key, int32_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putULong(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putFloat(const char* key, float value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putBool(const char* key, bool value) { return putUChar(key, value ? 1 : 0); }
+    size_t putString(const char* key, const char* value) { return putBytes(key, value, strlen(value)); }
+    size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+    size_t putBytes(const char* key, const void* value, size_t length);
+
+    int8_t getChar(const char* key, int8_t defaultValue = 0) { return getValue(key, defaultValue); }
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return getValue(key, defaultValue); }
+    int16_t getShort(const char* key, int16_t defaultValue = 0) { return getValue(key, defaultValue); }
+    uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return getValue(key, defaultValue); }
+    int32_t getInt(const char* key, int32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    int32_t getLong(const char* key, int32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    uint32_t getULong(const char* key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    float getFloat(const char* key, float defaultValue = 0) { return getValue(key, defaultValue); }
+    bool getBool(const char* key, bool defaultValue = false) { return getUChar(key, defaultValue ? 1 : 0) != 0; }
+    size_t getString(const char* key, char* value, size_t maxLength);
+    String getString(const char* key, const char* defaultValue = "");
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* value, size_t maxLength);
+
+private:
+    char _path[256] = "";
+    bool _readOnly = false;
+
+    bool keyPath(const char* key, char* path, size_t size);
+
+    // Stored values of the wrong size read as missing, like a type mismatch in NVS
+    template <typename T>
+    T getValue(const char* key, T defaultValue) {
+        T value;
+        if (getBytesLength(key) != sizeof(T)) return defaultValue;
+        return getBytes(key, &value, sizeof(T)) == sizeof(T) ? value : defaultValue;
+    }
+};
+
+#endif // NATIVE_PREFERENCES_H
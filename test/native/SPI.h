@@ -0,0 +1,31 @@
+#ifndef NATIVE_SPI_H
+#define NATIVE_SPI_H
+
+// Host stand-in for the SPI driver (native test environment)
+// There is no W5500 on the host, so nothing reaches here at runtime.
+
+#include <Arduino.h>
+
+#define MSBFIRST 1
+#define SPI_MODE0 0
+
+class SPISettings {
+public:
+    SPISettings(uint32_t clock = 1000000, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0) {}
+};
+
+class SPIClass {
+public:
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {}
+    void beginTransaction(SPISettings settings) {}
+    void endTransaction() {}
+    uint8_t transfer(uint8_t data) { return 0; }
+    void writeBytes(const uint8_t* data, uint32_t size) {}
+    void transferBytes(const uint8_t* data, uint8_t* out, uint32_t size) {
+        if (out != nullptr) memset(out, 0, size);
+    }
+};
+
+extern SPIClass SPI;
+
+#endif // NATIVE_SPI_H
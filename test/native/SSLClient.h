@@ -0,0 +1,37 @@
+#ifndef NATIVE_SSLCLIENT_H
+#define NATIVE_SSLCLIENT_H
+
+// Host stand-in for SSLClient (native firmware build)
+// No TLS: everything passes straight through to the wrapped client, so the
+// Telegram bot talks plain HTTP to whatever 443 is redirected to (the
+// end-to-end rig's fake Bot API, see NativeShim::redirect()).
+
+#include <Ethernet.h>
+
+struct br_x509_trust_anchor;
+
+class SSLClient : public Client {
+public:
+    SSLClient(Client& client, const br_x509_trust_anchor* trustAnchors, size_t trustAnchorCount,
+              int analogPin)
+        : _client(client) {}
+
+    int connect(IPAddress ip, uint16_t port) override { return _client.connect(ip, port); }
+    int connect(const char* host, uint16_t port) override { return _client.connect(host, port); }
+    size_t write(uint8_t b) override { return _client.write(b); }
+    size_t write(const uint8_t* buf, size_t size) override { return _client.write(buf, size); }
+    int available() override { return _client.available(); }
+    int read() override { return _client.read(); }
+    int read(uint8_t* buf, size_t size) override { return _client.read(buf, size); }
+    int peek() override { return _client.peek(); }
+    void flush() override { _client.flush(); }
+    void stop() override { _client.stop(); }
+    uint8_t connected() override { return _client.connected(); }
+    operator bool() override { return _client.connected(); }
+    using Print::write;
+
+private:
+    Client& _client;
+};
+
+#endif // NATIVE_SSLCLIENT_H
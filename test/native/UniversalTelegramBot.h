@@ -0,0 +1,53 @@
+#ifndef NATIVE_UNIVERSAL_TELEGRAM_BOT_H
+#define NATIVE_UNIVERSAL_TELEGRAM_BOT_H
+
+// Host stand-in for UniversalTelegramBot (native firmware build)
+// Same members the firmware uses, speaking the Bot API's JSON over the
+// given client (plain HTTP through the SSLClient stand-in) to
+// api.telegram.org:443, which the end-to-end rig redirects to its fake.
+
+#include <Arduino.h>
+#include <Ethernet.h>
+
+#define HANDLE_MESSAGES 1
+#define TELEGRAM_HOST "api.telegram.org"
+#define TELEGRAM_SSL_PORT 443
+
+struct telegramMessage {
+    String text;
+    String chat_id;
+    String chat_title;
+    String from_id;
+    String from_name;
+    String date;
+    String type;
+    int update_id = 0;
+    int message_id = 0;
+};
+
+class UniversalTelegramBot {
+public:
+    UniversalTelegramBot(const String& token, Client& client);
+
+    void updateToken(const String& token) { _token = token; }
+
+    // New messages since offset into messages[]; returns how many
+    int getUpdates(long offset);
+
+    bool sendMessage(const String& chat_id, const String& text, const String& parse_mode = "",
+                     int message_id = 0);
+
+    telegramMessage messages[HANDLE_MESSAGES];
+    long last_message_received = 0;
+    unsigned int waitForResponse = 1500;  // Real milliseconds on the host (the clock may be scaled)
+
+private:
+    String _token;
+    Client& _client;
+    char _response[4096];
+
+    // POST a JSON body to /bot<token>/<method>; the response body lands in _response
+    bool post(const char* method, const char* body);
+};
+
+#endif // NATIVE_UNIVERSAL_TELEGRAM_BOT_H
@@ -0,0 +1,39 @@
+#ifndef NATIVE_UPDATE_H
+#define NATIVE_UPDATE_H
+
+// Host stand-in for the ESP32 Update library (native test environment)
+// Images are written to <data dir>/ota/<partition>.bin: the inactive app
+// partition (see esp_ota_ops.h) for firmware, spiffs.bin for the filesystem.
+
+#include <Arduino.h>
+
+#define U_FLASH 0
+#define U_SPIFFS 100
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+
+// Partition sizes from the default 4 MB layout
+#define NATIVE_APP_PARTITION_SIZE 0x140000
+#define NATIVE_FS_PARTITION_SIZE 0x160000
+
+class UpdateClass {
+public:
+    bool begin(size_t size, int command = U_FLASH);
+    size_t write(uint8_t* data, size_t length);
+    bool end(bool evenIfRemaining = false);
+    void abort();
+    bool isFinished() const { return _file == nullptr && _error[0] == '\0'; }
+    bool hasError() const { return _error[0] != '\0'; }
+    const char* errorString() const { return _error; }
+
+private:
+    FILE* _file = nullptr;
+    int _command = U_FLASH;
+    size_t _size = 0;
+    size_t _written = 0;
+    char _path[256] = "";
+    char _error[48] = "";
+};
+
+extern UpdateClass Update;
+
+#endif // NATIVE_UPDATE_H
@@ -0,0 +1,454 @@
+// Arduino core, clock and host plumbing for the native test environment
+
+#include "Arduino.h"
+#include "native_shim.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <errno.h>
+#include <ftw.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// ---- Simulated clock ----
+// millis() = clockOffset + real time since clockStart x clockScale
+
+static std::mutex clockLock;
+static std::chrono::steady_clock::time_point clockStart = std::chrono::steady_clock::now();
+static double clockOffset = 0;
+static double clockScale = 0;
+
+static double nowMs() {
+    std::lock_guard<std::mutex> guard(clockLock);
+    if (clockScale == 0) return clockOffset;
+    std::chrono::duration<double, std::milli> real = std::chrono::steady_clock::now() - clockStart;
+    return clockOffset + real.count() * clockScale;
+}
+
+static void rebase(double ms, double scale) {
+    clockStart = std::chrono::steady_clock::now();
+    clockOffset = ms;
+    clockScale = scale;
+}
+
+unsigned long millis() { return (unsigned long)(uint64_t)nowMs(); }
+unsigned long micros() { return (unsigned long)(uint64_t)(nowMs() * 1000.0); }
+
+void delay(unsigned long ms) {
+    if (ms == 0) {
+        std::this_thread::yield();
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(NativeShim::realWaitMicros(ms)));
+    NativeShim::waitExpired(ms);
+}
+
+void yield() { std::this_thread::yield(); }
+
+void NativeShim::setTimeScale(double scale) {
+    double now = nowMs();
+    std::lock_guard<std::mutex> guard(clockLock);
+    rebase(now, scale < 0 ? 0 : scale);
+}
+
+void NativeShim::setMillis(unsigned long ms) {
+    std::lock_guard<std::mutex> guard(clockLock);
+    rebase(ms, clockScale);
+}
+
+void NativeShim::advanceMillis(unsigned long ms) {
+    std::lock_guard<std::mutex> guard(clockLock);
+    clockOffset += ms;
+}
+
+uint64_t NativeShim::realWaitMicros(unsigned long ms) {
+    std::lock_guard<std::mutex> guard(clockLock);
+    if (clockScale == 0) return ms < 1 ? ms * 1000 : 1000;
+    return (uint64_t)(ms * 1000.0 / clockScale);
+}
+
+void NativeShim::waitExpired(unsigned long ms) {
+    // Scaled time already moved while we slept
+    std::lock_guard<std::mutex> guard(clockLock);
+    if (clockScale == 0) clockOffset += ms;
+}
+
+// ---- Wall clock ----
+// Epoch seconds = wallBase + (millis() - wallBaseMs) / 1000; these replace
+// libc's so the firmware's settimeofday() can't touch the host clock.
+
+static std::atomic<int64_t> wallBase(0);
+static std::atomic<uint64_t> wallBaseMs(0);
+
+void NativeShim::setWallClock(uint32_t epoch) {
+    wallBaseMs = (uint64_t)nowMs();
+    wallBase = epoch;
+}
+
+extern "C" int gettimeofday(struct timeval* tv, void* tz) __THROW {
+    uint64_t elapsedMs = (uint64_t)nowMs() - wallBaseMs.load();
+    tv->tv_sec = wallBase.load() + (time_t)(elapsedMs / 1000);
+    tv->tv_usec = (suseconds_t)(elapsedMs % 1000) * 1000;
+    return 0;
+}
+
+extern "C" int settimeofday(const struct timeval* tv, const struct timezone* tz) __THROW {
+    if (tv == nullptr) return 0;
+    uint64_t now = (uint64_t)nowMs();
+    wallBaseMs = now - (uint64_t)(tv->tv_usec / 1000);
+    wallBase = tv->tv_sec;
+    return 0;
+}
+
+extern "C" time_t time(time_t* out) __THROW {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    if (out != nullptr) *out = tv.tv_sec;
+    return tv.tv_sec;
+}
+
+// ---- GPIO ----
+
+static std::mutex pinLock;
+static int pinStates[64];
+static bool pinsInitialized = false;
+
+static void initPins() {
+    if (pinsInitialized) return;
+    for (int i = 0; i < 64; i++) pinStates[i] = -1;
+    pinsInitialized = true;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    std::lock_guard<std::mutex> guard(pinLock);
+    initPins();
+}
+
+// Relay feed: pin changes go out as "pin <n> <0|1>" datagrams so a
+// simulator (test_bintrac_simulator.py --control-port) can follow the relays
+static int feedSocket = -1;
+static sockaddr_in feedAddress;
+static bool feedLoaded = false;
+
+static void openRelayFeed(const char* host, uint16_t port) {
+    if (feedSocket >= 0) close(feedSocket);
+    feedSocket = -1;
+    memset(&feedAddress, 0, sizeof(feedAddress));
+    feedAddress.sin_family = AF_INET;
+    feedAddress.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &feedAddress.sin_addr) != 1) return;
+    feedSocket = socket(AF_INET, SOCK_DGRAM, 0);
+}
+
+static void loadRelayFeed() {
+    if (feedLoaded) return;
+    feedLoaded = true;
+    const char* env = getenv("FEEDER_RELAY_FEED");
+    char host[64];
+    unsigned port;
+    if (env != nullptr && sscanf(env, "%63[^:]:%u", host, &port) == 2) openRelayFeed(host, port);
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    std::lock_guard<std::mutex> guard(pinLock);
+    initPins();
+    if (pin >= 64) return;
+    bool changed = pinStates[pin] != value;
+    pinStates[pin] = value;
+
+    loadRelayFeed();
+    if (changed && feedSocket >= 0) {
+        char line[24];
+        int len = snprintf(line, sizeof(line), "pin %u %u\n", pin, value == HIGH ? 1 : 0);
+        sendto(feedSocket, line, len, 0, (const sockaddr*)&feedAddress, sizeof(feedAddress));
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    std::lock_guard<std::mutex> guard(pinLock);
+    initPins();
+    return pin < 64 && pinStates[pin] == HIGH ? HIGH : LOW;
+}
+
+// No hardware to raise interrupts on the host
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode) {}
+void detachInterrupt(uint8_t pin) {}
+
+int NativeShim::pinState(uint8_t pin) {
+    std::lock_guard<std::mutex> guard(pinLock);
+    initPins();
+    return pin < 64 ? pinStates[pin] : -1;
+}
+
+void NativeShim::setRelayFeed(const char* host, uint16_t port) {
+    std::lock_guard<std::mutex> guard(pinLock);
+    feedLoaded = true;
+    if (host == nullptr) {
+        if (feedSocket >= 0) close(feedSocket);
+        feedSocket = -1;
+        return;
+    }
+    openRelayFeed(host, port);
+}
+
+#if defined(__GLIBC__) && !(__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 38))
+size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#endif
+
+// ---- Print / Stream ----
+
+size_t Print::printf(const char* format, ...) {
+    // Like the core: a stack buffer, the heap only for long output
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0) return 0;
+    if ((size_t)length < sizeof(buffer)) return write((const uint8_t*)buffer, length);
+
+    char* text = (char*)malloc(length + 1);
+    if (text == nullptr) return 0;
+    va_start(args, format);
+    vsnprintf(text, length + 1, format, args);
+    va_end(args);
+    size_t written = write((const uint8_t*)text, length);
+    free(text);
+    return written;
+}
+
+int Stream::timedRead() {
+    int c = read();
+    if (c >= 0) return c;
+
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::microseconds(NativeShim::realWaitMicros(_timeout));
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        c = read();
+        if (c >= 0) return c;
+    }
+    NativeShim::waitExpired(_timeout);
+    return -1;
+}
+
+size_t Stream::readBytes(uint8_t* buf, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = timedRead();
+        if (c < 0) break;
+        buf[count++] = (uint8_t)c;
+    }
+    return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buf, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = timedRead();
+        if (c < 0 || c == terminator) break;
+        buf[count++] = (char)c;
+    }
+    return count;
+}
+
+// ---- IPAddress ----
+
+bool IPAddress::fromString(const char* text) {
+    uint32_t octets[4];
+    char extra;
+    if (text == nullptr ||
+        sscanf(text, "%u.%u.%u.%u%c", &octets[0], &octets[1], &octets[2], &octets[3], &extra) != 4) {
+        return false;
+    }
+    for (int i = 0; i < 4; i++) {
+        if (octets[i] > 255) return false;
+    }
+    *this = IPAddress(octets[0], octets[1], octets[2], octets[3]);
+    return true;
+}
+
+String IPAddress::toString() const {
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(text);
+}
+
+// ---- ESP ----
+// Heap figures are nominal (a healthy ESP32 after boot), not the host's
+
+uint32_t EspClass::getCycleCount() { return (uint32_t)((uint64_t)(nowMs() * 1000.0) * getCpuFreqMHz()); }
+
+// Espressif OUI with the PID as the device part, so host instances differ like boards
+uint64_t EspClass::getEfuseMac() {
+    const char* env = getenv("FEEDER_EFUSE_MAC");
+    if (env != nullptr && env[0] != '\0') return strtoull(env, nullptr, 16);
+    uint32_t device = (uint32_t)getpid() & 0xFFFFFF;
+    // Byte 0 of the MAC is the lowest byte, as on the ESP32
+    return 0xC40A24ULL | ((uint64_t)(device & 0xFF) << 24) | ((uint64_t)((device >> 8) & 0xFF) << 32) |
+           ((uint64_t)(device >> 16) << 40);
+}
+uint32_t EspClass::getFreeHeap() { return 200 * 1024; }
+uint32_t EspClass::getMinFreeHeap() { return 180 * 1024; }
+uint32_t EspClass::getMaxAllocHeap() { return 110 * 1024; }
+
+uint32_t esp_random() {
+    static std::random_device device;
+    static std::mutex lock;
+    std::lock_guard<std::mutex> guard(lock);
+    return device();
+}
+
+void EspClass::restart() {
+    printf("[native] ESP.restart() - exiting with code %d\n", NativeShim::RESTART_EXIT_CODE);
+    fflush(stdout);
+    _exit(NativeShim::RESTART_EXIT_CODE);
+}
+
+// ---- Data directory ----
+
+static std::mutex pathLock;
+static char dataDir[200] = "";
+
+const char* NativeShim::getDataDir() {
+    std::lock_guard<std::mutex> guard(pathLock);
+    if (dataDir[0] == '\0') {
+        const char* env = getenv("FEEDER_DATA_DIR");
+        strlcpy(dataDir, env != nullptr && env[0] != '\0' ? env : "./.native_data", sizeof(dataDir));
+    }
+    return dataDir;
+}
+
+void NativeShim::setDataDir(const char* path) {
+    std::lock_guard<std::mutex> guard(pathLock);
+    strlcpy(dataDir, path, sizeof(dataDir));
+}
+
+static int removeEntry(const char* path, const struct stat* st, int flag, struct FTW* ftw) {
+    return remove(path);
+}
+
+void NativeShim::clearDataDir() {
+    nftw(getDataDir(), removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+static bool makeParents(char* path) {
+    for (char* p = path + 1; *p != '\0'; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        bool ok = mkdir(path, 0755) == 0 || errno == EEXIST;
+        *p = '/';
+        if (!ok) return false;
+    }
+    return true;
+}
+
+bool NativeShim::dataPath(const char* area, const char* name, char* path, size_t size) {
+    while (*name == '/') name++;
+    int length = snprintf(path, size, "%s/%s/%s", getDataDir(), area, name);
+    if (length < 0 || (size_t)length >= size) return false;
+    return makeParents(path);
+}
+
+// ---- Ports ----
+
+struct Redirect {
+    uint16_t port;
+    char host[64];
+    uint16_t hostPort;
+};
+
+static const int MAX_REDIRECTS = 16;
+static Redirect redirects[MAX_REDIRECTS];
+static int redirectCount = 0;
+static int portOffset = -1;
+static bool redirectsLoaded = false;
+
+static void loadPortSettings() {
+    if (portOffset < 0) {
+        const char* env = getenv("FEEDER_PORT_OFFSET");
+        portOffset = env != nullptr && env[0] != '\0' ? atoi(env) : 8000;
+    }
+    if (redirectsLoaded) return;
+    redirectsLoaded = true;
+
+    // "502=127.0.0.1:5020,123=127.0.0.1:1230"
+    const char* env = getenv("FEEDER_REDIRECT");
+    while (env != nullptr && *env != '\0' && redirectCount < MAX_REDIRECTS) {
+        Redirect& r = redirects[redirectCount];
+        unsigned port, hostPort;
+        int used = 0;
+        if (sscanf(env, "%u=%63[^:]:%u%n", &port, r.host, &hostPort, &used) == 3) {
+            r.port = port;
+            r.hostPort = hostPort;
+            redirectCount++;
+        }
+        env = strchr(env, ',');
+        if (env != nullptr) env++;
+    }
+}
+
+void NativeShim::setPortOffset(int offset) {
+    std::lock_guard<std::mutex> guard(pathLock);
+    loadPortSettings();
+    portOffset = offset;
+}
+
+uint16_t NativeShim::hostPort(uint16_t port) {
+    std::lock_guard<std::mutex> guard(pathLock);
+    loadPortSettings();
+    return (uint16_t)(port + portOffset);
+}
+
+void NativeShim::redirect(uint16_t port, const char* host, uint16_t hostPort) {
+    std::lock_guard<std::mutex> guard(pathLock);
+    loadPortSettings();
+    for (int i = 0; i < redirectCount; i++) {
+        if (redirects[i].port == port) {
+            strlcpy(redirects[i].host, host, sizeof(redirects[i].host));
+            redirects[i].hostPort = hostPort;
+            return;
+        }
+    }
+    if (redirectCount == MAX_REDIRECTS) return;
+    redirects[redirectCount].port = port;
+    strlcpy(redirects[redirectCount].host, host, sizeof(redirects[redirectCount].host));
+    redirects[redirectCount].hostPort = hostPort;
+    redirectCount++;
+}
+
+void NativeShim::clearRedirects() {
+    std::lock_guard<std::mutex> guard(pathLock);
+    redirectsLoaded = true;
+    redirectCount = 0;
+}
+
+bool NativeShim::findRedirect(uint16_t port, char* host, size_t hostSize, uint16_t& hostPort) {
+    std::lock_guard<std::mutex> guard(pathLock);
+    loadPortSettings();
+    for (int i = 0; i < redirectCount; i++) {
+        if (redirects[i].port == port) {
+            strlcpy(host, redirects[i].host, hostSize);
+            hostPort = redirects[i].hostPort;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,26 @@
+#ifndef NATIVE_ESP_OTA_OPS_H
+#define NATIVE_ESP_OTA_OPS_H
+
+// Host stand-in for the ESP-IDF OTA partition API (native test environment)
+// Two app partitions, app0 and app1; the one to boot is kept in
+// <data dir>/ota/boot so a restarted process "boots" the right image.
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_OTA_VALIDATE_FAILED 0x1503
+
+typedef struct {
+    char label[17];
+} esp_partition_t;
+
+const esp_partition_t* esp_ota_get_running_partition();
+const esp_partition_t* esp_ota_get_boot_partition();
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* start);
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* partition);  // Image must exist
+esp_err_t esp_ota_mark_app_valid_cancel_rollback();
+
+#endif // NATIVE_ESP_OTA_OPS_H
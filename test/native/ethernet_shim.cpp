@@ -0,0 +1,614 @@
+// Ethernet library over POSIX sockets for the native test environment
+// A table of MAX_SOCK_NUM slots plays the W5500's hardware sockets so the
+// firmware's socket accounting (SocketBudget, the web server's listener
+// handling) sees the same states it would on the chip.
+
+#include "Ethernet.h"
+#include "EthernetUdp.h"
+#include "SPI.h"
+#include "utility/w5100.h"
+#include <errno.h>
+#include <mutex>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+EthernetClass Ethernet;
+W5100Class W5100;
+SPIClass SPI;
+
+uint16_t EthernetServer::server_port[MAX_SOCK_NUM];
+
+struct NativeSocket {
+    int fd = -1;
+    uint8_t state = SnSR::CLOSED;
+};
+
+static std::recursive_mutex socketLock;
+static NativeSocket sockets[MAX_SOCK_NUM];
+
+// Host listeners, one per server port, open for the life of the process
+// like the chip's listen sockets
+struct Listener {
+    uint16_t port;
+    int fd;
+};
+
+static Listener listeners[MAX_SOCK_NUM];
+static int listenerCount = 0;
+
+static void setNonBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+static uint8_t allocateSocket() {
+    for (uint8_t s = 0; s < MAX_SOCK_NUM; s++) {
+        if (sockets[s].state == SnSR::CLOSED) {
+            EthernetServer::server_port[s] = 0;
+            return s;
+        }
+    }
+    return MAX_SOCK_NUM;
+}
+
+static void closeSocket(uint8_t s) {
+    if (s >= MAX_SOCK_NUM) return;
+    // Listen slots share the port's host listener; don't close it
+    if (sockets[s].fd >= 0 && sockets[s].state != SnSR::LISTEN) {
+        close(sockets[s].fd);
+    }
+    sockets[s].fd = -1;
+    sockets[s].state = SnSR::CLOSED;
+}
+
+static int pendingBytes(int fd) {
+    int count = 0;
+    if (ioctl(fd, FIONREAD, &count) < 0) return 0;
+    return count;
+}
+
+// Bring a slot's state up to date with its host socket
+static uint8_t refreshSocket(uint8_t s) {
+    NativeSocket& sock = sockets[s];
+
+    if (sock.state == SnSR::LISTEN) {
+        int fd = accept(sock.fd, nullptr, nullptr);
+        if (fd >= 0) {
+            setNonBlocking(fd);
+            sock.fd = fd;
+            sock.state = SnSR::ESTABLISHED;
+        }
+    }
+
+    if (sock.state == SnSR::ESTABLISHED && pendingBytes(sock.fd) == 0) {
+        uint8_t probe;
+        ssize_t n = recv(sock.fd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+        if (n == 0) {
+            sock.state = SnSR::CLOSE_WAIT;  // Peer sent FIN
+        } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            closeSocket(s);                 // Reset
+        }
+    }
+    return sock.state;
+}
+
+// Where a datagram or connection for ip:port really goes on the host
+static bool resolveTarget(const char* host, uint16_t port, bool multicast, sockaddr_in& addr) {
+    char target[64];
+    uint16_t targetPort = port;
+    strlcpy(target, host, sizeof(target));
+
+    // Multicast goes to the group port itself, which every instance shares
+    if (!multicast) {
+        NativeShim::findRedirect(port, target, sizeof(target), targetPort);
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(targetPort);
+    if (inet_pton(AF_INET, target, &addr.sin_addr) == 1) return true;
+
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(target, nullptr, &hints, &result) != 0 || result == nullptr) return false;
+    addr.sin_addr = ((sockaddr_in*)result->ai_addr)->sin_addr;
+    freeaddrinfo(result);
+    return true;
+}
+
+// The firmware resolves names itself (NetDns) at Ethernet.dnsServerIP():53.
+// Without a redirect for port 53 the query is answered here from the host's
+// resolver; a name it can't resolve gets 127.0.0.1, where the port
+// redirects route traffic as they would for the name itself.
+static size_t answerDnsQuery(const uint8_t* query, size_t length, uint8_t* reply, size_t size) {
+    char name[256];
+    size_t pos = 12;
+    size_t out = 0;
+    if (length <= pos) return 0;
+    while (pos < length && query[pos] != 0) {
+        uint8_t label = query[pos++];
+        if (pos + label > length || out + label + 1 >= sizeof(name)) return 0;
+        if (out > 0) name[out++] = '.';
+        memcpy(name + out, query + pos, label);
+        out += label;
+        pos += label;
+    }
+    name[out] = '\0';
+
+    size_t questionEnd = pos + 5;  // Root label, QTYPE, QCLASS
+    const uint8_t answer[12] = {0xC0, 12, 0, 1, 0, 1, 0, 0, 0, 60, 0, 4};  // Name at the question, A, IN, TTL 60, 4 bytes
+    if (questionEnd > length || questionEnd + sizeof(answer) + 4 > size) return 0;
+
+    in_addr ip;
+    ip.s_addr = htonl(INADDR_LOOPBACK);
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(name, nullptr, &hints, &result) == 0 && result != nullptr) {
+        ip = ((sockaddr_in*)result->ai_addr)->sin_addr;
+        freeaddrinfo(result);
+    }
+
+    memcpy(reply, query, questionEnd);
+    reply[2] = 0x81;  // Response, recursion desired
+    reply[3] = 0x80;  // Recursion available, no error
+    const uint8_t counts[8] = {0, 1, 0, 1, 0, 0, 0, 0};
+    memcpy(reply + 4, counts, sizeof(counts));
+    memcpy(reply + questionEnd, answer, sizeof(answer));
+    memcpy(reply + questionEnd + sizeof(answer), &ip.s_addr, 4);
+    return questionEnd + sizeof(answer) + 4;
+}
+
+// ---- W5100 ----
+
+uint8_t W5100Class::readSnSR(uint8_t socket) {
+    if (socket >= MAX_SOCK_NUM) return SnSR::CLOSED;
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    return refreshSocket(socket);
+}
+
+// ---- EthernetClass ----
+
+int EthernetClass::begin(uint8_t* mac, unsigned long timeout, unsigned long responseTimeout) {
+    memcpy(_mac, mac, sizeof(_mac));
+    _localIP = IPAddress(127, 0, 0, 1);
+    return 1;  // "DHCP" always answers
+}
+
+void EthernetClass::begin(uint8_t* mac, IPAddress ip) {
+    memcpy(_mac, mac, sizeof(_mac));
+    _localIP = ip;
+}
+
+void EthernetClass::begin(uint8_t* mac, IPAddress ip, IPAddress dns) { begin(mac, ip); }
+void EthernetClass::begin(uint8_t* mac, IPAddress ip, IPAddress dns, IPAddress gateway) { begin(mac, ip); }
+void EthernetClass::begin(uint8_t* mac, IPAddress ip, IPAddress dns, IPAddress gateway, IPAddress subnet) {
+    begin(mac, ip);
+}
+
+void EthernetClass::MACAddress(uint8_t* mac) {
+    memcpy(mac, _mac, sizeof(_mac));
+}
+
+// ---- EthernetClient ----
+
+uint8_t EthernetClient::status() {
+    if (_sockindex >= MAX_SOCK_NUM) return SnSR::CLOSED;
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    return refreshSocket(_sockindex);
+}
+
+int EthernetClient::connect(IPAddress ip, uint16_t port) {
+    return connectTo(ip.toString().c_str(), port);
+}
+
+int EthernetClient::connect(const char* host, uint16_t port) {
+    return connectTo(host, port);
+}
+
+int EthernetClient::connectTo(const char* host, uint16_t port) {
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    if (_sockindex < MAX_SOCK_NUM) stop();
+
+    sockaddr_in addr;
+    if (!resolveTarget(host, port, false, addr)) return 0;
+
+    uint8_t s = allocateSocket();
+    if (s == MAX_SOCK_NUM) return 0;
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return 0;
+    setNonBlocking(fd);
+
+    // Real time: the connection timeout is about the peer, not the simulation
+    int result = ::connect(fd, (sockaddr*)&addr, sizeof(addr));
+    if (result < 0 && errno == EINPROGRESS) {
+        pollfd pfd = {fd, POLLOUT, 0};
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (poll(&pfd, 1, min<int>(_timeout, 1000)) == 1 &&
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0) {
+            result = 0;
+        }
+    }
+    if (result < 0) {
+        close(fd);
+        return 0;
+    }
+
+    sockets[s].fd = fd;
+    sockets[s].state = SnSR::ESTABLISHED;
+    _sockindex = s;
+    return 1;
+}
+
+int EthernetClient::availableForWrite() {
+    return status() == SnSR::ESTABLISHED ? 2048 : 0;
+}
+
+size_t EthernetClient::write(uint8_t b) {
+    return write(&b, 1);
+}
+
+size_t EthernetClient::write(const uint8_t* buf, size_t size) {
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    if (_sockindex >= MAX_SOCK_NUM || sockets[_sockindex].fd < 0) {
+        setWriteError();
+        return 0;
+    }
+
+    int fd = sockets[_sockindex].fd;
+    size_t sent = 0;
+    while (sent < size) {
+        ssize_t n = send(fd, buf + sent, size - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += n;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            pollfd pfd = {fd, POLLOUT, 0};
+            if (poll(&pfd, 1, 1000) != 1) break;
+        } else {
+            break;
+        }
+    }
+    if (sent < size) setWriteError();
+    return sent;
+}
+
+int EthernetClient::available() {
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    if (_sockindex >= MAX_SOCK_NUM || sockets[_sockindex].fd < 0) return 0;
+    refreshSocket(_sockindex);
+    return sockets[_sockindex].fd >= 0 ? pendingBytes(sockets[_sockindex].fd) : 0;
+}
+
+int EthernetClient::read() {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int EthernetClient::read(uint8_t* buf, size_t size) {
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    if (_sockindex >= MAX_SOCK_NUM || sockets[_sockindex].fd < 0) return -1;
+    ssize_t n = recv(sockets[_sockindex].fd, buf, size, MSG_DONTWAIT);
+    return n > 0 ? (int)n : -1;
+}
+
+int EthernetClient::peek() {
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    if (_sockindex >= MAX_SOCK_NUM || sockets[_sockindex].fd < 0) return -1;
+    uint8_t b;
+    return recv(sockets[_sockindex].fd, &b, 1, MSG_PEEK | MSG_DONTWAIT) == 1 ? b : -1;
+}
+
+void EthernetClient::stop() {
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    if (_sockindex >= MAX_SOCK_NUM) return;
+    if (sockets[_sockindex].fd >= 0 && sockets[_sockindex].state != SnSR::LISTEN) {
+        shutdown(sockets[_sockindex].fd, SHUT_RDWR);
+        closeSocket(_sockindex);
+    }
+    _sockindex = MAX_SOCK_NUM;
+}
+
+// Same rule as the library: a closing socket counts as connected while data is left
+uint8_t EthernetClient::connected() {
+    uint8_t s = status();
+    return !(s == SnSR::LISTEN || s == SnSR::CLOSED || s == SnSR::FIN_WAIT ||
+             (s == SnSR::CLOSE_WAIT && available() == 0));
+}
+
+uint16_t EthernetClient::localPort() {
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    sockaddr_in addr;
+    socklen_t length = sizeof(addr);
+    if (_sockindex >= MAX_SOCK_NUM || getsockname(sockets[_sockindex].fd, (sockaddr*)&addr, &length) != 0) {
+        return 0;
+    }
+    return ntohs(addr.sin_port);
+}
+
+IPAddress EthernetClient::remoteIP() {
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    sockaddr_in addr;
+    socklen_t length = sizeof(addr);
+    if (_sockindex >= MAX_SOCK_NUM || getpeername(sockets[_sockindex].fd, (sockaddr*)&addr, &length) != 0) {
+        return IPAddress();
+    }
+    return IPAddress((uint32_t)addr.sin_addr.s_addr);
+}
+
+uint16_t EthernetClient::remotePort() {
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    sockaddr_in addr;
+    socklen_t length = sizeof(addr);
+    if (_sockindex >= MAX_SOCK_NUM || getpeername(sockets[_sockindex].fd, (sockaddr*)&addr, &length) != 0) {
+        return 0;
+    }
+    return ntohs(addr.sin_port);
+}
+
+// ---- EthernetServer ----
+
+static int listenerFor(uint16_t port) {
+    for (int i = 0; i < listenerCount; i++) {
+        if (listeners[i].port == port) return listeners[i].fd;
+    }
+    if (listenerCount == MAX_SOCK_NUM) return -1;
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(NativeShim::hostPort(port));
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, MAX_SOCK_NUM) != 0) {
+        printf("[native] Can't listen on port %u (for %u): %s\n",
+               NativeShim::hostPort(port), port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    setNonBlocking(fd);
+
+    listeners[listenerCount++] = {port, fd};
+    return fd;
+}
+
+void EthernetServer::begin(uint16_t port) {
+    if (port != 0) _port = port;
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+
+    int fd = listenerFor(_port);
+    if (fd < 0) return;
+
+    uint8_t s = allocateSocket();
+    if (s == MAX_SOCK_NUM) return;
+    sockets[s].fd = fd;
+    sockets[s].state = SnSR::LISTEN;
+    server_port[s] = _port;
+}
+
+EthernetClient EthernetServer::available() {
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    bool listening = false;
+    uint8_t ready = MAX_SOCK_NUM;
+
+    for (uint8_t s = 0; s < MAX_SOCK_NUM; s++) {
+        if (server_port[s] != _port) continue;
+
+        uint8_t state = refreshSocket(s);
+        if (state == SnSR::LISTEN) {
+            listening = true;
+        } else if (state == SnSR::ESTABLISHED || state == SnSR::CLOSE_WAIT) {
+            if (pendingBytes(sockets[s].fd) > 0) {
+                if (ready == MAX_SOCK_NUM) ready = s;
+            } else if (state == SnSR::CLOSE_WAIT) {
+                closeSocket(s);  // Peer left without sending anything
+            }
+        }
+    }
+
+    if (!listening) begin();
+    return EthernetClient(ready);
+}
+
+EthernetClient EthernetServer::accept() {
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    bool listening = false;
+    uint8_t accepted = MAX_SOCK_NUM;
+
+    for (uint8_t s = 0; s < MAX_SOCK_NUM; s++) {
+        if (server_port[s] != _port) continue;
+
+        uint8_t state = refreshSocket(s);
+        if (state == SnSR::LISTEN) {
+            listening = true;
+        } else if (accepted == MAX_SOCK_NUM && (state == SnSR::ESTABLISHED || state == SnSR::CLOSE_WAIT)) {
+            accepted = s;
+            server_port[s] = 0;  // Handed over; the server no longer tracks it
+        }
+    }
+
+    if (!listening) begin();
+    return EthernetClient(accepted);
+}
+
+// ---- EthernetUDP ----
+
+uint8_t EthernetUDP::begin(uint16_t port) {
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    if (_sockindex < MAX_SOCK_NUM) stop();
+
+    uint8_t s = allocateSocket();
+    if (s == MAX_SOCK_NUM) return 0;
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return 0;
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(NativeShim::hostPort(port));
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return 0;
+    }
+    setNonBlocking(fd);
+
+    sockets[s].fd = fd;
+    sockets[s].state = SnSR::UDP;
+    _sockindex = s;
+    _port = port;
+    _rxLength = _rxPos = 0;
+    return 1;
+}
+
+// Every instance on the host binds the group port itself (not port + offset)
+// and joins on loopback with loopback delivery on, so several controllers
+// started on one machine hear each other like boards on one LAN
+uint8_t EthernetUDP::beginMulticast(IPAddress ip, uint16_t port) {
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    if (_sockindex < MAX_SOCK_NUM) stop();
+
+    uint8_t s = allocateSocket();
+    if (s == MAX_SOCK_NUM) return 0;
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return 0;
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    in_addr loopback;
+    loopback.s_addr = htonl(INADDR_LOOPBACK);
+    ip_mreq request = {};
+    request.imr_multiaddr.s_addr = (uint32_t)ip;
+    request.imr_interface = loopback;
+    uint8_t loop = 1;
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof(request)) != 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &loopback, sizeof(loopback)) != 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) != 0) {
+        printf("[native] Can't join multicast group on port %u: %s\n", port, strerror(errno));
+        close(fd);
+        return 0;
+    }
+    setNonBlocking(fd);
+
+    sockets[s].fd = fd;
+    sockets[s].state = SnSR::UDP;
+    _sockindex = s;
+    _port = port;
+    _rxLength = _rxPos = 0;
+    return 1;
+}
+
+void EthernetUDP::stop() {
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    closeSocket(_sockindex);
+    _sockindex = MAX_SOCK_NUM;
+}
+
+int EthernetUDP::beginPacket(IPAddress ip, uint16_t port) {
+    return beginPacket(ip.toString().c_str(), port);
+}
+
+int EthernetUDP::beginPacket(const char* host, uint16_t port) {
+    if (_sockindex >= MAX_SOCK_NUM) return 0;
+    strlcpy(_txHost, host, sizeof(_txHost));
+    _txPort = port;
+    _txLength = 0;
+    return 1;
+}
+
+int EthernetUDP::endPacket() {
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    if (_sockindex >= MAX_SOCK_NUM) return 0;
+
+    char redirectHost[64];
+    uint16_t redirectPort;
+    if (_txPort == 53 && !NativeShim::findRedirect(53, redirectHost, sizeof(redirectHost), redirectPort)) {
+        // Answer to ourselves, as if from the DNS server
+        uint8_t reply[sizeof(_txBuffer)];
+        size_t length = answerDnsQuery(_txBuffer, _txLength, reply, sizeof(reply));
+        sockaddr_in self;
+        socklen_t selfLength = sizeof(self);
+        getsockname(sockets[_sockindex].fd, (sockaddr*)&self, &selfLength);
+        self.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        _txLength = 0;
+        return length > 0 &&
+               sendto(sockets[_sockindex].fd, reply, length, 0, (sockaddr*)&self, sizeof(self)) >= 0 ? 1 : 0;
+    }
+
+    IPAddress ip;
+    bool multicast = ip.fromString(_txHost) && ip[0] >= 224 && ip[0] <= 239;
+    sockaddr_in addr;
+    if (!resolveTarget(_txHost, _txPort, multicast, addr)) return 0;
+
+    ssize_t n = sendto(sockets[_sockindex].fd, _txBuffer, _txLength, 0, (sockaddr*)&addr, sizeof(addr));
+    _txLength = 0;
+    return n >= 0 ? 1 : 0;
+}
+
+size_t EthernetUDP::write(uint8_t b) {
+    return write(&b, 1);
+}
+
+size_t EthernetUDP::write(const uint8_t* buf, size_t size) {
+    size_t n = min(size, sizeof(_txBuffer) - _txLength);
+    memcpy(_txBuffer + _txLength, buf, n);
+    _txLength += n;
+    return n;
+}
+
+int EthernetUDP::parsePacket() {
+    std::lock_guard<std::recursive_mutex> guard(socketLock);
+    _rxLength = _rxPos = 0;
+    if (_sockindex >= MAX_SOCK_NUM) return 0;
+
+    sockaddr_in from;
+    socklen_t length = sizeof(from);
+    ssize_t n = recvfrom(sockets[_sockindex].fd, _rxBuffer, sizeof(_rxBuffer), MSG_DONTWAIT,
+                         (sockaddr*)&from, &length);
+    if (n <= 0) return 0;
+
+    _rxLength = n;
+    _remoteIP = IPAddress((uint32_t)from.sin_addr.s_addr);
+    _remotePort = ntohs(from.sin_port);
+    return n;
+}
+
+int EthernetUDP::available() {
+    return _rxLength - _rxPos;
+}
+
+int EthernetUDP::read() {
+    return _rxPos < _rxLength ? _rxBuffer[_rxPos++] : -1;
+}
+
+int EthernetUDP::read(uint8_t* buf, size_t size) {
+    size_t n = min(size, _rxLength - _rxPos);
+    if (n == 0) return -1;
+    memcpy(buf, _rxBuffer + _rxPos, n);
+    _rxPos += n;
+    return n;
+}
+
+int EthernetUDP::peek() {
+    return _rxPos < _rxLength ? _rxBuffer[_rxPos] : -1;
+}
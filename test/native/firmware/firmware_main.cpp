@@ -0,0 +1,22 @@
+// Entry point for the firmware on the host (native_firmware environment)
+// Runs setup() and the Arduino loop like the ESP32 core does, with every
+// module (main.cpp's tasks, Telegram bot included) over the shims in
+// test/native. The clock runs at $FEEDER_TIME_SCALE x real time (default
+// 1); the end-to-end rig (test/e2e) speeds days up this way.
+// ESP.restart() exits with NativeShim::RESTART_EXIT_CODE for the supervisor.
+
+#include <Arduino.h>
+
+void setup();
+void loop();
+
+int main(int argc, char** argv) {
+    const char* scale = getenv("FEEDER_TIME_SCALE");
+    NativeShim::setTimeScale(scale != nullptr ? atof(scale) : 1.0);
+
+    setvbuf(stdout, nullptr, _IOLBF, 0);  // Serial output line by line into the rig's log
+    setup();
+    for (;;) {
+        loop();
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef NATIVE_FREERTOS_H
+#define NATIVE_FREERTOS_H
+
+// Host stand-in for FreeRTOS types and critical sections (native test environment)
+// Ticks are milliseconds of simulated time (see native_shim.h).
+
+#include <stdint.h>
+#include <mutex>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portYIELD_FROM_ISR(woken) ((void)(woken))
+
+// ESP32 spinlock; a plain mutex is enough on the host
+struct portMUX_TYPE {
+    std::mutex mutex;
+
+    // Firmware re-initializes its locks by assignment; each keeps its own mutex
+    portMUX_TYPE() {}
+    portMUX_TYPE(const portMUX_TYPE&) {}
+    portMUX_TYPE& operator=(const portMUX_TYPE&) { return *this; }
+};
+
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux) (mux)->mutex.lock()
+#define portEXIT_CRITICAL(mux) (mux)->mutex.unlock()
+#define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux) portEXIT_CRITICAL(mux)
+
+#endif // NATIVE_FREERTOS_H
@@ -0,0 +1,20 @@
+#ifndef NATIVE_FREERTOS_EVENT_GROUPS_H
+#define NATIVE_FREERTOS_EVENT_GROUPS_H
+
+// Host stand-in for FreeRTOS event groups (native test environment)
+
+#include "FreeRTOS.h"
+
+struct NativeEventGroup;
+typedef NativeEventGroup* EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+EventGroupHandle_t xEventGroupCreate();
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t group, EventBits_t bits, BaseType_t* woken);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clearOnExit,
+                                BaseType_t waitForAll, TickType_t ticksToWait);
+
+#endif // NATIVE_FREERTOS_EVENT_GROUPS_H
@@ -0,0 +1,19 @@
+#ifndef NATIVE_FREERTOS_QUEUE_H
+#define NATIVE_FREERTOS_QUEUE_H
+
+// Host stand-in for FreeRTOS queues: fixed-size items copied in and out
+// (native test environment)
+
+#include "FreeRTOS.h"
+
+struct NativeQueue;
+typedef NativeQueue* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+#define xQueueSendToBack xQueueSend
+
+#endif // NATIVE_FREERTOS_QUEUE_H
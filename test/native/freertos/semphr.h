@@ -0,0 +1,19 @@
+#ifndef NATIVE_FREERTOS_SEMPHR_H
+#define NATIVE_FREERTOS_SEMPHR_H
+
+// Host stand-in for FreeRTOS mutexes (native test environment)
+
+#include "FreeRTOS.h"
+
+struct NativeSemaphore;
+typedef NativeSemaphore* SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+
+#define xSemaphoreTakeRecursive xSemaphoreTake
+#define xSemaphoreGiveRecursive xSemaphoreGive
+
+#endif // NATIVE_FREERTOS_SEMPHR_H
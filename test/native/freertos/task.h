@@ -0,0 +1,38 @@
+#ifndef NATIVE_FREERTOS_TASK_H
+#define NATIVE_FREERTOS_TASK_H
+
+// Host stand-in for FreeRTOS tasks: each task is a detached thread with a
+// notification counter (native test environment)
+
+#include "FreeRTOS.h"
+#include <thread>
+
+struct NativeTask;
+typedef NativeTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+typedef enum {
+    eNoAction,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite
+} eNotifyAction;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                   void* param, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                       void* param, UBaseType_t priority, TaskHandle_t* handle);
+void vTaskDelete(TaskHandle_t task);  // nullptr = calling task (its thread exits)
+TaskHandle_t xTaskGetCurrentTaskHandle();
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+void xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait);
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action);
+BaseType_t xTaskNotifyWait(uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t* value, TickType_t ticksToWait);
+void vTaskDelay(TickType_t ticks);
+
+#define taskYIELD() std::this_thread::yield()
+
+#endif // NATIVE_FREERTOS_TASK_H
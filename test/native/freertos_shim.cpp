@@ -0,0 +1,250 @@
+// FreeRTOS tasks, mutexes, queues and event groups for the native test environment
+// Timed waits take NativeShim::realWaitMicros() of real time and move the
+// simulated clock by their timeout when they run out.
+
+#include "Arduino.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Wait on a condition for ticksToWait of simulated time; true if it came true
+template <typename Predicate>
+static bool waitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& guard,
+                    TickType_t ticksToWait, Predicate ready) {
+    if (ticksToWait == portMAX_DELAY) {
+        cv.wait(guard, ready);
+        return true;
+    }
+    if (cv.wait_for(guard, std::chrono::microseconds(NativeShim::realWaitMicros(ticksToWait)), ready)) {
+        return true;
+    }
+    NativeShim::waitExpired(ticksToWait);
+    return false;
+}
+
+// ---- Mutexes ----
+
+struct NativeSemaphore {
+    std::recursive_timed_mutex mutex;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new NativeSemaphore(); }
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return new NativeSemaphore(); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+    if (ticksToWait == portMAX_DELAY) {
+        semaphore->mutex.lock();
+        return pdTRUE;
+    }
+    if (semaphore->mutex.try_lock_for(std::chrono::microseconds(NativeShim::realWaitMicros(ticksToWait)))) {
+        return pdTRUE;
+    }
+    NativeShim::waitExpired(ticksToWait);
+    return pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    semaphore->mutex.unlock();
+    return pdTRUE;
+}
+
+// ---- Tasks ----
+
+struct NativeTask {
+    std::mutex mutex;
+    std::condition_variable wake;
+    uint32_t value = 0;     // Notification value (a count for Give/Take)
+    bool pending = false;   // Notified since the last wait
+    uint32_t stackDepth = 0;
+};
+
+struct TaskExit {};  // Thrown by vTaskDelete(nullptr) to unwind the task's thread
+
+static thread_local NativeTask* currentTask = nullptr;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                   void* param, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core) {
+    NativeTask* task = new NativeTask();
+    task->stackDepth = stackDepth;
+    if (handle != nullptr) *handle = task;
+    std::thread([fn, param, task]() {
+        currentTask = task;
+        try {
+            fn(param);
+        } catch (const TaskExit&) {
+        }
+    }).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                       void* param, UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(fn, name, stackDepth, param, priority, handle, 0);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // Other tasks can't be stopped from outside a thread; only self-deletion is supported
+    if (task == nullptr || task == currentTask) throw TaskExit();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if (currentTask == nullptr) currentTask = new NativeTask();  // Main thread
+    return currentTask;
+}
+
+// Host threads have megabytes of stack; report the whole FreeRTOS budget as unused
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    if (task == nullptr) task = xTaskGetCurrentTaskHandle();
+    return task->stackDepth;
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+    xTaskNotify(task, 0, eIncrement);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait) {
+    NativeTask* task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> guard(task->mutex);
+    waitFor(task->wake, guard, ticksToWait, [task]() { return task->value > 0; });
+
+    uint32_t count = task->value;
+    if (count > 0) task->value = clearOnExit ? 0 : count - 1;
+    task->pending = false;
+    return count;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    std::lock_guard<std::mutex> guard(task->mutex);
+    switch (action) {
+        case eSetBits:               task->value |= value; break;
+        case eIncrement:             task->value++; break;
+        case eSetValueWithOverwrite: task->value = value; break;
+        case eSetValueWithoutOverwrite:
+            if (task->pending) return pdFAIL;
+            task->value = value;
+            break;
+        default: break;
+    }
+    task->pending = true;
+    task->wake.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t* value, TickType_t ticksToWait) {
+    NativeTask* task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> guard(task->mutex);
+    if (!task->pending) task->value &= ~clearOnEntry;
+
+    bool notified = waitFor(task->wake, guard, ticksToWait, [task]() { return task->pending; });
+    if (value != nullptr) *value = task->value;
+    if (notified) {
+        task->value &= ~clearOnExit;
+        task->pending = false;
+    }
+    return notified ? pdTRUE : pdFALSE;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    delay(ticks);
+}
+
+// ---- Queues ----
+
+struct NativeQueue {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::vector<uint8_t>> items;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    NativeQueue* queue = new NativeQueue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> guard(queue->mutex);
+    if (!waitFor(queue->changed, guard, ticksToWait, [queue]() { return queue->items.size() < queue->length; })) {
+        return pdFAIL;
+    }
+    const uint8_t* bytes = (const uint8_t*)item;
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> guard(queue->mutex);
+    if (!waitFor(queue->changed, guard, ticksToWait, [queue]() { return !queue->items.empty(); })) {
+        return pdFAIL;
+    }
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> guard(queue->mutex);
+    return queue->items.size();
+}
+
+// ---- Event groups ----
+
+struct NativeEventGroup {
+    std::mutex mutex;
+    std::condition_variable changed;
+    EventBits_t bits = 0;
+};
+
+EventGroupHandle_t xEventGroupCreate() { return new NativeEventGroup(); }
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+    std::lock_guard<std::mutex> guard(group->mutex);
+    group->bits |= bits;
+    group->changed.notify_all();
+    return group->bits;
+}
+
+BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t group, EventBits_t bits, BaseType_t* woken) {
+    xEventGroupSetBits(group, bits);
+    if (woken != nullptr) *woken = pdFALSE;
+    return pdPASS;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+    std::lock_guard<std::mutex> guard(group->mutex);
+    EventBits_t previous = group->bits;
+    group->bits &= ~bits;
+    return previous;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+    std::lock_guard<std::mutex> guard(group->mutex);
+    return group->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clearOnExit,
+                                BaseType_t waitForAll, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> guard(group->mutex);
+    auto ready = [group, bits, waitForAll]() {
+        return waitForAll ? (group->bits & bits) == bits : (group->bits & bits) != 0;
+    };
+    bool met = waitFor(group->changed, guard, ticksToWait, ready);
+
+    EventBits_t result = group->bits;
+    if (met && clearOnExit) group->bits &= ~bits;
+    return result;
+}
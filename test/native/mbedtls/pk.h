@@ -0,0 +1,22 @@
+#ifndef NATIVE_MBEDTLS_PK_H
+#define NATIVE_MBEDTLS_PK_H
+
+// Host stand-in for mbedTLS public keys (native test environment)
+// There's no ECDSA on the host: parsing any key fails, so builds with
+// OTA_SIGNING_PUBLIC_KEY set reject uploads here rather than accept them.
+
+#include "md.h"
+
+#define MBEDTLS_ERR_PK_FEATURE_UNAVAILABLE -0x3980
+
+typedef struct {
+    void* key;
+} mbedtls_pk_context;
+
+void mbedtls_pk_init(mbedtls_pk_context* ctx);
+void mbedtls_pk_free(mbedtls_pk_context* ctx);
+int mbedtls_pk_parse_public_key(mbedtls_pk_context* ctx, const unsigned char* key, size_t length);
+int mbedtls_pk_verify(mbedtls_pk_context* ctx, mbedtls_md_type_t type, const unsigned char* hash,
+                      size_t hashLength, const unsigned char* signature, size_t signatureLength);
+
+#endif // NATIVE_MBEDTLS_PK_H
@@ -0,0 +1,65 @@
+#ifndef NATIVE_SHIM_H
+#define NATIVE_SHIM_H
+
+// Test control over the native environment's stand-ins for the ESP32
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace NativeShim {
+    // Simulated clock: millis() = offset + real elapsed time x scale
+    // Scale 0 (default) freezes time: only advanceMillis(), delay() and timed
+    // waits that expire move it, so tests are deterministic. The integration
+    // rig runs the firmware with a scale > 1 for accelerated days.
+    void setTimeScale(double scale);
+    void setMillis(unsigned long ms);
+    void advanceMillis(unsigned long ms);
+
+    // Wall clock (time(), gettimeofday()) starts at 0 like the ESP32 after
+    // reset and follows millis() once set (settimeofday() does the same)
+    void setWallClock(uint32_t epoch);
+
+    // Relay pins
+    int pinState(uint8_t pin);  // Last digitalWrite value, -1 if never written
+
+    // Report pin changes as "pin <n> <0|1>" UDP datagrams to host:port (the
+    // BinTrac simulator's control port drains its bins while the auger runs).
+    // Defaults to $FEEDER_RELAY_FEED as "127.0.0.1:5021"; nullptr turns it off.
+    void setRelayFeed(const char* host, uint16_t port);
+
+    // Directory backing LittleFS (fs/), Preferences (nvs/) and OTA images (ota/)
+    // Defaults to $FEEDER_DATA_DIR, else ./.native_data
+    void setDataDir(const char* path);
+    const char* getDataDir();
+    void clearDataDir();
+
+    // Listening ports are opened at port + offset on the host (default
+    // $FEEDER_PORT_OFFSET, else 8000: the web server's port 80 becomes 8080)
+    void setPortOffset(int offset);
+    uint16_t hostPort(uint16_t port);
+
+    // Send outbound connections and datagrams for a remote port (Modbus 502,
+    // NTP 123, ...) to host:hostPort instead, whatever address the firmware
+    // uses. Also read from $FEEDER_REDIRECT as "502=127.0.0.1:5020,123=...".
+    void redirect(uint16_t port, const char* host, uint16_t hostPort);
+    void clearRedirects();
+
+    // For the shims themselves: how long a wait of ms simulated milliseconds
+    // takes in real time (frozen clock: at most 1 ms, then the clock jumps),
+    // and the clock update when such a wait runs out
+    uint64_t realWaitMicros(unsigned long ms);
+    void waitExpired(unsigned long ms);
+
+    // Host path for a name under one of the data dir's areas ("fs", "nvs",
+    // "ota"), creating the directories on the way; false if it doesn't fit
+    bool dataPath(const char* area, const char* name, char* path, size_t size);
+
+    // Where outbound traffic for a remote port goes; false = no redirect
+    bool findRedirect(uint16_t port, char* host, size_t hostSize, uint16_t& hostPort);
+
+    // ESP.restart() exits the process with this code so a supervisor can
+    // start it again like a reboot
+    const int RESTART_EXIT_CODE = 3;
+}
+
+#endif // NATIVE_SHIM_H
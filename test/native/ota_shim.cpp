@@ -0,0 +1,272 @@
+// Update, OTA partitions and the mbedTLS pieces OtaUpdate needs, for the
+// native test environment
+
+#include "Update.h"
+#include "esp_ota_ops.h"
+#include "mbedtls/md.h"
+#include "mbedtls/pk.h"
+#include <sys/stat.h>
+
+UpdateClass Update;
+
+// ---- Partitions ----
+
+static const esp_partition_t appPartitions[2] = {{"app0"}, {"app1"}};
+static const esp_partition_t* runningPartition = nullptr;
+
+static const esp_partition_t* readBootPartition() {
+    char path[256];
+    if (!NativeShim::dataPath("ota", "boot", path, sizeof(path))) return &appPartitions[0];
+
+    char label[17] = "";
+    FILE* file = fopen(path, "r");
+    if (file != nullptr) {
+        if (fgets(label, sizeof(label), file) == nullptr) label[0] = '\0';
+        fclose(file);
+    }
+    return strcmp(label, "app1") == 0 ? &appPartitions[1] : &appPartitions[0];
+}
+
+// The process "booted" whatever was set to boot when it started
+const esp_partition_t* esp_ota_get_running_partition() {
+    if (runningPartition == nullptr) runningPartition = readBootPartition();
+    return runningPartition;
+}
+
+const esp_partition_t* esp_ota_get_boot_partition() {
+    return readBootPartition();
+}
+
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* start) {
+    if (start == nullptr) start = esp_ota_get_running_partition();
+    return start == &appPartitions[0] ? &appPartitions[1] : &appPartitions[0];
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* partition) {
+    if (partition != &appPartitions[0] && partition != &appPartitions[1]) return ESP_FAIL;
+
+    // Like the IDF, refuse a partition without an image (app0 is the flashed build)
+    char path[256];
+    char image[32];
+    struct stat st;
+    snprintf(image, sizeof(image), "%s.bin", partition->label);
+    if (partition != &appPartitions[0] &&
+        (!NativeShim::dataPath("ota", image, path, sizeof(path)) || stat(path, &st) != 0)) {
+        return ESP_ERR_OTA_VALIDATE_FAILED;
+    }
+
+    if (!NativeShim::dataPath("ota", "boot", path, sizeof(path))) return ESP_FAIL;
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) return ESP_FAIL;
+    fputs(partition->label, file);
+    fclose(file);
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_valid_cancel_rollback() {
+    return ESP_OK;
+}
+
+// ---- Update ----
+
+bool UpdateClass::begin(size_t size, int command) {
+    _error[0] = '\0';
+    if (_file != nullptr) abort();
+
+    size_t limit = command == U_FLASH ? NATIVE_APP_PARTITION_SIZE : NATIVE_FS_PARTITION_SIZE;
+    if (size == 0 || size > limit) {
+        strlcpy(_error, "Not Enough Space", sizeof(_error));
+        return false;
+    }
+
+    char image[32];
+    snprintf(image, sizeof(image), "%s.bin",
+             command == U_FLASH ? esp_ota_get_next_update_partition(nullptr)->label : "spiffs");
+    if (!NativeShim::dataPath("ota", image, _path, sizeof(_path))) {
+        strlcpy(_error, "Bad Argument", sizeof(_error));
+        return false;
+    }
+
+    // Written beside the partition and renamed by end(), so a failed upload leaves nothing behind
+    char temp[270];
+    snprintf(temp, sizeof(temp), "%s.part", _path);
+    _file = fopen(temp, "wb");
+    if (_file == nullptr) {
+        strlcpy(_error, "Flash Erase Failed", sizeof(_error));
+        return false;
+    }
+
+    _command = command;
+    _size = size;
+    _written = 0;
+    return true;
+}
+
+size_t UpdateClass::write(uint8_t* data, size_t length) {
+    if (_file == nullptr) return 0;
+    if (_written + length > _size) {
+        strlcpy(_error, "Flash Write Failed", sizeof(_error));
+        abort();
+        return 0;
+    }
+    size_t n = fwrite(data, 1, length, _file);
+    _written += n;
+    return n;
+}
+
+bool UpdateClass::end(bool evenIfRemaining) {
+    if (_file == nullptr) {
+        strlcpy(_error, "Bad Argument", sizeof(_error));
+        return false;
+    }
+    if (_written < _size && !evenIfRemaining) {
+        strlcpy(_error, "Bad Size Given", sizeof(_error));
+        abort();
+        return false;
+    }
+
+    fclose(_file);
+    _file = nullptr;
+
+    char temp[270];
+    snprintf(temp, sizeof(temp), "%s.part", _path);
+    if (rename(temp, _path) != 0) {
+        strlcpy(_error, "Flash Write Failed", sizeof(_error));
+        return false;
+    }
+
+    // A firmware image becomes the boot partition, as in the library
+    if (_command == U_FLASH &&
+        esp_ota_set_boot_partition(esp_ota_get_next_update_partition(nullptr)) != ESP_OK) {
+        strlcpy(_error, "Could Not Activate The Firmware", sizeof(_error));
+        return false;
+    }
+    return true;
+}
+
+void UpdateClass::abort() {
+    if (_file == nullptr) return;
+    fclose(_file);
+    _file = nullptr;
+
+    char temp[270];
+    snprintf(temp, sizeof(temp), "%s.part", _path);
+    remove(temp);
+    if (_error[0] == '\0') strlcpy(_error, "Aborted", sizeof(_error));
+}
+
+// ---- SHA-256 (FIPS 180-4) ----
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+static void sha256Block(uint32_t state[8], const uint8_t block[64]) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 |
+               (uint32_t)block[i * 4 + 2] << 8 | block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+        uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+const mbedtls_md_info_t* mbedtls_md_info_from_type(mbedtls_md_type_t type) {
+    // Only SHA-256 exists here; any non-null pointer will do as its handle
+    static const int sha256 = 0;
+    return type == MBEDTLS_MD_SHA256 ? (const mbedtls_md_info_t*)&sha256 : nullptr;
+}
+
+void mbedtls_md_init(mbedtls_md_context_t* ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+int mbedtls_md_setup(mbedtls_md_context_t* ctx, const mbedtls_md_info_t* info, int hmac) {
+    return info != nullptr && hmac == 0 ? 0 : -1;
+}
+
+int mbedtls_md_starts(mbedtls_md_context_t* ctx) {
+    static const uint32_t initial[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    memcpy(ctx->state, initial, sizeof(initial));
+    ctx->length = 0;
+    ctx->blockLength = 0;
+    return 0;
+}
+
+int mbedtls_md_update(mbedtls_md_context_t* ctx, const unsigned char* input, size_t length) {
+    ctx->length += length;
+    while (length > 0) {
+        size_t n = min(length, sizeof(ctx->block) - ctx->blockLength);
+        memcpy(ctx->block + ctx->blockLength, input, n);
+        ctx->blockLength += n;
+        input += n;
+        length -= n;
+        if (ctx->blockLength == sizeof(ctx->block)) {
+            sha256Block(ctx->state, ctx->block);
+            ctx->blockLength = 0;
+        }
+    }
+    return 0;
+}
+
+int mbedtls_md_finish(mbedtls_md_context_t* ctx, unsigned char* output) {
+    uint64_t bits = ctx->length * 8;
+    uint8_t pad = 0x80;
+    mbedtls_md_update(ctx, &pad, 1);
+    pad = 0;
+    while (ctx->blockLength != 56) mbedtls_md_update(ctx, &pad, 1);
+
+    uint8_t length[8];
+    for (int i = 0; i < 8; i++) length[i] = (uint8_t)(bits >> (56 - i * 8));
+    mbedtls_md_update(ctx, length, sizeof(length));
+
+    for (int i = 0; i < 8; i++) {
+        output[i * 4] = ctx->state[i] >> 24;
+        output[i * 4 + 1] = ctx->state[i] >> 16;
+        output[i * 4 + 2] = ctx->state[i] >> 8;
+        output[i * 4 + 3] = ctx->state[i];
+    }
+    return 0;
+}
+
+void mbedtls_md_free(mbedtls_md_context_t* ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+// ---- Public keys ----
+
+void mbedtls_pk_init(mbedtls_pk_context* ctx) { ctx->key = nullptr; }
+void mbedtls_pk_free(mbedtls_pk_context* ctx) { ctx->key = nullptr; }
+
+int mbedtls_pk_parse_public_key(mbedtls_pk_context* ctx, const unsigned char* key, size_t length) {
+    return MBEDTLS_ERR_PK_FEATURE_UNAVAILABLE;
+}
+
+int mbedtls_pk_verify(mbedtls_pk_context* ctx, mbedtls_md_type_t type, const unsigned char* hash,
+                      size_t hashLength, const unsigned char* signature, size_t signatureLength) {
+    return MBEDTLS_ERR_PK_FEATURE_UNAVAILABLE;
+}
@@ -0,0 +1,250 @@
+// Preferences and LittleFS over a host directory for the native test environment
+
+#include "Preferences.h"
+#include "LittleFS.h"
+#include <dirent.h>
+#include <errno.h>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+LittleFSFS LittleFS;
+
+// ---- Preferences ----
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    char marker[256];
+    // A marker file makes the namespace directory (and its parents)
+    if (!NativeShim::dataPath("nvs", name, marker, sizeof(marker))) return false;
+    mkdir(marker, 0755);
+    strlcpy(_path, marker, sizeof(_path));
+    _readOnly = readOnly;
+    return true;
+}
+
+void Preferences::end() {
+    _path[0] = '\0';
+}
+
+bool Preferences::keyPath(const char* key, char* path, size_t size) {
+    if (_path[0] == '\0' || key == nullptr || key[0] == '\0' || strchr(key, '/') != nullptr) return false;
+    int length = snprintf(path, size, "%s/%s", _path, key);
+    return length > 0 && (size_t)length < size;
+}
+
+bool Preferences::clear() {
+    if (_path[0] == '\0' || _readOnly) return false;
+    DIR* dir = opendir(_path);
+    if (dir == nullptr) return false;
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') continue;
+        remove(entry->d_name);  // Each entry is a key
+    }
+    closedir(dir);
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    char path[320];
+    if (_readOnly || !keyPath(key, path, sizeof(path))) return false;
+    return unlink(path) == 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    char path[320];
+    struct stat st;
+    return keyPath(key, path, sizeof(path)) && stat(path, &st) == 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+    char path[320];
+    if (_readOnly || !keyPath(key, path, sizeof(path))) return 0;
+
+    // Write-then-rename, so a crash never leaves half a value
+    char temp[330];
+    snprintf(temp, sizeof(temp), "%s.tmp", path);
+    FILE* file = fopen(temp, "wb");
+    if (file == nullptr) return 0;
+    size_t written = length > 0 ? fwrite(value, 1, length, file) : 0;
+    fclose(file);
+    if (written != length || rename(temp, path) != 0) {
+        unlink(temp);
+        return 0;
+    }
+    return length;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    char path[320];
+    struct stat st;
+    if (!keyPath(key, path, sizeof(path)) || stat(path, &st) != 0) return 0;
+    return st.st_size;
+}
+
+size_t Preferences::getBytes(const char* key, void* value, size_t maxLength) {
+    char path[320];
+    if (!keyPath(key, path, sizeof(path))) return 0;
+    size_t length = getBytesLength(key);
+    if (length == 0 || length > maxLength) return 0;
+
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) return 0;
+    size_t n = fread(value, 1, length, file);
+    fclose(file);
+    return n;
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLength) {
+    size_t length = getBytesLength(key);
+    if (maxLength == 0 || length + 1 > maxLength || !isKey(key)) return 0;
+    size_t n = length > 0 ? getBytes(key, value, maxLength - 1) : 0;
+    value[n] = '\0';
+    return n + 1;  // Like NVS: the length including the terminator
+}
+
+String Preferences::getString(const char* key, const char* defaultValue) {
+    char value[512];
+    if (getString(key, value, sizeof(value)) == 0) return String(defaultValue);
+    return String(value);
+}
+
+// ---- LittleFS ----
+
+File::File(FILE* file, const char* path) : _file(file), _size(0) {
+    strlcpy(_name, path, sizeof(_name));
+    struct stat st;
+    if (fstat(fileno(file), &st) == 0) _size = st.st_size;
+}
+
+size_t File::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+    if (_file == nullptr) return 0;
+    size_t n = fwrite(buf, 1, size, _file);
+    long end = ftell(_file);
+    if (end > 0 && (size_t)end > _size) _size = end;
+    return n;
+}
+
+int File::available() {
+    if (_file == nullptr) return 0;
+    long pos = ftell(_file);
+    return pos >= 0 && (size_t)pos < _size ? (int)(_size - pos) : 0;
+}
+
+int File::read() {
+    return _file != nullptr ? fgetc(_file) : -1;
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+    return _file != nullptr ? fread(buf, 1, size, _file) : 0;
+}
+
+int File::peek() {
+    if (_file == nullptr) return -1;
+    int c = fgetc(_file);
+    if (c != EOF) ungetc(c, _file);
+    return c;
+}
+
+void File::flush() {
+    if (_file != nullptr) fflush(_file);
+}
+
+bool File::seek(size_t position) {
+    return _file != nullptr && fseek(_file, position, SEEK_SET) == 0;
+}
+
+size_t File::position() {
+    long pos = _file != nullptr ? ftell(_file) : -1;
+    return pos >= 0 ? pos : 0;
+}
+
+size_t File::size() {
+    return _size;
+}
+
+void File::close() {
+    if (_file != nullptr) fclose(_file);
+    _file = nullptr;
+}
+
+bool LittleFSFS::hostPath(const char* path, char* out, size_t size) {
+    return _mounted && path != nullptr && path[0] == '/' && strstr(path, "..") == nullptr &&
+           NativeShim::dataPath("fs", path, out, size);
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+    char root[256];
+    if (!NativeShim::dataPath("fs", "", root, sizeof(root))) return false;
+    _mounted = true;
+    return true;
+}
+
+static int removeEntry(const char* path, const struct stat* st, int flag, struct FTW* ftw) {
+    return ftw->level > 0 ? remove(path) : 0;  // Keep fs/ itself
+}
+
+bool LittleFSFS::format() {
+    char root[256];
+    if (!NativeShim::dataPath("fs", "", root, sizeof(root))) return false;
+    return nftw(root, removeEntry, 16, FTW_DEPTH | FTW_PHYS) == 0;
+}
+
+File LittleFSFS::open(const char* path, const char* mode) {
+    char host[256];
+    if (!hostPath(path, host, sizeof(host))) return File();
+
+    // "r", "w" and "a" as in LittleFS; binary on the host so sizes match
+    char hostMode[4] = "rb";
+    if (mode[0] == 'w') strlcpy(hostMode, strchr(mode, '+') ? "wb+" : "wb", sizeof(hostMode));
+    else if (mode[0] == 'a') strlcpy(hostMode, strchr(mode, '+') ? "ab+" : "ab", sizeof(hostMode));
+    else if (strchr(mode, '+')) strlcpy(hostMode, "rb+", sizeof(hostMode));
+
+    FILE* file = fopen(host, hostMode);
+    return file != nullptr ? File(file, path) : File();
+}
+
+bool LittleFSFS::exists(const char* path) {
+    char host[256];
+    struct stat st;
+    return hostPath(path, host, sizeof(host)) && stat(host, &st) == 0;
+}
+
+bool LittleFSFS::remove(const char* path) {
+    char host[256];
+    return hostPath(path, host, sizeof(host)) && ::remove(host) == 0;
+}
+
+bool LittleFSFS::rename(const char* from, const char* to) {
+    char hostFrom[256], hostTo[256];
+    return hostPath(from, hostFrom, sizeof(hostFrom)) && hostPath(to, hostTo, sizeof(hostTo)) &&
+           ::rename(hostFrom, hostTo) == 0;
+}
+
+bool LittleFSFS::mkdir(const char* path) {
+    char host[256];
+    return hostPath(path, host, sizeof(host)) && (::mkdir(host, 0755) == 0 || errno == EEXIST);
+}
+
+// The real partition's size; usage is the files under fs/
+size_t LittleFSFS::totalBytes() {
+    return 0x160000;
+}
+
+static size_t usedTotal;
+
+static int addEntry(const char* path, const struct stat* st, int flag, struct FTW* ftw) {
+    if (flag == FTW_F) usedTotal += st->st_size;
+    return 0;
+}
+
+size_t LittleFSFS::usedBytes() {
+    char root[256];
+    if (!NativeShim::dataPath("fs", "", root, sizeof(root))) return 0;
+    usedTotal = 0;
+    nftw(root, addEntry, 16, FTW_PHYS);
+    return usedTotal;
+}
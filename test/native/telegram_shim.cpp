@@ -0,0 +1,89 @@
+// Bot API client behind the UniversalTelegramBot stand-in
+
+#include "UniversalTelegramBot.h"
+#include <ArduinoJson.h>
+#include <chrono>
+#include <thread>
+
+UniversalTelegramBot::UniversalTelegramBot(const String& token, Client& client)
+    : _token(token), _client(client) {
+    _response[0] = '\0';
+}
+
+bool UniversalTelegramBot::post(const char* method, const char* body) {
+    _response[0] = '\0';
+    if (!_client.connect(TELEGRAM_HOST, TELEGRAM_SSL_PORT)) return false;
+
+    char headers[256];
+    int length = snprintf(headers, sizeof(headers),
+                          "POST /bot%s/%s HTTP/1.1\r\n"
+                          "Host: " TELEGRAM_HOST "\r\n"
+                          "Content-Type: application/json\r\n"
+                          "Content-Length: %u\r\n"
+                          "Connection: close\r\n\r\n",
+                          _token.c_str(), method, (unsigned)strlen(body));
+    _client.write((const uint8_t*)headers, length);
+    _client.write((const uint8_t*)body, strlen(body));
+
+    // Whole response until the server closes (real time bound)
+    size_t received = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(waitForResponse);
+    while (std::chrono::steady_clock::now() < deadline && received < sizeof(_response) - 1) {
+        int n = _client.available() ? _client.read((uint8_t*)_response + received,
+                                                   sizeof(_response) - 1 - received) : 0;
+        if (n > 0) {
+            received += n;
+        } else if (!_client.connected()) {
+            break;
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    _client.stop();
+    _response[received] = '\0';
+
+    if (strncmp(_response, "HTTP/1.1 200", 12) != 0 && strncmp(_response, "HTTP/1.0 200", 12) != 0) return false;
+    const char* bodyStart = strstr(_response, "\r\n\r\n");
+    if (bodyStart == nullptr) return false;
+    memmove(_response, bodyStart + 4, strlen(bodyStart + 4) + 1);
+    return true;
+}
+
+int UniversalTelegramBot::getUpdates(long offset) {
+    char body[96];
+    snprintf(body, sizeof(body), "{\"offset\":%ld,\"limit\":%d,\"timeout\":0}", offset, HANDLE_MESSAGES);
+    if (!post("getUpdates", body)) return 0;
+
+    JsonDocument doc;
+    if (deserializeJson(doc, _response) || !(doc["ok"] | false)) return 0;
+
+    int count = 0;
+    for (JsonVariant update : doc["result"].as<JsonArray>()) {
+        if (count == HANDLE_MESSAGES) break;
+        JsonVariant message = update["message"];
+        telegramMessage& m = messages[count++];
+        m.update_id = update["update_id"] | 0;
+        m.message_id = message["message_id"] | 0;
+        m.text = String(message["text"] | "");
+        m.chat_id = String(std::to_string(message["chat"]["id"].as<long long>()));
+        m.chat_title = String(message["chat"]["title"] | "");
+        m.from_id = String(std::to_string(message["from"]["id"].as<long long>()));
+        m.from_name = String(message["from"]["first_name"] | "");
+        m.date = String(std::to_string(message["date"].as<long long>()));
+        m.type = String("message");
+        last_message_received = m.update_id;
+    }
+    return count;
+}
+
+bool UniversalTelegramBot::sendMessage(const String& chat_id, const String& text, const String& parse_mode,
+                                       int message_id) {
+    JsonDocument doc;
+    doc["chat_id"] = chat_id.c_str();
+    doc["text"] = text.c_str();
+    if (!parse_mode.isEmpty()) doc["parse_mode"] = parse_mode.c_str();
+
+    char body[2048] = "";
+    serializeJson(doc, body, sizeof(body));
+    return post("sendMessage", body);
+}
@@ -0,0 +1,37 @@
+#ifndef NATIVE_W5100_H
+#define NATIVE_W5100_H
+
+// Host stand-in for the Ethernet library's chip access (native test environment)
+// Socket status comes from the emulated socket table; other registers read
+// as zero and writes are ignored.
+
+#include "../Ethernet.h"
+
+class SnSR {
+public:
+    static const uint8_t CLOSED = 0x00;
+    static const uint8_t INIT = 0x13;
+    static const uint8_t LISTEN = 0x14;
+    static const uint8_t SYNSENT = 0x15;
+    static const uint8_t SYNRECV = 0x16;
+    static const uint8_t ESTABLISHED = 0x17;
+    static const uint8_t FIN_WAIT = 0x18;
+    static const uint8_t CLOSING = 0x1A;
+    static const uint8_t TIME_WAIT = 0x1B;
+    static const uint8_t CLOSE_WAIT = 0x1C;
+    static const uint8_t LAST_ACK = 0x1D;
+    static const uint8_t UDP = 0x22;
+};
+
+class W5100Class {
+public:
+    static uint8_t readSnSR(uint8_t socket);
+    static uint8_t readSnIR(uint8_t socket) { return 0; }
+    static void writeSnIR(uint8_t socket, uint8_t value) {}
+    static uint16_t write(uint16_t address, uint8_t value) { return 1; }
+    static uint8_t read(uint16_t address) { return 0; }
+};
+
+extern W5100Class W5100;
+
+#endif // NATIVE_W5100_H
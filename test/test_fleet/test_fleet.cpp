@@ -0,0 +1,354 @@
+// Host tests of the fleet aggregator (fleet/)
+// The poller, connection pool, model and API against fake controllers on
+// localhost that answer /api/status and /api/history?since= like the
+// firmware (one request per connection unless told to keep connections).
+//
+//   pio test -e fleet_aggregator
+
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <errno.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "fleet_model.h"
+#include "fleet_server.h"
+#include "http_client.h"
+#include "json_scan.h"
+#include "poller.h"
+
+// ---- Fake controller ----
+// The history cursor here is an event index; the aggregator treats it as
+// opaque, like the firmware's byte offset. clearHistory() starts a new
+// generation, as DELETE /api/history does
+
+class FakeController {
+public:
+    int state = 0;
+    unsigned long clock = 1760774400;
+    std::vector<std::string> events;
+    uint32_t generation = 1;
+    bool keepAlive = false;
+    std::vector<std::string> requests;
+    std::atomic<int> connections{0};
+    std::mutex lock;
+
+    bool start() {
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(_fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(_fd, 16) != 0) return false;
+        socklen_t length = sizeof(address);
+        getsockname(_fd, (sockaddr*)&address, &length);
+        port = ntohs(address.sin_port);
+        _running = true;
+        _thread = std::thread(&FakeController::serve, this);
+        return true;
+    }
+
+    void stop() {
+        _running = false;
+        if (_thread.joinable()) _thread.join();
+        close(_fd);
+    }
+
+    void addEvents(int count) {
+        std::lock_guard<std::mutex> guard(lock);
+        for (int i = 0; i < count; i++) {
+            int n = events.size();
+            events.push_back("{\"timestamp\":" + std::to_string(1760774400 + n * 3600) + ",\"feedCycle\":" +
+                             std::to_string(n % 4) + ",\"targetWeight\":150,\"actualWeight\":149.5,\"duration\":" +
+                             "300,\"alarmTriggered\":false,\"alarmReason\":\"{not [json}\"}");
+        }
+    }
+
+    uint16_t port = 0;
+
+private:
+    int _fd = -1;
+    std::atomic<bool> _running{false};
+    std::thread _thread;
+
+    // Waits for data on fd while running; false when stopped
+    bool readable(int fd) {
+        while (_running) {
+            pollfd p = {fd, POLLIN, 0};
+            if (poll(&p, 1, 50) > 0) return true;
+        }
+        return false;
+    }
+
+    void serve() {
+        while (_running) {
+            if (!readable(_fd)) break;
+            int fd = accept(_fd, nullptr, nullptr);
+            if (fd < 0) continue;
+            connections++;
+
+            std::string data;
+            char buffer[1024];
+            for (;;) {
+                size_t end = data.find("\r\n\r\n");
+                if (end == std::string::npos) {
+                    if (!readable(fd)) break;
+                    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+                    if (n <= 0) break;
+                    data.append(buffer, n);
+                    continue;
+                }
+                std::string path = data.substr(4, data.find(' ', 4) - 4);
+                data.erase(0, end + 4);
+
+                std::string body = reply(path);
+                std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+                                       std::to_string(body.size()) + "\r\nConnection: " +
+                                       (keepAlive ? "keep-alive" : "close") + "\r\n\r\n" + body;
+                send(fd, response.data(), response.size(), MSG_NOSIGNAL);
+                if (!keepAlive) break;
+            }
+            close(fd);
+        }
+    }
+
+    std::string reply(const std::string& path) {
+        std::lock_guard<std::mutex> guard(lock);
+        requests.push_back(path);
+
+        if (path == "/api/status") {
+            clock++;
+            return "{\"state\":" + std::to_string(state) +
+                   ",\"currentWeight\":[1500,1200,0,0],\"lastError\":\"\",\"currentTime\":" +
+                   std::to_string(clock) + ",\"heap\":{\"free\":" + std::to_string(150000 + clock % 7) + "}}";
+        }
+        if (path.compare(0, 19, "/api/history?since=") == 0) {
+            size_t since = strtoul(path.c_str() + 19, nullptr, 10);
+            size_t generationParam = path.find("&generation=");
+            if (generationParam != std::string::npos &&
+                strtoul(path.c_str() + generationParam + 12, nullptr, 10) != generation) {
+                since = 0;  // Cleared since: start over
+            }
+            size_t next = std::min(events.size(), since + 50);
+            std::string body = "{\"history\":[";
+            for (size_t i = since; i < next; i++) {
+                if (i > since) body += ',';
+                body += events[i];
+            }
+            return body + "],\"next\":" + std::to_string(next) + ",\"generation\":" +
+                   std::to_string(generation) + "}";
+        }
+        return "{}";
+    }
+};
+
+static uint16_t closedPort() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd, (sockaddr*)&address, sizeof(address));
+    socklen_t length = sizeof(address);
+    getsockname(fd, (sockaddr*)&address, &length);
+    close(fd);
+    return ntohs(address.sin_port);
+}
+
+static std::string fleetReply(const FleetServer& server, const std::string& target) {
+    std::string contentType, body;
+    TEST_ASSERT_EQUAL_INT(200, server.handle("GET", target, contentType, body));
+    return body;
+}
+
+static size_t count(const std::string& s, const std::string& needle) {
+    size_t n = 0;
+    for (size_t pos = s.find(needle); pos != std::string::npos; pos = s.find(needle, pos + 1)) n++;
+    return n;
+}
+
+void setUp() {}
+void tearDown() {}
+
+// ---- Tests ----
+
+void test_json_scan() {
+    std::string json = "{\"a\":{\"state\":\"x\"},\"state\": 3,\"ok\":true,"
+                       "\"history\":[{\"t\":1,\"s\":\"}{\"},{\"t\":2,\"n\":{\"x\":[1]}}],\"next\":7}";
+    double value = 0;
+    TEST_ASSERT_TRUE(JsonScan::number(json, "ok", value));
+    TEST_ASSERT_EQUAL_INT(1, (int)value);
+    TEST_ASSERT_TRUE(JsonScan::number(json, "next", value));
+    TEST_ASSERT_EQUAL_INT(7, (int)value);
+    TEST_ASSERT_FALSE(JsonScan::number(json, "missing", value));
+
+    std::vector<std::string> objects;
+    TEST_ASSERT_TRUE(JsonScan::arrayObjects(json, "history", objects));
+    TEST_ASSERT_EQUAL_INT(2, objects.size());
+    TEST_ASSERT_EQUAL_STRING("{\"t\":1,\"s\":\"}{\"}", objects[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"t\":2,\"n\":{\"x\":[1]}}", objects[1].c_str());
+
+    TEST_ASSERT_EQUAL_STRING("{\"b\":2}", JsonScan::without("{\"a\":{\"x\":1},\"b\":2}", "a").c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1,\"b\":2}", JsonScan::without("{\"a\":1,\"t\":5,\"b\":2}", "t").c_str());
+    TEST_ASSERT_EQUAL_STRING("\"a\\\"b\\\\\\u000a\"", JsonScan::quote("a\"b\\\n").c_str());
+}
+
+void test_fleet_syncs_status_and_history_deltas() {
+    FakeController barn1, barn2;
+    TEST_ASSERT_TRUE(barn1.start());
+    TEST_ASSERT_TRUE(barn2.start());
+    barn1.addEvents(120);
+    barn2.addEvents(3);
+
+    FleetModel model(100);
+    model.add({"barn1", "127.0.0.1", barn1.port});
+    model.add({"barn2", "127.0.0.1", barn2.port});
+    model.add({"barn3", "127.0.0.1", closedPort()});
+    ConnectionPool pool(1000);
+    Poller poller(model, pool, PollerOptions());
+    FleetServer server(model, pool);
+
+    for (size_t i = 0; i < model.size(); i++) poller.pollController(i);
+
+    // 120 events in three pages, of which the last 100 are kept
+    std::string history = fleetReply(server, "/api/fleet/history?controller=barn1");
+    TEST_ASSERT_TRUE(history.find("\"first\":20,\"next\":120,") != std::string::npos);
+    TEST_ASSERT_EQUAL_INT(100, count(history, "\"feedCycle\""));
+    TEST_ASSERT_EQUAL_INT(120, model.historyCursor(0));
+    TEST_ASSERT_EQUAL_STRING("/api/history?since=100&generation=1", barn1.requests.back().c_str());
+
+    std::string fleet = fleetReply(server, "/api/fleet");
+    TEST_ASSERT_TRUE(fleet.find("\"controllers\":3,\"online\":2,\"offline\":1,\"idle\":2,\"waiting\":0,") !=
+                     std::string::npos);
+    TEST_ASSERT_TRUE(fleet.find("\"name\":\"barn3\"") != std::string::npos);
+    TEST_ASSERT_TRUE(fleet.find("\"lastError\":\"connect failed") != std::string::npos);
+    TEST_ASSERT_TRUE(fleet.find("\"status\":{\"state\":0,\"currentWeight\":[1500,1200,0,0]") != std::string::npos);
+
+    // Nothing but the clock and heap moved: an incremental read is empty
+    double version = 0;
+    JsonScan::number(fleet, "version", version);
+    poller.pollController(0);
+    poller.pollController(1);
+    std::string delta = fleetReply(server, "/api/fleet?since=" + std::to_string((uint64_t)version));
+    TEST_ASSERT_TRUE(delta.find("\"full\":false,") != std::string::npos);
+    TEST_ASSERT_TRUE(delta.find("\"controllers\":[]}") != std::string::npos);
+
+    // A feed on barn2, held back by the stagger first: its end brings the new
+    // event at once, from the cursor
+    barn2.state = 6;
+    poller.pollController(1);
+    fleet = fleetReply(server, "/api/fleet");
+    TEST_ASSERT_TRUE(fleet.find("\"error\":0,\"starting\":1}") != std::string::npos);
+    TEST_ASSERT_TRUE(fleet.find("\"state\":\"starting\"") != std::string::npos);
+    barn2.state = 2;
+    poller.pollController(1);
+    barn2.state = 0;
+    barn2.addEvents(1);
+    poller.pollController(1);
+    TEST_ASSERT_EQUAL_STRING("/api/history?since=3&generation=1", barn2.requests.back().c_str());
+    delta = fleetReply(server, "/api/fleet?since=" + std::to_string((uint64_t)version));
+    TEST_ASSERT_EQUAL_INT(1, count(delta, "\"name\":"));
+    TEST_ASSERT_TRUE(delta.find("\"name\":\"barn2\"") != std::string::npos);
+    TEST_ASSERT_TRUE(delta.find("\"historyEvents\":4,") != std::string::npos);
+
+    history = fleetReply(server, "/api/fleet/history?controller=barn2&since=3");
+    TEST_ASSERT_TRUE(history.find("\"first\":3,\"next\":4,") != std::string::npos);
+    TEST_ASSERT_EQUAL_INT(1, count(history, "\"feedCycle\""));
+
+    // History cleared on the controller and grown past the old cursor before
+    // the next poll: the generation says so, the aggregator starts over and
+    // the sequence numbers keep counting
+    {
+        std::lock_guard<std::mutex> guard(barn2.lock);
+        barn2.events.clear();
+        barn2.generation++;
+    }
+    barn2.addEvents(6);
+    poller.pollController(1, true);
+    history = fleetReply(server, "/api/fleet/history?controller=barn2");
+    TEST_ASSERT_TRUE(history.find("\"first\":4,\"next\":10,") != std::string::npos);
+    TEST_ASSERT_EQUAL_INT(6, model.historyCursor(1));
+    TEST_ASSERT_EQUAL_INT(2, model.historyGeneration(1));
+
+    std::string contentType, body;
+    TEST_ASSERT_EQUAL_INT(404, server.handle("GET", "/api/fleet/history?controller=barn9", contentType, body));
+
+    barn1.stop();
+    barn2.stop();
+}
+
+void test_pool_reuses_kept_connections() {
+    FakeController barn;
+    barn.keepAlive = true;
+    TEST_ASSERT_TRUE(barn.start());
+
+    ConnectionPool pool(1000);
+    HttpResponse response;
+    std::string error;
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(pool.get("127.0.0.1", barn.port, "/api/status", response, error));
+        TEST_ASSERT_EQUAL_INT(200, response.status);
+        TEST_ASSERT_TRUE(response.body.find("\"state\":0") == 1);
+    }
+    TEST_ASSERT_EQUAL_INT(1, barn.connections.load());
+    TEST_ASSERT_EQUAL_INT(1, pool.getOpened());
+    TEST_ASSERT_EQUAL_INT(4, pool.getReused());
+    TEST_ASSERT_EQUAL_INT(1, pool.getIdle());
+
+    // A controller that closes after each reply gets a connection per request
+    barn.stop();
+    FakeController closing;
+    TEST_ASSERT_TRUE(closing.start());
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(pool.get("127.0.0.1", closing.port, "/api/status", response, error));
+    }
+    TEST_ASSERT_EQUAL_INT(3, closing.connections.load());
+    closing.stop();
+    pool.closeIdle();
+}
+
+void test_poller_workers_cover_the_fleet() {
+    // 30 controller entries across three fakes, more than the workers
+    FakeController fakes[3];
+    FleetModel model;
+    for (int i = 0; i < 3; i++) TEST_ASSERT_TRUE(fakes[i].start());
+    for (int i = 0; i < 30; i++) model.add({"barn" + std::to_string(i), "127.0.0.1", fakes[i % 3].port});
+
+    ConnectionPool pool(1000);
+    PollerOptions options;
+    options.workers = 4;
+    options.statusIntervalMs = 200;
+    Poller poller(model, pool, options);
+    FleetServer server(model, pool);
+    poller.start();
+
+    // Every controller online within a few intervals, each polled repeatedly
+    std::string fleet;
+    for (int i = 0; i < 100; i++) {
+        fleet = fleetReply(server, "/api/fleet");
+        if (fleet.find("\"online\":30,") != std::string::npos && poller.getPolls() >= 90) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    poller.stop();
+    TEST_ASSERT_TRUE(fleet.find("\"online\":30,") != std::string::npos);
+    TEST_ASSERT_TRUE(poller.getPolls() >= 90);
+    TEST_ASSERT_EQUAL_INT(0, pool.getFailed());
+
+    for (FakeController& fake : fakes) fake.stop();
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_json_scan);
+    RUN_TEST(test_fleet_syncs_status_and_history_deltas);
+    RUN_TEST(test_pool_reuses_kept_connections);
+    RUN_TEST(test_poller_workers_cover_the_fleet);
+    return UNITY_END();
+}
@@ -0,0 +1,1322 @@
+// Host tests of the firmware modules on the native shims
+// Real Storage, AugerControl, BinTrac and FeedWebServer code, with NVS and
+// LittleFS in a scratch directory, relays as recorded pin states and the
+// network on localhost: BinTrac talks to a Modbus TCP responder thread here,
+// the web server answers a plain socket client, MQTT telemetry goes to a
+// minimal broker thread and InfluxDB pushes to a minimal write endpoint.
+// Start coordinators run as forked processes on the shared multicast port.
+//
+//   pio test -e native -f test_native_modules
+
+#include <Arduino.h>
+#include <unity.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <errno.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <zlib.h>
+#include "config.h"
+#include "types.h"
+#include "storage.h"
+#include "auger_control.h"
+#include "bintrac.h"
+#include "net_lock.h"
+#include "net_dns.h"
+#include "shared_state.h"
+#include "web_server.h"
+#include "mqtt_telemetry.h"
+#include "influx_push.h"
+#include "gzip.h"
+#include "schedule_expr.h"
+#include "scheduler.h"
+#include "feed_curve.h"
+#include "start_coordinator.h"
+#include "task_messages.h"
+#include "logger.h"
+
+#define TEST_DATA_DIR ".native_test_data"
+
+// ---- Modbus TCP responder ----
+// Answers Read Input Registers (function 4) from a register table, one
+// request per connection like the firmware's client
+
+static uint16_t inputRegisters[16];  // From MODBUS_BIN_A_ADDR
+static std::atomic<bool> responderRunning(false);
+static std::atomic<uint32_t> responderRequests(0);
+static int responderFd = -1;
+static uint16_t responderPort = 0;
+
+static bool readFully(int fd, uint8_t* buf, size_t length) {
+    size_t got = 0;
+    while (got < length) {
+        ssize_t n = recv(fd, buf + got, length - got, 0);
+        if (n <= 0) return false;
+        got += n;
+    }
+    return true;
+}
+
+static void serveModbus() {
+    while (responderRunning) {
+        int fd = accept(responderFd, nullptr, nullptr);
+        if (fd < 0) continue;
+
+        uint8_t request[12];
+        if (readFully(fd, request, sizeof(request)) && request[7] == MODBUS_FUNCTION_CODE) {
+            uint16_t address = request[8] << 8 | request[9];
+            uint16_t count = request[10] << 8 | request[11];
+
+            uint8_t response[9 + 32];
+            memcpy(response, request, 4);          // Transaction and protocol IDs
+            response[4] = 0;
+            response[5] = 3 + count * 2;
+            response[6] = request[6];
+            response[7] = request[7];
+            response[8] = count * 2;
+            for (uint16_t i = 0; i < count && i < 16; i++) {
+                uint16_t value = inputRegisters[(address - MODBUS_BIN_A_ADDR + i) % 16];
+                response[9 + i * 2] = value >> 8;
+                response[10 + i * 2] = value & 0xFF;
+            }
+            send(fd, response, 9 + count * 2, MSG_NOSIGNAL);
+            responderRequests++;
+        }
+        close(fd);
+    }
+}
+
+static std::thread startResponder() {
+    responderFd = socket(AF_INET, SOCK_STREAM, 0);
+    int on = 1;
+    setsockopt(responderFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    timeval timeout = {0, 100000};  // So the thread notices when to stop
+    setsockopt(responderFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;  // Any free port
+    bind(responderFd, (sockaddr*)&addr, sizeof(addr));
+    listen(responderFd, 4);
+
+    socklen_t length = sizeof(addr);
+    getsockname(responderFd, (sockaddr*)&addr, &length);
+    responderPort = ntohs(addr.sin_port);
+
+    responderRunning = true;
+    return std::thread(serveModbus);
+}
+
+static void stopResponder(std::thread& thread) {
+    responderRunning = false;
+    thread.join();
+    close(responderFd);
+}
+
+// ---- Fixtures ----
+
+static Storage storage;
+static ConfigStore configStore;
+static StatusStore statusStore;
+static FeedWebServer webServer(storage, configStore, statusStore);
+
+void setUp() {
+    NativeShim::setDataDir(TEST_DATA_DIR);
+    NativeShim::clearDataDir();
+    NativeShim::setMillis(60000);  // A minute after boot, past BinTrac's retry delay
+}
+
+void tearDown() {}
+
+// ---- Storage ----
+
+void test_config_survives_restart() {
+    TEST_ASSERT_TRUE(storage.begin());
+
+    Config saved;
+    strlcpy(saved.bintracIP, "10.0.0.42", sizeof(saved.bintracIP));
+    strlcpy(saved.feedSchedules[2], "30 17 * * 1-5", sizeof(saved.feedSchedules[2]));
+    saved.targetWeight = 72.5;
+    saved.chainPreRunTime = 12;
+    TEST_ASSERT_TRUE(storage.saveConfig(saved));
+
+    // A fresh instance reads what's on "flash"
+    Storage restarted;
+    TEST_ASSERT_TRUE(restarted.begin());
+    Config loaded;
+    TEST_ASSERT_TRUE(restarted.loadConfig(loaded));
+    TEST_ASSERT_EQUAL_STRING("10.0.0.42", loaded.bintracIP);
+    TEST_ASSERT_EQUAL_STRING("30 17 * * 1-5", loaded.feedSchedules[2]);
+    TEST_ASSERT_EQUAL_FLOAT(72.5, loaded.targetWeight);
+    TEST_ASSERT_EQUAL_UINT32(12, loaded.chainPreRunTime);
+}
+
+void test_history_round_trip() {
+    TEST_ASSERT_TRUE(storage.begin());
+    TEST_ASSERT_TRUE(storage.clearHistory());
+
+    for (int i = 0; i < 3; i++) {
+        FeedEvent event = {};
+        event.timestamp = 1700000000UL + i * 21600;
+        event.feedCycle = i;
+        event.targetWeight = 50.0;
+        event.actualWeight = 48.5 + i;
+        event.duration = 300 + i;
+        event.alarmTriggered = i == 2;
+        strlcpy(event.alarmReason, i == 2 ? "Max runtime" : "", sizeof(event.alarmReason));
+        TEST_ASSERT_TRUE(storage.addFeedEvent(event));
+    }
+
+    FeedEvent events[10];
+    int count = 0;
+    TEST_ASSERT_TRUE(storage.getFeedHistory(events, count, 10));
+    TEST_ASSERT_EQUAL_INT(3, count);
+
+    // Newest or oldest first, every event has to come back intact
+    for (int i = 0; i < count; i++) {
+        int cycle = events[i].feedCycle;
+        TEST_ASSERT_TRUE(cycle >= 0 && cycle < 3);
+        TEST_ASSERT_EQUAL_UINT32(1700000000UL + cycle * 21600, events[i].timestamp);
+        TEST_ASSERT_EQUAL_FLOAT(48.5 + cycle, events[i].actualWeight);
+        TEST_ASSERT_EQUAL_UINT32(300 + cycle, events[i].duration);
+        TEST_ASSERT_TRUE(events[i].alarmTriggered == (cycle == 2));
+    }
+
+    // Paging with a cursor: two, then the rest, then only what's added later
+    size_t cursor = 0;
+    uint32_t generation = 0;
+    TEST_ASSERT_TRUE(storage.getFeedHistory(events, count, 2, &cursor, &generation));
+    TEST_ASSERT_EQUAL_INT(2, count);
+    TEST_ASSERT_EQUAL_UINT32(storage.getHistoryGeneration(), generation);
+    TEST_ASSERT_TRUE(storage.getFeedHistory(events, count, 10, &cursor, &generation));
+    TEST_ASSERT_EQUAL_INT(1, count);
+    TEST_ASSERT_EQUAL_INT(2, events[0].feedCycle);
+    size_t end = cursor;
+    TEST_ASSERT_TRUE(storage.getFeedHistory(events, count, 10, &cursor, &generation));
+    TEST_ASSERT_EQUAL_INT(0, count);
+    TEST_ASSERT_EQUAL_INT(end, cursor);
+
+    FeedEvent event = {};
+    event.feedCycle = 3;
+    TEST_ASSERT_TRUE(storage.addFeedEvent(event));
+    TEST_ASSERT_TRUE(storage.getFeedHistory(events, count, 10, &cursor, &generation));
+    TEST_ASSERT_EQUAL_INT(1, count);
+    TEST_ASSERT_EQUAL_INT(3, events[0].feedCycle);
+
+    // Cleared, then grown past the old cursor: its generation is gone, so it
+    // starts over from the oldest event instead of seeking into the new file
+    uint32_t oldGeneration = generation;
+    TEST_ASSERT_TRUE(storage.clearHistory());
+    TEST_ASSERT_TRUE(storage.getHistoryGeneration() != oldGeneration);
+    for (int i = 0; i < 8; i++) {
+        event.feedCycle = i;
+        strlcpy(event.alarmReason, "Refill detected during feeding", sizeof(event.alarmReason));
+        TEST_ASSERT_TRUE(storage.addFeedEvent(event));
+    }
+    TEST_ASSERT_TRUE(storage.getFeedHistory(events, count, 10, &cursor, &generation));
+    TEST_ASSERT_EQUAL_INT(8, count);
+    TEST_ASSERT_EQUAL_INT(0, events[0].feedCycle);
+    TEST_ASSERT_EQUAL_UINT32(storage.getHistoryGeneration(), generation);
+}
+
+// ---- ScheduleExpr ----
+
+void test_schedule_expr_parses_and_finds_next_fire() {
+    CompiledSchedule schedule;
+    const char* invalid[] = {"60 * * * *", "* * * *", "* * * * * *", "1,,2 * * * *",
+                             "1, * * * *", "*/0 * * * *", "5-3 * * * *", "a * * * *", "0 24 * * *"};
+    for (const char* expr : invalid) {
+        TEST_ASSERT_FALSE(ScheduleExpr::compile(expr, schedule));
+    }
+
+    // Empty is a disabled slot, not an error
+    time_t next = 0;
+    TEST_ASSERT_TRUE(ScheduleExpr::compile("", schedule));
+    TEST_ASSERT_FALSE(schedule.enabled);
+    TEST_ASSERT_FALSE(ScheduleExpr::nextFire(schedule, 1704067200, next));
+
+    // 2024-01-01 00:00 is a Monday
+    const time_t monday = 1704067200;
+    TEST_ASSERT_TRUE(ScheduleExpr::compile("*/15 8-10 * * 1-5", schedule));
+    struct tm t = {};
+    t.tm_hour = 9;
+    t.tm_min = 45;
+    t.tm_mday = 3;
+    t.tm_wday = 3;
+    TEST_ASSERT_TRUE(ScheduleExpr::matches(schedule, t));
+    t.tm_min = 50;
+    TEST_ASSERT_FALSE(ScheduleExpr::matches(schedule, t));
+
+    // Saturday noon skips the weekend; a part minute rounds up to the next step
+    TEST_ASSERT_TRUE(ScheduleExpr::nextFire(schedule, monday + 5 * 86400 + 12 * 3600, next));
+    TEST_ASSERT_EQUAL_INT(monday + 7 * 86400 + 8 * 3600, next);
+    TEST_ASSERT_TRUE(ScheduleExpr::nextFire(schedule, next + 30, next));
+    TEST_ASSERT_EQUAL_INT(monday + 7 * 86400 + 8 * 3600 + 15 * 60, next);
+
+    // Both day fields restricted: the 13th or a Friday
+    TEST_ASSERT_TRUE(ScheduleExpr::compile("0 12 13 * 5", schedule));
+    TEST_ASSERT_TRUE(ScheduleExpr::nextFire(schedule, monday, next));
+    TEST_ASSERT_EQUAL_INT(monday + 4 * 86400 + 12 * 3600, next);
+    TEST_ASSERT_TRUE(ScheduleExpr::nextFire(schedule, next + 1, next));
+    TEST_ASSERT_EQUAL_INT(monday + 11 * 86400 + 12 * 3600, next);
+    TEST_ASSERT_TRUE(ScheduleExpr::nextFire(schedule, next + 1, next));
+    TEST_ASSERT_EQUAL_INT(monday + 12 * 86400 + 12 * 3600, next);
+
+    // 7 is Sunday too
+    TEST_ASSERT_TRUE(ScheduleExpr::compile("0 0 * * 7", schedule));
+    TEST_ASSERT_TRUE(ScheduleExpr::nextFire(schedule, monday + 1, next));
+    TEST_ASSERT_EQUAL_INT(monday + 6 * 86400, next);
+
+    // Legacy minute slots; 1440 was the old unreachable default
+    char buffer[48];
+    ScheduleExpr::fromMinutes(390, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_STRING("30 6 * * *", buffer);
+    ScheduleExpr::fromMinutes(1440, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_STRING("", buffer);
+}
+
+// ---- FeedCurve ----
+
+void test_feed_curve_splits_daily_target_per_fire() {
+    Config config;
+    config.feedCurveEnabled = true;
+    config.flockStartDate = 1760788800;  // 2025-10-18 12:00 UTC, local noon at UTC+0
+    config.feedCurvePoints = 3;
+    config.feedCurve[0] = {0, 100.0};
+    config.feedCurve[1] = {10, 200.0};
+    config.feedCurve[2] = {20, 0.0};
+    for (int i = 0; i < 4; i++) config.slotShare[i] = 25;
+
+    FeedCurve curve;
+    curve.configure(config, 0);
+    uint32_t startDay = 1760788800 / 86400;
+
+    // Interpolated between points, clamped past the last
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 150.0, curve.dailyTargetForAge(5));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 100.0, curve.dailyTargetForAge(0));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, curve.dailyTargetForAge(30));
+
+    // Before placement the curve is off: the fixed target applies
+    const uint16_t daily[4] = {1, 1, 1, 1};
+    curve.rebuild(startDay - 1, daily);
+    TEST_ASSERT_FALSE(curve.isActive());
+    TEST_ASSERT_EQUAL_FLOAT(42.0, curve.getSlotTarget(0, 42.0));
+
+    // Shares normalized over the slots firing today; a twice-daily slot gets
+    // its share in two halves, a slot not firing today nothing
+    const uint16_t fires[4] = {2, 1, 0, 1};
+    curve.rebuild(startDay + 10, fires);
+    TEST_ASSERT_TRUE(curve.isActive());
+    TEST_ASSERT_EQUAL_INT(10, curve.getFlockAgeDays());
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 200.0 / 3 / 2, curve.getSlotTarget(0, 42.0));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 200.0 / 3, curve.getSlotTarget(1, 42.0));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, curve.getSlotTarget(2, 42.0));
+    float total = curve.getSlotTarget(0, 0) * 2 + curve.getSlotTarget(1, 0) + curve.getSlotTarget(3, 0);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 200.0, total);
+
+    // A share of 0 means nothing, not the fixed target
+    config.slotShare[1] = 0;
+    curve.configure(config, 0);
+    curve.rebuild(startDay + 10, fires);
+    TEST_ASSERT_EQUAL_FLOAT(0.0, curve.getSlotTarget(1, 42.0));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 100.0, curve.getSlotTarget(3, 42.0));
+
+    // So does a curve point of 0
+    curve.rebuild(startDay + 25, fires);
+    TEST_ASSERT_EQUAL_FLOAT(0.0, curve.getSlotTarget(3, 42.0));
+}
+
+void test_schedule_fires_counted_per_day() {
+    CompiledSchedule schedule;
+    struct tm saturday = {};
+    saturday.tm_mday = 18;
+    saturday.tm_mon = 9;
+    saturday.tm_wday = 6;
+    struct tm monday = saturday;
+    monday.tm_mday = 20;
+    monday.tm_wday = 1;
+
+    TEST_ASSERT_TRUE(ScheduleExpr::compile("0 6,18 * * *", schedule));
+    TEST_ASSERT_EQUAL_INT(2, ScheduleExpr::firesOnDay(schedule, saturday));
+    TEST_ASSERT_TRUE(ScheduleExpr::compile("0,30 6 * * 0,6", schedule));
+    TEST_ASSERT_EQUAL_INT(2, ScheduleExpr::firesOnDay(schedule, saturday));
+    TEST_ASSERT_EQUAL_INT(0, ScheduleExpr::firesOnDay(schedule, monday));
+    TEST_ASSERT_TRUE(ScheduleExpr::compile("0 7 */2 * *", schedule));
+    TEST_ASSERT_EQUAL_INT(0, ScheduleExpr::firesOnDay(schedule, saturday));
+    TEST_ASSERT_EQUAL_INT(0, ScheduleExpr::firesOnDay(schedule, monday));
+    monday.tm_mday = 19;
+    TEST_ASSERT_EQUAL_INT(1, ScheduleExpr::firesOnDay(schedule, monday));
+    TEST_ASSERT_TRUE(ScheduleExpr::compile("", schedule));
+    TEST_ASSERT_EQUAL_INT(0, ScheduleExpr::firesOnDay(schedule, saturday));
+}
+
+void test_scheduled_feed_not_repeated_after_reboot() {
+    TEST_ASSERT_TRUE(storage.begin());
+    const char schedules[4][48] = {"0 6 * * *", "", "", ""};
+    const unsigned long sixAm = 1704067200 + 6 * 3600;  // 2024-01-01 06:00 UTC
+
+    NativeShim::setWallClock(0);
+    Scheduler scheduler;
+    scheduler.begin(0, &storage);
+    scheduler.setSchedules(schedules);
+    TEST_ASSERT_TRUE(scheduler.setManualTime(sixAm + 5));
+    uint8_t cycle = 9;
+    TEST_ASSERT_TRUE(scheduler.shouldFeed(cycle));
+    TEST_ASSERT_EQUAL_INT(0, cycle);
+    TEST_ASSERT_FALSE(scheduler.shouldFeed(cycle));
+    storage.processQueue(0);
+
+    // Reboot in the same minute: the clock resumes from the feed start
+    NativeShim::setWallClock(0);
+    Scheduler rebooted;
+    rebooted.begin(0, &storage);
+    rebooted.setSchedules(schedules);
+    TEST_ASSERT_EQUAL_INT(sixAm + 5, rebooted.getCurrentTime());
+    TEST_ASSERT_FALSE(rebooted.shouldFeed(cycle));
+
+    // Clock restored from an older periodic save runs into 06:00 again
+    TEST_ASSERT_TRUE(storage.saveLastKnownTime(sixAm - 300));
+    NativeShim::setWallClock(0);
+    Scheduler behind;
+    behind.begin(0, &storage);
+    behind.setSchedules(schedules);
+    NativeShim::advanceMillis(300000);
+    TEST_ASSERT_FALSE(behind.shouldFeed(cycle));
+
+    // The next day's match fires as usual
+    NativeShim::advanceMillis(86400000UL);
+    TEST_ASSERT_TRUE(behind.shouldFeed(cycle));
+    NativeShim::setWallClock(0);
+}
+
+// ---- Time sources ----
+
+void test_http_date_parsing() {
+    unsigned long epoch = 0;
+    TEST_ASSERT_TRUE(Scheduler::parseHttpDate(" Sun, 06 Nov 1994 08:49:37 GMT", epoch));
+    TEST_ASSERT_EQUAL_UINT32(784111777, epoch);
+    TEST_ASSERT_TRUE(Scheduler::parseHttpDate("Thu, 29 Feb 2024 12:00:00 GMT", epoch));
+    TEST_ASSERT_EQUAL_UINT32(1709208000, epoch);
+    TEST_ASSERT_TRUE(Scheduler::parseHttpDate("Wed, 01 Mar 2000 00:00:00 GMT", epoch));
+    TEST_ASSERT_EQUAL_UINT32(951868800, epoch);
+
+    // Malformed: no weekday, unknown or partial month names, fields missing or out of range
+    const char* malformed[] = {
+        "06 Nov 1994 08:49:37 GMT",
+        "Sun, 06 Foo 1994 08:49:37 GMT",
+        "Sun, 06 nov 1994 08:49:37 GMT",
+        "Sun, 06 anF 1994 08:49:37 GMT",
+        "Sun, 06 No 1994 08:49:37 GMT",
+        "Sun, 06 Nov 1994 GMT",
+        "Sun, 06 Nov 1994 24:00:00 GMT",
+        "Sun, 06 Nov 1994 08:60:00 GMT",
+        "Sun, 00 Nov 1994 08:49:37 GMT",
+        "Thu, 01 Jan 1969 00:00:00 GMT",
+        "Sunday, 06-Nov-94 08:49:37 GMT",
+        "",
+    };
+    for (const char* value : malformed) {
+        TEST_ASSERT_FALSE(Scheduler::parseHttpDate(value, epoch));
+    }
+}
+
+// One-shot time servers on loopback: each answers a single request, or gives
+// up after a second if none comes
+static int openLoopback(int type, uint16_t& port) {
+    int fd = socket(AF_INET, type, 0);
+    timeval timeout = {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd, (sockaddr*)&addr, sizeof(addr));
+    if (type == SOCK_STREAM) listen(fd, 1);
+
+    socklen_t length = sizeof(addr);
+    getsockname(fd, (sockaddr*)&addr, &length);
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+
+static void answerNtp(int fd, unsigned long epoch) {
+    uint8_t packet[48];
+    sockaddr_in from = {};
+    socklen_t length = sizeof(from);
+    if (recvfrom(fd, packet, sizeof(packet), 0, (sockaddr*)&from, &length) == sizeof(packet)) {
+        memset(packet, 0, sizeof(packet));
+        packet[0] = 0x24;  // Version 4, server
+        uint32_t seconds = epoch + 2208988800UL;  // Transmit timestamp, NTP era
+        for (int i = 0; i < 4; i++) packet[40 + i] = seconds >> (24 - 8 * i);
+        sendto(fd, packet, sizeof(packet), 0, (sockaddr*)&from, length);
+    }
+    close(fd);
+}
+
+static void answerHttpDate(int fd, const char* date) {
+    int client = accept(fd, nullptr, nullptr);
+    if (client >= 0) {
+        char request[256];
+        recv(client, request, sizeof(request), 0);
+        char response[128];
+        snprintf(response, sizeof(response), "HTTP/1.0 200 OK\r\nServer: test\r\nDate: %s\r\n\r\n", date);
+        send(client, response, strlen(response), MSG_NOSIGNAL);
+        close(client);
+    }
+    close(fd);
+}
+
+void test_time_sources_tried_in_priority_order() {
+    const unsigned long houseLinkTime = 1720000000;  // 2024-07-03
+    inputRegisters[8] = houseLinkTime >> 16;
+    inputRegisters[9] = houseLinkTime & 0xFFFF;
+    std::thread responder = startResponder();
+    NativeShim::redirect(MODBUS_PORT, "127.0.0.1", responderPort);
+
+    Config config;
+    strlcpy(config.timeHttpServer, "192.168.1.2", sizeof(config.timeHttpServer));
+    config.houseLinkTimeAddr = MODBUS_BIN_A_ADDR + 8;
+    BinTrac houseLink;
+    houseLink.setConnection("192.168.1.100", MODBUS_PORT, 1);
+    Scheduler scheduler;
+    scheduler.setTimeSources(config, houseLink);
+
+    // All three answer: NTP wins
+    uint16_t port;
+    int ntpFd = openLoopback(SOCK_DGRAM, port);
+    std::thread ntp(answerNtp, ntpFd, 1704067200UL);  // 2024-01-01
+    NativeShim::redirect(123, "127.0.0.1", port);
+    int httpFd = openLoopback(SOCK_STREAM, port);
+    std::thread http(answerHttpDate, httpFd, "Thu, 29 Feb 2024 12:00:00 GMT");
+    NativeShim::redirect(80, "127.0.0.1", port);
+
+    TimeReading first = {};
+    bool firstOk = scheduler.syncTime(first, 1);
+    ntp.join();
+
+    // NTP silent: the HTTP Date header is next (the same server is still waiting)
+    NativeShim::redirect(123, "127.0.0.1", 1);
+    TimeReading second = {};
+    bool secondOk = scheduler.syncTime(second, 1);
+    http.join();
+
+    // HTTP refused too: the HouseLink clock
+    NativeShim::redirect(80, "127.0.0.1", 1);
+    TimeReading third = {};
+    bool thirdOk = scheduler.syncTime(third, 1);
+
+    // Nothing answers
+    NativeShim::redirect(MODBUS_PORT, "127.0.0.1", 1);
+    TimeReading none = {};
+    bool noneOk = scheduler.syncTime(none, 1);
+
+    stopResponder(responder);
+    NativeShim::clearRedirects();
+
+    TEST_ASSERT_TRUE(firstOk);
+    TEST_ASSERT_EQUAL_INT((int)TimeSource::NTP, (int)first.source);
+    TEST_ASSERT_EQUAL_UINT32(1704067200, first.epoch);
+    TEST_ASSERT_TRUE(secondOk);
+    TEST_ASSERT_EQUAL_INT((int)TimeSource::HTTP, (int)second.source);
+    TEST_ASSERT_EQUAL_UINT32(1709208000, second.epoch);
+    TEST_ASSERT_TRUE(thirdOk);
+    TEST_ASSERT_EQUAL_INT((int)TimeSource::HOUSELINK, (int)third.source);
+    TEST_ASSERT_EQUAL_UINT32(houseLinkTime, third.epoch);
+    TEST_ASSERT_FALSE(noneOk);
+    TEST_ASSERT_EQUAL_INT((int)TimeSource::NONE, (int)none.source);
+
+    // The control task applies a reading, allowing for its time in the queue
+    first.readAt = millis();
+    NativeShim::advanceMillis(2000);
+    scheduler.applyTime(first);
+    TEST_ASSERT_EQUAL_INT((int)TimeSource::NTP, (int)scheduler.getTimeSource());
+    TEST_ASSERT_EQUAL_UINT32(1704067202, scheduler.getCurrentTime());
+    NativeShim::setWallClock(0);
+}
+
+void test_restored_time_saved_only_once_confirmed() {
+    TEST_ASSERT_TRUE(storage.begin());
+    const unsigned long saved = 1704067200;
+    TEST_ASSERT_TRUE(storage.saveLastKnownTime(saved));
+
+    NativeShim::setWallClock(0);
+    Scheduler scheduler;
+    scheduler.begin(0, &storage);
+    TEST_ASSERT_EQUAL_INT((int)TimeSource::RESTORED, (int)scheduler.getTimeSource());
+
+    // Periodic saves skip a clock nothing has confirmed yet
+    NativeShim::advanceMillis(TIME_PERSIST_INTERVAL + 1000);
+    scheduler.update();
+    storage.processQueue(0);
+    TEST_ASSERT_EQUAL_UINT32(saved, storage.loadLastKnownTime());
+
+    // Once a source answers, the clock is saved right away and periodically
+    TimeReading reading = {1709208000, millis(), TimeSource::HTTP};
+    scheduler.applyTime(reading);
+    storage.processQueue(0);
+    TEST_ASSERT_EQUAL_UINT32(1709208000, storage.loadLastKnownTime());
+    NativeShim::advanceMillis(TIME_PERSIST_INTERVAL + 1000);
+    scheduler.update();
+    storage.processQueue(0);
+    TEST_ASSERT_EQUAL_UINT32(1709208000 + TIME_PERSIST_INTERVAL / 1000 + 1, storage.loadLastKnownTime());
+    NativeShim::setWallClock(0);
+}
+
+// ---- AugerControl ----
+
+void test_feed_drives_relays() {
+    AugerControl auger;
+    auger.begin();
+    TEST_ASSERT_EQUAL_INT(LOW, NativeShim::pinState(RELAY_1_PIN));
+
+    auger.startFeeding(20.0, 5, 600, 10.0, 30);
+    TEST_ASSERT_EQUAL_INT(HIGH, NativeShim::pinState(RELAY_2_PIN));  // Chain first
+    TEST_ASSERT_EQUAL_INT(LOW, NativeShim::pinState(RELAY_1_PIN));
+
+    float weight = 1000.0;
+    FeedingStage stage = FeedingStage::CHAIN_ONLY;
+    for (int second = 0; second < 120 && stage != FeedingStage::COMPLETED; second++) {
+        stage = auger.update(weight, millis());
+        if (second == 3) TEST_ASSERT_EQUAL_INT(LOW, NativeShim::pinState(RELAY_1_PIN));
+        if (second == 15) {
+            // Control loop passes between samples leave the estimate alone
+            float flow = auger.getFlowEstimate();
+            TEST_ASSERT_FLOAT_WITHIN(1.0, 60.0, flow);
+            auger.update(weight - 5.0, millis());
+            TEST_ASSERT_EQUAL_FLOAT(flow, auger.getFlowEstimate());
+        }
+        if (NativeShim::pinState(RELAY_1_PIN) == HIGH) weight -= 1.0;
+        NativeShim::advanceMillis(1000);
+    }
+
+    TEST_ASSERT_TRUE(stage == FeedingStage::COMPLETED);
+    TEST_ASSERT_TRUE(auger.getWeightDispensed() >= 20.0);
+    TEST_ASSERT_EQUAL_INT(LOW, NativeShim::pinState(RELAY_1_PIN));
+    TEST_ASSERT_EQUAL_INT(LOW, NativeShim::pinState(RELAY_2_PIN));
+}
+
+// ---- BinTrac ----
+
+void test_bintrac_reads_bins_over_modbus() {
+    inputRegisters[0] = 1500;                 // Bin A
+    inputRegisters[2] = 820;                  // Bin B
+    inputRegisters[4] = (uint16_t)-32767;     // Bin C disabled
+    inputRegisters[6] = 305;                  // Bin D
+    std::thread responder = startResponder();
+
+    // The firmware dials the HouseLink's address on port 502; the shim sends it here
+    NativeShim::redirect(MODBUS_PORT, "127.0.0.1", responderPort);
+
+    // Stop the responder before asserting (a failed assert doesn't return)
+    BinTrac bintrac;
+    bool connected = bintrac.begin("192.168.1.100", MODBUS_PORT, 1);
+    float weights[4];
+    bool ok = bintrac.readAllBins(weights);
+    uint32_t requests = responderRequests;
+    stopResponder(responder);
+    NativeShim::clearRedirects();
+
+    TEST_ASSERT_TRUE(connected);
+    TEST_ASSERT_TRUE(ok);
+    TEST_ASSERT_EQUAL_FLOAT(1500.0, weights[0]);
+    TEST_ASSERT_EQUAL_FLOAT(820.0, weights[1]);
+    TEST_ASSERT_EQUAL_FLOAT(0.0, weights[2]);
+    TEST_ASSERT_EQUAL_FLOAT(305.0, weights[3]);
+    TEST_ASSERT_TRUE(requests >= 3);  // Connect check, bins A-C, bin D
+}
+
+void test_bintrac_times_out_without_server() {
+    NativeShim::redirect(MODBUS_PORT, "127.0.0.1", 1);  // Nothing listens there
+
+    BinTrac bintrac;
+    bintrac.setConnection("192.168.1.100", MODBUS_PORT, 1);
+    float weights[4];
+    TEST_ASSERT_TRUE(!bintrac.readAllBins(weights));
+    TEST_ASSERT_TRUE(strstr(bintrac.getLastError(), "connection failed") != nullptr);
+    NativeShim::clearRedirects();
+}
+
+// ---- FeedWebServer ----
+
+static std::atomic<bool> clientDone(false);
+static char httpResponse[4096];
+
+static void fetch(const char* request) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(NativeShim::hostPort(WEB_SERVER_PORT));
+
+    size_t length = 0;
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0) {
+        send(fd, request, strlen(request), MSG_NOSIGNAL);
+        ssize_t n;
+        while (length < sizeof(httpResponse) - 1 &&
+               (n = recv(fd, httpResponse + length, sizeof(httpResponse) - 1 - length, 0)) > 0) {
+            length += n;
+        }
+    }
+    httpResponse[length] = '\0';
+    close(fd);
+    clientDone = true;
+}
+
+// Serve until the client thread has its response (bounded in real time)
+static void serveRequest(const char* request) {
+    clientDone = false;
+    std::thread client(fetch, request);
+    for (int i = 0; i < 5000 && !clientDone; i++) {
+        if (!webServer.handleClient()) delay(1);
+    }
+    client.join();
+}
+
+void test_web_server_serves_status() {
+    Config config;
+    configStore.begin(config);
+    SystemStatus status = {};
+    status.feedingStage = FeedingStage::STOPPED;
+    statusStore.publish(status);
+
+    TEST_ASSERT_TRUE(storage.begin());
+    webServer.begin();
+
+    serveRequest("GET /api/status HTTP/1.1\r\nHost: feeder\r\nConnection: close\r\n\r\n");
+    TEST_ASSERT_TRUE(strncmp(httpResponse, "HTTP/1.1 200", 12) == 0);
+    TEST_ASSERT_TRUE(strstr(httpResponse, "application/json") != nullptr);
+
+    serveRequest("GET /no/such/page HTTP/1.1\r\nHost: feeder\r\nConnection: close\r\n\r\n");
+    TEST_ASSERT_TRUE(strncmp(httpResponse, "HTTP/1.1 404", 12) == 0);
+}
+
+// ---- NetDns ----
+
+void test_dns_resolves_names_and_literals() {
+    IPAddress address;
+    TEST_ASSERT_TRUE(NetDns::resolve("10.1.2.3", address));
+    TEST_ASSERT_EQUAL_STRING("10.1.2.3", address.toString().c_str());
+
+    // The shim answers the query from the host's resolver
+    TEST_ASSERT_TRUE(NetDns::resolve("localhost.", address));
+    TEST_ASSERT_EQUAL_STRING("127.0.0.1", address.toString().c_str());
+
+    TEST_ASSERT_FALSE(NetDns::resolve("bad..name", address));
+    TEST_ASSERT_FALSE(NetDns::resolve("", address));
+}
+
+// ---- MqttTelemetry ----
+
+// Broker stand-in: accepts one client at a time, answers CONNECT, QoS 1
+// PUBLISH and PINGREQ, and records what it was sent
+struct BrokerMessage {
+    std::string topic;
+    std::string payload;
+    bool retain;
+};
+
+static std::mutex brokerLock;
+static std::vector<BrokerMessage> brokerMessages;
+static std::string brokerWillTopic;
+static uint8_t brokerConnectFlags = 0;
+static std::atomic<bool> brokerRunning(false);
+static int brokerFd = -1;
+static uint16_t brokerPort = 0;
+
+static std::string readMqttString(const uint8_t*& p) {
+    uint16_t length = p[0] << 8 | p[1];
+    std::string s((const char*)p + 2, length);
+    p += 2 + length;
+    return s;
+}
+
+static void serveMqttClient(int fd) {
+    uint8_t header;
+    while (brokerRunning) {
+        ssize_t n = recv(fd, &header, 1, 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) continue;  // Idle client, check brokerRunning
+        if (n <= 0) return;
+        uint32_t length = 0;
+        uint8_t b;
+        int shift = 0;
+        do {
+            if (!readFully(fd, &b, 1)) return;
+            length |= (uint32_t)(b & 0x7F) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        std::vector<uint8_t> body(length);
+        if (length > 0 && !readFully(fd, body.data(), length)) return;
+        const uint8_t* p = body.data();
+
+        switch (header & 0xF0) {
+            case 0x10: {  // CONNECT
+                p += 6;   // Protocol name
+                p += 1;   // Level
+                uint8_t flags = *p++;
+                p += 2;   // Keepalive
+                readMqttString(p);  // Client ID
+                std::lock_guard<std::mutex> guard(brokerLock);
+                brokerConnectFlags = flags;
+                if (flags & 0x04) brokerWillTopic = readMqttString(p);
+                const uint8_t connack[] = {0x20, 2, 0, 0};
+                send(fd, connack, sizeof(connack), MSG_NOSIGNAL);
+                break;
+            }
+            case 0x30: {  // PUBLISH
+                BrokerMessage message;
+                message.topic = readMqttString(p);
+                message.retain = header & 0x01;
+                uint8_t qos = (header >> 1) & 0x03;
+                if (qos > 0) {
+                    const uint8_t puback[] = {0x40, 2, p[0], p[1]};
+                    p += 2;
+                    send(fd, puback, sizeof(puback), MSG_NOSIGNAL);
+                }
+                message.payload.assign((const char*)p, body.data() + length - p);
+                std::lock_guard<std::mutex> guard(brokerLock);
+                brokerMessages.push_back(message);
+                break;
+            }
+            case 0xC0: {  // PINGREQ
+                const uint8_t pingresp[] = {0xD0, 0};
+                send(fd, pingresp, sizeof(pingresp), MSG_NOSIGNAL);
+                break;
+            }
+            case 0xE0:    // DISCONNECT
+                return;
+        }
+    }
+}
+
+static void serveMqtt() {
+    while (brokerRunning) {
+        int fd = accept(brokerFd, nullptr, nullptr);
+        if (fd < 0) continue;
+        timeval timeout = {0, 100000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        serveMqttClient(fd);
+        close(fd);
+    }
+}
+
+static std::thread startBroker() {
+    {
+        std::lock_guard<std::mutex> guard(brokerLock);
+        brokerMessages.clear();
+        brokerWillTopic.clear();
+        brokerConnectFlags = 0;
+    }
+    brokerFd = socket(AF_INET, SOCK_STREAM, 0);
+    int on = 1;
+    setsockopt(brokerFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    timeval timeout = {0, 100000};
+    setsockopt(brokerFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(brokerFd, (sockaddr*)&addr, sizeof(addr));
+    listen(brokerFd, 4);
+
+    socklen_t length = sizeof(addr);
+    getsockname(brokerFd, (sockaddr*)&addr, &length);
+    brokerPort = ntohs(addr.sin_port);
+
+    brokerRunning = true;
+    return std::thread(serveMqtt);
+}
+
+static void stopBroker(std::thread& thread) {
+    brokerRunning = false;
+    thread.join();
+    close(brokerFd);
+}
+
+static int countMessages(const char* topic, const char* contains) {
+    std::lock_guard<std::mutex> guard(brokerLock);
+    int count = 0;
+    for (const BrokerMessage& message : brokerMessages) {
+        if (message.topic == topic && message.payload.find(contains) != std::string::npos) count++;
+    }
+    return count;
+}
+
+// Run update() until the broker has a matching message (bounded in real time)
+static bool pumpUntil(MqttTelemetry& telemetry, const SystemStatus& status, const char* topic, const char* contains) {
+    for (int i = 0; i < 2000; i++) {
+        telemetry.update(status);
+        if (countMessages(topic, contains) > 0) return true;
+        usleep(1000);
+    }
+    return false;
+}
+
+// Run update() until every buffered message is acknowledged
+static void pumpUntilDrained(MqttTelemetry& telemetry, const SystemStatus& status) {
+    for (int i = 0; i < 2000 && telemetry.getBuffered() > 0; i++) {
+        telemetry.update(status);
+        usleep(1000);
+    }
+}
+
+static Config mqttConfig() {
+    Config config;
+    config.mqttEnabled = true;
+    strlcpy(config.mqttBroker, "192.168.1.50", sizeof(config.mqttBroker));  // Default port 1883
+    return config;
+}
+
+void test_mqtt_publishes_status_weights_and_events() {
+    std::thread broker = startBroker();
+    NativeShim::redirect(MQTT_DEFAULT_PORT, "127.0.0.1", brokerPort);
+
+    MqttTelemetry telemetry;
+    telemetry.configure(mqttConfig(), 0x1234ABCD);
+
+    SystemStatus status = {};
+    status.bintracConnected = true;
+    status.currentWeight[0] = 1500.0;
+    status.currentWeight[1] = 820.0;
+    status.lastBintracUpdate = 1;
+    bool gotStatus = pumpUntil(telemetry, status, "feeder/1234ABCD/status", "\"state\":0");
+
+    Notification notification = {};
+    notification.type = NotificationType::FEEDING_COMPLETE;
+    notification.targetWeight = 50.0;
+    notification.actualWeight = 49.5;
+    strlcpy(notification.text, "quote \" here", sizeof(notification.text));
+    telemetry.publishNotification(notification);
+    bool gotEvent = pumpUntil(telemetry, status, "feeder/1234ABCD/events", "\"type\":\"feed\"");
+
+    // A reading a second for a batch's worth of intervals (with real time
+    // in between for the broker's PINGRESP and PUBACKs)
+    for (int second = 0; second < MQTT_WEIGHT_INTERVAL / 1000 * MQTT_WEIGHT_BATCH; second++) {
+        status.lastBintracUpdate++;
+        NativeShim::advanceMillis(1000);
+        for (int i = 0; i < 5; i++) {
+            telemetry.update(status);
+            usleep(1000);
+        }
+    }
+    bool gotWeights = pumpUntil(telemetry, status, "feeder/1234ABCD/weights", "1500.0,820.0");
+
+    status.state = SystemState::ALARM;
+    strlcpy(status.lastError, "Low feed rate", sizeof(status.lastError));
+    bool gotAlarm = pumpUntil(telemetry, status, "feeder/1234ABCD/status", "Low feed rate");
+    pumpUntilDrained(telemetry, status);
+
+    stopBroker(broker);
+    NativeShim::clearRedirects();
+
+    TEST_ASSERT_EQUAL_STRING("feeder/1234ABCD/online", brokerWillTopic.c_str());
+    TEST_ASSERT_TRUE(brokerConnectFlags & 0x20);  // Will retained
+    TEST_ASSERT_EQUAL_INT(1, countMessages("feeder/1234ABCD/online", "online"));
+    TEST_ASSERT_TRUE(gotStatus);
+    TEST_ASSERT_TRUE(gotEvent);
+    TEST_ASSERT_EQUAL_INT(1, countMessages("feeder/1234ABCD/events", "quote \\\" here"));
+    TEST_ASSERT_TRUE(gotWeights);
+    TEST_ASSERT_TRUE(gotAlarm);
+    TEST_ASSERT_TRUE(brokerMessages.front().retain);
+    TEST_ASSERT_EQUAL_INT(0, telemetry.getBuffered());
+}
+
+void test_mqtt_buffers_until_broker_returns() {
+    NativeShim::redirect(MQTT_DEFAULT_PORT, "127.0.0.1", 1);  // Nothing listens there
+
+    MqttTelemetry telemetry;
+    telemetry.configure(mqttConfig(), 0x1234ABCD);
+    SystemStatus status = {};
+
+    Notification notification = {};
+    notification.type = NotificationType::ALARM;
+    strlcpy(notification.text, "Max runtime", sizeof(notification.text));
+    telemetry.publishNotification(notification);
+    telemetry.update(status);
+    TEST_ASSERT_TRUE(!telemetry.isConnected());
+    TEST_ASSERT_EQUAL_INT(1, telemetry.getBuffered());
+
+    // Broker back; the next attempt waits out the backoff
+    std::thread broker = startBroker();
+    NativeShim::redirect(MQTT_DEFAULT_PORT, "127.0.0.1", brokerPort);
+    telemetry.update(status);
+    bool waited = !telemetry.isConnected();
+    NativeShim::advanceMillis(MQTT_RECONNECT_MAX);
+    bool delivered = pumpUntil(telemetry, status, "feeder/1234ABCD/events", "Max runtime");
+    pumpUntilDrained(telemetry, status);
+
+    stopBroker(broker);
+    NativeShim::clearRedirects();
+
+    TEST_ASSERT_TRUE(waited);
+    TEST_ASSERT_TRUE(delivered);
+    TEST_ASSERT_EQUAL_INT(0, telemetry.getBuffered());
+}
+
+// ---- Gzip and InfluxPush ----
+
+static std::string gunzip(const uint8_t* data, size_t length) {
+    std::string out(65536, '\0');
+    z_stream stream = {};
+    inflateInit2(&stream, 16 + MAX_WBITS);  // gzip wrapper
+    stream.next_in = (Bytef*)data;
+    stream.avail_in = length;
+    stream.next_out = (Bytef*)&out[0];
+    stream.avail_out = out.size();
+    int result = inflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    inflateEnd(&stream);
+    return result == Z_STREAM_END ? out : std::string("<corrupt>");
+}
+
+void test_gzip_round_trip() {
+    static Gzip gzip;
+    static uint8_t out[4096];
+
+    std::string lines;
+    for (int i = 0; i < 30; i++) {
+        char line[96];
+        snprintf(line, sizeof(line), "feeder_weights,node=1234ABCD a=%.1f,b=820.0,c=0.0,d=0.0 %d\n", 1500.0 - i * 0.4,
+                 1700000000 + 5 * i);
+        lines += line;
+    }
+    size_t length = gzip.compress((const uint8_t*)lines.data(), lines.size(), out, sizeof(out));
+    TEST_ASSERT_TRUE(length > 0);
+    TEST_ASSERT_TRUE(length < lines.size() / 3);
+    TEST_ASSERT_TRUE(gunzip(out, length) == lines);
+
+    // Incompressible data that doesn't fit is refused rather than cut short
+    uint8_t noise[1024];
+    uint32_t seed = 1;
+    for (size_t i = 0; i < sizeof(noise); i++) {
+        seed = seed * 1103515245 + 12345;
+        noise[i] = seed >> 16;
+    }
+    TEST_ASSERT_EQUAL_INT(0, gzip.compress(noise, sizeof(noise), out, sizeof(noise)));
+    length = gzip.compress(noise, sizeof(noise), out, sizeof(out));
+    TEST_ASSERT_TRUE(gunzip(out, length) == std::string((const char*)noise, sizeof(noise)));
+}
+
+// Write endpoint stand-in: records each request's path, token and lines
+struct InfluxRequest {
+    std::string path;
+    std::string authorization;
+    bool gzipped;
+    std::string body;
+};
+
+static std::vector<InfluxRequest> influxRequests;
+static std::atomic<bool> influxRunning(false);
+static int influxFd = -1;
+static uint16_t influxPort = 0;
+
+static void serveInflux() {
+    while (influxRunning) {
+        int fd = accept(influxFd, nullptr, nullptr);
+        if (fd < 0) continue;
+        timeval timeout = {1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        std::string headers;
+        char c;
+        while (headers.find("\r\n\r\n") == std::string::npos && recv(fd, &c, 1, 0) == 1) headers += c;
+
+        InfluxRequest request;
+        size_t pathStart = headers.find(' ') + 1;
+        request.path = headers.substr(pathStart, headers.find(' ', pathStart) - pathStart);
+        size_t auth = headers.find("Authorization: ");
+        if (auth != std::string::npos) request.authorization = headers.substr(auth + 15, headers.find('\r', auth) - auth - 15);
+        request.gzipped = headers.find("Content-Encoding: gzip") != std::string::npos;
+        size_t length = strtoul(headers.c_str() + headers.find("Content-Length: ") + 16, nullptr, 10);
+
+        std::vector<uint8_t> body(length);
+        if (length > 0 && readFully(fd, body.data(), length)) {
+            request.body = request.gzipped ? gunzip(body.data(), length) : std::string(body.begin(), body.end());
+            influxRequests.push_back(request);
+            const char* reply = "HTTP/1.1 204 No Content\r\nConnection: close\r\n\r\n";
+            send(fd, reply, strlen(reply), MSG_NOSIGNAL);
+        }
+        close(fd);
+    }
+}
+
+static std::thread startInflux() {
+    influxRequests.clear();
+    influxFd = socket(AF_INET, SOCK_STREAM, 0);
+    int on = 1;
+    setsockopt(influxFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    timeval timeout = {0, 100000};
+    setsockopt(influxFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(influxFd, (sockaddr*)&addr, sizeof(addr));
+    listen(influxFd, 4);
+
+    socklen_t length = sizeof(addr);
+    getsockname(influxFd, (sockaddr*)&addr, &length);
+    influxPort = ntohs(addr.sin_port);
+
+    influxRunning = true;
+    return std::thread(serveInflux);
+}
+
+void test_influx_spools_until_server_returns() {
+    TEST_ASSERT_TRUE(storage.begin());
+    NativeShim::setWallClock(1700000000);
+    NativeShim::redirect(INFLUX_DEFAULT_PORT, "127.0.0.1", 1);  // Nothing listens there
+
+    Config config;
+    config.influxEnabled = true;
+    strlcpy(config.influxServer, "influx.farm.lan", sizeof(config.influxServer));  // Looked up by NetDns
+    strlcpy(config.influxToken, "secret", sizeof(config.influxToken));
+    static InfluxPush push(storage);
+    push.configure(config, 0x1234ABCD);
+
+    // A batch interval of readings while the server is unreachable goes to the spool
+    const int points = INFLUX_BATCH_INTERVAL / INFLUX_SAMPLE_INTERVAL + 1;
+    SystemStatus status = {};
+    status.bintracConnected = true;
+    status.currentWeight[0] = 1500.0;
+    for (int i = 0; i < points; i++) {
+        status.lastBintracUpdate++;
+        NativeShim::advanceMillis(INFLUX_SAMPLE_INTERVAL);
+        push.update(status);
+    }
+    TEST_ASSERT_EQUAL_INT(0, push.getPending());
+    TEST_ASSERT_TRUE(push.getSpooled() > 0);
+    TEST_ASSERT_EQUAL_INT(push.getSpooled(), storage.getSpoolSize());
+
+    Notification notification = {};
+    notification.type = NotificationType::ALARM;
+    strlcpy(notification.text, "Low \"feed\" rate", sizeof(notification.text));
+    push.addNotification(notification);
+
+    // Server back: once the backoff is over the due batch goes out, then the spool
+    std::thread server = startInflux();
+    NativeShim::redirect(INFLUX_DEFAULT_PORT, "127.0.0.1", influxPort);
+    NativeShim::advanceMillis(INFLUX_RETRY_MAX);
+    push.update(status);
+
+    influxRunning = false;
+    server.join();
+    close(influxFd);
+    NativeShim::clearRedirects();
+
+    TEST_ASSERT_EQUAL_INT(0, push.getSpooled());
+    TEST_ASSERT_EQUAL_INT(0, storage.getSpoolSize());
+    TEST_ASSERT_EQUAL_INT(0, push.getDropped());
+    TEST_ASSERT_EQUAL_INT(2, influxRequests.size());
+    TEST_ASSERT_EQUAL_STRING("/write?db=feeder&precision=s", influxRequests[0].path.c_str());
+    TEST_ASSERT_EQUAL_STRING("Token secret", influxRequests[0].authorization.c_str());
+    TEST_ASSERT_TRUE(influxRequests[0].gzipped);
+    TEST_ASSERT_TRUE(influxRequests[0].body.find("feeder_events,node=1234ABCD,type=alarm ") == 0);
+    TEST_ASSERT_TRUE(influxRequests[0].body.find("text=\"Low \\\"feed\\\" rate\"") != std::string::npos);
+    TEST_ASSERT_TRUE(influxRequests[1].gzipped);
+    TEST_ASSERT_EQUAL_INT(0, influxRequests[1].body.find("feeder_weights,node=1234ABCD a=1500.0,b=0.0,c=0.0,d=0.0 17000000"));
+    TEST_ASSERT_EQUAL_INT(points, std::count(influxRequests[1].body.begin(), influxRequests[1].body.end(), '\n'));
+}
+
+// ---- StartCoordinator ----
+// Controllers are separate host processes sharing the multicast group port,
+// like boards on one LAN (each process has its own socket budget and clock)
+
+// Pump until that many peers are heard, re-announcing every round (the
+// clock jumps a HELLO interval, so one joining late still hears everyone)
+static bool exchange(StartCoordinator* coordinators, int count, uint32_t minute, uint8_t peers) {
+    for (int round = 0; round < 200; round++) {
+        bool done = true;
+        for (int i = 0; i < count; i++) {
+            coordinators[i].update(minute);
+            if (coordinators[i].getPeerCount() < peers) done = false;
+        }
+        if (done) return true;
+        NativeShim::advanceMillis(COORD_HELLO_INTERVAL + 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return false;
+}
+
+// One controller in a child process: its start delay down the pipe (-1 = no peers)
+static void runCoordinatorInstance(uint32_t nodeId, uint32_t minute, int fd) {
+    StartCoordinator coordinator;
+    long delay = -1;
+    if (coordinator.begin(nodeId, 5) && exchange(&coordinator, 1, minute, 2)) {
+        delay = coordinator.claimStart(minute, 5);
+    }
+    // Keep announcing a while so the others hear us too
+    for (int round = 0; round < 40; round++) {
+        coordinator.update(minute);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    if (write(fd, &delay, sizeof(delay)) != sizeof(delay)) delay = -1;
+    _exit(0);
+}
+
+void test_start_coordinators_stagger_on_one_host() {
+    const uint32_t minute = 29346240;  // A shared feed time
+    const uint32_t nodeIds[3] = {300, 100, 200};
+    int fds[3][2];
+    pid_t pids[3];
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(0, pipe(fds[i]));
+        fflush(stdout);  // Not twice
+        pids[i] = fork();
+        TEST_ASSERT_TRUE(pids[i] >= 0);
+        if (pids[i] == 0) runCoordinatorInstance(nodeIds[i], minute, fds[i][1]);
+        close(fds[i][1]);
+    }
+
+    long delays[3];
+    for (int i = 0; i < 3; i++) {
+        if (read(fds[i][0], &delays[i], sizeof(delays[i])) != sizeof(delays[i])) delays[i] = -2;
+        close(fds[i][0]);
+        waitpid(pids[i], nullptr, 0);
+    }
+
+    // Slots in node ID order, one stagger apart; own loopback isn't a peer
+    TEST_ASSERT_EQUAL_INT(10000, delays[0]);
+    TEST_ASSERT_EQUAL_INT(0, delays[1]);
+    TEST_ASSERT_EQUAL_INT(5000, delays[2]);
+
+    // The same node ID twice: they notice and separate, then rank normally
+    StartCoordinator twins[2];
+    TEST_ASSERT_TRUE(twins[0].begin(500, 5));
+    TEST_ASSERT_TRUE(twins[1].begin(500, 5));
+    for (int round = 0; round < 200 && twins[0].getNodeId() == twins[1].getNodeId(); round++) {
+        twins[0].update(0);
+        twins[1].update(0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    TEST_ASSERT_TRUE(twins[0].getNodeId() != twins[1].getNodeId());
+    TEST_ASSERT_TRUE(exchange(twins, 2, minute, 1));
+
+    unsigned long twinDelays[2] = {twins[0].claimStart(minute, 5), twins[1].claimStart(minute, 5)};
+    TEST_ASSERT_EQUAL_UINT32(5000, twinDelays[0] + twinDelays[1]);
+    for (StartCoordinator& coordinator : twins) coordinator.end();
+}
+
+// ---- Logger ----
+
+static std::atomic<bool> loggersRunning(false);
+
+static void logBurst(int writer) {
+    for (int n = 0; n < 500; n++) {
+        LOG_INFO("test", "w%d %05d %05d", writer, n, n);
+    }
+}
+
+void test_log_records_intact_under_concurrent_writers() {
+    uint32_t firstSeq = Logger::nextSeq();
+    uint32_t droppedBefore = Logger::getDropped();
+
+    loggersRunning = true;
+    std::vector<std::thread> writers;
+    for (int i = 0; i < 4; i++) writers.emplace_back(logBurst, i);
+
+    // Read the ring while it's written, like /api/logs and the drain task
+    uint32_t read = 0;
+    uint32_t torn = 0;
+    std::thread reader([&read, &torn]() {
+        Logger::Entry entry;
+        do {
+            for (uint32_t seq = Logger::oldestSeq(); seq < Logger::nextSeq(); seq++) {
+                if (!Logger::readEntry(seq, entry)) continue;
+                int writer, a, b;
+                bool ok = entry.seq == seq && strcmp(entry.tag, "test") == 0 &&
+                          sscanf(entry.message, "w%d %d %d", &writer, &a, &b) == 3 && a == b;
+                if (!ok && strcmp(entry.tag, "test") == 0) torn++;
+                read++;
+            }
+        } while (loggersRunning);
+    });
+    for (std::thread& writer : writers) writer.join();
+    loggersRunning = false;
+    reader.join();
+
+    // Every record either landed in order or was counted as dropped
+    uint32_t logged = Logger::nextSeq() - firstSeq;
+    TEST_ASSERT_EQUAL_UINT32(2000, logged + (Logger::getDropped() - droppedBefore));
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_TRUE(read > 0);
+
+    Logger::Entry last;
+    TEST_ASSERT_TRUE(Logger::readEntry(Logger::nextSeq() - 1, last));
+    TEST_ASSERT_EQUAL_STRING("test", last.tag);
+}
+
+// ---- Control commands ----
+
+// Control task stand-in: sends the late reply to the command it held back,
+// then a moment later answers the command that is waiting now
+static void answerAfterLateReply(ControlMessage held) {
+    ControlMessage msg;
+    if (xQueueReceive(controlQueue, &msg, portMAX_DELAY) != pdTRUE) return;
+    sendCommandReply(held.replyTo, held.sequence, CommandResult::BUSY);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    sendCommandReply(msg.replyTo, msg.sequence, CommandResult::OK);
+}
+
+void test_late_command_reply_is_discarded() {
+    if (controlQueue == nullptr) createTaskQueues();
+    NativeShim::setTimeScale(1.0);  // Real-time waits, so the stand-in gets to answer
+
+    // Nobody answers the first command in time
+    ControlMessage first = {};
+    first.type = ControlMessageType::STOP_FEED;
+    TEST_ASSERT_EQUAL_INT((int)CommandResult::TIMEOUT, (int)sendControlCommand(first, 50));
+    ControlMessage held;
+    TEST_ASSERT_TRUE(xQueueReceive(controlQueue, &held, 0) == pdTRUE);
+
+    // Its reply arrives while the next command waits; only the matching one counts
+    std::thread control(answerAfterLateReply, held);
+    ControlMessage second = {};
+    second.type = ControlMessageType::STOP_FEED;
+    CommandResult result = sendControlCommand(second, 2000);
+    control.join();
+    NativeShim::setTimeScale(0);
+
+    TEST_ASSERT_TRUE(second.sequence != first.sequence);
+    TEST_ASSERT_EQUAL_INT((int)CommandResult::OK, (int)result);
+}
+
+int main(int argc, char** argv) {
+    NetLock::begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_start_coordinators_stagger_on_one_host);  // First: it forks, before any test threads
+    RUN_TEST(test_config_survives_restart);
+    RUN_TEST(test_history_round_trip);
+    RUN_TEST(test_schedule_expr_parses_and_finds_next_fire);
+    RUN_TEST(test_feed_curve_splits_daily_target_per_fire);
+    RUN_TEST(test_schedule_fires_counted_per_day);
+    RUN_TEST(test_scheduled_feed_not_repeated_after_reboot);
+    RUN_TEST(test_http_date_parsing);
+    RUN_TEST(test_time_sources_tried_in_priority_order);
+    RUN_TEST(test_restored_time_saved_only_once_confirmed);
+    RUN_TEST(test_feed_drives_relays);
+    RUN_TEST(test_bintrac_reads_bins_over_modbus);
+    RUN_TEST(test_bintrac_times_out_without_server);
+    RUN_TEST(test_web_server_serves_status);
+    RUN_TEST(test_late_command_reply_is_discarded);
+    RUN_TEST(test_log_records_intact_under_concurrent_writers);
+    RUN_TEST(test_dns_resolves_names_and_literals);
+    RUN_TEST(test_mqtt_publishes_status_weights_and_events);
+    RUN_TEST(test_mqtt_buffers_until_broker_returns);
+    RUN_TEST(test_gzip_round_trip);
+    RUN_TEST(test_influx_spools_until_server_returns);
+    int failures = UNITY_END();
+
+    NativeShim::clearDataDir();
+    return failures;
+}
@@ -0,0 +1,272 @@
+// Host soak test: simulated months of feeding must not allocate
+// Runs the control task's long-running path (schedule, feed curve, auger
+// state machine, status/config stores, logger, JSON arena) day after day on
+// the native environment and counts every heap allocation made per feed
+// cycle. After the first (warm-up) day the count has to stay at zero, which
+// is what keeps the heap from fragmenting on a unit that runs for months.
+//
+//   pio test -e native -f test_soak
+
+#include <Arduino.h>
+#include <unity.h>
+#include <new>
+#include <atomic>
+#include "config.h"
+#include "types.h"
+#include "auger_control.h"
+#include "feed_curve.h"
+#include "schedule_expr.h"
+#include "shared_state.h"
+#include "logger.h"
+#include "json_arena.h"
+
+#define SOAK_DAYS 120
+
+// ---- Allocation counting ----
+// Every path into the heap (new, malloc and friends) goes through here while
+// counting is on; glibc's own entry points do the real work.
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+}
+
+static std::atomic<bool> counting(false);
+static std::atomic<uint32_t> allocations(0);
+
+static inline void countAllocation() {
+    if (counting.load(std::memory_order_relaxed)) allocations++;
+}
+
+extern "C" void* malloc(size_t size) {
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    countAllocation();
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void* ptr) {
+    __libc_free(ptr);
+}
+
+void* operator new(size_t size) {
+    countAllocation();
+    void* ptr = __libc_malloc(size ? size : 1);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* ptr) noexcept { __libc_free(ptr); }
+void operator delete[](void* ptr) noexcept { __libc_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { __libc_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { __libc_free(ptr); }
+
+// ---- Simulated feeder ----
+// Everything the control task keeps lives here, built once like the
+// firmware's globals.
+
+static Config config;
+static ConfigStore configStore;
+static StatusStore statusStore;
+static AugerControl augerControl;
+static FeedCurve feedCurve;
+static CompiledSchedule schedules[4];
+static SystemStatus systemStatus;
+alignas(8) static uint8_t arenaBuffer[WEB_JSON_ARENA_SIZE];
+static JsonArena arena(arenaBuffer, sizeof(arenaBuffer));
+
+static float binWeight;
+static time_t clockSeconds;  // Local time driving the schedule
+static uint32_t logCursor;
+
+static void initFeeder() {
+    strlcpy(config.feedSchedules[3], "0 21 * * *", sizeof(config.feedSchedules[3]));  // Four feeds a day
+    config.feedCurveEnabled = true;
+    config.flockStartDate = 0;
+    config.feedCurvePoints = 3;
+    config.feedCurve[0] = {0, 40.0};
+    config.feedCurve[1] = {60, 160.0};
+    config.feedCurve[2] = {400, 200.0};
+    config.chainPreRunTime = 10;
+    config.maxRuntime = 900;
+
+    configStore.begin(config);
+    augerControl.begin();
+    feedCurve.configure(config, 0);  // Clock runs in local time
+
+    for (int i = 0; i < 4; i++) {
+        ScheduleExpr::compile(config.feedSchedules[i], schedules[i]);
+    }
+
+    binWeight = 4000.0;
+    clockSeconds = 0;
+    logCursor = Logger::nextSeq();
+}
+
+// What the web task does per request, minus the socket
+static void serveStatusRequest() {
+    SystemStatus status;
+    statusStore.read(status);
+
+    arena.reset();
+    void* doc = arena.allocate(256);
+    void* strings = arena.allocate(64);
+    strings = arena.reallocate(strings, 160);  // Newest block grows in place
+    arena.deallocate(strings);
+    arena.deallocate(doc);
+    TEST_ASSERT_NOT_NULL(doc);
+
+    // /api/logs: copy out whatever was logged since the last poll
+    Logger::Entry entry;
+    while (logCursor < Logger::nextSeq()) {
+        if (Logger::readEntry(logCursor, entry)) {
+            TEST_ASSERT_EQUAL_UINT32(logCursor, entry.seq);
+        }
+        logCursor++;
+    }
+}
+
+static void publishStatus() {
+    systemStatus.augerRunning = augerControl.isAugerRunning();
+    systemStatus.chainRunning = augerControl.isChainRunning();
+    systemStatus.feedingStage = augerControl.getStage();
+    systemStatus.weightDispensed = augerControl.getWeightDispensed();
+    systemStatus.flowRate = augerControl.getFlowRate();
+    systemStatus.feedEtaSeconds = augerControl.getEtaSeconds();
+    systemStatus.flockAgeDays = feedCurve.getFlockAgeDays();
+    systemStatus.dailyTarget = feedCurve.getDailyTarget();
+    statusStore.publish(systemStatus);
+}
+
+// One scheduled feed, from waiting for the slot to the finished event
+// Returns the stage the feed ended in
+static FeedingStage runFeedCycle(uint32_t day, uint8_t slot, bool binFill) {
+    // Refresh the config copy like the control task does on a generation change
+    configStore.get(config);
+
+    time_t next;
+    TEST_ASSERT_TRUE(ScheduleExpr::nextFire(schedules[slot], clockSeconds, next));
+    NativeShim::advanceMillis((next - clockSeconds) * 1000UL);
+    clockSeconds = next;
+
+    float target = feedCurve.getSlotTarget(slot, config.targetWeight);
+    augerControl.startFeeding(target, config.chainPreRunTime, config.maxRuntime,
+                              config.fillDetectionThreshold, config.fillSettlingTime);
+
+    FeedingStage stage = augerControl.getStage();
+    for (uint32_t second = 0; second < 2UL * config.maxRuntime; second++) {
+        // Auger moves ~1 lb/s; a bin fill lands just after the auger starts
+        if (augerControl.isAugerRunning()) binWeight -= 1.0;
+        if (binFill && second == 15) binWeight += 500.0;
+
+        stage = augerControl.update(binWeight, millis());
+        const char* warning = augerControl.getNewWarning();
+        (void)warning;
+        publishStatus();
+        if (second % 5 == 0) serveStatusRequest();
+
+        NativeShim::advanceMillis(1000);
+        clockSeconds++;
+
+        if (stage == FeedingStage::COMPLETED || stage == FeedingStage::FAILED) break;
+    }
+
+    FeedEvent event;
+    event.timestamp = clockSeconds;
+    event.feedCycle = slot;
+    event.targetWeight = augerControl.getTargetWeight();
+    event.actualWeight = augerControl.getWeightDispensed();
+    event.duration = augerControl.getDuration();
+    event.alarmTriggered = augerControl.isAlarmTriggered();
+    strlcpy(event.alarmReason, augerControl.getAlarmReason(), sizeof(event.alarmReason));
+    LOG_INFO("soak", "Day %lu slot %d: %.1f of %.1f lbs", (unsigned long)day, slot,
+             event.actualWeight, event.targetWeight);
+
+    augerControl.stopAll();
+    if (binWeight < 1000.0) binWeight += 3000.0;  // Feed delivery
+    return stage;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_feed_cycles_do_not_allocate() {
+    initFeeder();
+
+    uint32_t warmup = 0;
+    uint32_t steady = 0;
+    uint32_t worstCycle = 0;
+    uint32_t cycles = 0;
+    uint32_t completed = 0;
+    const uint16_t slotFires[4] = {1, 1, 1, 1};  // Four daily slots
+
+    for (uint32_t day = 0; day < SOAK_DAYS; day++) {
+        for (uint8_t slot = 0; slot < 4; slot++) {
+            allocations = 0;
+            counting = true;
+
+            if (slot == 0) feedCurve.rebuild(day, slotFires);
+            FeedingStage stage = runFeedCycle(day, slot, day % 7 == 3 && slot == 1);
+
+            counting = false;
+
+            if (day == 0) {
+                warmup += allocations;
+            } else {
+                steady += allocations;
+                if (allocations > worstCycle) worstCycle = allocations;
+            }
+            cycles++;
+            if (stage == FeedingStage::COMPLETED) completed++;
+        }
+    }
+
+    printf("soak: %lu days, %lu feed cycles (%lu completed), %lu warm-up allocations, "
+           "%lu after warm-up (worst cycle %lu)\n",
+           (unsigned long)SOAK_DAYS, (unsigned long)cycles, (unsigned long)completed,
+           (unsigned long)warmup, (unsigned long)steady, (unsigned long)worstCycle);
+    printf("soak: JSON arena peak %lu of %lu bytes\n",
+           (unsigned long)arena.getPeak(), (unsigned long)arena.getSize());
+
+    TEST_ASSERT_EQUAL_UINT32(cycles, completed);
+    TEST_ASSERT_EQUAL_UINT32(0, steady);
+}
+
+void test_arena_reuses_buffer() {
+    arena.reset();
+    counting = true;
+    allocations = 0;
+
+    for (int request = 0; request < 10000; request++) {
+        arena.reset();
+        void* a = arena.allocate(512);
+        void* b = arena.allocate(1024);
+        TEST_ASSERT_NOT_NULL(a);
+        TEST_ASSERT_NOT_NULL(b);
+        b = arena.reallocate(b, 2048);
+        TEST_ASSERT_NOT_NULL(b);
+        TEST_ASSERT_NULL(arena.allocate(WEB_JSON_ARENA_SIZE));  // Doesn't fit: fails, no fallback
+    }
+
+    counting = false;
+    TEST_ASSERT_EQUAL_UINT32(0, allocations);
+    TEST_ASSERT_TRUE(arena.getPeak() <= arena.getSize());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_feed_cycles_do_not_allocate);
+    RUN_TEST(test_arena_reuses_buffer);
+    return UNITY_END();
+}
@@ -9,324 +9,912 @@ Protocol:
 - Registers: 1000-1001 (Bin A), 1002-1003 (Bin B), 1004-1005 (Bin C), 1006-1007 (Bin D)
 - Each bin: 2 registers, weight stored as signed 16-bit in first register
 - Value -32767 = bin disabled
+
+Modes:
+- GUI (default): sliders and buttons, weights set by hand
+- Headless (--headless): bins follow feed physics from a scenario file.
+  Feed drains from the bins while the auger relay is on; relay states come
+  in on the control port (TCP lines or UDP datagrams, see CONTROL COMMANDS).
+  Fill events, read noise, dropped/slow responses, exception codes and
+  offline periods are scheduled in simulated time.
+- Benchmark (--bench): hammer a running simulator and report requests/s
+
+Examples:
+  python3 test_bintrac_simulator.py
+  python3 test_bintrac_simulator.py --headless --scenario test/scenarios/daily_feed.json \\
+      --port 5020 --control-port 5021
+  python3 test_bintrac_simulator.py --bench --port 5020 --connections 8 --seconds 5
+
+CONTROL COMMANDS (one per line; TCP replies with one JSON line):
+  relay auger|chain on|off     Relay state (also: pin <gpio> <0|1>, mapped by
+                               the scenario's "relays", as the native
+                               firmware build sends them)
+  set <bin> <weight>           Set a bin's weight (bin A-D or 0-3)
+  fill <bin> <amount> [secs]   Add feed, spread over secs of simulated time
+  enable|disable <bin>         Bin reads as -32767 while disabled
+  flow <lb/s>                  Auger flow rate (0 = jammed)
+  fault <kind> [args...]       drop <p> | slow <ms> [p] | exception <code> [p] |
+                               offline | clear
+  speed <factor>               Simulated seconds per real second (0 = stepped)
+  advance <secs>               Move simulated time (any speed)
+  status                       Time, bins, relays, faults and request counters
+  quit                         Stop the simulator
 """
 
-import tkinter as tk
-from tkinter import ttk, scrolledtext
-import threading
+import argparse
+import asyncio
+import datetime
+import json
+import random
 import socket
 import struct
-import datetime
+import sys
+import threading
+import time
 
 # Modbus TCP constants
 MODBUS_PORT = 502
 REGISTER_BASE = 1000  # Starting address for Bin A
+DISABLED = -32767
+BIN_NAMES = "ABCD"
 
+# Modbus exception codes
+ILLEGAL_FUNCTION = 1
+ILLEGAL_DATA_ADDRESS = 2
+SERVER_DEVICE_FAILURE = 4
 
-class ModbusTCPServer:
-    """Simple Modbus TCP server for Function Code 4 (Read Input Registers)"""
+# Relay GPIOs as wired in config.h (RELAY_1_PIN auger, RELAY_2..5_PIN chains)
+DEFAULT_RELAYS = {"auger": [33], "chain": [32, 25, 26, 27]}
 
-    def __init__(self, port, get_weights_callback):
-        self.port = port
-        self.get_weights = get_weights_callback
-        self.running = False
-        self.server_socket = None
-        self.thread = None
 
-    def start(self):
-        """Start the Modbus TCP server"""
-        self.running = True
-        self.thread = threading.Thread(target=self._run_server, daemon=True)
-        self.thread.start()
+class ModbusError(Exception):
+    """Exception response to send instead of data"""
 
-    def stop(self):
-        """Stop the Modbus TCP server"""
-        self.running = False
-        if self.server_socket:
-            self.server_socket.close()
+    def __init__(self, code):
+        super().__init__(f"Modbus exception {code}")
+        self.code = code
 
-    def _run_server(self):
-        """Server main loop"""
-        try:
-            self.server_socket = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
-            self.server_socket.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
-            self.server_socket.bind(('0.0.0.0', self.port))
-            self.server_socket.listen(5)
-            self.server_socket.settimeout(1.0)
-            print(f"Modbus TCP server listening on port {self.port}")
-
-            while self.running:
-                try:
-                    client_socket, address = self.server_socket.accept()
-                    threading.Thread(target=self._handle_client, args=(client_socket, address), daemon=True).start()
-                except socket.timeout:
-                    continue
-                except Exception as e:
-                    if self.running:
-                        print(f"Server error: {e}")
-                    break
-        except Exception as e:
-            print(f"Failed to start server: {e}")
 
-    def _handle_client(self, client_socket, address):
-        """Handle a client connection"""
-        try:
-            client_socket.settimeout(5.0)
+class StaticModel:
+    """Register source for the GUI: weights exactly as set by hand"""
 
-            # Read Modbus TCP request (12 bytes)
-            request = client_socket.recv(12)
-            if len(request) < 12:
-                return
+    def __init__(self, get_weights_callback, log=print):
+        self.get_weights = get_weights_callback
+        self.log = log
+        self.requests = 0
+
+    def read_registers(self, peer, unit_id, function_code, start_address, register_count):
+        timestamp = datetime.datetime.now().strftime("%H:%M:%S")
+        self.log(f"[{timestamp}] {peer} - FC{function_code} addr={start_address} count={register_count}")
+        self.requests += 1
+        if function_code != 4:
+            raise ModbusError(ILLEGAL_FUNCTION)
+        return registers_for(self.get_weights(), start_address, register_count)
+
+    def fault(self):
+        return None
+
+
+def registers_for(weights, start_address, register_count):
+    """Register values for a read: weight in the first register of each bin pair"""
+    values = []
+    for i in range(register_count):
+        register_address = start_address + i
+        bin_index = (register_address - REGISTER_BASE) // 2
+        register_offset = (register_address - REGISTER_BASE) % 2
+
+        if 0 <= bin_index < 4 and register_offset == 0:
+            # Clamp to signed 16-bit range
+            values.append(max(DISABLED, min(32767, int(round(weights[bin_index])))))
+        else:
+            # Second register of pair or out of range - send 0
+            values.append(0)
+    return values
+
+
+class FeedModel:
+    """Bins, relays and faults in simulated time
+
+    Simulated time runs at `speed` simulated seconds per real second (0 =
+    only `advance` moves it). The state is integrated lazily whenever
+    something reads or changes it, so idle time costs nothing.
+    """
+
+    def __init__(self, scenario, speed=None, seed=None):
+        self.scenario = scenario
+        self.random = random.Random(seed if seed is not None else scenario.get("seed"))
+        self.lock = threading.Lock()
+
+        bins = scenario.get("bins", [{}, {}, {}, {}])
+        self.weights = [0.0] * 4
+        self.capacity = [20000.0] * 4
+        self.enabled = [False] * 4
+        for i, spec in enumerate(bins[:4]):
+            self.weights[i] = float(spec.get("weight", 0))
+            self.capacity[i] = float(spec.get("capacity", 20000))
+            self.enabled[i] = bool(spec.get("enabled", True))
+
+        self.flow_rate = float(scenario.get("flow_rate", 1.0))     # lb/s while the auger runs
+        self.draw = scenario.get("draw", "first")                  # first | even
+        self.noise = float(scenario.get("noise", 0.0))             # Std dev of each reading, lb
+        self.latency_ms = float(scenario.get("latency_ms", 0))     # Added to every response
+
+        relays = scenario.get("relays", DEFAULT_RELAYS)
+        self.pin_roles = {}
+        for role in ("auger", "chain"):
+            pins = relays.get(role, [])
+            for pin in pins if isinstance(pins, list) else [pins]:
+                self.pin_roles[int(pin)] = role
+        self.pins = {}  # GPIO -> on
+        self.relays = {"auger": False, "chain": False}
+
+        # Faults: each is a dict with "until" (simulated seconds, None = until cleared)
+        self.faults = {}
+
+        # Pending scenario events and fills in progress
+        self.events = sorted(scenario.get("events", []), key=lambda e: float(e.get("at", 0)))
+        self.fills = []  # [bin, remaining amount, rate per second]
+
+        self.sim_time = float(scenario.get("start", 0))
+        self.speed = float(speed if speed is not None else scenario.get("speed", 1.0))
+        self.real_base = time.monotonic()
+        self.sim_base = self.sim_time
+        self.end = scenario.get("end")
+
+        self.stats = {"requests": 0, "dropped": 0, "slowed": 0, "exceptions": 0, "refused": 0,
+                      "dispensed": 0.0, "filled": 0.0, "auger_seconds": 0.0}
+
+    # ---- Time ----
+
+    def _now(self):
+        if self.speed == 0:
+            return self.sim_time
+        return self.sim_base + (time.monotonic() - self.real_base) * self.speed
+
+    def _rebase(self):
+        self.real_base = time.monotonic()
+        self.sim_base = self.sim_time
+
+    def set_speed(self, speed):
+        with self.lock:
+            self._advance_to(self._now())
+            self.speed = max(0.0, float(speed))
+            self._rebase()
+
+    def advance(self, seconds):
+        with self.lock:
+            self._advance_to(self._now() + float(seconds))
+            self.sim_base = self.sim_time
+            self.real_base = time.monotonic()
+
+    def finished(self):
+        with self.lock:
+            return self.end is not None and self._now() >= float(self.end)
+
+    # ---- Physics ----
+
+    def _advance_to(self, target):
+        """Integrate from sim_time to target, stopping at each scheduled event"""
+        while self.sim_time < target:
+            step_end = target
+            if self.events and float(self.events[0].get("at", 0)) <= target:
+                step_end = max(self.sim_time, float(self.events[0]["at"]))
+            self._integrate(step_end - self.sim_time)
+            self.sim_time = step_end
+
+            while self.events and float(self.events[0].get("at", 0)) <= self.sim_time:
+                self._apply_event(self.events.pop(0))
+        while self.events and float(self.events[0].get("at", 0)) <= self.sim_time:
+            self._apply_event(self.events.pop(0))
+
+    def _integrate(self, dt):
+        if dt <= 0:
+            return
 
-            # Parse request
-            transaction_id = struct.unpack('>H', request[0:2])[0]
-            protocol_id = struct.unpack('>H', request[2:4])[0]
-            length = struct.unpack('>H', request[4:6])[0]
-            unit_id = request[6]
-            function_code = request[7]
-            start_address = struct.unpack('>H', request[8:10])[0]
-            register_count = struct.unpack('>H', request[10:12])[0]
-
-            # Log request
-            timestamp = datetime.datetime.now().strftime("%H:%M:%S")
-            log_msg = f"[{timestamp}] {address[0]} - FC{function_code} addr={start_address} count={register_count}"
-            print(log_msg)
-
-            # Only support Function Code 4 (Read Input Registers)
+        if self.relays["auger"]:
+            self.stats["auger_seconds"] += dt
+            wanted = self.flow_rate * dt
+            drawn = self._draw(wanted)
+            self.stats["dispensed"] += drawn
+
+        for fill in self.fills:
+            amount = min(fill[1], fill[2] * dt)
+            fill[1] -= amount
+            index = fill[0]
+            added = min(amount, max(0.0, self.capacity[index] - self.weights[index]))
+            self.weights[index] += added
+            self.stats["filled"] += added
+        self.fills = [f for f in self.fills if f[1] > 1e-9]
+
+        for kind in [k for k, f in self.faults.items() if f["until"] is not None and f["until"] <= self.sim_time + dt]:
+            del self.faults[kind]
+
+    def _draw(self, wanted):
+        """Take feed out of the enabled bins; returns what was actually there"""
+        sources = [i for i in range(4) if self.enabled[i] and self.weights[i] > 0]
+        if not sources:
+            return 0.0
+        drawn = 0.0
+        if self.draw == "even":
+            share = wanted / len(sources)
+            for i in sources:
+                take = min(share, self.weights[i])
+                self.weights[i] -= take
+                drawn += take
+        else:
+            for i in sources:
+                take = min(wanted - drawn, self.weights[i])
+                self.weights[i] -= take
+                drawn += take
+                if drawn >= wanted:
+                    break
+        return drawn
+
+    def _apply_event(self, event):
+        at = float(event.get("at", 0))
+        if "fill" in event:
+            self._start_fill(bin_index(event["fill"]), float(event.get("amount", 0)),
+                             float(event.get("duration", 0)))
+        if "set" in event:
+            self.weights[bin_index(event["set"])] = float(event.get("weight", 0))
+        if "enable" in event:
+            self.enabled[bin_index(event["enable"])] = True
+        if "disable" in event:
+            self.enabled[bin_index(event["disable"])] = False
+        if "fault" in event:
+            duration = event.get("duration")
+            self._set_fault(event["fault"], event, None if duration is None else at + float(duration))
+        if "relay" in event:
+            self._set_relay(event["relay"], bool(event.get("on", True)))
+        if "flow_rate" in event:
+            self.flow_rate = float(event["flow_rate"])
+
+    def _start_fill(self, index, amount, duration):
+        if duration <= 0:
+            added = min(amount, max(0.0, self.capacity[index] - self.weights[index]))
+            self.weights[index] += added
+            self.stats["filled"] += added
+        else:
+            self.fills.append([index, amount, amount / duration])
+
+    def _set_fault(self, kind, args, until):
+        if kind == "clear":
+            self.faults.clear()
+            return
+        self.faults[kind] = {
+            "until": until,
+            "probability": float(args.get("probability", 1.0)),
+            "delay_ms": float(args.get("delay_ms", 0)),
+            "code": int(args.get("code", SERVER_DEVICE_FAILURE)),
+        }
+
+    def _set_relay(self, role, on):
+        self.relays[role] = on
+
+    # ---- Control ----
+
+    def set_pin(self, pin, on):
+        with self.lock:
+            self._advance_to(self._now())
+            self.pins[pin] = on
+            role = self.pin_roles.get(pin)
+            if role is not None:
+                self.relays[role] = any(v for p, v in self.pins.items() if self.pin_roles.get(p) == role)
+
+    def set_relay(self, role, on):
+        with self.lock:
+            self._advance_to(self._now())
+            self._set_relay(role, on)
+
+    def set_weight(self, index, weight):
+        with self.lock:
+            self._advance_to(self._now())
+            self.weights[index] = float(weight)
+
+    def fill(self, index, amount, duration):
+        with self.lock:
+            self._advance_to(self._now())
+            self._start_fill(index, amount, duration)
+
+    def set_enabled(self, index, enabled):
+        with self.lock:
+            self.enabled[index] = enabled
+
+    def set_flow_rate(self, flow_rate):
+        with self.lock:
+            self._advance_to(self._now())
+            self.flow_rate = max(0.0, float(flow_rate))
+
+    def set_fault(self, kind, args):
+        with self.lock:
+            self._advance_to(self._now())
+            duration = args.get("duration")
+            self._set_fault(kind, args, None if duration is None else self.sim_time + float(duration))
+
+    def status(self):
+        with self.lock:
+            self._advance_to(self._now())
+            return {
+                "time": round(self.sim_time, 3),
+                "speed": self.speed,
+                "bins": [round(w, 2) if e else DISABLED for w, e in zip(self.weights, self.enabled)],
+                "relays": dict(self.relays),
+                "faults": sorted(self.faults),
+                "stats": {k: round(v, 2) if isinstance(v, float) else v for k, v in self.stats.items()},
+            }
+
+    # ---- Modbus ----
+
+    def fault(self):
+        """What to do with the next request: None, ("drop",), ("refuse",), ("slow", s), ("exception", code)"""
+        with self.lock:
+            self._advance_to(self._now())
+            if "offline" in self.faults:
+                self.stats["refused"] += 1
+                return ("refuse",)
+            drop = self.faults.get("drop")
+            if drop and self.random.random() < drop["probability"]:
+                self.stats["dropped"] += 1
+                return ("drop",)
+            exception = self.faults.get("exception")
+            if exception and self.random.random() < exception["probability"]:
+                self.stats["exceptions"] += 1
+                return ("exception", exception["code"])
+            delay = self.latency_ms
+            slow = self.faults.get("slow")
+            if slow and self.random.random() < slow["probability"]:
+                self.stats["slowed"] += 1
+                delay += slow["delay_ms"]
+            return ("slow", delay / 1000.0) if delay > 0 else None
+
+    def read_registers(self, peer, unit_id, function_code, start_address, register_count):
+        with self.lock:
+            self._advance_to(self._now())
+            self.stats["requests"] += 1
             if function_code != 4:
-                response = self._build_error_response(transaction_id, unit_id, function_code, 1)
-                client_socket.send(response)
-                return
+                raise ModbusError(ILLEGAL_FUNCTION)
+            if start_address < REGISTER_BASE or start_address + register_count > REGISTER_BASE + 8:
+                raise ModbusError(ILLEGAL_DATA_ADDRESS)
+            weights = []
+            for w, e in zip(self.weights, self.enabled):
+                if not e:
+                    weights.append(DISABLED)
+                elif self.noise > 0:
+                    weights.append(max(0.0, w + self.random.gauss(0, self.noise)))
+                else:
+                    weights.append(w)
+        return registers_for(weights, start_address, register_count)
 
-            # Get current weights from GUI
-            weights = self.get_weights()
 
-            # Build response data (2 registers per bin, weight in first register)
-            response_data = bytearray()
-            for i in range(register_count):
-                register_address = start_address + i
-                bin_index = (register_address - REGISTER_BASE) // 2
-                register_offset = (register_address - REGISTER_BASE) % 2
+def bin_index(name):
+    """Bin by letter (A-D) or index (0-3)"""
+    name = str(name).strip().upper()
+    if name in BIN_NAMES and len(name) == 1:
+        return BIN_NAMES.index(name)
+    index = int(name)
+    if not 0 <= index < 4:
+        raise ValueError(f"No bin {name}")
+    return index
 
-                if bin_index < 4 and register_offset == 0:
-                    # First register of bin pair - contains weight
-                    weight = weights[bin_index]
-                    response_data.extend(struct.pack('>h', weight))  # Signed 16-bit
-                else:
-                    # Second register of pair or out of range - send 0
-                    response_data.extend(struct.pack('>H', 0))
 
-            # Build Modbus TCP response
-            byte_count = len(response_data)
-            response = struct.pack('>HHHBB',
-                                 transaction_id,
-                                 protocol_id,
-                                 byte_count + 3,  # Unit ID + Function Code + Byte Count
-                                 unit_id,
-                                 function_code) + bytes([byte_count]) + response_data
+class ModbusTCPServer:
+    """Modbus TCP server for Function Code 4 (Read Input Registers)
 
-            client_socket.send(response)
+    One event loop serves every connection, and a connection may carry any
+    number of requests (the firmware opens one per read; load generators
+    keep them open), so it keeps up with thousands of requests per second.
+    """
 
+    def __init__(self, port, model, host="0.0.0.0"):
+        self.host = host
+        self.port = port
+        self.model = model
+        self.loop = None
+        self.server = None
+        self.thread = None
+
+    # Blocking start in a background thread (GUI)
+    def start(self):
+        ready = threading.Event()
+        errors = []
+
+        def run():
+            self.loop = asyncio.new_event_loop()
+            asyncio.set_event_loop(self.loop)
+            try:
+                self.loop.run_until_complete(self.listen())
+            except Exception as e:
+                errors.append(e)
+                ready.set()
+                return
+            ready.set()
+            self.loop.run_forever()
+
+        self.thread = threading.Thread(target=run, daemon=True)
+        self.thread.start()
+        ready.wait()
+        if errors:
+            raise errors[0]
+
+    def stop(self):
+        if self.loop is not None and self.server is not None:
+            self.loop.call_soon_threadsafe(self.server.close)
+            self.loop.call_soon_threadsafe(self.loop.stop)
+
+    async def listen(self):
+        self.server = await asyncio.start_server(self._handle_client, self.host, self.port,
+                                                 reuse_address=True, backlog=128)
+        print(f"Modbus TCP server listening on port {self.port}")
+
+    async def _handle_client(self, reader, writer):
+        """Serve requests on a connection until the client closes it"""
+        peer = writer.get_extra_info("peername")
+        peer = peer[0] if peer else "?"
+        sock = writer.get_extra_info("socket")
+        if sock is not None:
+            sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+
+        try:
+            while True:
+                # MBAP header, then the PDU (its length includes the unit ID)
+                header = await reader.readexactly(7)
+                transaction_id, protocol_id, length, unit_id = struct.unpack('>HHHB', header)
+                if length < 2 or length > 256:
+                    break
+                pdu = await reader.readexactly(length - 1)
+                function_code = pdu[0]
+
+                fault = self.model.fault()
+                if fault is not None:
+                    if fault[0] in ("drop", "refuse"):
+                        break
+                    if fault[0] == "exception":
+                        writer.write(self._build_error_response(transaction_id, unit_id, function_code, fault[1]))
+                        await writer.drain()
+                        continue
+                    if fault[0] == "slow":
+                        await asyncio.sleep(fault[1])
+
+                if len(pdu) < 5:
+                    writer.write(self._build_error_response(transaction_id, unit_id, function_code,
+                                                            ILLEGAL_FUNCTION))
+                    await writer.drain()
+                    continue
+
+                start_address, register_count = struct.unpack('>HH', pdu[1:5])
+                try:
+                    values = self.model.read_registers(peer, unit_id, function_code, start_address, register_count)
+                except ModbusError as e:
+                    writer.write(self._build_error_response(transaction_id, unit_id, function_code, e.code))
+                    await writer.drain()
+                    continue
+
+                # Build Modbus TCP response
+                response_data = struct.pack(f'>{len(values)}h', *[v if v < 32768 else v - 65536 for v in values])
+                byte_count = len(response_data)
+                writer.write(struct.pack('>HHHBBB',
+                                         transaction_id,
+                                         protocol_id,
+                                         byte_count + 3,  # Unit ID + Function Code + Byte Count
+                                         unit_id,
+                                         function_code,
+                                         byte_count) + response_data)
+                await writer.drain()
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
         except Exception as e:
             print(f"Client handler error: {e}")
         finally:
-            client_socket.close()
+            writer.close()
 
     def _build_error_response(self, transaction_id, unit_id, function_code, exception_code):
         """Build Modbus error response"""
         return struct.pack('>HHHBBB',
-                         transaction_id,
-                         0,  # Protocol ID
-                         3,  # Length
-                         unit_id,
-                         function_code | 0x80,  # Error flag
-                         exception_code)
-
+                           transaction_id,
+                           0,  # Protocol ID
+                           3,  # Length
+                           unit_id,
+                           function_code | 0x80,  # Error flag
+                           exception_code)
 
-class BinTracSimulator:
-    """GUI application for BinTrac simulator"""
 
-    def __init__(self, root):
-        self.root = root
-        self.root.title("BinTrac HouseLink Simulator")
-        self.root.geometry("800x700")
+class ControlServer:
+    """Control channel: command lines over TCP (one JSON reply each) or UDP (no reply)"""
 
-        # Bin weights (use signed 16-bit range)
-        self.weights = [0, 0, 0, 0]
-        self.enabled = [True, True, True, True]
-
-        # Create GUI
-        self._create_gui()
+    def __init__(self, port, model, stop_event, host="0.0.0.0"):
+        self.host = host
+        self.port = port
+        self.model = model
+        self.stop_event = stop_event
 
-        # Start Modbus server
-        self.server = ModbusTCPServer(MODBUS_PORT, self._get_weights)
-        try:
-            self.server.start()
-            self.status_label.config(text="Server Status: Running on port 502", foreground="green")
-        except Exception as e:
-            self.status_label.config(text=f"Server Status: Failed - {e}", foreground="red")
-
-    def _create_gui(self):
-        """Create the GUI elements"""
-        # Title
-        title = tk.Label(self.root, text="BinTrac HouseLink Simulator", font=("Arial", 16, "bold"))
-        title.pack(pady=10)
-
-        # Connection info
-        info_frame = tk.Frame(self.root)
-        info_frame.pack(pady=5)
-
-        tk.Label(info_frame, text="Configure ESP32 to connect to:", font=("Arial", 10)).pack()
-        ip_label = tk.Label(info_frame, text=self._get_local_ip(), font=("Arial", 12, "bold"), foreground="blue")
-        ip_label.pack()
-        tk.Label(info_frame, text="Port: 502", font=("Arial", 10)).pack()
-
-        self.status_label = tk.Label(self.root, text="Server Status: Starting...", foreground="orange")
-        self.status_label.pack(pady=5)
-
-        # Bins frame
-        bins_frame = tk.Frame(self.root)
-        bins_frame.pack(pady=10, padx=20, fill=tk.BOTH, expand=True)
-
-        bin_labels = ['Bin A', 'Bin B', 'Bin C', 'Bin D']
-
-        for i, label in enumerate(bin_labels):
-            self._create_bin_control(bins_frame, i, label)
-
-        # Total weight display
-        total_frame = tk.Frame(self.root, relief=tk.RIDGE, borderwidth=2)
-        total_frame.pack(pady=10, padx=20, fill=tk.X)
-
-        tk.Label(total_frame, text="Total Weight:", font=("Arial", 12, "bold")).pack(side=tk.LEFT, padx=10)
-        self.total_label = tk.Label(total_frame, text="0 lbs", font=("Arial", 14, "bold"), foreground="blue")
-        self.total_label.pack(side=tk.LEFT, padx=10)
-
-        # Log area
-        log_frame = tk.LabelFrame(self.root, text="Modbus Request Log", font=("Arial", 10, "bold"))
-        log_frame.pack(pady=10, padx=20, fill=tk.BOTH, expand=True)
-
-        self.log_text = scrolledtext.ScrolledText(log_frame, height=8, state='disabled')
-        self.log_text.pack(fill=tk.BOTH, expand=True)
-
-        # Redirect print to log window
-        import sys
-        sys.stdout = TextRedirector(self.log_text)
-
-    def _create_bin_control(self, parent, index, label):
-        """Create controls for a single bin"""
-        frame = tk.LabelFrame(parent, text=label, font=("Arial", 10, "bold"))
-        frame.pack(side=tk.LEFT, padx=10, pady=5, fill=tk.BOTH, expand=True)
-
-        # Enable/Disable checkbox
-        enabled_var = tk.BooleanVar(value=True)
-        enabled_check = tk.Checkbutton(frame, text="Enabled", variable=enabled_var,
-                                      command=lambda: self._toggle_bin(index, enabled_var.get()))
-        enabled_check.pack(pady=5)
-
-        # Weight display
-        weight_display = tk.Label(frame, text="0 lbs", font=("Arial", 16, "bold"), foreground="green")
-        weight_display.pack(pady=5)
-
-        # Entry field
-        entry_frame = tk.Frame(frame)
-        entry_frame.pack(pady=5)
-        tk.Label(entry_frame, text="Set:").pack(side=tk.LEFT)
-        entry = tk.Entry(entry_frame, width=8)
-        entry.pack(side=tk.LEFT, padx=5)
-        entry.insert(0, "0")
-        set_btn = tk.Button(entry_frame, text="Set",
-                           command=lambda: self._set_weight(index, entry, weight_display))
-        set_btn.pack(side=tk.LEFT)
-
-        # +/- 10 buttons
-        large_frame = tk.Frame(frame)
-        large_frame.pack(pady=5)
-        tk.Button(large_frame, text="-10", width=5,
-                 command=lambda: self._adjust_weight(index, -10, weight_display)).pack(side=tk.LEFT, padx=2)
-        tk.Button(large_frame, text="+10", width=5,
-                 command=lambda: self._adjust_weight(index, 10, weight_display)).pack(side=tk.LEFT, padx=2)
-
-        # +/- 1 buttons
-        small_frame = tk.Frame(frame)
-        small_frame.pack(pady=5)
-        tk.Button(small_frame, text="-1", width=5,
-                 command=lambda: self._adjust_weight(index, -1, weight_display)).pack(side=tk.LEFT, padx=2)
-        tk.Button(small_frame, text="+1", width=5,
-                 command=lambda: self._adjust_weight(index, 1, weight_display)).pack(side=tk.LEFT, padx=2)
-
-    def _toggle_bin(self, index, enabled):
-        """Toggle bin enabled/disabled"""
-        self.enabled[index] = enabled
-        if not enabled:
-            self.weights[index] = -32767  # Disabled marker
-        else:
-            self.weights[index] = 0
-        self._update_total()
+    async def listen(self):
+        await asyncio.start_server(self._handle_client, self.host, self.port, reuse_address=True)
+        loop = asyncio.get_running_loop()
+        await loop.create_datagram_endpoint(lambda: _ControlDatagrams(self), local_addr=(self.host, self.port),
+                                            reuse_port=True)
+        print(f"Control channel on port {self.port} (TCP and UDP)")
 
-    def _set_weight(self, index, entry, display):
-        """Set weight from entry field"""
+    async def _handle_client(self, reader, writer):
         try:
-            value = int(entry.get())
-            # Clamp to signed 16-bit range
-            value = max(-32767, min(32767, value))
-            self.weights[index] = value
-            display.config(text=f"{value} lbs")
-            self._update_total()
-        except ValueError:
+            while True:
+                line = await reader.readline()
+                if not line:
+                    break
+                reply = self.execute(line.decode(errors="replace"))
+                writer.write((json.dumps(reply) + "\n").encode())
+                await writer.drain()
+        except ConnectionError:
             pass
+        finally:
+            writer.close()
 
-    def _adjust_weight(self, index, delta, display):
-        """Adjust weight by delta"""
-        if not self.enabled[index]:
-            return
-        new_value = self.weights[index] + delta
-        # Clamp to signed 16-bit range
-        new_value = max(-32767, min(32767, new_value))
-        self.weights[index] = new_value
-        display.config(text=f"{new_value} lbs")
-        self._update_total()
-
-    def _update_total(self):
-        """Update total weight display"""
-        total = sum(w for w, e in zip(self.weights, self.enabled) if e and w != -32767)
-        self.total_label.config(text=f"{total} lbs")
-
-    def _get_weights(self):
-        """Get current weights for Modbus server (callback)"""
-        return self.weights.copy()
-
-    def _get_local_ip(self):
-        """Get local IP address"""
+    def execute(self, line):
+        words = line.split()
+        if not words:
+            return {"ok": True}
+        command, args = words[0].lower(), words[1:]
+        try:
+            if command == "relay":
+                self.model.set_relay(args[0].lower(), args[1].lower() in ("on", "1", "true"))
+            elif command == "pin":
+                self.model.set_pin(int(args[0]), args[1] in ("1", "on", "high"))
+            elif command == "set":
+                self.model.set_weight(bin_index(args[0]), float(args[1]))
+            elif command == "fill":
+                self.model.fill(bin_index(args[0]), float(args[1]), float(args[2]) if len(args) > 2 else 0)
+            elif command == "flow":
+                self.model.set_flow_rate(float(args[0]))
+            elif command in ("enable", "disable"):
+                self.model.set_enabled(bin_index(args[0]), command == "enable")
+            elif command == "fault":
+                self.model.set_fault(args[0].lower(), fault_args(args[0].lower(), args[1:]))
+            elif command == "speed":
+                self.model.set_speed(float(args[0]))
+            elif command == "advance":
+                self.model.advance(float(args[0]))
+            elif command == "status":
+                pass
+            elif command == "quit":
+                self.stop_event.set()
+            else:
+                return {"ok": False, "error": f"Unknown command: {command}"}
+        except (IndexError, ValueError, KeyError) as e:
+            return {"ok": False, "error": f"Bad arguments for {command}: {e}"}
+        reply = self.model.status()
+        reply["ok"] = True
+        return reply
+
+
+class _ControlDatagrams(asyncio.DatagramProtocol):
+    def __init__(self, control):
+        self.control = control
+
+    def datagram_received(self, data, addr):
+        for line in data.decode(errors="replace").splitlines():
+            self.control.execute(line)
+
+
+def fault_args(kind, args):
+    """Positional control arguments to the scenario's fault fields"""
+    if kind == "drop":
+        return {"probability": float(args[0]) if args else 1.0}
+    if kind == "slow":
+        return {"delay_ms": float(args[0]), "probability": float(args[1]) if len(args) > 1 else 1.0}
+    if kind == "exception":
+        return {"code": int(args[0]) if args else SERVER_DEVICE_FAILURE,
+                "probability": float(args[1]) if len(args) > 1 else 1.0}
+    return {}
+
+
+async def run_headless(args, model):
+    stop_event = asyncio.Event()
+    server = ModbusTCPServer(args.port, model, args.host)
+    await server.listen()
+    if args.control_port:
+        await ControlServer(args.control_port, model, stop_event, args.host).listen()
+
+    last_report = time.monotonic()
+    last_requests = 0
+    while not stop_event.is_set():
         try:
-            s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
-            s.connect(("8.8.8.8", 80))
-            ip = s.getsockname()[0]
-            s.close()
-            return ip
-        except:
-            return "127.0.0.1"
+            await asyncio.wait_for(stop_event.wait(), timeout=0.25)
+        except asyncio.TimeoutError:
+            pass
 
+        if model.finished():
+            print("Scenario finished")
+            break
+
+        now = time.monotonic()
+        if args.report and now - last_report >= args.report:
+            status = model.status()
+            requests = status["stats"]["requests"]
+            rate = (requests - last_requests) / (now - last_report)
+            print(f"t={status['time']:.0f}s bins={status['bins']} relays={status['relays']} "
+                  f"faults={status['faults']} {rate:.0f} req/s")
+            last_report, last_requests = now, requests
+
+    print(json.dumps(model.status()))
+
+
+def run_benchmark(args):
+    """Closed-loop load: each connection sends a read and waits for the reply"""
+    request_template = struct.pack('>HHBBHH', 0, 6, 1, 4, REGISTER_BASE, 6)
+    counts = [0] * args.connections
+    errors = [0] * args.connections
+    deadline = time.monotonic() + args.seconds
+
+    def worker(index):
+        sock = None
+        transaction = 0
+        while time.monotonic() < deadline:
+            try:
+                if sock is None:
+                    sock = socket.create_connection((args.host_target, args.port), timeout=5)
+                    sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+                transaction = (transaction + 1) & 0xFFFF
+                sock.sendall(struct.pack('>H', transaction) + request_template)
+                response = b""
+                while len(response) < 9 or len(response) < 6 + struct.unpack('>H', response[4:6])[0]:
+                    chunk = sock.recv(256)
+                    if not chunk:
+                        raise ConnectionError("closed")
+                    response += chunk
+                counts[index] += 1
+                if args.reconnect:
+                    sock.close()
+                    sock = None
+            except (OSError, ConnectionError):
+                errors[index] += 1
+                if sock is not None:
+                    sock.close()
+                sock = None
+        if sock is not None:
+            sock.close()
+
+    threads = [threading.Thread(target=worker, args=(i,)) for i in range(args.connections)]
+    start = time.monotonic()
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    elapsed = time.monotonic() - start
+
+    total = sum(counts)
+    print(json.dumps({"requests": total, "errors": sum(errors), "seconds": round(elapsed, 2),
+                      "requests_per_second": round(total / elapsed), "connections": args.connections,
+                      "reconnect": args.reconnect}))
+
+
+def load_scenario(path):
+    if path is None:
+        return {"bins": [{"weight": 4000}, {"weight": 4000}, {"enabled": False}, {"enabled": False}]}
+    with open(path) as f:
+        return json.load(f)
+
+
+# ---- GUI ----
+
+def run_gui(port):
+    import tkinter as tk
+    from tkinter import scrolledtext
+
+    class TextRedirector:
+        """Redirect stdout to tkinter Text widget"""
+
+        def __init__(self, text_widget):
+            self.text_widget = text_widget
+
+        def write(self, string):
+            # Called from the server thread too; hand over to the Tk thread
+            self.text_widget.after(0, self._append, string)
+
+        def _append(self, string):
+            self.text_widget.config(state='normal')
+            self.text_widget.insert(tk.END, string)
+            self.text_widget.see(tk.END)
+            self.text_widget.config(state='disabled')
+
+        def flush(self):
+            pass
 
-class TextRedirector:
-    """Redirect stdout to tkinter Text widget"""
+    class BinTracSimulator:
+        """GUI application for BinTrac simulator"""
+
+        def __init__(self, root):
+            self.root = root
+            self.root.title("BinTrac HouseLink Simulator")
+            self.root.geometry("800x700")
+
+            # Bin weights (use signed 16-bit range)
+            self.weights = [0, 0, 0, 0]
+            self.enabled = [True, True, True, True]
+
+            # Create GUI
+            self._create_gui()
+
+            # Start Modbus server
+            self.server = ModbusTCPServer(port, StaticModel(self._get_weights))
+            try:
+                self.server.start()
+                self.status_label.config(text=f"Server Status: Running on port {port}", foreground="green")
+            except Exception as e:
+                self.status_label.config(text=f"Server Status: Failed - {e}", foreground="red")
+
+        def _create_gui(self):
+            """Create the GUI elements"""
+            # Title
+            title = tk.Label(self.root, text="BinTrac HouseLink Simulator", font=("Arial", 16, "bold"))
+            title.pack(pady=10)
+
+            # Connection info
+            info_frame = tk.Frame(self.root)
+            info_frame.pack(pady=5)
+
+            tk.Label(info_frame, text="Configure ESP32 to connect to:", font=("Arial", 10)).pack()
+            ip_label = tk.Label(info_frame, text=self._get_local_ip(), font=("Arial", 12, "bold"), foreground="blue")
+            ip_label.pack()
+            tk.Label(info_frame, text=f"Port: {port}", font=("Arial", 10)).pack()
+
+            self.status_label = tk.Label(self.root, text="Server Status: Starting...", foreground="orange")
+            self.status_label.pack(pady=5)
+
+            # Bins frame
+            bins_frame = tk.Frame(self.root)
+            bins_frame.pack(pady=10, padx=20, fill=tk.BOTH, expand=True)
+
+            bin_labels = ['Bin A', 'Bin B', 'Bin C', 'Bin D']
+
+            for i, label in enumerate(bin_labels):
+                self._create_bin_control(bins_frame, i, label)
+
+            # Total weight display
+            total_frame = tk.Frame(self.root, relief=tk.RIDGE, borderwidth=2)
+            total_frame.pack(pady=10, padx=20, fill=tk.X)
+
+            tk.Label(total_frame, text="Total Weight:", font=("Arial", 12, "bold")).pack(side=tk.LEFT, padx=10)
+            self.total_label = tk.Label(total_frame, text="0 lbs", font=("Arial", 14, "bold"), foreground="blue")
+            self.total_label.pack(side=tk.LEFT, padx=10)
+
+            # Log area
+            log_frame = tk.LabelFrame(self.root, text="Modbus Request Log", font=("Arial", 10, "bold"))
+            log_frame.pack(pady=10, padx=20, fill=tk.BOTH, expand=True)
+
+            self.log_text = scrolledtext.ScrolledText(log_frame, height=8, state='disabled')
+            self.log_text.pack(fill=tk.BOTH, expand=True)
+
+            # Redirect print to log window
+            sys.stdout = TextRedirector(self.log_text)
+
+        def _create_bin_control(self, parent, index, label):
+            """Create controls for a single bin"""
+            frame = tk.LabelFrame(parent, text=label, font=("Arial", 10, "bold"))
+            frame.pack(side=tk.LEFT, padx=10, pady=5, fill=tk.BOTH, expand=True)
+
+            # Enable/Disable checkbox
+            enabled_var = tk.BooleanVar(value=True)
+            enabled_check = tk.Checkbutton(frame, text="Enabled", variable=enabled_var,
+                                           command=lambda: self._toggle_bin(index, enabled_var.get()))
+            enabled_check.pack(pady=5)
+
+            # Weight display
+            weight_display = tk.Label(frame, text="0 lbs", font=("Arial", 16, "bold"), foreground="green")
+            weight_display.pack(pady=5)
+
+            # Entry field
+            entry_frame = tk.Frame(frame)
+            entry_frame.pack(pady=5)
+            tk.Label(entry_frame, text="Set:").pack(side=tk.LEFT)
+            entry = tk.Entry(entry_frame, width=8)
+            entry.pack(side=tk.LEFT, padx=5)
+            entry.insert(0, "0")
+            set_btn = tk.Button(entry_frame, text="Set",
+                                command=lambda: self._set_weight(index, entry, weight_display))
+            set_btn.pack(side=tk.LEFT)
+
+            # +/- 10 buttons
+            large_frame = tk.Frame(frame)
+            large_frame.pack(pady=5)
+            tk.Button(large_frame, text="-10", width=5,
+                      command=lambda: self._adjust_weight(index, -10, weight_display)).pack(side=tk.LEFT, padx=2)
+            tk.Button(large_frame, text="+10", width=5,
+                      command=lambda: self._adjust_weight(index, 10, weight_display)).pack(side=tk.LEFT, padx=2)
+
+            # +/- 1 buttons
+            small_frame = tk.Frame(frame)
+            small_frame.pack(pady=5)
+            tk.Button(small_frame, text="-1", width=5,
+                      command=lambda: self._adjust_weight(index, -1, weight_display)).pack(side=tk.LEFT, padx=2)
+            tk.Button(small_frame, text="+1", width=5,
+                      command=lambda: self._adjust_weight(index, 1, weight_display)).pack(side=tk.LEFT, padx=2)
+
+        def _toggle_bin(self, index, enabled):
+            """Toggle bin enabled/disabled"""
+            self.enabled[index] = enabled
+            if not enabled:
+                self.weights[index] = DISABLED  # Disabled marker
+            else:
+                self.weights[index] = 0
+            self._update_total()
 
-    def __init__(self, text_widget):
-        self.text_widget = text_widget
+        def _set_weight(self, index, entry, display):
+            """Set weight from entry field"""
+            try:
+                value = int(entry.get())
+                # Clamp to signed 16-bit range
+                value = max(DISABLED, min(32767, value))
+                self.weights[index] = value
+                display.config(text=f"{value} lbs")
+                self._update_total()
+            except ValueError:
+                pass
+
+        def _adjust_weight(self, index, delta, display):
+            """Adjust weight by delta"""
+            if not self.enabled[index]:
+                return
+            new_value = self.weights[index] + delta
+            # Clamp to signed 16-bit range
+            new_value = max(DISABLED, min(32767, new_value))
+            self.weights[index] = new_value
+            display.config(text=f"{new_value} lbs")
+            self._update_total()
 
-    def write(self, string):
-        self.text_widget.config(state='normal')
-        self.text_widget.insert(tk.END, string)
-        self.text_widget.see(tk.END)
-        self.text_widget.config(state='disabled')
+        def _update_total(self):
+            """Update total weight display"""
+            total = sum(w for w, e in zip(self.weights, self.enabled) if e and w != DISABLED)
+            self.total_label.config(text=f"{total} lbs")
+
+        def _get_weights(self):
+            """Get current weights for Modbus server (callback)"""
+            return self.weights.copy()
+
+        def _get_local_ip(self):
+            """Get local IP address"""
+            try:
+                s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+                s.connect(("8.8.8.8", 80))
+                ip = s.getsockname()[0]
+                s.close()
+                return ip
+            except OSError:
+                return "127.0.0.1"
 
-    def flush(self):
-        pass
+    root = tk.Tk()
+    BinTracSimulator(root)
+    root.mainloop()
 
 
 def main():
-    root = tk.Tk()
-    app = BinTracSimulator(root)
-    root.mainloop()
+    parser = argparse.ArgumentParser(description="BinTrac HouseLink Modbus TCP simulator",
+                                     formatter_class=argparse.RawDescriptionHelpFormatter,
+                                     epilog=__doc__.split("CONTROL COMMANDS")[1] if "CONTROL COMMANDS" in __doc__ else None)
+    parser.add_argument("--port", type=int, default=MODBUS_PORT, help="Modbus TCP port (default 502)")
+    parser.add_argument("--host", default="0.0.0.0", help="Address to listen on")
+    parser.add_argument("--headless", action="store_true", help="Run the scenario simulation without the GUI")
+    parser.add_argument("--scenario", help="Scenario JSON file (headless)")
+    parser.add_argument("--control-port", type=int, default=0, help="Control channel port (headless, 0 = off)")
+    parser.add_argument("--speed", type=float, help="Simulated seconds per real second (overrides the scenario)")
+    parser.add_argument("--seed", type=int, help="Random seed for noise and faults")
+    parser.add_argument("--report", type=float, default=10.0, help="Status line interval in seconds (0 = off)")
+    parser.add_argument("--bench", action="store_true", help="Measure requests/s against a running simulator")
+    parser.add_argument("--target", dest="host_target", default="127.0.0.1", help="Simulator address (--bench)")
+    parser.add_argument("--connections", type=int, default=4, help="Concurrent clients (--bench)")
+    parser.add_argument("--seconds", type=float, default=5.0, help="Duration (--bench)")
+    parser.add_argument("--reconnect", action="store_true",
+                        help="New connection per request, like the firmware (--bench)")
+    args = parser.parse_args()
+
+    if args.bench:
+        run_benchmark(args)
+    elif args.headless:
+        model = FeedModel(load_scenario(args.scenario), speed=args.speed, seed=args.seed)
+        try:
+            asyncio.run(run_headless(args, model))
+        except KeyboardInterrupt:
+            print(json.dumps(model.status()))
+    else:
+        run_gui(args.port)
 
 
 if __name__ == "__main__":